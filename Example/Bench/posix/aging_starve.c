@@ -0,0 +1,320 @@
+/*****************************************************************************
+* Product: Aging (QV_AGING) starvation benchmark, POSIX (Linux),
+*          posix-qv port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#include "qpc.h"
+
+#include <stdio.h>  /* for printf()/fprintf() */
+#include <stdlib.h> /* for exit(), atoi() */
+#include <time.h>   /* for clock_gettime() */
+
+Q_DEFINE_THIS_FILE
+
+#define TICK_NS       200000U  /* the "SysTick" period (200us) */
+#define N_TICK        1500U    /* ticks of the overload run (300ms) */
+#define N_AO          8U       /* AOs of the overhead runs */
+#define N_PING        2000000U /* RTC steps of the ping-pong run */
+#define N_FAN         200000U  /* rounds of the fan-out run */
+
+enum BenchSignals {
+    WORK_SIG = Q_USER_SIG,
+    SELF_SIG,
+    PING_SIG
+};
+
+enum BenchPhases {
+    OVERLOAD_PHASE,
+    PING_PHASE,
+    FAN_PHASE,
+    DONE_PHASE
+};
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_ao[N_AO + 1U];                /* l_ao[0] is not used */
+static QEvt const *l_aoQSto[N_AO + 1U][32];
+static QEvt const l_workEvt = QEVT_INITIALIZER(WORK_SIG);
+static QEvt const l_selfEvt = QEVT_INITIALIZER(SELF_SIG);
+static QEvt const l_pingEvt = QEVT_INITIALIZER(PING_SIG);
+
+static uint32_t l_nDone[4];
+static uint32_t l_nDrop[4];
+#ifdef QV_AGING
+static QVAgingStat l_agingStat[4];  /* QV_getAgingStat() after overload */
+#endif
+static uint32_t l_tick;
+static uint64_t l_tickNext;         /* time of the next "SysTick" */
+static uint64_t l_tickLast;         /* time of the last call to tick_() */
+static uint64_t l_stallMax;         /* longest host stall, NOTE3 */
+static uint32_t l_nStall;           /* host stalls over 1ms */
+static bool l_overDone;
+
+static uint8_t l_phase;
+static uint32_t l_round;
+static uint32_t l_pingLeft;
+static uint64_t l_t0;
+static double l_pingNs;
+static double l_fanNs;
+
+static QState AO_initial(QActive * const me, void const * const par);
+static QState AO_active(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void spin_(uint32_t ns) {
+    uint64_t const t0 = nsNow_();
+    while (nsNow_() - t0 < ns) {
+    }
+}
+/*..........................................................................*/
+static void tick_(void) { /* the "SysTick ISR" of this benchmark, NOTE2 */
+    uint64_t const now = nsNow_();
+    if (!l_overDone) { /* RTC steps are 20-30us, a longer gap is a stall */
+        if (now - l_tickLast > l_stallMax) {
+            l_stallMax = now - l_tickLast;
+        }
+        if (now - l_tickLast > 1000000U) {
+            ++l_nStall;
+        }
+        l_tickLast = now;
+    }
+    while ((!l_overDone) && (now >= l_tickNext)) {
+        l_tickNext += TICK_NS;
+        ++l_tick;
+        if (!QACTIVE_POST_X(&l_ao[2], &l_workEvt, 1U, (void *)0)) {
+            ++l_nDrop[2]; /* every 200us */
+        }
+        if ((l_tick % 5U) == 0U) { /* every 1ms */
+            if (!QACTIVE_POST_X(&l_ao[1], &l_workEvt, 1U, (void *)0)) {
+                ++l_nDrop[1];
+            }
+        }
+        if (l_tick == N_TICK) {
+            l_overDone = true; /* prio 3 stops, the queues drain */
+        }
+    }
+}
+
+/*..........................................................................*/
+int main(int argc, char *argv[]) {
+    uint_fast8_t p;
+#ifdef QV_AGING
+    /* aging threshold of prio 1 and 2 [us], 0 means no aging, NOTE1 */
+    uint32_t const thresholdUs = (argc > 1) ? (uint32_t)atoi(argv[1]) : 2000U;
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
+    QF_init();
+    for (p = 1U; p <= N_AO; ++p) {
+        QActive_ctor(&l_ao[p], Q_STATE_CAST(&AO_initial));
+        QACTIVE_START(&l_ao[p], p, l_aoQSto[p], Q_DIM(l_aoQSto[p]),
+                      (void *)0, 0U, (void *)0);
+    }
+#ifdef QV_AGING
+    QV_setAgingThreshold(1U, 1000U * thresholdUs); /* [ns] in posix-qv */
+    QV_setAgingThreshold(2U, 1000U * thresholdUs);
+    printf("aging threshold %u us\n", (unsigned)thresholdUs);
+#else
+    printf("no QV_AGING\n");
+#endif
+
+    l_tickLast = nsNow_();
+    l_tickNext = l_tickLast + TICK_NS;
+    QACTIVE_POST(&l_ao[3], &l_selfEvt, (void *)0); /* start the overload */
+    return QF_run(); /* QV_onIdle() drives the runs, NOTE2 */
+}
+
+/*..........................................................................*/
+static QState AO_initial(QActive * const me, void const * const par) {
+    (void)me;
+    (void)par;
+    return Q_TRAN(&AO_active);
+}
+/*..........................................................................*/
+static QState AO_active(QActive * const me, QEvt const * const e) {
+    QState status_;
+    switch (e->sig) {
+        case WORK_SIG: { /* the periodic jobs of prio 1 and 2 */
+            spin_(30000U);
+            if (!l_overDone) {
+                ++l_nDone[me->prio];
+            }
+            tick_();
+            status_ = Q_HANDLED();
+            break;
+        }
+        case SELF_SIG: { /* prio 3 keeps itself ready, NOTE1 */
+            spin_(20000U);
+            if (!l_overDone) {
+                ++l_nDone[me->prio];
+                QACTIVE_POST(me, &l_selfEvt, me);
+            }
+            tick_();
+            status_ = Q_HANDLED();
+            break;
+        }
+        case PING_SIG: {
+            if (l_pingLeft != 0U) { /* forward the PING? */
+                --l_pingLeft;
+                QACTIVE_POST(&l_ao[(me->prio % N_AO) + 1U], &l_pingEvt, me);
+            }
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+    uint_fast8_t p;
+    for (p = 1U; p <= 3U; ++p) {
+        printf("prio %u: %u events done during the overload, %u dropped",
+               (unsigned)p, (unsigned)l_nDone[p], (unsigned)l_nDrop[p]);
+#ifdef QV_AGING
+        printf(", waitMax %.2f ms, %u boosts",
+               (double)l_agingStat[p].waitMax / 1e6,
+               (unsigned)l_agingStat[p].nBoost);
+#endif
+        printf("\n");
+    }
+    printf("host stalls over 1ms: %u, longest %.2f ms\n",
+           (unsigned)l_nStall, (double)l_stallMax / 1e6);
+    printf("ping-pong over %u AOs: %.1f ns per post+dispatch\n"
+           "fan-out to %u ready AOs: %.1f ns per post+dispatch\n",
+           (unsigned)N_AO, l_pingNs, (unsigned)N_AO, l_fanNs);
+    exit(0);
+}
+/*..........................................................................*/
+void QF_onClockTick(void) { /* no ticker thread, see NOTE2 */
+}
+/*..........................................................................*/
+void QV_onIdle(void) { /* called with interrupts DISABLED, NOTE2 */
+    uint_fast8_t p;
+
+    QF_INT_ENABLE();
+    if ((l_phase == OVERLOAD_PHASE) && (!l_overDone)) {
+        tick_(); /* idle during the overload (prio 3 is always ready) */
+        return;
+    }
+    switch (l_phase) {
+        case OVERLOAD_PHASE: { /* the overload is over and drained */
+#ifdef QV_AGING
+            for (p = 1U; p <= 3U; ++p) {
+                l_agingStat[p] = *QV_getAgingStat(p);
+            }
+#endif
+            l_phase = PING_PHASE;
+            l_pingLeft = N_PING - 1U; /* forwards after the first PING */
+            l_t0 = nsNow_();
+            QACTIVE_POST(&l_ao[1], &l_pingEvt, (void *)0);
+            break;
+        }
+        case PING_PHASE: {
+            l_pingNs = (double)(nsNow_() - l_t0) / (double)N_PING;
+            l_phase = FAN_PHASE;
+            l_round = 0U;
+            l_t0 = nsNow_();
+        }
+        /* fall through */
+        case FAN_PHASE: {
+            if (l_round < N_FAN) {
+                ++l_round;
+                l_pingLeft = 0U; /* no PING is forwarded */
+                for (p = 1U; p <= N_AO; ++p) {
+                    QACTIVE_POST(&l_ao[p], &l_pingEvt, (void *)0);
+                }
+                break;
+            }
+            l_fanNs = (double)(nsNow_() - l_t0)
+                      / ((double)N_FAN * (double)N_AO);
+            l_phase = DONE_PHASE;
+            QF_stop(); /* calls QF_onCleanup() */
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* For 300ms the AO of priority 3 keeps itself ready with back-to-back RTC
+* steps of 20us, while the "SysTick ISR" gives the AO of priority 2 a job
+* of 30us every 200us and the AO of priority 1 one every 1ms (both with a
+* queue margin of 1, so that a starved AO drops its jobs). Without aging
+* the two lower priorities never run until the overload ends. With
+* QV_AGING each of them is served ahead of priority 3 once it has waited
+* longer than the threshold (the first argument [us], 2000 by default; 0
+* turns the aging off in the same build).
+*
+* NOTE2:
+* The benchmark runs the real QF_run() loop. The "SysTick ISR" tick_() is
+* called after every RTC step and posts the jobs of all the ticks that have
+* elapsed. QV can only schedule between RTC steps, so this is equivalent to
+* a real ISR for the scheduling decisions, and, unlike the ticker thread of
+* the posix-qv port, it is not delayed by the host scheduler when the host
+* has a single CPU. After the overload, every call to QV_onIdle()
+* means that the previous ping-pong run or fan-out round has been
+* processed, so QV_onIdle() posts the next one and returns instead of
+* sleeping. The overhead of the QV_AGING build includes the QV_CYCCNT_GET()
+* calls, which are clock_gettime() in the posix-qv port.
+*
+* NOTE3:
+* QV_readySince_[] and the threshold are wall-clock times, so a stall of the
+* whole process by the host (preemption, a CPU quota of a container or a VM)
+* is counted as waiting time, and after the stall the jobs of all the
+* elapsed ticks are posted at once. The waitMax of every priority, prio 3
+* included, is then about the threshold plus the longest stall; the
+* benchmark reports the stalls it has seen, so that the numbers can be
+* told apart from the scheduling latency of QV itself.
+*/
@@ -0,0 +1,277 @@
+/*****************************************************************************
+* Product: Earliest-deadline-first (QV_EDF) benchmark, POSIX (Linux),
+*          posix-qv port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#include "qpc.h"
+
+#include <stdio.h>  /* for printf()/fprintf() */
+#include <stdlib.h> /* for exit() */
+#include <time.h>   /* for clock_gettime() */
+
+Q_DEFINE_THIS_FILE
+
+#define N_AO      8U       /* AOs of the overhead runs */
+#define N_BURST   200U     /* bursts of the deadline run, NOTE1 */
+#define N_PING    2000000U /* RTC steps of the ping-pong run */
+#define N_FAN     200000U  /* rounds of the fan-out run */
+
+enum BenchSignals {
+    WORK_SIG = Q_USER_SIG,
+    PING_SIG
+};
+
+enum BenchPhases {
+    DEADLINE_PHASE,
+    PING_PHASE,
+    FAN_PHASE,
+    DONE_PHASE
+};
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_ao[N_AO + 1U];                /* l_ao[0] is not used */
+static QEvt const *l_aoQSto[N_AO + 1U][32];
+#ifdef QV_EDF
+static uint32_t l_dlSto[N_AO + 1U][32];        /* per-slot deadlines */
+#endif
+static QEvt const l_workEvt = QEVT_INITIALIZER(WORK_SIG);
+static QEvt const l_pingEvt = QEVT_INITIALIZER(PING_SIG);
+
+static uint32_t const l_cost[3] = { 0U, 10000U, 40000U }; /* C [ns] */
+static uint32_t const l_rel[3]  = { 0U, 60000U, 400000U }; /* D [ns] */
+static uint64_t l_posted[3][4];  /* post times of the WORK events */
+static uint8_t l_head[3];
+static uint8_t l_tail[3];
+static uint32_t l_nDone[3];
+static uint32_t l_nMiss[3];
+
+static uint8_t l_phase;
+static uint32_t l_round;
+static uint32_t l_pingLeft;
+static uint64_t l_t0;
+static double l_pingNs;
+static double l_fanNs;
+static double l_cyccntNs;        /* cost of one QV_CYCCNT_GET() */
+#ifdef QV_EDF
+static QVEdfStat l_edfStat[3];   /* QV_getEdfStat() after the deadline run */
+#endif
+
+static QState AO_initial(QActive * const me, void const * const par);
+static QState AO_active(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void postWork_(uint_fast8_t p) {
+    l_posted[p][l_head[p] & 3U] = nsNow_();
+    ++l_head[p];
+    QACTIVE_POST(&l_ao[p], &l_workEvt, (void *)0);
+}
+
+/*..........................................................................*/
+int main(void) {
+    uint_fast8_t p;
+    uint32_t volatile sink = 0U;
+    uint64_t t0;
+    uint32_t k;
+
+    t0 = nsNow_();
+    for (k = 0U; k < 1000000U; ++k) {
+        sink += QV_CYCCNT_GET();
+    }
+    l_cyccntNs = (double)(nsNow_() - t0) / 1e6;
+    (void)sink;
+
+    QF_init();
+    for (p = 1U; p <= N_AO; ++p) {
+        QActive_ctor(&l_ao[p], Q_STATE_CAST(&AO_initial));
+        QACTIVE_START(&l_ao[p], p, l_aoQSto[p], Q_DIM(l_aoQSto[p]),
+                      (void *)0, 0U, (void *)0);
+#ifdef QV_EDF
+        QV_edfSet(p, (p < Q_DIM(l_rel)) ? l_rel[p] : 1000000U,
+                  l_dlSto[p], Q_DIM(l_dlSto[p]));
+#endif
+    }
+    return QF_run(); /* QV_onIdle() drives the runs, NOTE2 */
+}
+
+/*..........................................................................*/
+static QState AO_initial(QActive * const me, void const * const par) {
+    (void)me;
+    (void)par;
+    return Q_TRAN(&AO_active);
+}
+/*..........................................................................*/
+static QState AO_active(QActive * const me, QEvt const * const e) {
+    QState status_;
+    switch (e->sig) {
+        case WORK_SIG: {
+            uint_fast8_t const p = me->prio;
+            uint64_t const t0 = nsNow_();
+            while (nsNow_() - t0 < l_cost[p]) { /* the computation C */
+            }
+            if (nsNow_() - l_posted[p][l_tail[p] & 3U] > l_rel[p]) {
+                ++l_nMiss[p];
+            }
+            ++l_tail[p];
+            ++l_nDone[p];
+            status_ = Q_HANDLED();
+            break;
+        }
+        case PING_SIG: {
+            if (l_pingLeft != 0U) { /* forward the PING? */
+                --l_pingLeft;
+                QACTIVE_POST(&l_ao[(me->prio % N_AO) + 1U], &l_pingEvt, me);
+            }
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+#ifdef QV_EDF
+    printf("EDF");
+#else
+    printf("fixed priority");
+#endif
+    printf(" deadline run: prio 1 (C=10us, D=60us) missed %u/%u, "
+           "prio 2 (C=40us, D=400us) missed %u/%u\n",
+           (unsigned)l_nMiss[1], (unsigned)l_nDone[1],
+           (unsigned)l_nMiss[2], (unsigned)l_nDone[2]);
+#ifdef QV_EDF
+    printf("QV_getEdfStat(): prio 1 nMiss %u lateMax %u ns, "
+           "prio 2 nMiss %u lateMax %u ns\n",
+           (unsigned)l_edfStat[1].nMiss, (unsigned)l_edfStat[1].lateMax,
+           (unsigned)l_edfStat[2].nMiss, (unsigned)l_edfStat[2].lateMax);
+#endif
+    printf("ping-pong over %u AOs: %.1f ns per post+dispatch\n"
+           "fan-out to %u ready AOs: %.1f ns per post+dispatch\n"
+           "QV_CYCCNT_GET(): %.1f ns per call\n",
+           (unsigned)N_AO, l_pingNs, (unsigned)N_AO, l_fanNs, l_cyccntNs);
+    exit(((l_nDone[1] == N_BURST) && (l_nDone[2] == 2U * N_BURST)) ? 0 : 1);
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+}
+/*..........................................................................*/
+void QV_onIdle(void) { /* called with interrupts DISABLED, NOTE2 */
+    uint_fast8_t p;
+
+    QF_INT_ENABLE();
+    switch (l_phase) {
+        case DEADLINE_PHASE: { /* the previous burst is done */
+            if (l_round < N_BURST) {
+                ++l_round;
+                postWork_(2U); /* two long jobs of the fixed-priority */
+                postWork_(2U); /* "more important" AO... */
+                postWork_(1U); /* ...and one short job with a tight D */
+                break;
+            }
+#ifdef QV_EDF
+            l_edfStat[1] = *QV_getEdfStat(1U);
+            l_edfStat[2] = *QV_getEdfStat(2U);
+#endif
+            l_phase = PING_PHASE;
+            l_pingLeft = N_PING - 1U; /* forwards after the first PING */
+            l_t0 = nsNow_();
+            QACTIVE_POST(&l_ao[1], &l_pingEvt, (void *)0);
+            break;
+        }
+        case PING_PHASE: {
+            l_pingNs = (double)(nsNow_() - l_t0) / (double)N_PING;
+            l_phase = FAN_PHASE;
+            l_round = 0U;
+            l_t0 = nsNow_();
+        }
+        /* fall through */
+        case FAN_PHASE: {
+            if (l_round < N_FAN) {
+                ++l_round;
+                l_pingLeft = 0U; /* no PING is forwarded */
+                for (p = 1U; p <= N_AO; ++p) {
+                    QACTIVE_POST(&l_ao[p], &l_pingEvt, (void *)0);
+                }
+                break;
+            }
+            l_fanNs = (double)(nsNow_() - l_t0)
+                      / ((double)N_FAN * (double)N_AO);
+            l_phase = DONE_PHASE;
+            QF_stop(); /* calls QF_onCleanup() */
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* In the deadline run the AO of priority 2 gets two jobs of C=40us with a
+* relative deadline D=400us and the AO of priority 1 one job of C=10us with
+* D=60us, all posted at once, N_BURST times. Fixed priorities run the two
+* long jobs first, so the short job always finishes after 90us. EDF runs
+* the short job first, because its absolute deadline is the earliest. Build
+* with and without -DQV_EDF to compare the two schedulers.
+*
+* NOTE2:
+* The benchmark runs the real QF_run() loop. Every call to QV_onIdle()
+* means that the previous burst (or the whole ping-pong run) has been
+* processed, so QV_onIdle() posts the next burst like an ISR would and
+* returns instead of sleeping. In the fan-out run no PING is forwarded, so
+* each round is N_AO posts and N_AO dispatches.
+*
+* Under QV_EDF every post stamps the absolute deadline and every dispatch
+* checks it, with QV_CYCCNT_GET(), which is clock_gettime() in the posix-qv
+* port and a single load of DWT->CYCCNT on Cortex-M. The benchmark prints
+* the cost of one QV_CYCCNT_GET() call, so that it can be subtracted from
+* the overhead of the EDF build.
+*/
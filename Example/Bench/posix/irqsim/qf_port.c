@@ -0,0 +1,104 @@
+/**
+* @file
+* @brief QF/C port to POSIX, simulated interrupts (benchmarks only)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#define _POSIX_C_SOURCE 200809L /* sigaction(), sigprocmask() */
+
+/* This port is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+#include "qassert.h"
+
+#include <signal.h>
+#include <sys/time.h>
+
+Q_DEFINE_THIS_MODULE("qf_port")
+
+/* Local objects ***********************************************************/
+static sigset_t l_irqMask;       /* just SIGALRM */
+static void (*l_isr)(void);      /* the application "ISR" */
+
+/*..........................................................................*/
+void QF_enterCriticalSection_(void) {
+    sigprocmask(SIG_BLOCK, &l_irqMask, (sigset_t *)0);
+}
+/*..........................................................................*/
+void QF_leaveCriticalSection_(void) {
+    sigprocmask(SIG_UNBLOCK, &l_irqMask, (sigset_t *)0);
+}
+/*..........................................................................*/
+static void sigHandler_(int sig) {
+    (void)sig;
+    (*l_isr)();
+}
+/*..........................................................................*/
+void QF_irqStart(void (*isr)(void), uint32_t periodUs) {
+    struct sigaction sa;
+    struct itimerval it;
+
+    Q_REQUIRE_ID(100, (isr != (void (*)(void))0) && (periodUs != 0U));
+
+    sigemptyset(&l_irqMask);
+    sigaddset(&l_irqMask, SIGALRM);
+    l_isr = isr;
+
+    sa.sa_handler = &sigHandler_;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    Q_ALLEGE_ID(110, sigaction(SIGALRM, &sa, (struct sigaction *)0) == 0);
+
+    it.it_interval.tv_sec  = (time_t)(periodUs / 1000000U);
+    it.it_interval.tv_usec = (suseconds_t)(periodUs % 1000000U);
+    it.it_value = it.it_interval;
+    Q_ALLEGE_ID(120, setitimer(ITIMER_REAL, &it, (struct itimerval *)0) == 0);
+}
+/*..........................................................................*/
+void QF_irqStop(void) {
+    struct itimerval it = { { 0, 0 }, { 0, 0 } };
+    (void)setitimer(ITIMER_REAL, &it, (struct itimerval *)0);
+}
+
+#ifndef QF_IRQSIM_QK
+/*..........................................................................*/
+void QV_sleep_(void) {
+    sigset_t mask;
+    sigprocmask(SIG_BLOCK, (sigset_t *)0, &mask); /* the current mask */
+    sigdelset(&mask, SIGALRM);
+    sigsuspend(&mask); /* atomically unblock SIGALRM and wait for it */
+    QF_INT_ENABLE();
+}
+#endif
@@ -0,0 +1,100 @@
+/**
+* @file
+* @brief QF/C port to POSIX, simulated interrupts, QV or QK kernel (benchmarks only)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#ifndef QF_PORT_H
+#define QF_PORT_H
+
+/* The maximum number of active objects in the application */
+#define QF_MAX_ACTIVE           64U
+
+/* The maximum number of system clock tick rates */
+#define QF_MAX_TICK_RATE        2U
+
+/* QF interrupt disable/enable (block/unblock SIGALRM), see NOTE1 */
+#define QF_INT_DISABLE()        QF_enterCriticalSection_()
+#define QF_INT_ENABLE()         QF_leaveCriticalSection_()
+
+/* QF critical section entry/exit (unconditional) */
+/*#define QF_CRIT_STAT_TYPE not defined */
+#define QF_CRIT_ENTRY(dummy)    QF_enterCriticalSection_()
+#define QF_CRIT_EXIT(dummy)     QF_leaveCriticalSection_()
+
+/* GCC/Clang builtin for fast LOG2 */
+#define QF_LOG2(n_) ((uint_fast8_t)(32U - __builtin_clz((unsigned)(n_))))
+
+#include "qep_port.h" /* QEP port */
+
+/* enter/leave the critical section (block/unblock SIGALRM) */
+void QF_enterCriticalSection_(void);
+void QF_leaveCriticalSection_(void);
+
+/* call isr() from SIGALRM every periodUs [us], see NOTE2 */
+void QF_irqStart(void (*isr)(void), uint32_t periodUs);
+
+/* stop the simulated interrupt */
+void QF_irqStop(void);
+
+#ifdef QF_IRQSIM_QK /* see NOTE3 */
+#include "qk_port.h"  /* QK preemptive kernel port */
+#else
+#include "qv_port.h"  /* QV cooperative kernel port */
+#endif
+#include "qf.h"       /* QF platform-independent public interface */
+
+/*****************************************************************************
+* NOTE1:
+* This port runs the whole application in one POSIX thread and uses
+* SIGALRM as the only interrupt, so that the interrupt latency of the QV
+* and QK kernels can be compared on the host with the unmodified kernel
+* sources. The critical section blocks SIGALRM with sigprocmask(), which
+* is the equivalent of disabling the QF-aware interrupts on Cortex-M.
+*
+* NOTE2:
+* The "ISR" is an ordinary function of the application that must bracket
+* its body with QK_ISR_ENTRY()/QK_ISR_EXIT() under QK, like the ISRs of a
+* Cortex-M BSP. It runs in the SIGALRM handler, with SIGALRM blocked.
+*
+* NOTE3:
+* The kernel is selected at compile time: define QF_IRQSIM_QK and build
+* qpc/src/qk/qk.c for QK, or build qpc/src/qv/qv.c for QV. Under QK,
+* QK_ISR_EXIT() runs the activator directly in the signal handler, with
+* SIGALRM unblocked during the RTC steps, which plays the role of PendSV on
+* Cortex-M (the preempted AO resumes when the signal handler returns).
+*/
+
+#endif /* QF_PORT_H */
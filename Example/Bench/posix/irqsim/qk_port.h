@@ -0,0 +1,71 @@
+/**
+* @file
+* @brief QK/C port to POSIX, simulated interrupts (benchmarks only)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#ifndef QK_PORT_H
+#define QK_PORT_H
+
+/* QK interrupt entry and exit, see NOTE1 */
+#define QK_ISR_ENTRY() do { \
+    QF_INT_DISABLE();       \
+    ++QK_attr_.intNest;     \
+    QF_INT_ENABLE();        \
+} while (false)
+
+#define QK_ISR_EXIT()  do {     \
+    QF_INT_DISABLE();           \
+    --QK_attr_.intNest;         \
+    if (QK_sched_() != 0U) {    \
+        QK_activate_();         \
+    }                           \
+    QF_INT_ENABLE();            \
+} while (false)
+
+/* no ARM Erratum 838869 on POSIX */
+#define QK_ARM_ERRATUM_838869() ((void)0)
+
+#include "qk.h" /* QK platform-independent public interface */
+
+/*****************************************************************************
+* NOTE1:
+* There is no IPSR on the host, so QK_ISR_ENTRY() counts the interrupt
+* nesting in QK_attr_.intNest, which the default QK_ISR_CONTEXT_() checks.
+* QK_ISR_EXIT() activates the preempting AOs directly, instead of pending
+* PendSV as the Cortex-M port does.
+*/
+
+#endif /* QK_PORT_H */
@@ -0,0 +1,59 @@
+/**
+* @file
+* @brief QV/C port to POSIX, simulated interrupts (benchmarks only)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#ifndef QV_PORT_H
+#define QV_PORT_H
+
+/* atomically unblock SIGALRM and wait for it inside QV_onIdle(), see NOTE1 */
+#define QV_CPU_SLEEP() QV_sleep_()
+void QV_sleep_(void);
+
+/* no ARM Erratum 838869 on POSIX */
+#define QV_ARM_ERRATUM_838869() ((void)0)
+
+#include "qv.h" /* QV platform-independent public interface */
+
+/*****************************************************************************
+* NOTE1:
+* QV_CPU_SLEEP() must be called with SIGALRM blocked, as QV_onIdle() is
+* called. It waits in sigsuspend(), which unblocks SIGALRM atomically, just
+* like WFI on Cortex-M wakes up with interrupts still masked by PRIMASK.
+* On return SIGALRM is unblocked.
+*/
+
+#endif /* QV_PORT_H */
@@ -0,0 +1,243 @@
+/*****************************************************************************
+* Product: QV vs. QK interrupt latency benchmark, POSIX (Linux),
+*          irqsim port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#define _POSIX_C_SOURCE 200809L /* clock_gettime() */
+#include "qpc.h"
+
+#include <stdio.h>  /* for printf()/fprintf() */
+#include <stdlib.h> /* for exit(), atoi(), qsort() */
+#include <time.h>   /* for clock_gettime() */
+
+Q_DEFINE_THIS_FILE
+
+#define N_PHILO   5U     /* background AOs with long RTC steps, NOTE1 */
+#define N_SAMPLE  3000U  /* latency samples */
+#define ISR_US    997U   /* period of the "ISR" [us] */
+
+enum BenchSignals {
+    STEP_SIG = Q_USER_SIG,
+    TICK_SIG
+};
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_philo[N_PHILO];
+static QEvt const *l_philoQSto[N_PHILO][4];
+static QActive l_hp;                     /* the high-priority AO */
+static QEvt const *l_hpQSto[4];
+static QEvt const l_stepEvt = QEVT_INITIALIZER(STEP_SIG);
+static QEvt const l_tickEvt = QEVT_INITIALIZER(TICK_SIG);
+
+static uint64_t l_stepNs;                /* length of one Philo RTC step */
+static uint64_t volatile l_isrNs;        /* time stamp of the last "ISR" */
+static uint32_t l_lat[N_SAMPLE];         /* ISR --> AO latency [ns] */
+static uint32_t l_nSample;
+static bool volatile l_done;
+
+static QState Philo_initial(QActive * const me, void const * const par);
+static QState Philo_busy(QActive * const me, QEvt const * const e);
+static QState Hp_initial(QActive * const me, void const * const par);
+static QState Hp_active(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static int cmp_(void const *a, void const *b) {
+    uint32_t const x = *(uint32_t const *)a;
+    uint32_t const y = *(uint32_t const *)b;
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+/*..........................................................................*/
+static void isr_(void) { /* the "SysTick ISR" of this benchmark, NOTE2 */
+#ifdef QK_H
+    QK_ISR_ENTRY(); /* inform QK about entering an ISR */
+#endif
+    if (!l_done) {
+        l_isrNs = nsNow_();
+        QACTIVE_POST(&l_hp, &l_tickEvt, (void *)0);
+    }
+#ifdef QK_H
+    QK_ISR_EXIT();  /* inform QK about exiting an ISR */
+#endif
+}
+
+/*..........................................................................*/
+int main(int argc, char *argv[]) {
+    uint_fast8_t n;
+
+    l_stepNs = 1000U * (uint64_t)((argc > 1) ? atoi(argv[1]) : 50);
+
+    QF_init();
+    for (n = 0U; n < N_PHILO; ++n) {
+        QActive_ctor(&l_philo[n], Q_STATE_CAST(&Philo_initial));
+        QACTIVE_START(&l_philo[n], (uint_fast8_t)(n + 1U),
+                      l_philoQSto[n], Q_DIM(l_philoQSto[n]),
+                      (void *)0, 0U, (void *)0);
+    }
+    QActive_ctor(&l_hp, Q_STATE_CAST(&Hp_initial));
+    QACTIVE_START(&l_hp, N_PHILO + 1U, l_hpQSto, Q_DIM(l_hpQSto),
+                  (void *)0, 0U, (void *)0);
+
+    /* start the "SysTick" here, because QK runs the Philos already in
+    * QF_run() before QF_onStartup() and they are never idle, NOTE1
+    */
+    QF_irqStart(&isr_, ISR_US);
+
+    return QF_run(); /* QF_onCleanup() reports the results and exits */
+}
+
+/*..........................................................................*/
+static QState Philo_initial(QActive * const me, void const * const par) {
+    (void)par;
+    QACTIVE_POST(me, &l_stepEvt, me);
+    return Q_TRAN(&Philo_busy);
+}
+/*..........................................................................*/
+static QState Philo_busy(QActive * const me, QEvt const * const e) {
+    QState status_;
+    switch (e->sig) {
+        case STEP_SIG: {
+            uint64_t const t0 = nsNow_();
+            while (nsNow_() - t0 < l_stepNs) { /* one long RTC step */
+            }
+            if (!l_done) {
+                QACTIVE_POST(me, &l_stepEvt, me); /* the next step */
+            }
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+/*..........................................................................*/
+static QState Hp_initial(QActive * const me, void const * const par) {
+    (void)me;
+    (void)par;
+    return Q_TRAN(&Hp_active);
+}
+/*..........................................................................*/
+static QState Hp_active(QActive * const me, QEvt const * const e) {
+    QState status_;
+    (void)me;
+    switch (e->sig) {
+        case TICK_SIG: {
+            l_lat[l_nSample] = (uint32_t)(nsNow_() - l_isrNs);
+            ++l_nSample;
+            if (l_nSample == N_SAMPLE) {
+                l_done = true; /* the Philos stop and QF becomes idle */
+            }
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+    uint64_t sum = 0U;
+    uint32_t k;
+
+    QF_irqStop();
+    for (k = 0U; k < N_SAMPLE; ++k) {
+        sum += l_lat[k];
+    }
+    qsort(l_lat, N_SAMPLE, sizeof(l_lat[0]), &cmp_);
+#ifdef QK_H
+    printf("QK");
+#else
+    printf("QV");
+#endif
+    printf(" step %u us: ISR->AO latency mean %.1f us, p50 %.1f us, "
+           "p99 %.1f us, max %.1f us\n",
+           (unsigned)(l_stepNs / 1000U),
+           (double)sum / (double)N_SAMPLE / 1e3,
+           (double)l_lat[N_SAMPLE / 2U] / 1e3,
+           (double)l_lat[(N_SAMPLE * 99U) / 100U] / 1e3,
+           (double)l_lat[N_SAMPLE - 1U] / 1e3);
+    exit(0);
+}
+/*..........................................................................*/
+#ifdef QK_H
+void QK_onIdle(void) { /* called with interrupts ENABLED */
+    if (l_done) {
+        QF_stop();
+    }
+}
+#else
+void QV_onIdle(void) { /* called with interrupts DISABLED */
+    if (l_done) {
+        QF_INT_ENABLE();
+        QF_stop();
+    }
+    else {
+        QV_CPU_SLEEP(); /* atomically go to sleep and enable interrupts */
+    }
+}
+#endif
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* Five Philo-like AOs (priorities 1..5) run back-to-back RTC steps of a
+* configurable length (the first argument [us], 50 by default), as the
+* DPP example does under load. An "ISR" posts to the AO of priority 6
+* about every millisecond, and the benchmark measures the time from the
+* post in the ISR to the start of the RTC step of that AO.
+*
+* NOTE2:
+* The ISR follows the BSPs of the DPP and Blinky examples: under QK it is
+* bracketed with QK_ISR_ENTRY()/QK_ISR_EXIT(), so the high-priority AO
+* preempts the running Philo right at the end of the ISR. Under QV the AO
+* runs only after the current RTC step has completed, so the QV latency is
+* bounded by the longest RTC step and the QK latency is not.
+*/
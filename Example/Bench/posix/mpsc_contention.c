@@ -0,0 +1,242 @@
+/*****************************************************************************
+* Product: Event queue contention benchmark, POSIX (Linux), posix port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#define _POSIX_C_SOURCE 200809L /* clock_gettime(), sched_yield() */
+#include "qpc.h"
+
+#include <stdio.h>   /* for printf()/fprintf() */
+#include <stdlib.h>  /* for exit(), atoi() */
+#include <time.h>    /* for clock_gettime() */
+#include <sched.h>   /* for sched_yield() */
+#include <pthread.h> /* for the producer threads */
+
+Q_DEFINE_THIS_FILE
+
+#define MAX_PROD   16U       /* the most producer threads of a run */
+#define N_POST     2000000U  /* events posted by all producers together */
+#define N_DEFER    5U        /* events of the recall check, NOTE2 */
+
+typedef struct {
+    QEvt super;
+    uint32_t n;
+} NumEvt;
+
+enum BenchSignals {
+    DATA_SIG = Q_USER_SIG, /* producer --> consumer */
+    DEFER_SIG              /* events of the recall check */
+};
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_cons;                  /* the consumer AO */
+static QEvt const *l_consQSto[200];
+static QEQueue l_deferQueue;
+static QEvt const *l_deferQSto[N_DEFER];
+static QF_MPOOL_EL(NumEvt) l_poolSto[1024];
+static QEvt const l_dataEvt = QEVT_INITIALIZER(DATA_SIG);
+
+static uint_fast8_t l_nProd;
+static bool l_dynamic;                  /* post dynamic events? */
+static uint32_t volatile l_nRecv;       /* DATA events received */
+static uint32_t l_order[N_DEFER];       /* order of the DEFER events */
+static uint_fast8_t volatile l_nOrder;
+
+static QState Cons_initial(QActive * const me, void const * const par);
+static QState Cons_active(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void *producer_(void *arg) {
+    uint32_t k;
+    (void)arg;
+    for (k = 0U; k < N_POST / l_nProd; ++k) {
+        if (l_dynamic) {
+            for (;;) { /* retry while the pool or the queue is full */
+                NumEvt *ne;
+                Q_NEW_X(ne, NumEvt, 1U, DATA_SIG);
+                if (ne != (NumEvt *)0) {
+                    ne->n = k;
+                    if (QACTIVE_POST_X(&l_cons, &ne->super, 1U, (void *)0)) {
+                        break;
+                    }
+                    /* not posted, QActive_post_() has recycled the event */
+                }
+                sched_yield();
+            }
+        }
+        else {
+            while (!QACTIVE_POST_X(&l_cons, &l_dataEvt, 1U, (void *)0)) {
+                sched_yield();
+            }
+        }
+    }
+    return (void *)0;
+}
+/*..........................................................................*/
+static void *runner_(void *arg) { /* drives the checks and the run */
+    static uint32_t const expected[N_DEFER] = { 4U, 3U, 2U, 1U, 0U };
+    pthread_t thread[MAX_PROD];
+    uint_fast8_t n;
+    uint64_t t0;
+    bool recallOk = true;
+    (void)arg;
+
+    /* 1. defer and recall, NOTE2 */
+    for (n = 0U; n < N_DEFER; ++n) {
+        NumEvt *ne = Q_NEW(NumEvt, DEFER_SIG);
+        ne->n = n;
+        QACTIVE_POST(&l_cons, &ne->super, (void *)0);
+    }
+    while (l_nOrder < N_DEFER) {
+        sched_yield();
+    }
+    printf("recall order:");
+    for (n = 0U; n < N_DEFER; ++n) {
+        printf(" %u", (unsigned)l_order[n]);
+        if (l_order[n] != expected[n]) {
+            recallOk = false;
+        }
+    }
+    printf("\n");
+
+    /* 2. the producers post N_POST events to the consumer, NOTE1 */
+    t0 = nsNow_();
+    for (n = 0U; n < l_nProd; ++n) {
+        Q_ALLEGE(pthread_create(&thread[n], (pthread_attr_t *)0,
+                                &producer_, (void *)0) == 0);
+    }
+    for (n = 0U; n < l_nProd; ++n) {
+        pthread_join(thread[n], (void **)0);
+    }
+    while (l_nRecv < (N_POST / l_nProd) * l_nProd) {
+        sched_yield();
+    }
+    printf("%u producers, %s events: %.2f Mposts/s, queue min %u free\n",
+           (unsigned)l_nProd, l_dynamic ? "dynamic" : "static",
+           (double)l_nRecv * 1e3 / (double)(nsNow_() - t0),
+           (unsigned)QF_getQueueMin(l_cons.prio));
+    exit(recallOk ? 0 : 1); /* the AO thread is not joined */
+}
+
+/*..........................................................................*/
+int main(int argc, char *argv[]) {
+    /* arguments: producer threads, 1 for dynamic events */
+    l_nProd   = (argc > 1) ? (uint_fast8_t)atoi(argv[1]) : 1U;
+    l_dynamic = (argc > 2) && (atoi(argv[2]) != 0);
+    Q_REQUIRE((0U < l_nProd) && (l_nProd <= MAX_PROD));
+
+    QF_init();
+    QF_poolInit(l_poolSto, sizeof(l_poolSto), sizeof(l_poolSto[0]));
+    QEQueue_init(&l_deferQueue, l_deferQSto, Q_DIM(l_deferQSto));
+    QActive_ctor(&l_cons, Q_STATE_CAST(&Cons_initial));
+    QACTIVE_START(&l_cons, 1U, l_consQSto, Q_DIM(l_consQSto),
+                  (void *)0, 0U, (void *)0);
+    return QF_run();
+}
+
+/*..........................................................................*/
+static QState Cons_initial(QActive * const me, void const * const par) {
+    (void)me;
+    (void)par;
+    return Q_TRAN(&Cons_active);
+}
+/*..........................................................................*/
+static QState Cons_active(QActive * const me, QEvt const * const e) {
+    QState status_;
+    switch (e->sig) {
+        case DATA_SIG: {
+            ++l_nRecv;
+            status_ = Q_HANDLED();
+            break;
+        }
+        case DEFER_SIG: {
+            uint32_t const n = Q_EVT_CAST(NumEvt)->n;
+            if ((l_nOrder == 0U) && (n < N_DEFER - 1U)) {
+                (void)QActive_defer(me, &l_deferQueue, e);
+            }
+            else {
+                l_order[l_nOrder] = n;
+                ++l_nOrder;
+                if (n == N_DEFER - 1U) { /* the last one recalls the rest */
+                    while (QActive_recall(me, &l_deferQueue)) {
+                    }
+                }
+            }
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+    pthread_t thread;
+    Q_ALLEGE(pthread_create(&thread, (pthread_attr_t *)0,
+                            &runner_, (void *)0) == 0);
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+}
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* P producer threads (the first argument) post N_POST events in total to
+* one AO with a margin of 1, and retry with sched_yield() while its queue is
+* full. With the second argument 1 every event is a dynamic event. Built
+* without options the AO uses the native QEQueue under the global QF mutex;
+* built with -std=c11 -DQF_MPSC_QUEUE (and qf_mpsc.c) the lock-free MPSC
+* queue of the posix port.
+*
+* NOTE2:
+* Before the run the AO defers four events and recalls them all when the
+* fifth one arrives. QActive_recall() posts with LIFO, so the events come
+* back in the reverse order. The MPSC queue implements LIFO differently
+* from QEQueue, and both queues must hand the events back in this order.
+*/
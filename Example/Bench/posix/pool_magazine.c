@@ -0,0 +1,156 @@
+/*****************************************************************************
+* Product: Event pool magazine benchmark, POSIX (Linux), posix port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#define _POSIX_C_SOURCE 200809L /* clock_gettime() */
+#include "qpc.h"
+
+#include <stdio.h>   /* for printf()/fprintf() */
+#include <stdlib.h>  /* for exit(), atoi() */
+#include <time.h>    /* for clock_gettime() */
+#include <pthread.h> /* for the allocating threads */
+
+Q_DEFINE_THIS_FILE
+
+#define MAX_THREAD 16U      /* the most threads of a run */
+#define N_EVT      4000000U /* events allocated by all threads together */
+#define N_BURST    4U       /* events each thread holds at a time */
+#define N_BLOCK    4096U    /* blocks of the event pool */
+
+typedef struct {
+    QEvt super;
+    uint32_t payload[4];
+} BenchEvt;
+
+/* Local-scope objects -----------------------------------------------------*/
+static QF_MPOOL_EL(BenchEvt) l_poolSto[N_BLOCK];
+static uint_fast8_t l_nThread;
+
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void *alloc_(void *arg) { /* Q_NEW() and QF_gc() in bursts, NOTE1 */
+    uint32_t k;
+    (void)arg;
+    for (k = 0U; k < N_EVT / l_nThread; k += N_BURST) {
+        BenchEvt *be[N_BURST];
+        uint_fast8_t n;
+        for (n = 0U; n < N_BURST; ++n) {
+            be[n] = Q_NEW(BenchEvt, Q_USER_SIG);
+        }
+        for (n = 0U; n < N_BURST; ++n) {
+            QF_gc(&be[n]->super);
+        }
+    }
+    return (void *)0; /* the exit of the thread flushes its magazines */
+}
+
+/*..........................................................................*/
+int main(int argc, char *argv[]) {
+    pthread_t thread[MAX_THREAD];
+    uint_fast8_t n;
+    uint64_t t0;
+    double rate;
+    uint_fast16_t nMin;
+    uint32_t nFree = 0U;
+
+    /* argument: number of allocating threads */
+    l_nThread = (argc > 1) ? (uint_fast8_t)atoi(argv[1]) : 1U;
+    Q_REQUIRE((0U < l_nThread) && (l_nThread <= MAX_THREAD));
+
+    QF_init();
+    QF_poolInit(l_poolSto, sizeof(l_poolSto), sizeof(l_poolSto[0]));
+
+    t0 = nsNow_();
+    for (n = 0U; n < l_nThread; ++n) {
+        Q_ALLEGE(pthread_create(&thread[n], (pthread_attr_t *)0,
+                                &alloc_, (void *)0) == 0);
+    }
+    for (n = 0U; n < l_nThread; ++n) {
+        pthread_join(thread[n], (void **)0);
+    }
+    rate = (double)((N_EVT / l_nThread) * l_nThread) * 1e3
+           / (double)(nsNow_() - t0);
+    nMin = QF_getPoolMin(1U);
+
+    /* count the free blocks after all threads have exited, NOTE2 */
+    for (;;) {
+        BenchEvt *be;
+        Q_NEW_X(be, BenchEvt, 0U, Q_USER_SIG);
+        if (be == (BenchEvt *)0) {
+            break;
+        }
+        ++nFree;
+    }
+
+    printf("%u threads: %.2f M alloc+free/s, pool min %u, "
+           "%u of %u blocks free after the threads exited\n",
+           (unsigned)l_nThread, rate, (unsigned)nMin,
+           (unsigned)nFree, (unsigned)N_BLOCK);
+    return (nFree == N_BLOCK) ? 0 : 1;
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+}
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* T threads (the argument) together allocate and free N_EVT events, each
+* thread holding N_BURST events at a time, without QF_run(). Built without
+* options every Q_NEW() and QF_gc() takes the global QF mutex for the free
+* list of the pool; built with -DQF_POOL_MAG=16U (and qf_mag.c) they are
+* served from the magazines of the calling thread, and the mutex is taken
+* only to refill or drain a magazine by one batch. QF_gc() still takes it
+* to check the reference counter.
+*
+* NOTE2:
+* QF_getPoolMin() counts the blocks cached in the magazines as used, so it
+* is a conservative lower bound. The magazines of a thread are returned to
+* the pool when the thread exits, so after the join the main thread must be
+* able to allocate all N_BLOCK blocks again.
+*/
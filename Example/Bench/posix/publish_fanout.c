@@ -0,0 +1,185 @@
+/*****************************************************************************
+* Product: Publish fan-out benchmark, POSIX (Linux), posix-qv port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#define QP_IMPL      /* drains the queues with QActive_get_(), see NOTE1 */
+#include "qpc.h"
+#include "qf_pkg.h"
+
+#include <stdio.h>  /* for printf()/fprintf() */
+#include <stdlib.h> /* for exit() */
+#include <time.h>   /* for clock_gettime() */
+
+Q_DEFINE_THIS_FILE
+
+#define MAX_SUB  32U     /* the largest fan-out measured */
+#define N_ROUNDS 200000U /* publishes per fan-out */
+
+enum BenchSignals {
+    DATA_SIG = Q_USER_SIG,
+    MAX_PUB_SIG
+};
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_sub[MAX_SUB];
+static QEvt const *l_subQSto[MAX_SUB][4];
+static QSubscrList l_subscrSto[MAX_PUB_SIG];
+static QF_MPOOL_EL(QEvt) l_poolSto[8];
+static uint32_t l_nRecv;
+
+static QState Sub_initial(QActive * const me, void const * const par);
+static QState Sub_idle(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void drain_(uint_fast8_t nSub) { /* consume without QF_run() */
+    uint_fast8_t n;
+    for (n = 0U; n < nSub; ++n) {
+        while (l_sub[n].eQueue.frontEvt != (QEvt *)0) {
+            QEvt const *e = QActive_get_(&l_sub[n]);
+            ++l_nRecv;
+            QF_gc(e);
+        }
+    }
+    QF_INT_DISABLE();
+    QPSet_setEmpty(&QV_readySet_);
+    QF_INT_ENABLE();
+}
+
+/*..........................................................................*/
+int main(void) {
+    static uint_fast8_t const fanOut[] = { 1U, 2U, 4U, 8U, 16U, 32U };
+    uint_fast8_t i;
+    uint_fast8_t n;
+
+    QF_init();
+    QF_psInit(l_subscrSto, Q_DIM(l_subscrSto));
+    QF_poolInit(l_poolSto, sizeof(l_poolSto), sizeof(l_poolSto[0]));
+    for (n = 0U; n < MAX_SUB; ++n) {
+        QActive_ctor(&l_sub[n], Q_STATE_CAST(&Sub_initial));
+        QACTIVE_START(&l_sub[n], (uint_fast8_t)(n + 1U),
+                      l_subQSto[n], Q_DIM(l_subQSto[n]),
+                      (void *)0, 0U, (void *)0);
+    }
+
+    printf("subscribers  publish [ns]  post loop [ns]\n");
+    for (i = 0U; i < Q_DIM(fanOut); ++i) {
+        uint64_t tPub  = 0U;
+        uint64_t tPost = 0U;
+        uint32_t r;
+
+        for (n = 0U; n < MAX_SUB; ++n) {
+            if (n < fanOut[i]) {
+                QActive_subscribe(&l_sub[n], DATA_SIG);
+            }
+            else {
+                QActive_unsubscribe(&l_sub[n], DATA_SIG);
+            }
+        }
+        l_nRecv = 0U;
+        for (r = 0U; r < N_ROUNDS; ++r) {
+            uint64_t t0;
+            QEvt *e;
+
+            /* multicast through QF_publish_() */
+            e = Q_NEW(QEvt, DATA_SIG);
+            t0 = nsNow_();
+            QF_PUBLISH(e, (void *)0);
+            tPub += nsNow_() - t0;
+            drain_(fanOut[i]);
+
+            /* the same fan-out as one QACTIVE_POST() per subscriber */
+            e = Q_NEW(QEvt, DATA_SIG);
+            t0 = nsNow_();
+            for (n = 0U; n < fanOut[i]; ++n) {
+                QACTIVE_POST(&l_sub[n], e, (void *)0);
+            }
+            tPost += nsNow_() - t0;
+            drain_(fanOut[i]);
+        }
+        /* every subscriber got every event (a leak would make Q_NEW()
+        * assert, as the pool holds only a few events)
+        */
+        Q_ASSERT(l_nRecv == 2U * N_ROUNDS * fanOut[i]);
+
+        printf("%11u  %12.0f  %14.0f\n", (unsigned)fanOut[i],
+               (double)tPub / (double)N_ROUNDS,
+               (double)tPost / (double)N_ROUNDS);
+    }
+    return 0;
+}
+
+/*..........................................................................*/
+static QState Sub_initial(QActive * const me, void const * const par) {
+    (void)me;
+    (void)par;
+    return Q_TRAN(&Sub_idle);
+}
+/*..........................................................................*/
+static QState Sub_idle(QActive * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    return Q_SUPER(&QHsm_top);
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+}
+/*..........................................................................*/
+void QV_onIdle(void) {
+    QV_CPU_SLEEP();
+}
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* The benchmark publishes from main() and drains the queues of the
+* subscribers itself instead of running QF_run(), so only the cost of the
+* multicast is timed. The "post loop" column posts the same dynamic event
+* to the same subscribers one by one, which is what QF_publish_() did
+* before the single-critical-section fast path.
+*/
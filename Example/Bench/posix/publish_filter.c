@@ -0,0 +1,272 @@
+/*****************************************************************************
+* Product: Content-filtered subscription benchmark, POSIX (Linux),
+*          posix-qv port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#define QP_IMPL      /* drains the queues with QActive_get_(), see NOTE1 */
+#include "qpc.h"
+#include "qf_pkg.h"
+
+#include <stdio.h>   /* for printf()/fprintf() */
+#include <stdlib.h>  /* for exit() */
+#include <stddef.h>  /* for offsetof() */
+#include <time.h>    /* for clock_gettime() */
+#include <pthread.h> /* for the filter churn thread, NOTE2 */
+
+Q_DEFINE_THIS_FILE
+
+#if (QF_MAX_PS_FILTER == 0U)
+    #error Build with -DQF_MAX_PS_FILTER=16U
+#endif
+
+#define N_PHILO   5U       /* subscribers checked by the benchmark */
+#define N_NOISE   4U       /* subscribers whose filters churn, NOTE2 */
+#define N_PUB     1000000U /* publishes of each run */
+
+typedef struct {
+    QEvt super;
+    uint8_t philoNum;
+} TableEvt;
+
+enum BenchSignals {
+    EAT_SIG = Q_USER_SIG,
+    MAX_PUB_SIG
+};
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_sub[N_PHILO + N_NOISE];
+static QEvt const *l_subQSto[N_PHILO + N_NOISE][16];
+static QSubscrList l_subscrSto[MAX_PUB_SIG];
+static QF_MPOOL_EL(TableEvt) l_poolSto[64];
+static uint32_t l_rnd = 1U;
+
+static uint32_t l_nDispatch; /* events dispatched to the checked AOs */
+static uint32_t l_nIgnored;  /* events the checked AOs would ignore */
+static uint32_t l_nBad;      /* events no filter in effect would pass */
+static uint8_t l_alt;        /* churn: which key each checked AO accepts */
+static bool volatile l_churn;
+
+static QState Sub_initial(QActive * const me, void const * const par);
+static QState Sub_idle(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint32_t random_(void) {
+    l_rnd = l_rnd * 1103515245U + 12345U;
+    return l_rnd >> 8;
+}
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void drain_(void) { /* consume without QF_run() */
+    uint_fast8_t n;
+    for (n = 0U; n < Q_DIM(l_sub); ++n) {
+        while (l_sub[n].eQueue.frontEvt != (QEvt *)0) {
+            TableEvt const *te = (TableEvt const *)QActive_get_(&l_sub[n]);
+            if (n < N_PHILO) {
+                ++l_nDispatch;
+                if (te->philoNum != n) {
+                    ++l_nIgnored; /* the handler would just drop it */
+                }
+                /* under churn the filter accepts n or n + N_PHILO */
+                if ((te->philoNum != n) && (te->philoNum != n + N_PHILO)) {
+                    ++l_nBad;
+                }
+            }
+            QF_gc(&te->super);
+        }
+    }
+    QF_INT_DISABLE();
+    QPSet_setEmpty(&QV_readySet_);
+    QF_INT_ENABLE();
+}
+/*..........................................................................*/
+static double run_(uint8_t nKeys) { /* returns ns per publish + dispatch */
+    uint64_t const t0 = nsNow_();
+    uint32_t k;
+    for (k = 0U; k < N_PUB; ++k) {
+        TableEvt *te = Q_NEW(TableEvt, EAT_SIG);
+        te->philoNum = (uint8_t)(random_() % nKeys);
+        QF_PUBLISH(&te->super, (void *)0);
+        if ((k & 3U) == 3U) {
+            drain_();
+        }
+    }
+    drain_();
+    return (double)(nsNow_() - t0) / (double)N_PUB;
+}
+/*..........................................................................*/
+static bool noiseFilter_(QActive const * const me, QEvt const * const e) {
+    uint_fast16_t volatile spin; /* a slow predicate widens the window */
+    (void)me;
+    (void)e;
+    for (spin = 0U; spin < 200U; ++spin) {
+    }
+    return false;
+}
+/*..........................................................................*/
+static void *churn_(void *arg) { /* another "thread" editing the filters */
+    uint_fast8_t n = 0U;
+    (void)arg;
+    while (l_churn) {
+        /* flip the key of a checked AO between n and n + N_PHILO */
+        uint_fast8_t const p = n % N_PHILO;
+        l_alt ^= (uint8_t)(1U << p);
+        QActive_setFilterKey(&l_sub[p], EAT_SIG,
+            offsetof(TableEvt, philoNum), 1U,
+            (uint32_t)(p + ((((uint32_t)l_alt >> p) & 1U) * N_PHILO)));
+
+        /* drop and re-add a noise filter, so that the table is compacted
+        * and the records of the checked AOs move to other slots
+        */
+        QActive_clearFilter(&l_sub[N_PHILO + (n % N_NOISE)], EAT_SIG);
+        QActive_setFilter(&l_sub[N_PHILO + ((n + 1U) % N_NOISE)], EAT_SIG,
+                          &noiseFilter_);
+        ++n;
+    }
+    return (void *)0;
+}
+
+/*..........................................................................*/
+int main(void) {
+    uint_fast8_t n;
+    double tNone;
+    double tKey;
+    uint32_t nFiltered = 0U;
+    pthread_t thread;
+
+    QF_init();
+    QF_psInit(l_subscrSto, Q_DIM(l_subscrSto));
+    QF_poolInit(l_poolSto, sizeof(l_poolSto), sizeof(l_poolSto[0]));
+    for (n = 0U; n < N_PHILO; ++n) {
+        QActive_ctor(&l_sub[n], Q_STATE_CAST(&Sub_initial));
+        QACTIVE_START(&l_sub[n], (uint_fast8_t)(n + 1U),
+                      l_subQSto[n], Q_DIM(l_subQSto[n]),
+                      (void *)0, 0U, (void *)0);
+        QActive_subscribe(&l_sub[n], EAT_SIG);
+    }
+
+    /* 1. five Philo-like subscribers, each needs 1/5 of the EAT events */
+    tNone = run_(N_PHILO);
+    printf("unfiltered: %u dispatches, %u ignored by the handler, "
+           "%.0f ns/publish\n",
+           (unsigned)l_nDispatch, (unsigned)l_nIgnored, tNone);
+
+    for (n = 0U; n < N_PHILO; ++n) {
+        QActive_setFilterKey(&l_sub[n], EAT_SIG,
+                             offsetof(TableEvt, philoNum), 1U, n);
+    }
+    l_nDispatch = 0U;
+    l_nIgnored  = 0U;
+    tKey = run_(N_PHILO);
+    for (n = 0U; n < N_PHILO; ++n) {
+        nFiltered += QActive_getFiltered(&l_sub[n], EAT_SIG);
+    }
+    printf("key filter: %u dispatches, %u ignored by the handler, "
+           "%u filtered, %.0f ns/publish\n",
+           (unsigned)l_nDispatch, (unsigned)l_nIgnored,
+           (unsigned)nFiltered, tKey);
+    Q_ASSERT((l_nIgnored == 0U) && (l_nDispatch + nFiltered == N_PHILO * N_PUB));
+
+    /* 2. publish while another thread rewrites the filter table, NOTE2 */
+    for (n = N_PHILO; n < Q_DIM(l_sub); ++n) {
+        QActive_ctor(&l_sub[n], Q_STATE_CAST(&Sub_initial));
+        QACTIVE_START(&l_sub[n], (uint_fast8_t)(n + 1U),
+                      l_subQSto[n], Q_DIM(l_subQSto[n]),
+                      (void *)0, 0U, (void *)0);
+        QActive_subscribe(&l_sub[n], EAT_SIG);
+    }
+    l_nDispatch = 0U;
+    l_nBad      = 0U;
+    l_churn     = true;
+    Q_ALLEGE(pthread_create(&thread, (pthread_attr_t *)0,
+                            &churn_, (void *)0) == 0);
+    tKey = run_(2U * N_PHILO);
+    l_churn = false;
+    pthread_join(thread, (void **)0);
+    printf("churn:      %u dispatches, %u passed by no filter, "
+           "%.0f ns/publish\n",
+           (unsigned)l_nDispatch, (unsigned)l_nBad, tKey);
+
+    return (l_nBad == 0U) ? 0 : 1;
+}
+
+/*..........................................................................*/
+static QState Sub_initial(QActive * const me, void const * const par) {
+    (void)me;
+    (void)par;
+    return Q_TRAN(&Sub_idle);
+}
+/*..........................................................................*/
+static QState Sub_idle(QActive * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    return Q_SUPER(&QHsm_top);
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+}
+/*..........................................................................*/
+void QV_onIdle(void) {
+    QV_CPU_SLEEP();
+}
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* The benchmark publishes from main() and drains the queues of the
+* subscribers itself instead of running QF_run(), every four publishes, as
+* five Philo AOs that each need only their own EAT events.
+*
+* NOTE2:
+* In the churn run a second thread, which the posix-qv port treats like an
+* interrupt, keeps replacing the key filters of the checked subscribers and
+* drops and re-adds the filters of four more subscribers, so that the
+* filter table is compacted under the publisher. Every event a checked
+* subscriber receives must pass one of the two keys its filter alternates
+* between; an event passed by neither means that QF_publish_() evaluated a
+* filter record that was being rewritten or moved.
+*/
@@ -0,0 +1,215 @@
+/*****************************************************************************
+* Product: Table/worker round-trip benchmark, POSIX (Linux),
+*          posix and posix-qv ports
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#define _POSIX_C_SOURCE 200809L /* clock_gettime() */
+#include "qpc.h"
+
+#include <stdio.h>  /* for printf()/fprintf() */
+#include <stdlib.h> /* for exit(), atoi() */
+#include <time.h>   /* for clock_gettime() */
+
+Q_DEFINE_THIS_FILE
+
+#define MAX_WORKER 16U    /* the most workers of a run */
+#define RUN_TICKS  200U   /* length of a run [ticks of 10ms] */
+
+typedef struct {
+    QEvt super;
+    uint8_t worker; /* index of the worker */
+} JobEvt;
+
+enum BenchSignals {
+    JOB_SIG = Q_USER_SIG, /* Table --> worker */
+    DONE_SIG              /* worker --> Table */
+};
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_table;
+static QActive l_worker[MAX_WORKER];
+static QEvt const *l_tableQSto[2U * MAX_WORKER];
+static QEvt const *l_workerQSto[MAX_WORKER][4];
+static QF_MPOOL_EL(JobEvt) l_poolSto[4U * MAX_WORKER];
+
+static uint_fast8_t l_nWorker;
+static uint32_t l_workNs;          /* work of each job [ns] */
+static uint32_t volatile l_nDone;  /* round trips completed */
+static uint32_t l_tick;
+
+static QState Table_initial(QActive * const me, void const * const par);
+static QState Table_serving(QActive * const me, QEvt const * const e);
+static QState Worker_initial(QActive * const me, void const * const par);
+static QState Worker_busy(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void spin_(uint32_t ns) {
+    uint64_t const t0 = nsNow_();
+    while (nsNow_() - t0 < ns) {
+    }
+}
+/*..........................................................................*/
+static void postJob_(QActive * const me, uint8_t worker) {
+    JobEvt *je = Q_NEW(JobEvt, JOB_SIG);
+    (void)me; /* the sender is used only with Q_SPY */
+    je->worker = worker;
+    QACTIVE_POST(&l_worker[worker], &je->super, me);
+}
+
+/*..........................................................................*/
+int main(int argc, char *argv[]) {
+    uint_fast8_t n;
+
+    /* arguments: number of workers, work of each job [us], NOTE1 */
+    l_nWorker = (argc > 1) ? (uint_fast8_t)atoi(argv[1]) : 4U;
+    l_workNs  = (argc > 2) ? (1000U * (uint32_t)atoi(argv[2])) : 0U;
+    Q_REQUIRE((0U < l_nWorker) && (l_nWorker <= MAX_WORKER));
+
+    QF_init();
+    QF_poolInit(l_poolSto, sizeof(l_poolSto), sizeof(l_poolSto[0]));
+    for (n = 0U; n < l_nWorker; ++n) {
+        QActive_ctor(&l_worker[n], Q_STATE_CAST(&Worker_initial));
+        QACTIVE_START(&l_worker[n], (uint_fast8_t)(n + 1U),
+                      l_workerQSto[n], Q_DIM(l_workerQSto[n]),
+                      (void *)0, 0U, (void *)0);
+    }
+    QActive_ctor(&l_table, Q_STATE_CAST(&Table_initial));
+    QACTIVE_START(&l_table, (uint_fast8_t)(l_nWorker + 1U),
+                  l_tableQSto, Q_DIM(l_tableQSto),
+                  (void *)0, 0U, (void *)0);
+    return QF_run();
+}
+
+/*..........................................................................*/
+static QState Table_initial(QActive * const me, void const * const par) {
+    uint_fast8_t n;
+    (void)par;
+    for (n = 0U; n < l_nWorker; ++n) { /* one job in flight per worker */
+        postJob_(me, (uint8_t)n);
+    }
+    return Q_TRAN(&Table_serving);
+}
+/*..........................................................................*/
+static QState Table_serving(QActive * const me, QEvt const * const e) {
+    QState status_;
+    switch (e->sig) {
+        case DONE_SIG: {
+            ++l_nDone;
+            postJob_(me, Q_EVT_CAST(JobEvt)->worker);
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+/*..........................................................................*/
+static QState Worker_initial(QActive * const me, void const * const par) {
+    (void)me;
+    (void)par;
+    return Q_TRAN(&Worker_busy);
+}
+/*..........................................................................*/
+static QState Worker_busy(QActive * const me, QEvt const * const e) {
+    QState status_;
+    switch (e->sig) {
+        case JOB_SIG: {
+            JobEvt *je;
+            spin_(l_workNs);
+            je = Q_NEW(JobEvt, DONE_SIG);
+            je->worker = Q_EVT_CAST(JobEvt)->worker;
+            QACTIVE_POST(&l_table, &je->super, me);
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+    QF_setTickRate(100U, 0); /* 10ms ticks measure the run */
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+    ++l_tick;
+    if (l_tick == RUN_TICKS) {
+        printf("%u workers, %u us of work per job: %.0f round trips/s\n",
+               (unsigned)l_nWorker, (unsigned)(l_workNs / 1000U),
+               (double)l_nDone * 100.0 / (double)RUN_TICKS);
+        exit(0); /* the AO threads of the posix port never return, NOTE2 */
+    }
+}
+#ifdef QV_H
+/*..........................................................................*/
+void QV_onIdle(void) {
+    QV_CPU_SLEEP();
+}
+#endif
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* The Table AO keeps one job in flight per worker AO: every DONE event from
+* a worker is answered with the next JOB event, each a dynamic event
+* (Q_NEW(), post, QF_gc()). The second argument is the work of each job in
+* microseconds (0 by default). The same source builds with the thread-per-AO
+* posix port and with the single-thread posix-qv port, so the two can be
+* compared for the same AOs; the thread port pays a thread switch on every
+* post, which only pays off with enough work per job and more than one CPU.
+*
+* NOTE2:
+* The run lasts RUN_TICKS clock ticks. QF_onClockTick() runs in the thread
+* of QF_run() (posix) or in the ticker thread (posix-qv) and ends the
+* program directly, because the AO threads of the posix port block on
+* their queues and are not joined.
+*/
@@ -0,0 +1,381 @@
+/*****************************************************************************
+* Product: Shared-memory event channel benchmark, POSIX (Linux),
+*          posix-qv port with the posix-shm add-on
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#define _GNU_SOURCE /* socketpair(), kill(), nanosleep() */
+#include "qpc.h"
+#include "qf_shm.h"
+
+#include <stdio.h>      /* for printf()/fprintf() */
+#include <stdlib.h>     /* for exit(), qsort() */
+#include <string.h>     /* for strcmp(), memcpy() */
+#include <time.h>       /* for clock_gettime(), nanosleep() */
+#include <sched.h>      /* for sched_yield() */
+#include <signal.h>     /* for kill() */
+#include <unistd.h>     /* for fork(), read(), write(), _exit() */
+#include <sys/socket.h> /* for socketpair() */
+
+Q_DEFINE_THIS_FILE
+
+#define N_THROUGHPUT  1000000U /* events of a throughput run */
+#define N_LATENCY     20000U   /* events of a latency run */
+#define PACE_NS       100000U  /* period of the latency run [ns] */
+#define N_SLOT        256U     /* slots of the channel */
+#define SHM_NAME      "/qp_bench_shm"
+
+typedef struct {
+    QEvt super;
+    uint64_t stamp;     /* CLOCK_MONOTONIC of the send [ns] */
+    uint32_t seq;       /* sequence number, checked by the sink */
+    uint8_t payload[20];
+} DataEvt;              /* 40 bytes */
+
+enum BenchSignals {
+    DATA_SIG = Q_USER_SIG, /* producer process --> sink */
+    GEN_SIG,               /* the generator AO of the proxy run */
+    MAX_PUB_SIG
+};
+
+enum BenchModes {
+    SHM_MODE,    /* Q_SHM_NEW() + QF_shmCommit() */
+    SOCKET_MODE, /* the same events over a UNIX SEQPACKET socket */
+    PROXY_MODE   /* a producer AO posting to a QShmProxy */
+};
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_sink;                 /* receiving AO */
+static QActive l_gen;                  /* producing AO of the proxy run */
+static QShmProxy l_proxy;
+static QEvt const *l_sinkQSto[200];
+static QEvt const *l_genQSto[8];
+static QEvt const *l_proxyQSto[64];
+static QSubscrList l_subscrSto[MAX_PUB_SIG];
+static QF_MPOOL_EL(DataEvt) l_poolSto[512];
+static QEvt const l_genEvt = QEVT_INITIALIZER(GEN_SIG);
+
+static QFShm l_shm;
+static int l_sock[2];                  /* [0] producer, [1] receiver */
+static pid_t l_child;                  /* the producer process */
+static uint8_t l_mode;
+static bool l_latency;                 /* latency run? */
+static uint32_t l_nEvt;
+static uint32_t l_nRecv;
+static uint32_t l_nGen;
+static uint64_t l_seqSum;
+static uint64_t l_t0;
+static uint32_t l_lat[N_LATENCY];      /* latency of each event [ns] */
+
+static QState Sink_initial(QActive * const me, void const * const par);
+static QState Sink_active(QActive * const me, QEvt const * const e);
+static QState Gen_initial(QActive * const me, void const * const par);
+static QState Gen_active(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void sleepNs_(long ns) {
+    struct timespec const t = { 0, ns };
+    nanosleep(&t, (struct timespec *)0);
+}
+/*..........................................................................*/
+static int cmpU32_(void const *a, void const *b) {
+    uint32_t const x = *(uint32_t const *)a;
+    uint32_t const y = *(uint32_t const *)b;
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+/*..........................................................................*/
+static void *receive_(void *arg) { /* receive thread of the sink process */
+    (void)arg;
+    for (;;) {
+        if (l_mode == SOCKET_MODE) {
+            DataEvt buf;
+            DataEvt *de;
+            if (read(l_sock[1], &buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+                return (void *)0;
+            }
+            /* the same single copy as QF_shmRecv() */
+            for (;;) {
+                de = Q_NEW(DataEvt, DATA_SIG);
+                de->stamp = buf.stamp;
+                de->seq   = buf.seq;
+                memcpy(de->payload, buf.payload, sizeof(de->payload));
+                if (QACTIVE_POST_X(&l_sink, &de->super, 0U, (void *)0)) {
+                    break;
+                }
+                sleepNs_(QF_SHM_BACKOFF_NS); /* the queue is full */
+            }
+        }
+        else {
+            (void)QF_shmRecv(&l_shm, -1);
+        }
+    }
+}
+/*..........................................................................*/
+static void produce_(void) { /* the producer process of SHM/SOCKET_MODE */
+    uint32_t k;
+    QFShm shm;
+    if (l_mode == SHM_MODE) {
+        while (!QF_shmOpen(&shm, SHM_NAME, 0U, 0U)) {
+            sched_yield();
+        }
+    }
+    for (k = 0U; k < l_nEvt; ++k) {
+        if (l_latency) {
+            sleepNs_(PACE_NS);
+        }
+        if (l_mode == SHM_MODE) {
+            DataEvt *de;
+            while (Q_SHM_NEW_X(de, &shm, DataEvt, 0U, DATA_SIG)
+                   == (DataEvt *)0)
+            {
+                sleepNs_(QF_SHM_BACKOFF_NS); /* the channel is full */
+            }
+            de->seq   = k;
+            de->stamp = nsNow_();
+            QF_shmCommit(&shm, 1U); /* to the sink at prio 1 */
+        }
+        else {
+            DataEvt buf;
+            buf.seq   = k;
+            buf.stamp = nsNow_();
+            Q_ALLEGE(write(l_sock[0], &buf, sizeof(buf))
+                     == (ssize_t)sizeof(buf));
+        }
+    }
+}
+/*..........................................................................*/
+static void proxyProducer_(void) { /* the producer process of PROXY_MODE */
+    QFShm shm;
+    while (!QF_shmOpen(&shm, SHM_NAME, 0U, 0U)) {
+        sched_yield();
+    }
+    QF_init();
+    QF_poolInit(l_poolSto, sizeof(l_poolSto), sizeof(l_poolSto[0]));
+    QF_psInit(l_subscrSto, Q_DIM(l_subscrSto));
+    QShmProxy_ctor(&l_proxy, &shm, 1U); /* stands for the remote sink */
+    QACTIVE_START(&l_proxy.super, 2U, l_proxyQSto, Q_DIM(l_proxyQSto),
+                  (void *)0, 0U, (void *)0);
+    QActive_ctor(&l_gen, Q_STATE_CAST(&Gen_initial));
+    QACTIVE_START(&l_gen, 1U, l_genQSto, Q_DIM(l_genQSto),
+                  (void *)0, 0U, (void *)0);
+    (void)QF_run();
+}
+
+/*..........................................................................*/
+int main(int argc, char *argv[]) {
+    /* arguments: shm | socket | proxy, then "lat" for a latency run */
+    l_mode = SHM_MODE;
+    if (argc > 1) {
+        if (strcmp(argv[1], "socket") == 0) {
+            l_mode = SOCKET_MODE;
+        }
+        else if (strcmp(argv[1], "proxy") == 0) {
+            l_mode = PROXY_MODE;
+        }
+        else {
+            Q_REQUIRE(strcmp(argv[1], "shm") == 0);
+        }
+    }
+    l_latency = (argc > 2) && (strcmp(argv[2], "lat") == 0);
+    Q_REQUIRE(!(l_latency && (l_mode == PROXY_MODE)));
+    l_nEvt = l_latency ? N_LATENCY : N_THROUGHPUT;
+
+    if (l_mode == SOCKET_MODE) {
+        Q_ALLEGE(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, l_sock) == 0);
+    }
+    else {
+        Q_ALLEGE(QF_shmOpen(&l_shm, SHM_NAME, N_SLOT, sizeof(DataEvt)));
+    }
+
+    l_child = fork();
+    Q_ASSERT(l_child >= 0);
+    if (l_child == 0) { /* the producer process, NOTE1 */
+        if (l_mode == PROXY_MODE) {
+            proxyProducer_();
+        }
+        else {
+            produce_();
+        }
+        _exit(0);
+    }
+
+    QF_init(); /* the sink process */
+    QF_poolInit(l_poolSto, sizeof(l_poolSto), sizeof(l_poolSto[0]));
+    QF_psInit(l_subscrSto, Q_DIM(l_subscrSto));
+    QActive_ctor(&l_sink, Q_STATE_CAST(&Sink_initial));
+    QACTIVE_START(&l_sink, 1U, l_sinkQSto, Q_DIM(l_sinkQSto),
+                  (void *)0, 0U, (void *)0);
+    return QF_run();
+}
+
+/*..........................................................................*/
+static QState Sink_initial(QActive * const me, void const * const par) {
+    (void)me;
+    (void)par;
+    return Q_TRAN(&Sink_active);
+}
+/*..........................................................................*/
+static QState Sink_active(QActive * const me, QEvt const * const e) {
+    static char const * const name[] = { "shm   ", "socket", "proxy " };
+    QState status_;
+    (void)me;
+    switch (e->sig) {
+        case DATA_SIG: {
+            DataEvt const *de = Q_EVT_CAST(DataEvt);
+            uint64_t const now = nsNow_();
+            if (l_nRecv == 0U) {
+                l_t0 = now;
+            }
+            if (l_latency) {
+                l_lat[l_nRecv] = (uint32_t)(now - de->stamp);
+            }
+            l_seqSum += de->seq;
+            ++l_nRecv;
+            if (l_nRecv == l_nEvt) { /* the run is over */
+                bool const ok = (l_seqSum
+                    == ((uint64_t)l_nEvt * (uint64_t)(l_nEvt - 1U)) / 2U);
+                if (l_latency) {
+                    qsort(l_lat, l_nEvt, sizeof(l_lat[0]), &cmpU32_);
+                    printf("%s latency: min %.1f us, median %.1f us, "
+                           "p99 %.1f us, max %.1f us\n", name[l_mode],
+                           (double)l_lat[0] / 1e3,
+                           (double)l_lat[l_nEvt / 2U] / 1e3,
+                           (double)l_lat[(l_nEvt * 99U) / 100U] / 1e3,
+                           (double)l_lat[l_nEvt - 1U] / 1e3);
+                }
+                else {
+                    printf("%s throughput: %.2f M events/s\n", name[l_mode],
+                           (double)l_nEvt * 1e3 / (double)(now - l_t0));
+                }
+                if (!ok) {
+                    printf("events lost or duplicated\n");
+                }
+                fflush(stdout);
+                kill(l_child, SIGKILL);
+                if (l_mode != SOCKET_MODE) {
+                    QF_shmClose(&l_shm); /* removes the segment */
+                }
+                _exit(ok ? 0 : 1); /* the receive thread blocks, NOTE2 */
+            }
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+/*..........................................................................*/
+static QState Gen_initial(QActive * const me, void const * const par) {
+    (void)par;
+    QACTIVE_POST(me, &l_genEvt, me);
+    return Q_TRAN(&Gen_active);
+}
+/*..........................................................................*/
+static QState Gen_active(QActive * const me, QEvt const * const e) {
+    QState status_;
+    switch (e->sig) {
+        case GEN_SIG: { /* post a burst to the proxy and come back */
+            uint_fast8_t n;
+            for (n = 0U; (n < 16U) && (l_nGen < l_nEvt); ++n) {
+                DataEvt *de = Q_NEW(DataEvt, DATA_SIG);
+                de->seq   = l_nGen;
+                de->stamp = nsNow_();
+                if (!QACTIVE_POST_X(&l_proxy.super, &de->super, 1U, me)) {
+                    break; /* the proxy waits for the channel, retry */
+                }
+                ++l_nGen;
+            }
+            if (l_nGen < l_nEvt) {
+                QACTIVE_POST(me, &l_genEvt, me);
+            }
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+    if (l_child != 0) { /* the sink process? */
+        pthread_t thread;
+        Q_ALLEGE(pthread_create(&thread, (pthread_attr_t *)0,
+                                &receive_, (void *)0) == 0);
+    }
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+}
+#ifdef QV_H
+/*..........................................................................*/
+void QV_onIdle(void) {
+    QV_CPU_SLEEP();
+}
+#endif
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    _exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* The program forks into a producer process and a sink process with the
+* AO at priority 1 and a receive thread (an "interrupt" of the posix-qv
+* port). "shm" builds each 40-byte event in the channel with Q_SHM_NEW()
+* and sends it with QF_shmCommit(); "socket" sends the same events over a
+* UNIX SEQPACKET socketpair, received with the same single copy into a
+* dynamic event; "proxy" runs QF in the producer process too, where an AO
+* posts the events to a QShmProxy that forwards them into the channel.
+* "lat" paces the events every PACE_NS and reports the distribution of the
+* latency from the send to the dispatch in the sink. The sink checks the
+* sum of the sequence numbers, so a lost or duplicated event fails the run.
+*
+* NOTE2:
+* The sink AO ends the program with _exit() after killing the producer,
+* because the receive thread stays blocked in QF_shmRecv() or read().
+*/
@@ -0,0 +1,252 @@
+/*****************************************************************************
+* Product: Timeout service stress benchmark, POSIX (Linux), posix-qv port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#define QP_IMPL      /* drives QF_tickX_() and QActive_get_() directly */
+#include "qpc.h"
+#include "qf_pkg.h"
+
+#include <stdio.h>  /* for printf()/fprintf() */
+#include <stdlib.h> /* for exit() */
+#include <time.h>   /* for clock_gettime() */
+
+Q_DEFINE_THIS_FILE
+
+#ifndef QF_TMO_WHEEL_SIZE
+    #error Build with -DQF_TMO_WHEEL_SIZE=<power of 2>, see NOTE1
+#endif
+
+#define N_TMO    10000U  /* concurrent timeouts */
+#define N_TICKS  50000U  /* ticks of the run */
+#define N_REARM  40000U  /* expired timeouts are re-armed until this tick */
+#define MAX_TMO  5000U   /* longest timeout [ticks] */
+#define HASH_LEN 32768U  /* handle --> entity map, power of 2 > 2*N_TMO */
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_ao;                          /* receives all expirations */
+static QEvt const *l_aoQSto[N_TMO + 10U];
+static QTmo l_tmoSto[N_TMO];
+static QF_MPOOL_EL(QTmoEvt) l_poolSto[N_TMO];
+
+static QTmoHandle l_handle[N_TMO]; /* live handle of each entity (0: none) */
+static uint32_t l_due[N_TMO];      /* expected expiration tick */
+static QTmoHandle l_hashKey[HASH_LEN];
+static uint16_t l_hashVal[HASH_LEN];
+static uint32_t l_rnd = 7U;
+
+static struct {
+    uint32_t nFired;
+    uint32_t nLate;     /* expired on a tick other than the due tick */
+    uint32_t nCancel;   /* cancel attempts */
+    uint32_t nCanceled; /* cancel attempts on live timeouts */
+    uint32_t nArm;
+    uint64_t armNs;
+    uint64_t cancelNs;
+    uint64_t tickNs;
+} l_stat;
+
+static QState AO_initial(QActive * const me, void const * const par);
+static QState AO_idle(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint32_t random_(void) {
+    l_rnd = l_rnd * 1103515245U + 12345U;
+    return l_rnd >> 8;
+}
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void hashPut_(QTmoHandle h, uint16_t i) {
+    uint32_t k = (h * 2654435761U) & (HASH_LEN - 1U);
+    while ((l_hashKey[k] != 0U) && (l_hashKey[k] != h)) {
+        k = (k + 1U) & (HASH_LEN - 1U);
+    }
+    l_hashKey[k] = h;
+    l_hashVal[k] = i;
+}
+/*..........................................................................*/
+static uint16_t hashTake_(QTmoHandle h) { /* returns N_TMO if not found */
+    uint32_t k = (h * 2654435761U) & (HASH_LEN - 1U);
+    uint16_t i;
+    while (l_hashKey[k] != h) {
+        if (l_hashKey[k] == 0U) {
+            return (uint16_t)N_TMO;
+        }
+        k = (k + 1U) & (HASH_LEN - 1U);
+    }
+    i = l_hashVal[k];
+    /* backward-shift deletion keeps the probe chains intact */
+    for (;;) {
+        uint32_t const j = k;
+        uint32_t home;
+        l_hashKey[k] = 0U;
+        do {
+            k = (k + 1U) & (HASH_LEN - 1U);
+            if (l_hashKey[k] == 0U) {
+                return i;
+            }
+            home = (l_hashKey[k] * 2654435761U) & (HASH_LEN - 1U);
+        } while (((j < k) && (j < home) && (home <= k))
+                 || ((j > k) && ((j < home) || (home <= k))));
+        l_hashKey[j] = l_hashKey[k];
+        l_hashVal[j] = l_hashVal[k];
+    }
+}
+/*..........................................................................*/
+static void arm_(uint16_t i) {
+    QTimeEvtCtr const n = (QTimeEvtCtr)(1U + (random_() % MAX_TMO));
+    uint64_t const t0 = nsNow_();
+    l_handle[i] = QActive_armTmo(&l_ao, Q_USER_SIG, n);
+    l_stat.armNs += nsNow_() - t0;
+    ++l_stat.nArm;
+    l_due[i] = QF_getTickCtrX(0U) + n;
+    hashPut_(l_handle[i], i);
+}
+
+/*..........................................................................*/
+int main(void) {
+    uint32_t k;
+    uint16_t i;
+
+    QF_init();
+    QF_poolInit(l_poolSto, sizeof(l_poolSto), sizeof(l_poolSto[0]));
+    QActive_ctor(&l_ao, Q_STATE_CAST(&AO_initial));
+    QACTIVE_START(&l_ao, 1U, l_aoQSto, Q_DIM(l_aoQSto),
+                  (void *)0, 0U, (void *)0);
+    QF_tmoInit(l_tmoSto, N_TMO, 0U);
+
+    for (i = 0U; i < N_TMO; ++i) {
+        arm_(i);
+    }
+
+    for (k = 0U; k < N_TICKS; ++k) {
+        uint64_t const t0 = nsNow_();
+        QF_TICK_X(0U, (void *)0); /* the "SysTick ISR" of this benchmark */
+        l_stat.tickNs += nsNow_() - t0;
+
+        /* collect the expirations without QF_run(), see NOTE2 */
+        while (l_ao.eQueue.frontEvt != (QEvt *)0) {
+            QTmoEvt const *te = (QTmoEvt const *)QActive_get_(&l_ao);
+            i = hashTake_(te->handle);
+            ++l_stat.nFired;
+            if ((i == N_TMO) || (l_due[i] != QF_getTickCtrX(0U))) {
+                ++l_stat.nLate;
+            }
+            QF_gc(&te->super);
+            if (i != N_TMO) {
+                l_handle[i] = 0U;
+                if (k < N_REARM) {
+                    arm_(i);
+                }
+            }
+        }
+
+        /* cancel three random timeouts per tick and re-arm the canceled */
+        for (i = 0U; i < 3U; ++i) {
+            uint16_t const j = (uint16_t)(random_() % N_TMO);
+            if (l_handle[j] != 0U) {
+                uint64_t const t1 = nsNow_();
+                bool const ok = QActive_cancelTmo(&l_ao, l_handle[j]);
+                l_stat.cancelNs += nsNow_() - t1;
+                ++l_stat.nCancel;
+                if (ok) {
+                    ++l_stat.nCanceled;
+                    (void)hashTake_(l_handle[j]);
+                    arm_(j);
+                }
+            }
+        }
+    }
+
+    printf("%u timeouts, %u ticks, wheel %u slots\n"
+           "fired %u (late %u), canceled %u of %u, min free records %u\n"
+           "arm %.0f ns, cancel %.0f ns, tick %.0f ns\n",
+           (unsigned)N_TMO, (unsigned)N_TICKS, (unsigned)QF_TMO_WHEEL_SIZE,
+           (unsigned)l_stat.nFired, (unsigned)l_stat.nLate,
+           (unsigned)l_stat.nCanceled, (unsigned)l_stat.nCancel,
+           (unsigned)QF_getTmoMin(),
+           (double)l_stat.armNs / (double)l_stat.nArm,
+           (double)l_stat.cancelNs / (double)l_stat.nCancel,
+           (double)l_stat.tickNs / (double)N_TICKS);
+
+    return (l_stat.nLate == 0U) ? 0 : 1;
+}
+
+/*..........................................................................*/
+static QState AO_initial(QActive * const me, void const * const par) {
+    (void)me;
+    (void)par;
+    return Q_TRAN(&AO_idle);
+}
+/*..........................................................................*/
+static QState AO_idle(QActive * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    return Q_SUPER(&QHsm_top);
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) { /* no ticker thread, main() ticks, NOTE2 */
+}
+/*..........................................................................*/
+void QV_onIdle(void) {
+    QV_CPU_SLEEP();
+}
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* The timeout service is compiled only with QF_TMO_WHEEL_SIZE defined, for
+* example -DQF_TMO_WHEEL_SIZE=64U or -DQF_TMO_WHEEL_SIZE=1024U; the wheel
+* size trades the per-tick scan against the memory of the wheel.
+*
+* NOTE2:
+* The benchmark calls QF_TICK_X() and drains the queue of the AO from
+* main() instead of running QF_run(), so that the cost of QActive_armTmo(),
+* QActive_cancelTmo() and of one tick (including allocating and posting the
+* expirations) can be timed call by call. Every expiration is checked
+* against the tick on which its timeout was due.
+*/
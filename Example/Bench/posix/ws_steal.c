@@ -0,0 +1,217 @@
+/*****************************************************************************
+* Product: Work-stealing scheduler benchmark, POSIX (Linux), posix-ws port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#define _POSIX_C_SOURCE 200809L /* clock_gettime() */
+#include "qpc.h"
+
+#include <stdio.h>  /* for printf()/fprintf() */
+#include <stdlib.h> /* for exit(), atoi() */
+#include <time.h>   /* for clock_gettime() */
+
+Q_DEFINE_THIS_FILE
+
+#define N_RING     48U    /* AOs of the token ring */
+#define LATE_PRIO  53U    /* prio of the AO started after QF_run(), NOTE2 */
+#define LATE_TICK  50U    /* tick on which the late AO is started */
+#define N_LATE     100U   /* events posted to the late AO, one per tick */
+#define RUN_TICKS  200U   /* length of the run [ticks of 10ms] */
+
+enum BenchSignals {
+    HOP_SIG = Q_USER_SIG, /* the token passed around the ring */
+    LATE_SIG              /* ticker --> late AO */
+};
+
+/* Local-scope objects -----------------------------------------------------*/
+static QActive l_ring[N_RING];
+static QEvt const *l_ringQSto[N_RING][N_RING];
+static QActive l_late;
+static QEvt const *l_lateQSto[N_LATE];
+static QEvt const l_hopEvt  = QEVT_INITIALIZER(HOP_SIG);
+static QEvt const l_lateEvt = QEVT_INITIALIZER(LATE_SIG);
+
+static uint_fast8_t l_nWorker;
+static uint_fast8_t l_nToken;
+static uint32_t l_workNs;            /* work of each hop [ns] */
+static uint32_t l_nHop[N_RING];
+static int volatile l_inside[N_RING]; /* RTC steps in progress, NOTE1 */
+static uint32_t volatile l_nOverlap;  /* overlapping RTC steps of an AO */
+static uint32_t volatile l_nLate;     /* events handled by the late AO */
+static uint32_t l_tick;
+
+static QState AO_initial(QActive * const me, void const * const par);
+static QState AO_active(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static uint64_t nsNow_(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000U) + (uint64_t)t.tv_nsec;
+}
+/*..........................................................................*/
+static void spin_(uint32_t ns) {
+    uint64_t const t0 = nsNow_();
+    while (nsNow_() - t0 < ns) {
+    }
+}
+
+/*..........................................................................*/
+int main(int argc, char *argv[]) {
+    uint_fast8_t n;
+
+    /* arguments: workers, work of each hop [us], tokens in the ring */
+    l_nWorker = (argc > 1) ? (uint_fast8_t)atoi(argv[1]) : 2U;
+    l_workNs  = (argc > 2) ? (1000U * (uint32_t)atoi(argv[2])) : 0U;
+    l_nToken  = (argc > 3) ? (uint_fast8_t)atoi(argv[3]) : 4U;
+    Q_REQUIRE((0U < l_nToken) && (l_nToken <= N_RING));
+
+    QF_init();
+    QF_setWorkers(l_nWorker);
+    for (n = 0U; n < N_RING; ++n) {
+        QActive_ctor(&l_ring[n], Q_STATE_CAST(&AO_initial));
+        QACTIVE_START(&l_ring[n], (uint_fast8_t)(n + 1U),
+                      l_ringQSto[n], Q_DIM(l_ringQSto[n]),
+                      (void *)0, 0U, (void *)0);
+    }
+    QActive_ctor(&l_late, Q_STATE_CAST(&AO_initial));
+    return QF_run();
+}
+
+/*..........................................................................*/
+static QState AO_initial(QActive * const me, void const * const par) {
+    (void)par;
+    if ((me != &l_late) && (me->prio <= l_nToken)) {
+        QACTIVE_POST(me, &l_hopEvt, me); /* inject a token */
+    }
+    return Q_TRAN(&AO_active);
+}
+/*..........................................................................*/
+static QState AO_active(QActive * const me, QEvt const * const e) {
+    QState status_;
+    switch (e->sig) {
+        case HOP_SIG: {
+            uint_fast8_t const i = (uint_fast8_t)(me->prio - 1U);
+            if (__sync_fetch_and_add(&l_inside[i], 1) != 0) {
+                ++l_nOverlap; /* two workers run the same AO */
+            }
+            spin_(l_workNs);
+            ++l_nHop[i];
+            (void)__sync_fetch_and_sub(&l_inside[i], 1);
+            QACTIVE_POST(&l_ring[(i + 1U) % N_RING], &l_hopEvt, me);
+            status_ = Q_HANDLED();
+            break;
+        }
+        case LATE_SIG: {
+            ++l_nLate;
+            status_ = Q_HANDLED();
+            break;
+        }
+        default: {
+            status_ = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status_;
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+    QF_setTickRate(100U, 0); /* 10ms ticks drive the run */
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+    ++l_tick;
+    if (l_tick == LATE_TICK) { /* start an AO while QF is running, NOTE2 */
+        QACTIVE_START(&l_late, LATE_PRIO, l_lateQSto, Q_DIM(l_lateQSto),
+                      (void *)0, 0U, (void *)0);
+    }
+    if ((LATE_TICK <= l_tick) && (l_tick < LATE_TICK + N_LATE)) {
+        QACTIVE_POST(&l_late, &l_lateEvt, (void *)0);
+    }
+    if (l_tick == RUN_TICKS) {
+        uint32_t nHop = 0U;
+        uint32_t nDispatch = 0U;
+        uint32_t nSteal = 0U;
+        uint32_t nSleep = 0U;
+        uint_fast8_t n;
+        for (n = 0U; n < N_RING; ++n) {
+            nHop += l_nHop[n];
+        }
+        for (n = 0U; n < l_nWorker; ++n) {
+            QFWorkerStat const *st = QF_getWorkerStat(n);
+            nDispatch += st->nDispatch;
+            nSteal    += st->nSteal;
+            nSleep    += st->nSleep;
+        }
+        printf("%u workers, %u tokens, %u us of work per hop: "
+               "%.0f hops/s\n"
+               "stolen %.1f%% of the dispatches, %u sleeps, "
+               "%u overlapping RTC steps\n"
+               "late AO at prio %u: %u of %u events handled\n",
+               (unsigned)l_nWorker, (unsigned)l_nToken,
+               (unsigned)(l_workNs / 1000U),
+               (double)nHop * 100.0 / (double)RUN_TICKS,
+               100.0 * (double)nSteal / (double)nDispatch,
+               (unsigned)nSleep, (unsigned)l_nOverlap,
+               (unsigned)LATE_PRIO, (unsigned)l_nLate, (unsigned)N_LATE);
+        /* the workers never return, NOTE3 */
+        exit(((l_nOverlap == 0U) && (l_nLate == N_LATE)) ? 0 : 1);
+    }
+}
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* The tokens hop around a ring of AOs, so that there are always more ready
+* AOs than tokens and the workers steal from each other. Every AO counts
+* the RTC steps in progress; a count above one means that two workers ran
+* the same AO at the same time, which the port must never do.
+*
+* NOTE2:
+* The late AO is started from QF_onClockTick(), that is after QF_run() has
+* created the workers. LATE_PRIO is chosen so that LATE_PRIO modulo
+* QF_MAX_WORKERS (5) is not a running worker with the default two workers;
+* such an AO used to be made affine to a worker that did not exist and was
+* never served. Each of the following ticks posts it one event, which
+* all must be handled by the end of the run.
+*
+* NOTE3:
+* QF_onClockTick() runs in the thread of QF_run() and ends the program
+* directly, because the worker threads are not joined.
+*/
@@ -61,8 +61,21 @@ void SysTick_Handler(void);
 
 /* ISRs used in this project ===============================================*/
 void SysTick_Handler(void) {
+#if defined QK_H
+    QK_ISR_ENTRY(); /* inform QK about entering an ISR */
     QF_TICK_X(0U, (void *)0); /* process time events for rate 0 */
+    QK_ISR_EXIT();  /* inform QK about exiting an ISR */
+#elif defined QXK_H
+    QXK_ISR_ENTRY(); /* inform QXK about entering an ISR */
+    QF_TICK_X(0U, (void *)0); /* process time events for rate 0 */
+    QXK_ISR_EXIT();  /* inform QXK about exiting an ISR */
+#else
+    QV_ISR_ENTRY(); /* ISR time accounting (QV_LOAD_STAT) */
+    QV_TT_TICK();   /* advance the time-triggered schedule (QV_TT) */
+    QF_TICK_X(0U, (void *)0); /* process time events for rate 0 */
+    QV_ISR_EXIT();
     QV_ARM_ERRATUM_838869();
+#endif
 }
 
 
@@ -139,6 +152,27 @@ void QF_onStartup(void) {
 void QF_onCleanup(void) {
 }
 /*..........................................................................*/
+#if (defined QK_H) || (defined QXK_H)
+#ifdef QK_H
+void QK_onIdle(void) { /* called with interrupts ENABLED, NOTE01 */
+#else
+void QXK_onIdle(void) { /* called with interrupts ENABLED, NOTE01 */
+#endif
+    /* toggle LED1 on and then off, see NOTE02 */
+    QF_INT_DISABLE();
+    GPIO->P[LED1_PORT].DOUT |=  (1U << LED1_PIN);
+    GPIO->P[LED1_PORT].DOUT &= ~(1U << LED1_PIN);
+    QF_INT_ENABLE();
+
+#ifdef NDEBUG
+    /* Put the CPU and peripherals to the low-power mode.
+    * you might need to customize the clock management for your application,
+    * see the datasheet for your particular Cortex-M MCU.
+    */
+    __WFI(); /* Wait-For-Interrupt */
+#endif
+}
+#else /* QV */
 void QV_onIdle(void) { /* CATION: called with interrupts DISABLED, NOTE01 */
     /* toggle LED1 on and then off, see NOTE02 */
     GPIO_PinOutSet(LED1_PORT, LED1_PIN);
@@ -156,6 +190,7 @@ void QV_onIdle(void) { /* CATION: called with interrupts DISABLED, NOTE01 */
     QF_INT_ENABLE(); /* just enable interrupts */
 #endif
 }
+#endif /* QK_H || QXK_H */
 
 /*..........................................................................*/
 Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
@@ -193,6 +228,11 @@ Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
 * an event. QV_onIdle() must internally enable interrupts, ideally
 * atomically with putting the CPU to the power-saving mode.
 *
+* Under the preemptive QK and QXK kernels, QK_onIdle() or QXK_onIdle() is
+* called instead, with interrupts enabled, so it only needs to disable them
+* around the LED toggle. It can be preempted by any AO (or, under QXK, any
+* extended thread) made ready by an ISR.
+*
 * NOTE02:
 * One of the LEDs is used to visualize the idle loop activity. The brightness
 * of the LED is proportional to the frequency of invcations of the idle loop.
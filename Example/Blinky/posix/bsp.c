@@ -0,0 +1,106 @@
+/*****************************************************************************
+* Product: "Blinky" on POSIX (Linux),
+*          QV (posix-qv) or thread-per-AO (posix) port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#include "qpc.h"
+#include "blinky.h"
+#include "bsp.h"
+
+#include <stdio.h>  /* for printf()/fprintf() */
+#include <stdlib.h> /* for exit() */
+
+//Q_DEFINE_THIS_FILE
+
+#ifdef Q_SPY
+    #error Simple Blinky Application does not provide Spy build configuration
+#endif
+
+/* "ISRs" defined in this BSP ----------------------------------------------*/
+void QF_onClockTick(void) { /* called from the clock tick of the port */
+#ifdef QV_H /* posix-qv port? */
+    QV_ISR_ENTRY(); /* ISR time accounting (QV_LOAD_STAT) */
+    QV_TT_TICK();   /* advance the time-triggered schedule (QV_TT) */
+#endif
+    QF_TICK_X(0U, (void *)0); /* process time events for rate 0 */
+#ifdef QV_H
+    QV_ISR_EXIT();
+#endif
+}
+
+/* BSP functions ===========================================================*/
+void BSP_init(void) {
+    printf("Simple Blinky example\n"
+           "QP %s (POSIX)\n"
+           "Press Ctrl-C to quit...\n",
+           QP_VERSION_STR);
+}
+/*..........................................................................*/
+void BSP_ledOff(void) {
+    printf("LED OFF\n");
+    fflush(stdout);
+}
+/*..........................................................................*/
+void BSP_ledOn(void) {
+    printf("LED ON\n");
+    fflush(stdout);
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+    QF_setTickRate(BSP_TICKS_PER_SEC, 0); /* start the ticker thread */
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+#ifdef QV_H /* posix-qv port? */
+void QV_onIdle(void) { /* CATION: called with interrupts DISABLED, NOTE01 */
+    QV_CPU_SLEEP(); /* wait for the next "interrupt" and enable interrupts */
+}
+#endif
+
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    QF_onCleanup();
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE01:
+* With the posix-qv port, QV_onIdle() is called with interrupts disabled
+* (the global mutex of the port locked). QV_CPU_SLEEP() waits until another
+* thread (here the ticker thread) executes a critical section, so the
+* process does not spin in the idle loop. The thread-per-AO posix port has
+* no idle callback, as every AO thread blocks on its own event queue.
+*/
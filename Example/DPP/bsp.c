@@ -87,6 +87,14 @@ void SysTick_Handler(void) {
     uint32_t current;
     uint32_t tmp;
 
+#if defined QK_H
+    QK_ISR_ENTRY(); /* inform QK about entering an ISR */
+#elif defined QXK_H
+    QXK_ISR_ENTRY(); /* inform QXK about entering an ISR */
+#else
+    QV_ISR_ENTRY(); /* ISR time accounting (QV_LOAD_STAT) */
+#endif
+
 #ifdef Q_SPY
     {
         tmp = SysTick->CTRL; /* clear SysTick_CTRL_COUNTFLAG */
@@ -94,6 +102,9 @@ void SysTick_Handler(void) {
     }
 #endif
 
+#ifdef QV_H
+    QV_TT_TICK(); /* advance the time-triggered schedule (QV_TT) */
+#endif
     //QF_TICK_X(0U, &l_SysTick_Handler); /* process time events for rate 0 */
     QACTIVE_POST(the_Ticker0, 0, &l_SysTick_Handler); /* post to Ticker0 */
 
@@ -109,20 +120,37 @@ void SysTick_Handler(void) {
     tmp ^= buttons.depressed;     /* changed debounced depressed */
     if ((tmp & (1U << PB0_PIN)) != 0U) {  /* debounced PB0 state changed? */
         if ((buttons.depressed & (1U << PB0_PIN)) != 0U) { /* PB0 depressed?*/
-            static QEvt const pauseEvt = { PAUSE_SIG, 0U, 0U};
+            static QEvt const pauseEvt = QEVT_INITIALIZER(PAUSE_SIG);
             QF_PUBLISH(&pauseEvt, &l_SysTick_Handler);
         }
         else {            /* the button is released */
-            static QEvt const serveEvt = { SERVE_SIG, 0U, 0U};
+            static QEvt const serveEvt = QEVT_INITIALIZER(SERVE_SIG);
             QF_PUBLISH(&serveEvt, &l_SysTick_Handler);
         }
     }
+#if defined QK_H
+    QK_ISR_EXIT();  /* inform QK about exiting an ISR */
+#elif defined QXK_H
+    QXK_ISR_EXIT(); /* inform QXK about exiting an ISR */
+#else
+    QV_ISR_EXIT();
     QV_ARM_ERRATUM_838869();
+#endif
 }
 /*..........................................................................*/
 void GPIO_EVEN_IRQHandler(void) { /* for testing, NOTE4 */
+#if defined QK_H
+    QK_ISR_ENTRY(); /* inform QK about entering an ISR */
+#elif defined QXK_H
+    QXK_ISR_ENTRY(); /* inform QXK about entering an ISR */
+#endif
     QACTIVE_POST(AO_Table, Q_NEW(QEvt, MAX_PUB_SIG), /* for testing... */
                  &l_GPIO_EVEN_IRQHandler);
+#if defined QK_H
+    QK_ISR_EXIT();  /* inform QK about exiting an ISR */
+#elif defined QXK_H
+    QXK_ISR_EXIT(); /* inform QXK about exiting an ISR */
+#endif
 }
 /*..........................................................................*/
 #ifdef Q_SPY
@@ -138,7 +166,13 @@ void USART0_RX_IRQHandler(void) {
         uint32_t b = l_USART0->RXDATA;
         QS_RX_PUT(b);
     }
+#if defined QK_H
+    QK_ARM_ERRATUM_838869();
+#elif defined QXK_H
+    QXK_ARM_ERRATUM_838869();
+#else
     QV_ARM_ERRATUM_838869();
+#endif
 }
 #else
 void USART0_RX_IRQHandler(void) {}
@@ -285,6 +319,41 @@ void QF_onStartup(void) {
 void QF_onCleanup(void) {
 }
 /*..........................................................................*/
+#if (defined QK_H) || (defined QXK_H)
+#ifdef QK_H
+void QK_onIdle(void) { /* called with interrupts ENABLED, NOTE2 */
+#else
+void QXK_onIdle(void) { /* called with interrupts ENABLED, NOTE2 */
+#endif
+    /* toggle the User LED on and then off, see NOTE3 */
+    QF_INT_DISABLE();
+    GPIO->P[LED_PORT].DOUT |=  (1U << LED1_PIN);
+    GPIO->P[LED_PORT].DOUT &= ~(1U << LED1_PIN);
+    QF_INT_ENABLE();
+
+#ifdef Q_SPY
+    QS_rxParse();  /* parse all the received bytes */
+
+    if ((l_USART0->STATUS & USART_STATUS_TXBL) != 0) {  /* is TXE empty? */
+        uint16_t b;
+
+        QF_INT_DISABLE();
+        b = QS_getByte();
+        QF_INT_ENABLE();
+
+        if (b != QS_EOD) {  /* not End-Of-Data? */
+            l_USART0->TXDATA = (b & 0xFFU);  /* put into the DR register */
+        }
+    }
+#elif defined NDEBUG
+    /* Put the CPU and peripherals to the low-power mode.
+    * you might need to customize the clock management for your application,
+    * see the datasheet for your particular Cortex-M MCU.
+    */
+    __WFI(); /* Wait-For-Interrupt */
+#endif
+}
+#else /* QV */
 void QV_onIdle(void) { /* CATION: called with interrupts DISABLED, NOTE2 */
     /* toggle the User LED on and then off, see NOTE3 */
     GPIO->P[LED_PORT].DOUT |=  (1U << LED1_PIN);
@@ -315,6 +384,7 @@ void QV_onIdle(void) { /* CATION: called with interrupts DISABLED, NOTE2 */
     QF_INT_ENABLE(); /* just enable interrupts */
 #endif
 }
+#endif /* QK_H || QXK_H */
 
 /*..........................................................................*/
 Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
@@ -486,6 +556,11 @@ void QS_onCommand(uint8_t cmdId,
 * an event. QV_onIdle() must internally enable interrupts, ideally
 * atomically with putting the CPU to the power-saving mode.
 *
+* Under the preemptive QK and QXK kernels, QK_onIdle() or QXK_onIdle() is
+* called instead, with interrupts enabled, so it only needs to disable them
+* around the LED toggle. It can be preempted by any AO (or, under QXK, any
+* extended thread) made ready by an ISR.
+*
 * NOTE3:
 * The User LED is used to visualize the idle loop activity. The brightness
 * of the LED is proportional to the frequency of invcations of the idle loop.
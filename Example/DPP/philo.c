@@ -16,6 +16,7 @@
 * for more details.
 */
 /*.$endhead${.::philo.c} ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^*/
+#include <stddef.h> /* for offsetof() */
 #include "qpc.h"
 #include "dpp.h"
 #include "bsp.h"
@@ -111,6 +112,11 @@ static QState Philo_initial(Philo * const me, void const * const par) {
 
     QActive_subscribe(&me->super, EAT_SIG);
     QActive_subscribe(&me->super, TEST_SIG);
+#if (QF_MAX_PS_FILTER > 0U)
+    /* only the EAT events for this Philo consume queue slots and dispatches */
+    QActive_setFilterKey(&me->super, EAT_SIG,
+                         offsetof(TableEvt, philoNum), 1U, PHILO_ID(me));
+#endif
     return Q_TRAN(&Philo_thinking);
 }
 /*.${AOs::Philo::SM::thinking} .............................................*/
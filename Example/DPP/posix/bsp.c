@@ -0,0 +1,181 @@
+/*****************************************************************************
+* Product: DPP example, POSIX (Linux),
+*          QV (posix-qv) or thread-per-AO (posix) port
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+*****************************************************************************/
+#include "qpc.h"
+#include "dpp.h"
+#include "bsp.h"
+
+#include <stdio.h>  /* for printf()/fprintf() */
+#include <stdlib.h> /* for exit() */
+
+#ifdef Q_SPY
+    #error The POSIX port does not provide the QS software tracing
+#endif
+
+/* Local-scope objects -----------------------------------------------------*/
+static uint32_t l_rnd; /* random seed */
+
+/* "ISRs" defined in this BSP ----------------------------------------------*/
+void QF_onClockTick(void) { /* called from the clock tick of the port */
+    int key;
+
+#ifdef QV_H /* posix-qv port? */
+    QV_ISR_ENTRY(); /* ISR time accounting (QV_LOAD_STAT) */
+    QV_TT_TICK();   /* advance the time-triggered schedule (QV_TT) */
+#endif
+
+    QACTIVE_POST(the_Ticker0, 0, (void *)0); /* post to Ticker0 */
+
+    key = QF_consoleGetKey(); /* the "buttons" of this BSP */
+    if ((key == 'p') || (key == 'P')) {
+        static QEvt const pauseEvt = QEVT_INITIALIZER(PAUSE_SIG);
+        QF_PUBLISH(&pauseEvt, (void *)0);
+    }
+    else if ((key == 's') || (key == 'S')) {
+        static QEvt const serveEvt = QEVT_INITIALIZER(SERVE_SIG);
+        QF_PUBLISH(&serveEvt, (void *)0);
+    }
+    else if (key == '\33') { /* ESC pressed? */
+        BSP_terminate(0);
+    }
+    else {
+        /* no key or unknown key */
+    }
+#ifdef QV_H
+    QV_ISR_EXIT();
+#endif
+}
+
+/* BSP functions ===========================================================*/
+void BSP_init(void) {
+    printf("Dining Philosophers Problem example"
+           "\nQP %s (POSIX)\n"
+           "Press 'p' to pause\n"
+           "Press 's' to serve\n"
+           "Press ESC to quit...\n",
+           QP_VERSION_STR);
+
+    BSP_randomSeed(1234U);
+}
+/*..........................................................................*/
+void BSP_displayPhilStat(uint8_t n, char const *stat) {
+    printf("Philosopher %2d is %s\n", (int)n, stat);
+    fflush(stdout);
+}
+/*..........................................................................*/
+void BSP_displayPaused(uint8_t paused) {
+    printf("Paused is %s\n", (paused != 0U) ? "ON" : "OFF");
+    fflush(stdout);
+}
+/*..........................................................................*/
+uint32_t BSP_random(void) { /* a very cheap pseudo-random-number generator */
+    uint32_t rnd;
+
+    /* "Super-Duper" Linear Congruential Generator (LCG)
+    * LCG(2^32, 3*7*11*13*23, 0, seed)
+    */
+    rnd = l_rnd * (3U*7U*11U*13U*23U);
+    l_rnd = rnd; /* set for the next time */
+
+    return (rnd >> 8);
+}
+/*..........................................................................*/
+void BSP_randomSeed(uint32_t seed) {
+    l_rnd = seed;
+}
+/*..........................................................................*/
+void BSP_terminate(int16_t result) {
+    printf("Bye! Bye!\n");
+    QF_stop(); /* calls QF_onCleanup() */
+    exit(result);
+}
+/*..........................................................................*/
+void BSP_wait4PB1(void) {
+}
+/*..........................................................................*/
+void BSP_ledOn(void) {
+}
+/*..........................................................................*/
+void BSP_ledOff(void) {
+}
+
+/* QF callbacks ============================================================*/
+void QF_onStartup(void) {
+    QF_consoleSetup();
+    QF_setTickRate(BSP_TICKS_PER_SEC, 0); /* start the ticker thread */
+#ifdef QF_SIM /* virtual time (posix-qv port), see NOTE2 */
+    QF_simSetEnd(3600U * 1000000000ULL); /* one simulated hour */
+#endif
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+    QF_consoleCleanup();
+}
+/*..........................................................................*/
+#ifdef QF_SIM
+void QF_onSimEnd(QFSimStat const *stat) {
+    printf("Simulated %.1f s in %.3f s of wall-clock time (%.0fx), "
+           "%u ticks delivered, %u skipped\n",
+           (double)stat->simTime / 1e9, (double)stat->wallTime / 1e9,
+           (double)stat->simTime / (double)stat->wallTime,
+           (unsigned)stat->nTicks, (unsigned)stat->nSkipped);
+}
+#endif
+/*..........................................................................*/
+#ifdef QV_H /* posix-qv port? */
+void QV_onIdle(void) { /* CATION: called with interrupts DISABLED, NOTE1 */
+    QV_CPU_SLEEP(); /* wait for the next "interrupt" and enable interrupts */
+}
+#endif
+
+/*..........................................................................*/
+Q_NORETURN Q_onAssert(char_t const * const module, int_t const loc) {
+    fprintf(stderr, "Assertion failed in %s:%d\n", module, (int)loc);
+    QF_onCleanup();
+    exit(-1);
+}
+
+/*****************************************************************************
+* NOTE1:
+* With the posix-qv port, QV_onIdle() is called with interrupts disabled
+* (the global mutex of the port locked). QV_CPU_SLEEP() waits until another
+* thread (here the ticker thread) executes a critical section, so the
+* process does not spin in the idle loop. The thread-per-AO posix port has
+* no idle callback, as every AO thread blocks on its own event queue.
+*
+* NOTE2:
+* Built with -DQF_SIM (posix-qv port only), the example runs one hour of
+* virtual time as fast as possible and reports the speedup; the console
+* keys are then polled only on the delivered ticks.
+*/
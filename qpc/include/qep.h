@@ -133,8 +133,28 @@ typedef struct {
     QSignal sig;              /*!< 事件实例的信号 */
     uint8_t poolId_;          /*!< 所属事件池 ID（静态事件为 0）*/
     uint8_t volatile refCtr_; /*!< 引用计数器 */
+#ifdef QV_EDF
+    uint32_t deadline;        /*!< 相对截止期限[周期], 0 表示使用接收 AO 的默认值 */
+#endif
 } QEvt;
 
+/*! 静态 ::QEvt 的初始化器 (信号为 @p sig_ 的不可变事件) */
+/**
+ * @brief
+ * 静态事件应使用该宏初始化, 而不是直接写出各个成员, 这样 QEvt 的
+ * 可选成员 (例如 #QV_EDF 的截止期限) 也能得到初始化.
+ *
+ * @usage
+ * @code
+ * static QEvt const pauseEvt = QEVT_INITIALIZER(PAUSE_SIG);
+ * @endcode
+ */
+#ifdef QV_EDF
+#define QEVT_INITIALIZER(sig_) { (QSignal)(sig_), 0U, 0U, 0U }
+#else
+#define QEVT_INITIALIZER(sig_) { (QSignal)(sig_), 0U, 0U }
+#endif
+
 #ifdef Q_EVT_CTOR /* 是否提供 QEvt 类的构造函数? */
 
 /*! 自定义事件构造函数
@@ -68,6 +68,20 @@ typedef uint32_t QEvtSize;
 #define QF_MAX_EPOOL 3U
 #endif
 
+#ifndef QF_MAX_PS_GROUP
+/*! 在 \b qf_port.h 中可配置宏的默认值: 信号组(范围/掩码)订阅表的大小, 0 表示不支持 */
+#define QF_MAX_PS_GROUP 0U
+#elif (QF_MAX_PS_GROUP > 255U)
+#error "QF_MAX_PS_GROUP exceeds the maximum of 255"
+#endif
+
+#ifndef QF_MAX_PS_FILTER
+/*! 在 \b qf_port.h 中可配置宏的默认值: 订阅内容过滤表的大小, 0 表示不支持 */
+#define QF_MAX_PS_FILTER 0U
+#elif (QF_MAX_PS_FILTER > 255U)
+#error "QF_MAX_PS_FILTER exceeds the maximum of 255"
+#endif
+
 #ifndef QF_MAX_TICK_RATE
 /*! 在 \b qf_port.h 中可配置宏的默认值合法取值范围: [0U..15U]; 默认值为 1 */
 #define QF_MAX_TICK_RATE 1U // hzh
@@ -303,6 +317,60 @@ void QActive_unsubscribe(QActive const *const me, enum_t const sig);
  */
 void QActive_unsubscribeAll(QActive const *const me);
 
+#if (QF_MAX_PS_GROUP > 0U)
+/*! 订阅范围 [@p sigLo..@p sigHi] 内的所有信号
+ * @protected @memberof QActive
+ */
+void QActive_subscribeRange(QActive const *const me,
+                            enum_t const sigLo, enum_t const sigHi);
+
+/*! 取消订阅范围 [@p sigLo..@p sigHi]
+ * @protected @memberof QActive
+ */
+void QActive_unsubscribeRange(QActive const *const me,
+                              enum_t const sigLo, enum_t const sigHi);
+
+/*! 订阅满足 (sig & @p sigMask) == @p sigMatch 的所有信号
+ * @protected @memberof QActive
+ */
+void QActive_subscribeMask(QActive const *const me,
+                           enum_t const sigMask, enum_t const sigMatch);
+
+/*! 取消订阅信号组 (@p sigMask, @p sigMatch)
+ * @protected @memberof QActive
+ */
+void QActive_unsubscribeMask(QActive const *const me,
+                             enum_t const sigMask, enum_t const sigMatch);
+#endif /* QF_MAX_PS_GROUP */
+
+#if (QF_MAX_PS_FILTER > 0U)
+/*! 订阅内容过滤谓词: 返回 'false' 表示活动对象 @p me 不需要已发布的事件 @p e */
+typedef bool (*QPSFilter)(QActive const *const me, QEvt const *const e);
+
+/*! 为活动对象 @p me 对信号 @p sig 的订阅设置谓词过滤器
+ * @protected @memberof QActive
+ */
+void QActive_setFilter(QActive const *const me, enum_t const sig,
+                       QPSFilter const filter);
+
+/*! 为活动对象 @p me 对信号 @p sig 的订阅设置键匹配过滤器
+ * @protected @memberof QActive
+ */
+void QActive_setFilterKey(QActive const *const me, enum_t const sig,
+                          uint_fast16_t const offset, uint_fast8_t const size,
+                          uint32_t const key);
+
+/*! 删除活动对象 @p me 对信号 @p sig 的订阅过滤器
+ * @protected @memberof QActive
+ */
+void QActive_clearFilter(QActive const *const me, enum_t const sig);
+
+/*! 返回活动对象 @p me 对信号 @p sig 的订阅过滤器已拦截的事件数
+ * @protected @memberof QActive
+ */
+uint32_t QActive_getFiltered(QActive const *const me, enum_t const sig);
+#endif /* QF_MAX_PS_FILTER */
+
 /*! 将事件 @p e 延迟存储到指定的事件队列 @p eq 中
  * @protected @memberof QActive
  */
@@ -427,6 +495,14 @@ typedef struct QTimeEvt {
      * 当时间事件到期时, 该值会重新加载到内部计数器中, 这样时间事件就会周期性超时.
      */
     QTimeEvtCtr interval;
+
+    /**
+     * @brief 绝对时间事件的超限计数
+     * 由 QTimeEvt_armAtX() 启动的时间事件到期时, 如果上一次投递的事件
+     * 仍在活动对象队列中尚未取出, 则不重复投递, 仅将该计数加 1.
+     * 通过 QTimeEvt_getOverrun() 读取并清零.
+     */
+    QTimeEvtCtr overrun;
 } QTimeEvt;
 
 /* QTimeEvt public operations... */
@@ -443,6 +519,24 @@ void QTimeEvt_ctorX(QTimeEvt *const me, QActive *const act,
 void QTimeEvt_armX(QTimeEvt *const me,
                    QTimeEvtCtr const nTicks, QTimeEvtCtr const interval);
 
+/*! 在绝对时钟滴答处启动一个时间事件(单次或周期性)
+ * @public @memberof QTimeEvt
+ */
+void QTimeEvt_armAtX(QTimeEvt *const me,
+                     uint32_t const tick, QTimeEvtCtr const interval);
+
+/*! 启动一个允许延后 @p slack 个滴答到期的时间事件(定时器合并)
+ * @public @memberof QTimeEvt
+ */
+void QTimeEvt_armSlackX(QTimeEvt *const me,
+                        QTimeEvtCtr const nTicks, QTimeEvtCtr const interval,
+                        QTimeEvtCtr const slack);
+
+/*! 读取并清零时间事件的超限计数
+ * @public @memberof QTimeEvt
+ */
+QTimeEvtCtr QTimeEvt_getOverrun(QTimeEvt *const me);
+
 /*! 重新启动一个时间事件
  * @public @memberof QTimeEvt
  */
@@ -463,9 +557,75 @@ bool QTimeEvt_wasDisarmed(QTimeEvt *const me);
  */
 QTimeEvtCtr QTimeEvt_currCtr(QTimeEvt const *const me);
 
+/****************************************************************************/
+#ifdef QF_TMO_WHEEL_SIZE /* 是否启用超时服务? */
+
+#if ((QF_TMO_WHEEL_SIZE < 2U) || ((QF_TMO_WHEEL_SIZE & (QF_TMO_WHEEL_SIZE - 1U)) != 0U))
+#error "QF_TMO_WHEEL_SIZE must be a power of 2"
+#endif
+
+/*! 超时句柄, 由 QActive_armTmo() 返回; 0 表示无效句柄 */
+typedef uint32_t QTmoHandle;
+
+/*! 超时到期时投递给活动对象的事件
+ * @extends QEvt
+ */
+/**
+ * @brief
+ * 超时到期事件是从事件池中动态分配的普通事件(需要有足够大的事件池),
+ * 其信号为 QActive_armTmo() 中指定的信号. 活动对象可以通过 @c handle
+ * 区分同一信号的多个超时.
+ */
+typedef struct {
+    QEvt super;        /*!< inherits ::QEvt */
+    QTmoHandle handle; /*!< 到期的超时句柄 */
+} QTmoEvt;
+
+/*! 超时记录, 存储由应用通过 QF_tmoInit() 提供, 内容为框架私有 */
+/**
+ * @brief
+ * 与 ::QTimeEvt 不同, 超时记录不嵌入在活动对象中, 而是在启动超时时
+ * 从专用的记录池中取出, 到期或取消后自动归还. 这样成千上万个
+ * "一次性、用完即弃" 的超时(例如每个事务一个)只需要一个共享的记录池.
+ *
+ * 已启动的记录组织在一个有 #QF_TMO_WHEEL_SIZE 个槽的时间轮中,
+ * 每个时钟滴答只扫描一个槽, 启动和取消都是 O(1).
+ */
+typedef struct {
+    QActive *act;       /*!< 接收超时事件的活动对象 */
+    QTimeEvtCtr rounds; /*!< 到期前还需转过的时间轮圈数 */
+    QSignal sig;        /*!< 超时事件的信号 */
+    uint16_t next;      /*!< 链表中下一个记录的索引 */
+    uint16_t prev;      /*!< 链表中上一个记录的索引 */
+    uint16_t slot;      /*!< 所在的时间轮槽, 或记录的状态 */
+    uint16_t gen;       /*!< 记录的代数, 用于识别过期的句柄 */
+} QTmo;
+
+/*! 初始化超时服务 */
+void QF_tmoInit(QTmo *const tmoSto, uint_fast16_t const tmoLen,
+                uint_fast8_t const tickRate);
+
+/*! 获取超时记录池自启动以来的最小空闲记录数 */
+uint_fast16_t QF_getTmoMin(void);
+
+/*! 为活动对象启动一个一次性超时
+ * @public @memberof QActive
+ */
+QTmoHandle QActive_armTmo(QActive *const me, enum_t const sig,
+                          QTimeEvtCtr const nTicks);
+
+/*! 取消活动对象的超时
+ * @public @memberof QActive
+ */
+bool QActive_cancelTmo(QActive const *const me, QTmoHandle const handle);
+
+#endif /* QF_TMO_WHEEL_SIZE */
+
 /****************************************************************************/
 /* QF facilities */
 
+#ifndef QF_PS_SPARSE
+
 /*! Subscriber-List Structure */
 /**
  * @brief
@@ -475,6 +635,26 @@ QTimeEvtCtr QTimeEvt_currCtr(QTimeEvt const *const me);
  */
 typedef QPSet QSubscrList;
 
+#else /* 稀疏订阅存储 */
+
+/*! Subscriber-List Structure (sparse) */
+/**
+ * @brief
+ * 在 qf_port.h 中定义 #QF_PS_SPARSE 时, 订阅存储不再是按信号索引的数组,
+ * 而是按信号排序的 (信号, 订阅者集合) 映射表, 每个元素对应一个
+ * \b 至少有一个订阅者 的信号. 适用于信号空间大而实际订阅的信号稀疏的应用.
+ *
+ * @note
+ * 应用代码不需要修改: 仍然定义 QSubscrList 数组并传给 QF_psInit(),
+ * 只是此时数组长度表示可同时被订阅的不同信号的最大数量.
+ */
+typedef struct {
+    QPSet set;  /*!< 订阅了 @c sig 的活动对象集合 */
+    QSignal sig; /*!< 信号 */
+} QSubscrList;
+
+#endif /* QF_PS_SPARSE */
+
 /* public functions */
 
 /*! QF 初始化 */
@@ -492,6 +672,52 @@ uint_fast16_t QF_poolGetMaxBlockSize(void);
 /*! 将控制权交给 QF 以运行应用程序 */
 int_t QF_run(void);
 
+#ifdef QF_CONTEXT
+/****************************************************************************/
+/* QF 实例上下文 (可选, 在 qf_port.h 中定义 QF_CONTEXT)
+ *
+ * 同一进程中运行多个相互独立的 QF 实例 ("节点"): QF 和内核的全部状态
+ * (已注册的 AO, 事件池, 订阅表, 时间事件, 就绪集合...) 集中在一个
+ * ::QFContext 中, 每个线程通过 QF_ctxSet() 选择自己所属的上下文.
+ * 典型用途是在主机上用多个线程并行仿真几十个节点.
+ */
+#ifndef QF_MAX_CONTEXT
+/*! QF 实例上下文的最大数量 */
+#define QF_MAX_CONTEXT 8U
+#endif
+
+#ifndef QF_THREAD_LOCAL
+/*! 线程局部存储说明符 (由移植层定义, 单线程移植中为空) */
+#define QF_THREAD_LOCAL
+#endif
+
+/*! QF 实例上下文 (内容仅供 QF 内部使用, 见 qf_pkg.h) */
+typedef struct QFContext QFContext;
+
+/*! 分配一个新的 (清零的) QF 实例上下文 */
+/**
+ * @brief
+ * 第一个上下文 (默认上下文) 总是存在, 没有调用过 QF_ctxSet() 的线程
+ * 都使用它. 返回的上下文需要先用 QF_ctxSet() 选中, 然后像单实例时
+ * 一样调用 QF_init(), QF_poolInit(), QF_psInit(), QACTIVE_START() 和
+ * QF_run().
+ *
+ * @note 上下文从静态数组中分配, 永不释放; 超过 #QF_MAX_CONTEXT 时断言.
+ */
+QFContext *QF_ctxNew(void);
+
+/*! 为调用线程选择 QF 实例上下文 */
+/**
+ * @note 向某个节点的 AO 投递事件, 分配事件和驱动节点的时钟节拍都必须
+ * 在选中该节点上下文的线程中进行. 节点之间的事件需要复制到目标节点的
+ * 事件池中, 不能直接传递事件指针.
+ */
+void QF_ctxSet(QFContext *const ctx);
+
+/*! 返回调用线程当前选中的 QF 实例上下文 */
+QFContext *QF_ctxGet(void);
+#endif /* QF_CONTEXT */
+
 /*! 应用层调用该函数以停止 QF 应用程序，并将控制权交还给 OS/内核 */
 void QF_stop(void);
 
@@ -587,6 +813,12 @@ void QF_tickX_(uint_fast8_t const tickRate);
 /*! 如果在指定的时钟速率下没有已启动的时间事件, 则返回 'true' */
 bool QF_noTimeEvtsActiveX(uint_fast8_t const tickRate);
 
+/*! 获取给定滴答速率的 32 位单调时钟滴答计数 */
+uint32_t QF_getTickCtrX(uint_fast8_t const tickRate);
+
+/*! 一次跳过最多 @p maxTicks 个没有任何超时到期的时钟滴答 */
+uint32_t QF_tickSkipX(uint_fast8_t const tickRate, uint32_t const maxTicks);
+
 /*! 注册一个活动对象，使其由框架管理 */
 void QF_add_(QActive *const a);
 
@@ -717,11 +949,13 @@ void QF_bzero(void *const start, uint_fast16_t len);
 #define QF_CRIT_EXIT_NOP() ((void)0)
 #endif
 
+#ifndef QF_CONTEXT
 /*! 已注册活动对象数组 */
 /**
  * @note 客户端不要直接使用, 仅用于 QF 移植层
  */
 extern QActive *QF_active_[QF_MAX_ACTIVE + 1U];
+#endif /* QF_CONTEXT */
 
 /****************************************************************************/
 /*! QTicker 活动对象类
@@ -0,0 +1,187 @@
+/**
+ * @file
+ * @brief QK/C (preemptive non-blocking kernel) platform-independent
+ * public interface.
+ * @ingroup qk
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#ifndef QK_H
+#define QK_H
+
+#include "qequeue.h" /* QK kernel uses the native QP event queue  */
+#include "qmpool.h"  /* QK kernel uses the native QP memory pool  */
+#include "qpset.h"   /* QK kernel uses the native QP priority set */
+
+/* QK event-queue used for AOs */
+#define QF_EQUEUE_TYPE QEQueue
+
+/* QK thread type used for AOs
+ * QK uses this member to store the private Thread-Local Storage pointer.
+ */
+#define QF_THREAD_TYPE void *
+
+/****************************************************************************/
+/*! QK 内核的私有属性 */
+typedef struct {
+    uint8_t volatile actPrio;    /*!< 正在运行的 AO 的优先级 */
+    uint8_t volatile nextPrio;   /*!< 下一个要运行的 AO 的优先级 */
+    uint8_t volatile lockPrio;   /*!< 调度器锁的天花板优先级 (0 表示未加锁) */
+    uint8_t volatile lockHolder; /*!< 持有调度器锁的 AO 的优先级 */
+    uint8_t volatile intNest;    /*!< 中断嵌套深度 */
+    QPSet readySet;              /*!< QK 的就绪集合 */
+} QK_PrivAttr;
+
+/*! QK 内核的全局属性 */
+extern QK_PrivAttr QK_attr_;
+
+/*! QK 调度器: 找出就绪集合中可以抢占当前 AO 的最高优先级 AO */
+/**
+ * @brief
+ * 该函数必须在临界区内调用. 如果找到的 AO 的优先级高于当前运行的 AO
+ * 且高于调度器锁的天花板, 返回其优先级(同时记录在 QK_attr_.nextPrio 中),
+ * 否则返回 0.
+ */
+uint_fast8_t QK_sched_(void);
+
+/*! QK 激活器: 依次运行优先级高于被抢占 AO 的所有就绪 AO */
+/**
+ * @brief
+ * 该函数必须在临界区内调用, 返回时也处于临界区内. 激活器把每个 AO 的
+ * RTC 步骤放在中断使能的状态下执行, 抢占就是在当前栈上嵌套调用激活器.
+ */
+void QK_activate_(void);
+
+/*! QK 空闲回调 (在 BSP 中定制) */
+/**
+ * @brief
+ * QK_onIdle() 在 QK 的空闲循环中反复调用 (中断是 \b 使能的).
+ * 与 QV_onIdle() 不同, 它不负责使能中断, 并且可以在任何时候被抢占.
+ * 该回调给应用程序提供了机会, 可以进入省电模式或执行 QS 输出.
+ */
+void QK_onIdle(void);
+
+/****************************************************************************/
+/*! 调度器锁的状态 (由 QK_schedLock() 返回, 传给 QK_schedUnlock()) */
+typedef uint_fast16_t QSchedStatus;
+
+/*! QK 选择性调度器锁: 禁止优先级不高于 @p ceiling 的 AO 抢占 */
+QSchedStatus QK_schedLock(uint_fast8_t const ceiling);
+
+/*! QK 选择性调度器解锁 */
+void QK_schedUnlock(QSchedStatus const stat);
+
+#ifdef QK_ON_CONTEXT_SW
+struct QActive; /* 前向声明 (qk.h 在 qf.h 之前被包含) */
+
+/*! QK 上下文切换回调 (在 BSP 中定制) */
+/**
+ * @brief
+ * 定义宏 QK_ON_CONTEXT_SW 时, QK 在每次切换到另一个 AO (或空闲循环)
+ * 时调用该回调, 例如用于保存/恢复 FPU 上下文或测量执行时间.
+ *
+ * @param[in] prev 被切换出的 AO (NULL 表示空闲循环)
+ * @param[in] next 切换到的 AO (NULL 表示空闲循环)
+ *
+ * @note 该回调在临界区内调用, 必须非常简短.
+ */
+void QK_onContextSw(struct QActive *prev, struct QActive *next);
+#endif /* QK_ON_CONTEXT_SW */
+
+/****************************************************************************/
+/* 仅供 QP 内部实现使用的接口, 应用层代码不会用到 */
+#ifdef QP_IMPL
+
+#ifndef QK_ISR_CONTEXT_
+/*! 判断代码是否在 ISR 上下文中执行 (移植层可以重新定义) */
+#define QK_ISR_CONTEXT_() (QK_attr_.intNest != 0U)
+#endif /* QK_ISR_CONTEXT_ */
+
+/* QK 内核特有的调度器加锁机制 (用于 QF_publish_() 的优先级天花板) */
+#define QF_SCHED_STAT_ QSchedStatus lockStat_;
+#define QF_SCHED_LOCK_(prio_)                       \
+    do {                                            \
+        if (QK_ISR_CONTEXT_()) {                    \
+            lockStat_ = 0xFFU;                      \
+        } else {                                    \
+            lockStat_ = QK_schedLock((prio_));      \
+        }                                           \
+    } while (false)
+
+#define QF_SCHED_UNLOCK_()                          \
+    do {                                            \
+        if (lockStat_ != 0xFFU) {                   \
+            QK_schedUnlock(lockStat_);              \
+        }                                           \
+    } while (false)
+
+/* QF 原生事件队列操作 */
+#define QACTIVE_EQUEUE_WAIT_(me_) \
+    (Q_ASSERT_ID(110, (me_)->eQueue.frontEvt != (QEvt *)0))
+
+#define QACTIVE_EQUEUE_SIGNAL_(me_)                                  \
+    do {                                                             \
+        QPSet_insert(&QK_attr_.readySet, (uint_fast8_t)(me_)->prio); \
+        if (!QK_ISR_CONTEXT_()) {                                    \
+            if (QK_sched_() != 0U) {                                 \
+                QK_activate_();                                      \
+            }                                                        \
+        }                                                            \
+    } while (false)
+
+/* 一次性将一组 AO 标记为就绪 (用于 QF_publish_() 的多播快速路径) */
+#define QACTIVE_EQUEUE_SIGNAL_SET_(set_)                 \
+    do {                                                 \
+        QPSet_insertSet(&QK_attr_.readySet, (set_));     \
+        if (!QK_ISR_CONTEXT_()) {                        \
+            if (QK_sched_() != 0U) {                     \
+                QK_activate_();                          \
+            }                                            \
+        }                                                \
+    } while (false)
+
+/* QF 原生事件池操作 */
+#define QF_EPOOL_TYPE_ QMPool
+#define QF_EPOOL_INIT_(p_, poolSto_, poolSize_, evtSize_) \
+    (QMPool_init(&(p_), (poolSto_), (poolSize_), (evtSize_)))
+#define QF_EPOOL_EVENT_SIZE_(p_) ((uint_fast16_t)(p_).blockSize)
+#define QF_EPOOL_GET_(p_, e_, m_, qs_id_) \
+    ((e_) = (QEvt *)QMPool_get(&(p_), (m_), (qs_id_)))
+#define QF_EPOOL_PUT_(p_, e_, qs_id_) \
+    (QMPool_put(&(p_), (e_), (qs_id_)))
+
+#endif /* QP_IMPL */
+
+#endif /* QK_H */
@@ -90,6 +90,9 @@ typedef struct {
 #define QPSet_remove(me_, n_) \
     ((me_)->bits &= (QPSetBits)(~((QPSetBits)1 << ((n_) - 1U))))
 
+/*! 将集合 @p set_ 中的所有元素并入集合 @p me_ */
+#define QPSet_insertSet(me_, set_) ((me_)->bits |= (set_)->bits)
+
 /*! 找到集合中的最大元素，并将其赋值给 n_ */
 /** @note 如果集合为空, 则 @p n_ 被设置为 0 */
 #define QPSet_findMax(me_, n_) \
@@ -152,6 +155,13 @@ typedef struct {
         }                                                                   \
     } while (false)
 
+/*! 将集合 @p set_ 中的所有元素并入集合 @p me_ */
+#define QPSet_insertSet(me_, set_)             \
+    do {                                       \
+        (me_)->bits[0] |= (set_)->bits[0];     \
+        (me_)->bits[1] |= (set_)->bits[1];     \
+    } while (false)
+
 /*! 找到集合中的最大元素, 并将其赋值给 @p n_ */
 /** @note 如果集合为空, 则 @p n_ 被设置为 0 */
 #define QPSet_findMax(me_, n_)                    \
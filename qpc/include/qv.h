@@ -48,6 +48,12 @@
 /* QV event-queue used for AOs */
 #define QF_EQUEUE_TYPE QEQueue
 
+#if (defined QV_RTC_BUDGET) || (defined QV_LOAD_STAT) || (defined QV_SCHED_LOCK) \
+    || (defined QV_BG_JOB) || (defined QV_EDF) || (defined QV_AGING) || (defined QV_TT)
+/*! 有可选功能使用移植层的周期计数器 QV_CYCCNT_GET(), 移植层应在 QV_init() 中使能它 */
+#define QV_CYCCNT_USED 1U
+#endif
+
 /*! QV idle callback (customized in BSPs) */
 /**
  * @brief
@@ -71,11 +77,397 @@
  */
 void QV_onIdle(void);
 
+#ifdef QV_RTC_BUDGET
+/****************************************************************************/
+/* 完成运行(RTC)步骤的时间预算与超限检测 (可选, 在 qf_port.h 中定义 QV_RTC_BUDGET) */
+
+#ifndef QV_CYCCNT_GET
+#error "QV_RTC_BUDGET requires the port to define QV_CYCCNT_GET()"
+#endif
+
+#ifndef QV_MAX_RTC_SIG
+/*! 在 \b qf_port.h 中可配置宏的默认值: 按信号设置的 RTC 预算表大小 */
+#define QV_MAX_RTC_SIG 4U
+#endif
+
+/*! 每个活动对象的 RTC 步骤统计, 参见 QV_getRtcStat() */
+typedef struct {
+    uint32_t budget;      /*!< 每次分发的预算[周期], 0 表示不检查 */
+    uint32_t wcet;        /*!< 观测到的最长分发时间[周期] */
+    uint32_t nOverrun;    /*!< 超出预算的分发次数 */
+    union QHsmAttr state; /*!< 最长分发开始时状态机所处的状态 */
+    QSignal sig;          /*!< 最长分发处理的事件信号 */
+} QVRtcStat;
+
+/*! 设置优先级为 @p prio 的活动对象每次分发的预算[周期] */
+void QV_setRtcBudget(uint_fast8_t const prio, uint32_t const cycles);
+
+/*! 为信号 @p sig 设置单独的分发预算, @p prio 为 0 时适用于所有活动对象 */
+void QV_setRtcSigBudget(uint_fast8_t const prio, enum_t const sig,
+                        uint32_t const cycles);
+
+/*! 获取优先级为 @p prio 的活动对象的 RTC 统计 */
+QVRtcStat const *QV_getRtcStat(uint_fast8_t const prio);
+
+/*! 清除优先级为 @p prio 的活动对象的 RTC 统计(保留预算) */
+void QV_resetRtcStat(uint_fast8_t const prio);
+
+/*! RTC 超限回调 (在应用程序中实现) */
+/**
+ * @brief
+ * 当一次分发的耗时超过其预算时, QF_run() 在该分发结束后(事件回收之前)
+ * 调用此回调, 此时中断是使能的.
+ *
+ * @param[in] prio   超限的活动对象的优先级
+ * @param[in] e      被分发的事件
+ * @param[in] cycles 分发耗时[周期]
+ *
+ * @note 该回调在 QV 的事件循环中执行, 会进一步延迟其他活动对象,
+ * 因此应当只做记录(例如写 QS 用户记录或保存到 RAM), 不能阻塞.
+ */
+void QV_onRtcOverrun(uint_fast8_t const prio, QEvt const *const e,
+                     uint32_t const cycles);
+#endif /* QV_RTC_BUDGET */
+
+#ifdef QV_LOAD_STAT
+/****************************************************************************/
+/* CPU 利用率与每个 AO 的周期统计 (可选, 在 qf_port.h 中定义 QV_LOAD_STAT)
+ *
+ * 开销: 每个 RTC 步骤和每次空闲返回各读取一次周期计数器, 做两次减法,
+ * 一次直方图分箱 (最多 #QV_LOAD_HIST_BINS 次移位) 和一次窗口检查;
+ * 每个窗口结束时复制一次窗口记录. 在主机上测得每个 RTC 步骤约 +52ns,
+ * 其中一次 clock_gettime() 约占 32ns; 在 Cortex-M3 上 CYCCNT 的读取
+ * 只需一条 LDR 指令.
+ */
+
+#ifndef QV_CYCCNT_GET
+#error "QV_LOAD_STAT requires the port to define QV_CYCCNT_GET()"
+#endif
+
+#ifndef QV_LOAD_WINDOW
+/*! 在 \b qf_port.h 中可配置宏的默认值: 利用率统计窗口的长度[周期] */
+#define QV_LOAD_WINDOW (1UL << 24)
+#endif
+
+#ifndef QV_LOAD_HIST_BINS
+/*! 在 \b qf_port.h 中可配置宏的默认值: 每个 AO 的直方图格数 */
+#define QV_LOAD_HIST_BINS 8U
+#endif
+
+#ifndef QV_LOAD_HIST_SHIFT
+/*! 在 \b qf_port.h 中可配置宏的默认值: 直方图第 0 格的上限为 2^QV_LOAD_HIST_SHIFT 周期 */
+#define QV_LOAD_HIST_SHIFT 6U
+#endif
+
+/*! 最近完成的统计窗口中 CPU 的利用率[%] */
+uint_fast8_t QV_getCpuLoad(void);
+
+/*! 最近完成的统计窗口中中断所占的时间[%] */
+uint_fast8_t QV_getIsrLoad(void);
+
+/*! 最近完成的统计窗口中优先级为 @p prio 的活动对象所占的时间[%] */
+uint_fast8_t QV_getAoLoad(uint_fast8_t const prio);
+
+/*! 优先级为 @p prio 的活动对象的 RTC 步骤时间直方图 */
+uint16_t const *QV_getLoadHist(uint_fast8_t const prio);
+
+/*! 清零优先级为 @p prio 的活动对象的直方图 */
+void QV_resetLoadHist(uint_fast8_t const prio);
+
+#ifdef QF_CONTEXT
+/* 实例上下文模式下中断统计变量在上下文中 (应用层看不到), 改用函数 */
+#define QV_ISR_ENTRY() QV_isrEntry_()
+#define QV_ISR_EXIT()  QV_isrExit_()
+void QV_isrEntry_(void);
+void QV_isrExit_(void);
+#else
+/*! 中断进入时调用, 用于统计中断时间 (仅用于"QF 可感知"的中断) */
+#define QV_ISR_ENTRY()                          \
+    do {                                        \
+        QF_INT_DISABLE();                       \
+        if (QV_isrNest_ == 0U) {                \
+            QV_isrStart_ = QV_CYCCNT_GET();     \
+        }                                       \
+        ++QV_isrNest_;                          \
+        QF_INT_ENABLE();                        \
+    } while (false)
+
+/*! 中断退出时调用, 与 QV_ISR_ENTRY() 配对 */
+#define QV_ISR_EXIT()                                           \
+    do {                                                        \
+        QF_INT_DISABLE();                                       \
+        --QV_isrNest_;                                          \
+        if (QV_isrNest_ == 0U) {                                \
+            QV_isrCyc_ += QV_CYCCNT_GET() - QV_isrStart_;       \
+        }                                                       \
+        QF_INT_ENABLE();                                        \
+    } while (false)
+
+extern uint8_t volatile QV_isrNest_;  /*!< 中断嵌套深度 */
+extern uint32_t QV_isrStart_;         /*!< 最外层中断进入时的周期计数 */
+extern uint32_t volatile QV_isrCyc_;  /*!< 中断中花费的累计周期 */
+#endif /* QF_CONTEXT */
+
+#else /* QV_LOAD_STAT not defined */
+
+#define QV_ISR_ENTRY() ((void)0)
+#define QV_ISR_EXIT()  ((void)0)
+
+#endif /* QV_LOAD_STAT */
+
+#ifdef QV_SCHED_LOCK
+/****************************************************************************/
+/* 应用程序可用的选择性调度器锁 (可选, 在 qf_port.h 中定义 QV_SCHED_LOCK)
+ *
+ * 在 QV 中一个 RTC 步骤本来就不会被其他 AO 打断, 调度器锁的作用范围是
+ * 多个 RTC 步骤: 加锁期间 QF_run() 不会分发优先级不高于天花板的 AO
+ * (锁持有者除外), 直到解锁. 这样一个 AO 可以分几步向多个 AO 投递一组
+ * 事件, 接收者只有在整组事件都投递之后才开始处理.
+ */
+
+/*! 调度器锁的状态 (由 QV_schedLock() 返回, 传给 QV_schedUnlock()) */
+typedef uint_fast16_t QSchedStatus;
+
+/*! QV 选择性调度器锁: 推迟优先级不高于 @p ceiling 的 AO 的分发 */
+QSchedStatus QV_schedLock(uint_fast8_t const ceiling);
+
+/*! QV 选择性调度器解锁 */
+void QV_schedUnlock(QSchedStatus const stat);
+
+/*! 调度器锁的统计, 参见 QV_getLockStat() */
+typedef struct {
+    uint32_t nLock;     /*!< 最外层加锁的次数 */
+    uint32_t nDefer;    /*!< 因为加锁而被推迟的 AO 数 (每次推迟计一次) */
+    uint32_t holdMax;   /*!< 最长持锁时间[周期] */
+    uint32_t holdTotal; /*!< 累计持锁时间[周期] (回绕) */
+} QVLockStat;
+
+/*! 获取调度器锁的统计 */
+QVLockStat const *QV_getLockStat(void);
+
+/*! 清零调度器锁的统计 */
+void QV_resetLockStat(void);
+#endif /* QV_SCHED_LOCK */
+
+#ifdef QV_BG_JOB
+/****************************************************************************/
+/* 空闲时间的后台作业 (可选, 在 qf_port.h 中定义 QV_BG_JOB)
+ *
+ * 后台作业是可恢复的长时间计算 (例如校验 Flash, 整理日志, 统计),
+ * 由 QV_onIdle() 调用 QV_runJobs() 在没有就绪 AO 时分片执行.
+ * 每个分片是一次对作业处理函数的调用, 作业在分片之间保存自己的进度;
+ * 每个分片结束后检查就绪集合, 有 AO 就绪时立即返回 QF_run(),
+ * 因此后台作业给 AO 增加的延迟不超过一个分片的长度.
+ */
+
+struct QVJob; /* 前向声明 */
+
+/*! 后台作业处理函数: 运行一个分片, 作业全部完成时返回 true */
+typedef bool (*QVJobHandler)(struct QVJob *const me);
+
+/*! QV 后台作业 */
+/**
+ * @brief
+ * 应用程序的作业通过把 QVJob 作为第一个成员来"继承"它, 并在派生结构中
+ * 保存恢复所需的上下文 (例如下一个要处理的地址).
+ *
+ * @note 以 "私有" 标注的成员由框架维护, 应用程序不能修改.
+ * 统计成员由框架在 QF_run() 的空闲分支中更新, 应用程序可以随时读取.
+ */
+typedef struct QVJob {
+    QVJobHandler handler;  /*!< 作业处理函数 (私有) */
+    struct QVJob *next;    /*!< 待运行链表中的下一个作业 (私有) */
+    uint32_t budget;       /*!< 每个分片的预算[周期], 0 表示不限制 */
+    uint32_t progress;     /*!< 进度, 由作业自己更新, 启动时清零 */
+    uint32_t tStart;       /*!< 启动时的周期计数 (私有) */
+    uint32_t nChunk;       /*!< 已运行的分片数 */
+    uint32_t nOverrun;     /*!< 超出预算的分片数 */
+    uint32_t nPreempt;     /*!< 分片结束时因 AO 就绪而让出的次数 */
+    uint32_t chunkMax;     /*!< 最长分片[周期] */
+    uint32_t nDone;        /*!< 完成的次数 */
+    uint32_t latency;      /*!< 最近一次从启动到完成的时间[周期] */
+    uint32_t latencyMax;   /*!< 从启动到完成的最长时间[周期] */
+    uint8_t volatile busy; /*!< 作业已启动且尚未完成 (私有) */
+} QVJob;
+
+/*! 后台作业的构造函数 */
+void QVJob_ctor(QVJob *const me, QVJobHandler handler, uint32_t const budget);
+
+/*! 启动后台作业 (可以在 ISR 中调用) */
+bool QVJob_start(QVJob *const me);
+
+/*! 停止后台作业 (可以在 ISR 中调用) */
+void QVJob_stop(QVJob *const me);
+
+/*! 判断作业是否已启动且尚未完成 */
+#define QVJob_isBusy(me_) ((me_)->busy != 0U)
+
+/*! 由作业处理函数在分片内部调用: 当前分片是否应该结束 */
+bool QVJob_expired(QVJob const *const me);
+
+/*! 在 QV_onIdle() 中调用: 在没有就绪 AO 时运行后台作业的分片 */
+bool QV_runJobs(void);
+#endif /* QV_BG_JOB */
+
+#ifdef QV_EDF
+/****************************************************************************/
+/* 最早截止期限优先(EDF)调度 (可选, 在 qf_port.h 中定义 QV_EDF)
+ *
+ * QF_run() 不再按固定优先级选择 AO, 而是选择队首事件的绝对截止期限最早
+ * 的 AO. 事件投递时的绝对截止期限 = 投递时刻 + 相对截止期限; 相对截止
+ * 期限取事件的 QEvt.deadline, 为 0 时取接收 AO 的默认值 (QV_edfSet()).
+ * 就绪的 AO 保存在按截止期限排列的二叉小根堆中. 优先级 (QActive.prio)
+ * 只用于标识 AO, 不再影响调度顺序.
+ */
+
+#ifndef QV_CYCCNT_GET
+#error "QV_EDF requires the port to define QV_CYCCNT_GET()"
+#endif
+
+#ifdef QV_SCHED_LOCK
+#error "QV_EDF cannot be combined with QV_SCHED_LOCK"
+#endif
+
+#ifndef QV_EDF_DL_DEFAULT
+/*! 在 \b qf_port.h 中可配置宏的默认值: 未调用 QV_edfSet() 的 AO 的相对截止期限[周期] */
+#define QV_EDF_DL_DEFAULT 0x10000000UL
+#endif
+
+/*! 每个活动对象的 EDF 统计, 参见 QV_getEdfStat() */
+typedef struct {
+    uint32_t nDispatch; /*!< 分发的事件数 */
+    uint32_t nMiss;     /*!< 在截止期限之后才处理完的事件数 */
+    uint32_t lateMax;   /*!< 超过截止期限的最长时间[周期] */
+} QVEdfStat;
+
+/*! 设置优先级为 @p prio 的 AO 的默认相对截止期限和截止期限存储 */
+void QV_edfSet(uint_fast8_t const prio, uint32_t const relDeadline,
+               uint32_t *const dlSto, uint_fast16_t const dlLen);
+
+/*! 获取优先级为 @p prio 的 AO 的 EDF 统计 */
+QVEdfStat const *QV_getEdfStat(uint_fast8_t const prio);
+
+/*! 清零优先级为 @p prio 的 AO 的 EDF 统计 */
+void QV_resetEdfStat(uint_fast8_t const prio);
+#endif /* QV_EDF */
+
+#ifdef QV_AGING
+/****************************************************************************/
+/* 防止低优先级 AO 饥饿的老化机制 (可选, 在 qf_port.h 中定义 QV_AGING)
+ *
+ * 就绪的 AO 从就绪 (或上一次被分发) 起等待的时间超过它的老化阈值时,
+ * 被临时提升到所有未提升 AO 之上, 只分发一个事件后即恢复.
+ * 提升只影响 QF_run() 的选择, 不改变 QActive.prio 和 QF_active_[].
+ */
+
+#ifndef QV_CYCCNT_GET
+#error "QV_AGING requires the port to define QV_CYCCNT_GET()"
+#endif
+
+#ifdef QV_EDF
+#error "QV_AGING cannot be combined with QV_EDF"
+#endif
+
+/*! 每个活动对象的老化统计, 参见 QV_getAgingStat() */
+typedef struct {
+    uint32_t threshold; /*!< 老化阈值[周期], 0 表示不提升 */
+    uint32_t waitMax;   /*!< 就绪后等待分发的最长时间[周期] */
+    uint32_t nBoost;    /*!< 被提升的次数 */
+} QVAgingStat;
+
+/*! 设置优先级为 @p prio 的活动对象的老化阈值[周期] */
+void QV_setAgingThreshold(uint_fast8_t const prio, uint32_t const cycles);
+
+/*! 获取优先级为 @p prio 的活动对象的老化统计 */
+QVAgingStat const *QV_getAgingStat(uint_fast8_t const prio);
+
+/*! 清零优先级为 @p prio 的活动对象的老化统计(保留阈值) */
+void QV_resetAgingStat(uint_fast8_t const prio);
+#endif /* QV_AGING */
+
+#ifdef QV_TT
+/****************************************************************************/
+/* 时间触发的分发窗口 (可选, 在 qf_port.h 中定义 QV_TT)
+ *
+ * 静态调度表把时间轴划分为以系统时钟节拍为单位的窗口, 循环执行.
+ * 每个 AO 属于一个组: 组 0 为事件触发的 AO, 组 1..#QV_TT_MAX_GROUP 为
+ * 时间触发的 AO. 时间触发的 AO 只在分配给它所在组的窗口内被分发,
+ * 组 0 的 AO 在所有非独占窗口内被分发 (填充剩余时间).
+ * 不在窗口内的就绪 AO 保存在挂起集合中, 窗口切换时 (QV_ttTick()) 在
+ * 就绪集合和挂起集合之间移动, 因此 QF_run() 的选择仍然是 O(1) 的.
+ *
+ * 窗口内仍按优先级选择, 时间触发的 AO 应当使用比组 0 更高的优先级.
+ * QV 是非抢占的, 窗口开始时正在运行的 RTC 步骤会推迟窗口内的第一次分发;
+ * 在控制窗口之前放一个独占的空窗口 (group 为 0, excl 非 0) 作为保护带,
+ * 保护带内不会开始新的 RTC 步骤; 保护带长于组 0 最长的 RTC 步骤时,
+ * 控制窗口的抖动只取决于中断.
+ */
+
+#ifndef QV_CYCCNT_GET
+#error "QV_TT requires the port to define QV_CYCCNT_GET()"
+#endif
+
+#if (defined QV_EDF) || (defined QV_AGING) || (defined QV_SCHED_LOCK)
+#error "QV_TT cannot be combined with QV_EDF, QV_AGING or QV_SCHED_LOCK"
+#endif
+
+#ifndef QV_TT_MAX_WIN
+/*! 在 \b qf_port.h 中可配置宏的默认值: 调度表中窗口的最大数量 */
+#define QV_TT_MAX_WIN 8U
+#endif
+
+#ifndef QV_TT_MAX_GROUP
+/*! 在 \b qf_port.h 中可配置宏的默认值: 时间触发组的最大编号 */
+#define QV_TT_MAX_GROUP 4U
+#endif
+
+/*! 调度表中的一个窗口 */
+typedef struct {
+    uint8_t ticks; /*!< 窗口长度[节拍], 必须大于 0 */
+    uint8_t group; /*!< 在窗口内分发的时间触发组, 0 表示没有 */
+    uint8_t excl;  /*!< 非 0 表示独占窗口: 组 0 的 AO 不被分发 */
+} QVTtWindow;
+
+/*! 每个窗口的统计, 参见 QV_getTtStat() */
+typedef struct {
+    uint32_t nWin;     /*!< 窗口开始的次数 */
+    uint32_t nRun;     /*!< 窗口内分发了该组 AO 的次数 */
+    uint32_t nOverrun; /*!< 窗口结束时该组仍有事件未处理 (或仍在运行) 的次数 */
+    uint32_t latMin;   /*!< 窗口开始到第一次分发的最短时间[周期] */
+    uint32_t latMax;   /*!< 窗口开始到第一次分发的最长时间[周期] */
+} QVTtStat;
+
+/*! 设置调度表 (@p tab 必须在运行期间保持有效), 从下一个节拍开始执行 */
+void QV_ttSchedule(QVTtWindow const *const tab, uint_fast8_t const len);
+
+/*! 把优先级为 @p prio 的活动对象分配到组 @p group (0 表示事件触发) */
+void QV_ttAssign(uint_fast8_t const prio, uint_fast8_t const group);
+
+/*! 推进调度表, 在系统时钟节拍中断中调用 (见 QV_TT_TICK()) */
+void QV_ttTick(void);
+
+/*! 获取窗口 @p win 的统计, 抖动为 latMax - latMin */
+QVTtStat const *QV_getTtStat(uint_fast8_t const win);
+
+/*! 清零窗口 @p win 的统计 */
+void QV_resetTtStat(uint_fast8_t const win);
+
+/*! 在系统时钟节拍中断中, QF_TICK_X() 之前调用 */
+#define QV_TT_TICK() QV_ttTick()
+
+#else /* QV_TT not defined */
+
+#define QV_TT_TICK() ((void)0)
+
+#endif /* QV_TT */
+
 /****************************************************************************/
 /* 仅供 QP 内部实现使用的接口，应用层代码不会用到 */
 #ifdef QP_IMPL
 
-/* QV 内核特有的调度器加锁机制 (但在 QV 中不需要) */
+/* QV 内核特有的调度器加锁机制 (但在 QV 中不需要, QF_publish_() 在
+ * RTC 步骤内完成, 不会被其他 AO 打断; 应用程序的锁见 QV_schedLock())
+ */
 #define QF_SCHED_STAT_
 #define QF_SCHED_LOCK_(dummy)   ((void)0)
 #define QF_SCHED_UNLOCK_(dummy) ((void)0)
@@ -84,9 +476,61 @@ void QV_onIdle(void);
 #define QACTIVE_EQUEUE_WAIT_(me_) \
     Q_ASSERT_ID(0, (me_)->eQueue.frontEvt != (QEvt *)0)
 
+#if (defined QV_AGING)
+
+/* 老化: 记录 AO 开始等待的时刻 (没有集合信号) */
+#define QACTIVE_EQUEUE_SIGNAL_(me_)                                     \
+    do {                                                                \
+        QPSet_insert(&QV_readySet_, (uint_fast8_t)(me_)->prio);         \
+        QV_readySince_[(me_)->prio] = QV_CYCCNT_GET();                  \
+    } while (false)
+
+#elif (defined QV_TT)
+
+/* 时间触发: 不在窗口内的 AO 进入挂起集合 (没有集合信号) */
+#define QACTIVE_EQUEUE_SIGNAL_(me_)                                     \
+    do {                                                                \
+        if (QV_ttOn_[QV_ttGroup_[(me_)->prio]] != 0U) {                 \
+            QPSet_insert(&QV_readySet_, (uint_fast8_t)(me_)->prio);     \
+        } else {                                                        \
+            QPSet_insert(&QV_ttPend_, (uint_fast8_t)(me_)->prio);       \
+        }                                                               \
+    } while (false)
+
+#elif (!defined QV_EDF)
+
 #define QACTIVE_EQUEUE_SIGNAL_(me_) \
     QPSet_insert(&QV_readySet_, (uint_fast8_t)(me_)->prio)
 
+/* 一次性将一组 AO 标记为就绪 (用于 QF_publish_() 的多播快速路径) */
+#define QACTIVE_EQUEUE_SIGNAL_SET_(set_) \
+    QPSet_insertSet(&QV_readySet_, (set_))
+
+#else /* QV_EDF */
+
+/* EDF: 就绪的 AO 还要按截止期限插入堆中 (没有集合信号) */
+#define QACTIVE_EQUEUE_SIGNAL_(me_)                                 \
+    do {                                                            \
+        QPSet_insert(&QV_readySet_, (uint_fast8_t)(me_)->prio);     \
+        QV_edfInsert_((uint_fast8_t)(me_)->prio);                   \
+    } while (false)
+
+struct QActive; /* 前向声明 (qv.h 在 qf.h 之前被包含) */
+
+/*! 记录投递到 @p me 的事件 @p e 的绝对截止期限 (在临界区内, 入队之前调用) */
+void QV_edfPut_(struct QActive const *const me, QEvt const *const e);
+
+/*! 记录以 LIFO 策略投递的事件 @p e 的截止期限 (在临界区内, 入队之前调用) */
+void QV_edfPutLIFO_(struct QActive const *const me, QEvt const *const e);
+
+/*! 队首事件被取出后, 更新 @p me 的队首截止期限 (在临界区内, 出队之前调用) */
+void QV_edfGet_(struct QActive const *const me);
+
+/*! 把就绪的 AO 插入截止期限堆 (在临界区内调用) */
+void QV_edfInsert_(uint_fast8_t const prio);
+
+#endif /* QV_EDF */
+
 /* QF 原生事件池操作 */
 #define QF_EPOOL_TYPE_ QMPool
 #define QF_EPOOL_INIT_(p_, poolSto_, poolSize_, evtSize_) \
@@ -99,6 +543,162 @@ void QV_onIdle(void);
 
 extern QPSet QV_readySet_; /*!< QV ready-set of AOs */
 
+#ifdef QV_AGING
+extern uint32_t QV_readySince_[QF_MAX_ACTIVE + 1U]; /*!< AO 开始等待的时刻 */
+#endif
+
+#ifdef QV_TT
+extern QPSet QV_ttPend_; /*!< 就绪但不在窗口内的 AO */
+extern uint8_t QV_ttGroup_[QF_MAX_ACTIVE + 1U]; /*!< 每个 AO 所属的组 */
+extern uint8_t QV_ttOn_[QV_TT_MAX_GROUP + 1U];  /*!< 当前窗口内允许分发的组 */
+#endif
+
+#ifdef QV_BG_JOB
+extern QVJob *QV_jobHead_; /*!< 待运行后台作业链表的头 */
+extern QVJob *QV_jobTail_; /*!< 待运行后台作业链表的尾 */
+#endif
+
+#if (defined QV_RTC_BUDGET) && (QV_MAX_RTC_SIG > 0U)
+/*! 按信号设置的 RTC 预算 */
+typedef struct {
+    uint32_t budget; /*!< 预算[周期] */
+    QSignal sig;     /*!< 信号 */
+    uint8_t prio;    /*!< 活动对象优先级, 0 表示所有活动对象 */
+} QVRtcSig;
+#endif
+
+#ifdef QV_LOAD_STAT
+/*! 一个统计窗口内的周期计数 */
+typedef struct {
+    uint32_t t0;                        /*!< 当前时间段开始时的周期计数 */
+    uint32_t isr0;                      /*!< 当前时间段开始时的 QV_isrCyc_ */
+    uint32_t start;                     /*!< 窗口开始时的周期计数 */
+    uint32_t isrStart;                  /*!< 窗口开始时的 QV_isrCyc_ */
+    uint32_t total;                     /*!< 窗口长度 */
+    uint32_t idle;                      /*!< 空闲(QV_onIdle())周期 */
+    uint32_t isr;                       /*!< 中断周期 */
+    uint32_t busy[QF_MAX_ACTIVE + 1U];  /*!< 每个 AO 的 RTC 步骤周期 */
+} QVLoadWin;
+#endif
+
+#ifdef QV_EDF
+/*! 每个 AO 的 EDF 属性 */
+typedef struct {
+    uint32_t *dlSto; /*!< 环形缓冲区中各事件的绝对截止期限 (与 eQueue.ring 对应) */
+    uint32_t front;  /*!< 队首事件 (eQueue.frontEvt) 的绝对截止期限 */
+    uint32_t rel;    /*!< 默认相对截止期限, 0 表示 #QV_EDF_DL_DEFAULT */
+    uint8_t pos;     /*!< 在截止期限堆中的下标 + 1, 0 表示不在堆中 */
+} QVEdf;
+#endif
+
+#ifdef QF_CONTEXT
+/*! QV 内核在一个 QF 实例上下文中的全部状态, 见 QF_ctxNew() */
+/**
+ * @brief
+ * 各成员与非上下文模式下 qv.c 和 qv_job.c 中的同名全局对象一一对应,
+ * 下面的宏把这些名字重定向到当前线程所选上下文 (QF_ctx_) 中的成员,
+ * 因此内核代码不需要修改.
+ */
+typedef struct {
+    QPSet readySet;
+#ifdef QV_RTC_BUDGET
+    QVRtcStat rtcStat[QF_MAX_ACTIVE + 1U];
+#if (QV_MAX_RTC_SIG > 0U)
+    QVRtcSig rtcSig[QV_MAX_RTC_SIG];
+    uint_fast8_t rtcSigNum;
+#endif
+#endif
+#ifdef QV_LOAD_STAT
+    uint8_t volatile isrNest;
+    uint32_t isrStart;
+    uint32_t volatile isrCyc;
+    QVLoadWin loadCur;
+    QVLoadWin loadLast;
+    uint16_t loadHist[QF_MAX_ACTIVE + 1U][QV_LOAD_HIST_BINS];
+#endif
+#ifdef QV_SCHED_LOCK
+    uint8_t volatile actPrio;
+    uint8_t volatile lockPrio;
+    uint8_t volatile lockHolder;
+    QVLockStat lockStat;
+    QPSet deferSet;
+    uint32_t lockStart;
+#endif
+#ifdef QV_BG_JOB
+    QVJob *jobHead;
+    QVJob *jobTail;
+    QVJob *jobCurr;
+    uint32_t jobT0;
+    uint32_t jobLast;
+#endif
+#ifdef QV_EDF
+    QVEdf edf[QF_MAX_ACTIVE + 1U];
+    QVEdfStat edfStat[QF_MAX_ACTIVE + 1U];
+    uint8_t edfHeap[QF_MAX_ACTIVE];
+    uint_fast8_t edfNum;
+#endif
+#ifdef QV_AGING
+    uint32_t readySince[QF_MAX_ACTIVE + 1U];
+    QVAgingStat agingStat[QF_MAX_ACTIVE + 1U];
+    QPSet agedSet;
+#endif
+#ifdef QV_TT
+    QPSet ttPend;
+    uint8_t ttGroup[QF_MAX_ACTIVE + 1U];
+    uint8_t ttOn[QV_TT_MAX_GROUP + 1U];
+    QVTtWindow const *ttTab;
+    uint_fast8_t ttLen;
+    uint_fast8_t ttIdx;
+    uint_fast8_t ttLeft;
+    uint32_t ttStart;
+    bool ttFirst;
+    QVTtStat ttStat[QV_TT_MAX_WIN];
+#endif
+} QVContext;
+
+/* QF 实例上下文中内核部分的类型, 见 qf_pkg.h */
+#define QF_KERNEL_CTX_TYPE_ QVContext
+
+#define QV_readySet_    (QF_ctx_->kernel.readySet)
+#define QV_rtcStat_     (QF_ctx_->kernel.rtcStat)
+#define QV_rtcSig_      (QF_ctx_->kernel.rtcSig)
+#define QV_rtcSigNum_   (QF_ctx_->kernel.rtcSigNum)
+#define QV_isrNest_     (QF_ctx_->kernel.isrNest)
+#define QV_isrStart_    (QF_ctx_->kernel.isrStart)
+#define QV_isrCyc_      (QF_ctx_->kernel.isrCyc)
+#define QV_loadCur_     (QF_ctx_->kernel.loadCur)
+#define QV_loadLast_    (QF_ctx_->kernel.loadLast)
+#define QV_loadHist_    (QF_ctx_->kernel.loadHist)
+#define QV_actPrio_     (QF_ctx_->kernel.actPrio)
+#define QV_lockPrio_    (QF_ctx_->kernel.lockPrio)
+#define QV_lockHolder_  (QF_ctx_->kernel.lockHolder)
+#define QV_lockStat_    (QF_ctx_->kernel.lockStat)
+#define QV_deferSet_    (QF_ctx_->kernel.deferSet)
+#define QV_lockStart_   (QF_ctx_->kernel.lockStart)
+#define QV_jobHead_     (QF_ctx_->kernel.jobHead)
+#define QV_jobTail_     (QF_ctx_->kernel.jobTail)
+#define QV_jobCurr_     (QF_ctx_->kernel.jobCurr)
+#define QV_jobT0_       (QF_ctx_->kernel.jobT0)
+#define QV_jobLast_     (QF_ctx_->kernel.jobLast)
+#define QV_edf_         (QF_ctx_->kernel.edf)
+#define QV_edfStat_     (QF_ctx_->kernel.edfStat)
+#define QV_edfHeap_     (QF_ctx_->kernel.edfHeap)
+#define QV_edfNum_      (QF_ctx_->kernel.edfNum)
+#define QV_readySince_  (QF_ctx_->kernel.readySince)
+#define QV_agingStat_   (QF_ctx_->kernel.agingStat)
+#define QV_agedSet_     (QF_ctx_->kernel.agedSet)
+#define QV_ttPend_      (QF_ctx_->kernel.ttPend)
+#define QV_ttGroup_     (QF_ctx_->kernel.ttGroup)
+#define QV_ttOn_        (QF_ctx_->kernel.ttOn)
+#define QV_ttTab_       (QF_ctx_->kernel.ttTab)
+#define QV_ttLen_       (QF_ctx_->kernel.ttLen)
+#define QV_ttIdx_       (QF_ctx_->kernel.ttIdx)
+#define QV_ttLeft_      (QF_ctx_->kernel.ttLeft)
+#define QV_ttStart_     (QF_ctx_->kernel.ttStart)
+#define QV_ttFirst_     (QF_ctx_->kernel.ttFirst)
+#define QV_ttStat_      (QF_ctx_->kernel.ttStat)
+#endif /* QF_CONTEXT */
+
 #endif /* QP_IMPL */
 
 #endif /* QV_H */
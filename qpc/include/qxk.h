@@ -0,0 +1,235 @@
+/**
+ * @file
+ * @brief QXK/C (preemptive dual-mode kernel) platform-independent
+ * public interface.
+ * @ingroup qxk
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#ifndef QXK_H
+#define QXK_H
+
+#include "qequeue.h" /* QXK kernel uses the native QP event queue  */
+#include "qmpool.h"  /* QXK kernel uses the native QP memory pool  */
+#include "qpset.h"   /* QXK kernel uses the native QP priority set */
+
+/* QXK event-queue used for AOs and extended threads */
+#define QF_EQUEUE_TYPE QEQueue
+
+/* QXK OS-object used to store the private stack pointer of extended
+ * threads (NULL for AOs, which share the common stack).
+ */
+#define QF_OS_OBJECT_TYPE void *
+
+/* QXK thread type used for AOs and extended threads
+ * QXK uses this member to store the private Thread-Local Storage pointer.
+ */
+#define QF_THREAD_TYPE void *
+
+/****************************************************************************/
+struct QActive; /* 前向声明 (qxk.h 在 qf.h 之前被包含) */
+
+/*! QXK 内核的私有属性 */
+/**
+ * @brief
+ * QXK 中有两种线程:
+ * - 基本线程 (AO): 与 QK 相同的 RTC 语义, 共用一个栈 ("基本上下文",
+ *   即 main() 的栈, 空闲循环也在其中运行);
+ * - 扩展线程 (::QXThread): 拥有私有栈, 可以阻塞.
+ *
+ * 基本上下文在 QXK 中由 @c idleThread 对象表示, 其 osObject 保存被切换出去
+ * 时的栈指针. 移植层只需按 @c curr / @c next 保存和恢复栈指针,
+ * 见 QXK_contextSw_().
+ *
+ * @note 移植层的汇编代码依赖前三个成员的偏移, 修改时必须同步修改移植层.
+ */
+typedef struct {
+    struct QActive *volatile curr; /*!< 当前运行的上下文 (扩展线程或基本上下文) */
+    struct QActive *volatile next; /*!< 待切换到的上下文 (NULL 表示不切换) */
+    struct QActive *idleThread;    /*!< 表示基本上下文的对象 */
+    uint8_t volatile actPrio;      /*!< 基本上下文中正在运行的 AO 的优先级 */
+    uint8_t volatile nextPrio;     /*!< 下一个要激活的 AO 的优先级 */
+    uint8_t volatile lockPrio;     /*!< 调度器锁的天花板优先级 (0 表示未加锁) */
+    uint8_t volatile lockHolder;   /*!< 持有调度器锁的线程的优先级 */
+    uint8_t volatile intNest;      /*!< 中断嵌套深度 */
+    QPSet readySet;                /*!< 就绪集合 (AO 和扩展线程) */
+} QXK_PrivAttr;
+
+/*! QXK 内核的全局属性 */
+extern QXK_PrivAttr QXK_attr_;
+
+/*! QXK 调度器: 决定下一个运行的线程 */
+/**
+ * @brief
+ * 该函数必须在临界区内调用. 如果需要切换到另一个上下文 (扩展线程或基本
+ * 上下文), 它设置 QXK_attr_.next 并通过移植层的 QXK_CONTEXT_SWITCH_()
+ * 请求切换, 然后返回 0. 如果需要在当前的基本上下文中激活优先级更高的 AO,
+ * 返回该 AO 的优先级 (同时记录在 QXK_attr_.nextPrio 中).
+ */
+uint_fast8_t QXK_sched_(void);
+
+/*! QXK 激活器: 在基本上下文中依次运行优先级高于被抢占 AO 的所有就绪 AO */
+/**
+ * @brief
+ * 该函数必须在临界区内调用, 返回时也处于临界区内.
+ */
+void QXK_activate_(void);
+
+/*! QXK 上下文切换辅助函数 (由移植层在临界区内调用) */
+/**
+ * @brief
+ * 保存当前上下文的栈指针 @p sp, 切换到 QXK_attr_.next, 返回要恢复的栈指针.
+ * 返回前会重新调度, 如果切换到的是基本上下文并且需要激活 AO,
+ * QXK_attr_.nextPrio 非零, 移植层此时应在线程模式下调用 QXK_activate_().
+ */
+void *QXK_contextSw_(void *sp);
+
+/*! 初始化扩展线程的私有栈 (由移植层实现) */
+/**
+ * @brief
+ * 在 @p stkSto 中构造一个看起来像"刚被切换出去"的上下文, 恢复后从
+ * @p handler(@p thr) 开始执行, @p handler 返回时进入 QXK_threadExit_().
+ * 移植层必须把得到的栈指针保存在 @p thr 的 osObject 中.
+ */
+void QXK_stackInit_(void *thr, QXThreadHandler handler,
+                    void *stkSto, uint_fast16_t stkSize);
+
+/*! 扩展线程的处理函数返回后执行: 停止该线程, 不会返回 */
+void QXK_threadExit_(void);
+
+/*! QXK 空闲回调 (在 BSP 中定制) */
+/**
+ * @brief
+ * QXK_onIdle() 在 QXK 的空闲循环中反复调用 (中断是 \b 使能的),
+ * 可以在任何时候被 AO 或扩展线程抢占.
+ */
+void QXK_onIdle(void);
+
+/*! 返回当前正在运行的 AO 或扩展线程 (空闲时返回 NULL) */
+struct QActive *QXK_current(void);
+
+/****************************************************************************/
+/*! 调度器锁的状态 (由 QXK_schedLock() 返回, 传给 QXK_schedUnlock()) */
+typedef uint_fast16_t QSchedStatus;
+
+/*! QXK 选择性调度器锁: 禁止优先级不高于 @p ceiling 的线程抢占 */
+QSchedStatus QXK_schedLock(uint_fast8_t const ceiling);
+
+/*! QXK 选择性调度器解锁 */
+void QXK_schedUnlock(QSchedStatus const stat);
+
+#ifdef QXK_ON_CONTEXT_SW
+/*! QXK 上下文切换回调 (在 BSP 中定制) */
+/**
+ * @brief
+ * 定义宏 QXK_ON_CONTEXT_SW 时, QXK 在每次切换到另一个 AO, 扩展线程
+ * (或空闲循环) 时调用该回调.
+ *
+ * @param[in] prev 被切换出的线程 (NULL 表示空闲循环)
+ * @param[in] next 切换到的线程 (NULL 表示空闲循环)
+ *
+ * @note 该回调在临界区内调用, 必须非常简短.
+ */
+void QXK_onContextSw(struct QActive *prev, struct QActive *next);
+#endif /* QXK_ON_CONTEXT_SW */
+
+/****************************************************************************/
+/* 仅供 QP 内部实现使用的接口, 应用层代码不会用到 */
+#ifdef QP_IMPL
+
+#ifndef QXK_ISR_CONTEXT_
+/*! 判断代码是否在 ISR 上下文中执行 (移植层可以重新定义) */
+#define QXK_ISR_CONTEXT_() (QXK_attr_.intNest != 0U)
+#endif /* QXK_ISR_CONTEXT_ */
+
+/* QXK 内核特有的调度器加锁机制 (用于 QF_publish_() 的优先级天花板) */
+#define QF_SCHED_STAT_ QSchedStatus lockStat_;
+#define QF_SCHED_LOCK_(prio_)                       \
+    do {                                            \
+        if (QXK_ISR_CONTEXT_()) {                   \
+            lockStat_ = 0xFFU;                      \
+        } else {                                    \
+            lockStat_ = QXK_schedLock((prio_));     \
+        }                                           \
+    } while (false)
+
+#define QF_SCHED_UNLOCK_()                          \
+    do {                                            \
+        if (lockStat_ != 0xFFU) {                   \
+            QXK_schedUnlock(lockStat_);             \
+        }                                           \
+    } while (false)
+
+/* QF 原生事件队列操作 (仅用于 AO, 扩展线程有自己的 post 操作) */
+#define QACTIVE_EQUEUE_WAIT_(me_) \
+    (Q_ASSERT_ID(110, (me_)->eQueue.frontEvt != (QEvt *)0))
+
+#define QACTIVE_EQUEUE_SIGNAL_(me_)                                     \
+    do {                                                                \
+        QPSet_insert(&QXK_attr_.readySet, (uint_fast8_t)(me_)->dynPrio); \
+        if (!QXK_ISR_CONTEXT_()) {                                      \
+            if (QXK_sched_() != 0U) {                                   \
+                QXK_activate_();                                        \
+            }                                                           \
+        }                                                               \
+    } while (false)
+
+/* 一次性将一组 AO 标记为就绪 (用于 QF_publish_() 的多播快速路径) */
+#define QACTIVE_EQUEUE_SIGNAL_SET_(set_)                 \
+    do {                                                 \
+        QPSet_insertSet(&QXK_attr_.readySet, (set_));    \
+        if (!QXK_ISR_CONTEXT_()) {                       \
+            if (QXK_sched_() != 0U) {                    \
+                QXK_activate_();                         \
+            }                                            \
+        }                                                \
+    } while (false)
+
+/* QF 原生事件池操作 */
+#define QF_EPOOL_TYPE_ QMPool
+#define QF_EPOOL_INIT_(p_, poolSto_, poolSize_, evtSize_) \
+    (QMPool_init(&(p_), (poolSto_), (poolSize_), (evtSize_)))
+#define QF_EPOOL_EVENT_SIZE_(p_) ((uint_fast16_t)(p_).blockSize)
+#define QF_EPOOL_GET_(p_, e_, m_, qs_id_) \
+    ((e_) = (QEvt *)QMPool_get(&(p_), (m_), (qs_id_)))
+#define QF_EPOOL_PUT_(p_, e_, qs_id_) \
+    (QMPool_put(&(p_), (e_), (qs_id_)))
+
+/*! 扩展线程的超时处理 (由 QF_tickX_() 在临界区内调用) */
+void QXThread_timeout_(struct QActive *const act);
+
+#endif /* QP_IMPL */
+
+#endif /* QXK_H */
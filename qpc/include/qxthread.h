@@ -0,0 +1,178 @@
+/**
+ * @file
+ * @brief QXK/C extended (blocking) threads, semaphores and mutexes.
+ * @ingroup qxk
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#ifndef QXTHREAD_H
+#define QXTHREAD_H
+
+/****************************************************************************/
+/*! 扩展 (阻塞) 线程 */
+/**
+ * @brief
+ * ::QXThread 是 QXK 内核中可以阻塞的线程, 拥有私有栈. 它适合天然按顺序
+ * 执行的代码 (例如 SPI Flash 或 I2C 传感器驱动), 可以与 AO 共存:
+ * 扩展线程可以阻塞在延时 (QXThread_delay()), 自身的事件队列
+ * (QXThread_queueGet()), 信号量 (::QXSemaphore) 和互斥量 (::QXMutex) 上,
+ * 并且都可以指定以时钟滴答为单位的超时.
+ *
+ * 扩展线程与 AO 使用同一个优先级空间 (1..#QF_MAX_ACTIVE), 每个优先级只能
+ * 被一个 AO 或扩展线程使用. AO 可以向扩展线程投递事件, 也可以让扩展线程
+ * 订阅发布的事件.
+ *
+ * @note 扩展线程继承自 ::QActive, 但不是状态机, 不能调用 QHSM_DISPATCH().
+ *
+ * @usage
+ * @code
+ * static QXThread l_flash;
+ * static uint64_t l_flashStk[64];
+ *
+ * static void Flash_run(QXThread * const me) {
+ *     for (;;) {
+ *         QEvt const *e = QXThread_queueGet(QXTHREAD_NO_TIMEOUT);
+ *         ... // 顺序地执行 SPI 传输, 用 QXSemaphore_wait() 等待 DMA 完成
+ *         QF_gc(e);
+ *     }
+ * }
+ * ...
+ * QXThread_ctor(&l_flash, &Flash_run, 0U);
+ * QXTHREAD_START(&l_flash, 3U, l_flashQSto, Q_DIM(l_flashQSto),
+ *                l_flashStk, sizeof(l_flashStk), (void *)0);
+ * @endcode
+ */
+struct QXThread {
+    QActive super;    /*!< inherits ::QActive */
+    QTimeEvt timeEvt; /*!< 用于阻塞超时的私有时间事件 */
+};
+
+/*! ::QXThread 类的虚表 */
+typedef struct {
+    QActiveVtable super; /*!< inherits ::QActiveVtable */
+} QXThreadVtable;
+
+/*! 扩展线程的构造函数 */
+void QXThread_ctor(QXThread *const me, QXThreadHandler handler,
+                   uint_fast8_t tickRate);
+
+/*! 启动扩展线程 (多态调用 QXThread 的 start 操作) */
+/**
+ * @brief
+ * 与 QACTIVE_START() 相同, 但 @p stkSto_ 和 @p stkSize_ 必须提供线程的
+ * 私有栈; 如果线程不使用事件队列, @p qSto_ 可以为 NULL, @p qLen_ 为 0.
+ */
+#define QXTHREAD_START(me_, prio_, qSto_, qLen_, stkSto_, stkSize_, par_) \
+    QACTIVE_START(&(me_)->super, (prio_), (qSto_), (qLen_),                \
+                  (stkSto_), (stkSize_), (par_))
+
+/*! 向扩展线程投递事件 (可以指定 margin) */
+#define QXTHREAD_POST_X(me_, e_, margin_, sender_) \
+    QACTIVE_POST_X(&(me_)->super, (e_), (margin_), (sender_))
+
+/*! 不带超时的阻塞 */
+#define QXTHREAD_NO_TIMEOUT ((uint_fast16_t)0)
+
+/*! 阻塞当前扩展线程 @p nTicks 个时钟滴答 */
+bool QXThread_delay(uint_fast16_t const nTicks);
+
+/*! 取消扩展线程 @p me 的延时 */
+bool QXThread_delayCancel(QXThread *const me);
+
+/*! 从当前扩展线程的事件队列中取出事件, 队列为空时阻塞 */
+QEvt const *QXThread_queueGet(uint_fast16_t const nTicks);
+
+/****************************************************************************/
+/*! 计数信号量 */
+/**
+ * @brief
+ * 扩展线程可以阻塞在信号量上 (QXSemaphore_wait()), 而 AO, ISR 和扩展线程
+ * 都可以发出信号 (QXSemaphore_signal()). 多个线程等待同一个信号量时,
+ * 优先级最高的线程先被唤醒.
+ */
+typedef struct {
+    QPSet waitSet;          /*!< 等待该信号量的线程集合 (必须是第一个成员) */
+    uint8_t volatile count; /*!< 信号量计数 */
+    uint8_t maxCount;       /*!< 信号量计数的最大值 */
+} QXSemaphore;
+
+/*! 初始化信号量 */
+void QXSemaphore_init(QXSemaphore *const me, uint_fast8_t const count,
+                      uint_fast8_t const maxCount);
+
+/*! 等待信号量, 最多阻塞 @p nTicks 个时钟滴答 */
+bool QXSemaphore_wait(QXSemaphore *const me, uint_fast16_t const nTicks);
+
+/*! 不阻塞地尝试获取信号量 */
+bool QXSemaphore_tryWait(QXSemaphore *const me);
+
+/*! 发出信号量 */
+bool QXSemaphore_signal(QXSemaphore *const me);
+
+/****************************************************************************/
+/*! 优先级天花板互斥量 */
+/**
+ * @brief
+ * ::QXMutex 保护扩展线程之间共享的资源. 持有互斥量的线程被提升到天花板
+ * 优先级, 因此不会发生无界的优先级反转: 共享该资源的其他线程在天花板之下,
+ * 不能抢占持有者, 而天花板之上的线程和 AO 不受影响.
+ *
+ * 天花板优先级在 QF 中被保留 (不能再分配给 AO 或扩展线程), 并且必须高于
+ * 所有使用该互斥量的线程. 天花板为 0 表示不提升优先级的普通互斥量.
+ * 互斥量可以被持有者嵌套加锁.
+ *
+ * @note 互斥量只能在扩展线程中使用. AO 应使用 QXK_schedLock().
+ * 一个线程同一时刻只能持有一个带天花板的互斥量.
+ */
+typedef struct {
+    QPSet waitSet;                 /*!< 等待该互斥量的线程集合 (必须是第一个成员) */
+    QActive *volatile holder;      /*!< 持有者 (NULL 表示空闲) */
+    uint8_t ceiling;               /*!< 天花板优先级 (0 表示不提升) */
+    uint8_t volatile lockNest;     /*!< 持有者的嵌套加锁次数 */
+} QXMutex;
+
+/*! 初始化互斥量 */
+void QXMutex_init(QXMutex *const me, uint_fast8_t const ceiling);
+
+/*! 加锁互斥量, 最多阻塞 @p nTicks 个时钟滴答 */
+bool QXMutex_lock(QXMutex *const me, uint_fast16_t const nTicks);
+
+/*! 不阻塞地尝试加锁互斥量 */
+bool QXMutex_tryLock(QXMutex *const me);
+
+/*! 解锁互斥量 */
+void QXMutex_unlock(QXMutex *const me);
+
+#endif /* QXTHREAD_H */
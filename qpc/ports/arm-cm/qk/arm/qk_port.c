@@ -0,0 +1,243 @@
+/**
+ * @file
+ * @brief QK/C port to ARM Cortex-M, ARM-KEIL toolset
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.8.0
+ * Last updated on  2020-01-25
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2020 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses/>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+/* This QK port is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+
+#if (__TARGET_ARCH_THUMB == 3) /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+
+/* Cortex-M0/M0+/M1(v6-M, v6S-M) 的汇编手工优化快速 LOG2 函数 */
+// clang-format off
+__asm uint_fast8_t QF_qlog2(uint32_t x) {
+    MOVS    r1,#0
+
+#if (QF_MAX_ACTIVE > 16)
+    LSRS    r2,r0,#16
+    BEQ.N   QF_qlog2_1
+    MOVS    r1,#16
+    MOVS    r0,r2
+QF_qlog2_1
+#endif
+#if (QF_MAX_ACTIVE > 8)
+    LSRS    r2,r0,#8
+    BEQ.N   QF_qlog2_2
+    ADDS    r1,r1,#8
+    MOVS    r0,r2
+QF_qlog2_2
+#endif
+    LSRS    r2,r0,#4
+    BEQ.N   QF_qlog2_3
+    ADDS    r1,r1,#4
+    MOVS    r0,r2
+QF_qlog2_3
+    LDR     r2,=QF_qlog2_LUT
+    LDRB    r0,[r2,r0]
+    ADDS    r0,r1,r0
+    BX      lr
+
+    ALIGN
+
+QF_qlog2_LUT
+    DCB     0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4
+}
+// clang-format on
+
+#endif /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+
+/* 函数原型 -----------------------------------------------------------------*/
+void PendSV_Handler(void);
+void NMI_Handler(void);
+
+#define SCnSCB_ICTR ((uint32_t volatile *)0xE000E004)
+#define SCB_SYSPRI  ((uint32_t volatile *)0xE000ED14)
+#define NVIC_IP     ((uint32_t volatile *)0xE000E400)
+
+/*
+ * 初始化异常优先级和 IRQ 优先级为安全值.
+ *
+ * 说明:
+ * 对于 Cortex-M3/M4/M7, 这个 QK 移植使用 BASEPRI 寄存器来禁止中断.
+ * 但是 BASEPRI 不能屏蔽优先级为 0 的中断, 而默认所有中断复位后优先级为 0.
+ * 以下代码将 SysTick 和所有 IRQ 优先级设置为 QF_BASEPRI,
+ * 这样 QF 的临界区(critical section)可以有效屏蔽它们.
+ *
+ * 对所有 Cortex-M 内核, 用于异步抢占的 PendSV 异常被设置为最低优先级(0xFF),
+ * 使其只在所有嵌套中断返回之后(尾链)才执行.
+ *
+ * 应用程序可以在之后修改 QK_init() 设置的中断优先级, 但 PendSV 除外.
+ */
+void QK_init(void)
+{
+#if (__TARGET_ARCH_THUMB != 3) /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    uint32_t n;
+
+    /* 将异常优先级设置为 QF_BASEPRI...
+     * SCB_SYSPRI1: 使用故障、总线故障、内存管理故障
+     */
+    SCB_SYSPRI[1] |= (QF_BASEPRI << 16) | (QF_BASEPRI << 8) | QF_BASEPRI;
+
+    /* SCB_SYSPRI2: SVCall */
+    SCB_SYSPRI[2] |= (QF_BASEPRI << 24);
+
+    /* SCB_SYSPRI3:  SysTick, PendSV, Debug */
+    SCB_SYSPRI[3] |= (QF_BASEPRI << 24) | (QF_BASEPRI << 16) | QF_BASEPRI;
+
+    // 从 SCnSCB_ICTR 寄存器读取已实现的 IRQ 数量
+    n = 8U + ((*SCnSCB_ICTR & 0x7U) << 3); /* (# NVIC_PRIO registers)/4 */
+    /* set all implemented IRQ priories to QF_BASEPRI... */
+    do {
+        --n;
+        NVIC_IP[n] = (QF_BASEPRI << 24) | (QF_BASEPRI << 16) | (QF_BASEPRI << 8) | QF_BASEPRI;
+    } while (n != 0);
+#endif /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M) */
+
+    /* PendSV 设为最低优先级 0xFF */
+    SCB_SYSPRI[3] |= (0xFFU << 16);
+}
+
+/*****************************************************************************
+ * PendSV_Handler 用于处理 QK 的异步抢占.
+ *
+ * PendSV 必须是整个系统中优先级最低的异常(0xFF, 见 QK_init()), 这样它由尾链
+ * 机制在*最后一个*嵌套中断返回后立即进入, 这正是 QK 激活器需要处理异步抢占
+ * 的时刻. 所有“QF aware”的 ISR 必须在退出时调用 QK_ISR_EXIT(), 该宏在发现
+ * 需要抢占时挂起 PendSV.
+ *
+ * QK 激活器必须运行在线程模式. PendSV 通过构造一个返回地址为 QK_activate_()
+ * 的异常栈帧并执行异常返回来切换到线程模式. QK_activate_() 在关中断状态下被
+ * 调用, 也在关中断状态下返回到 QK_thread_ret().
+ */
+// clang-format off
+__asm void PendSV_Handler(void) {
+    IMPORT  QK_activate_          /* 外部引用 */
+
+    /* 进入临界区之前准备寄存器常量 */
+    LDR     r3,=0xE000ED04        /* 中断控制与状态寄存器 ICSR */
+    MOVS    r1,#1
+    LSLS    r1,r1,#27             /* r1 := (1 << 27) (UNPENDSVSET 位) */
+
+    /*<<<<<<<<<<<<<<<<<<<<<<< 临界区开始 <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+  IF {TARGET_ARCH_THUMB} == 3     /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    CPSID   i                     /* 关中断(置 PRIMASK) */
+  ELSE                            /* M3/M4/M7 */
+  IF {TARGET_FPU_VFP} = {TRUE}    /* 有 VFP? */
+    PUSH    {r0,lr}               /* 压入 lr 及栈对齐字 */
+  ENDIF                           /* VFP available */
+    MOVS    r0,#QF_BASEPRI
+    CPSID   i                     /* 用 BASEPRI 选择性关中断 */
+    MSR     BASEPRI,r0            /* 规避 Cortex-M7 勘误 837070 */
+    CPSIE   i                     /* (见 SDEN-1068427) */
+  ENDIF                           /* M3/M4/M7 */
+
+    /* PendSV 可能被中断抢占并被再次挂起, 这里清除这种多余的挂起 */
+    STR     r1,[r3]               /* ICSR[27] := 1 (清除 PendSV 挂起) */
+
+    /* 构造异常栈帧, 异常返回到 QK_activate_() */
+    LSRS    r3,r1,#3              /* r3 := (r1 >> 3), T 位 (新 xpsr) */
+    LDR     r2,=QK_activate_      /* QK_activate_ 的地址 */
+    SUBS    r2,r2,#1              /* Thumb 地址按半字对齐 (新 pc) */
+    LDR     r1,=QK_thread_ret     /* QK_activate_ 的返回地址 (新 lr) */
+
+    SUB     sp,sp,#8*4            /* 为异常栈帧预留空间 */
+    ADD     r0,sp,#5*4            /* r0 := 栈顶下方 5 个寄存器处 */
+    STM     r0!,{r1-r3}           /* 保存 xpsr, pc, lr */
+
+    MOVS    r0,#6
+    MVNS    r0,r0                 /* r0 := ~6 == 0xFFFFFFF9 */
+  IF {TARGET_ARCH_THUMB} != 3     /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    DSB                           /* ARM 勘误 838869 */
+  ENDIF
+    BX      r0                    /* 异常返回到 QK 激活器 */
+
+    ALIGN                         /* 确保文字池对齐 */
+}
+// clang-format on
+
+/*****************************************************************************
+ * QK_thread_ret 在 QK 激活器返回后执行(线程模式, 关中断).
+ *
+ * 返回到被抢占的任务必须通过异常返回完成, 因此这里挂起 NMI, 由 NMI_Handler
+ * 丢弃伪造的异常栈帧.
+ */
+// clang-format off
+__asm void QK_thread_ret(void) {
+
+  IF {TARGET_FPU_VFP} = {TRUE}    /* 有 VFP? */
+    /* 确保随后的 NMI 不使用 VFP 栈帧 */
+    MRS     r0,CONTROL            /* r0 := CONTROL */
+    BICS    r0,r0,#4              /* r0 := r0 & ~4 (FPCA 位) */
+    MSR     CONTROL,r0            /* CONTROL := r0 (清除 CONTROL[2] FPCA) */
+    ISB                           /* MSR CONTROL 之后需要 ISB */
+  ENDIF                           /* VFP available */
+
+    /* 触发 NMI 返回被抢占的任务 (NMI 在关中断状态下触发) */
+    LDR     r0,=0xE000ED04        /* 中断控制与状态寄存器 ICSR */
+    MOVS    r1,#1
+    LSLS    r1,r1,#31             /* r1 := (1 << 31) (NMI 位) */
+    STR     r1,[r0]               /* ICSR[31] := 1 (挂起 NMI) */
+    B       .                     /* 等待 NMI 抢占 */
+
+    ALIGN                         /* 确保文字池对齐 */
+}
+// clang-format on
+
+/*****************************************************************************
+ * NMI_Handler 用于返回到被抢占的任务: 它丢弃 PendSV 伪造的异常栈帧,
+ * 然后利用栈顶处原始的中断栈帧异常返回. NMI 在关中断状态下进入, 因此返回前
+ * 需要重新开中断. 因此 NMI 异常不能再被应用程序使用.
+ */
+// clang-format off
+__asm void NMI_Handler(void) {
+
+    ADD     sp,sp,#(8*4)          /* 移除一个 8 寄存器的异常栈帧 */
+
+  IF {TARGET_ARCH_THUMB} == 3     /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    CPSIE   i                     /* 开中断 (清除 PRIMASK) */
+    BX      lr                    /* 返回被抢占的任务 */
+  ELSE                            /* M3/M4/M7 */
+    MOVS    r0,#0
+    MSR     BASEPRI,r0            /* 开中断 (清除 BASEPRI) */
+  IF {TARGET_FPU_VFP} = {TRUE}    /* 有 VFP? */
+    POP     {r0,pc}               /* 弹出栈对齐字, EXC_RETURN 装入 pc */
+  ELSE                            /* no VFP */
+    BX      lr                    /* 返回被抢占的任务 */
+  ENDIF                           /* VFP available */
+  ENDIF                           /* M3/M4/M7 */
+}
+// clang-format on
@@ -83,6 +83,8 @@ QF_qlog2_LUT
 #define SCnSCB_ICTR ((uint32_t volatile *)0xE000E004)
 #define SCB_SYSPRI  ((uint32_t volatile *)0xE000ED14)
 #define NVIC_IP     ((uint32_t volatile *)0xE000E400)
+#define DEMCR       ((uint32_t volatile *)0xE000EDFC)
+#define DWT_CTRL    ((uint32_t volatile *)0xE0001000)
 
 /*
  * 初始化异常优先级和 IRQ 优先级为安全值.
@@ -118,6 +120,12 @@ void QV_init(void)
         --n;
         NVIC_IP[n] = (QF_BASEPRI << 24) | (QF_BASEPRI << 16) | (QF_BASEPRI << 8) | QF_BASEPRI;
     } while (n != 0);
+
+#ifdef QV_CYCCNT_USED
+    /* 使能 DWT 周期计数器 CYCCNT (DEMCR.TRCENA, DWT_CTRL.CYCCNTENA) */
+    *DEMCR |= (1U << 24);
+    *DWT_CTRL |= 1U;
+#endif
 }
 
 #endif /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M)? */
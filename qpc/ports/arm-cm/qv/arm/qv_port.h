@@ -65,6 +65,11 @@
 #define QV_INIT()               QV_init()
 void QV_init(void);
 
+/* 宏: 读取 DWT 周期计数器 CYCCNT, 供 QV 的可选功能测量时间
+ * (有可选功能使用它时, 即定义了 #QV_CYCCNT_USED 时, 由 QV_init() 使能)
+ */
+#define QV_CYCCNT_GET()         (*(uint32_t volatile *)0xE0001004U)
+
 /* 宏: 处理 ARM Erratum 838869 的推荐方法
  * 说明: 对于 Cortex-M3/M4/M7, 需要在 ISR 结束前执行 DSB（数据同步屏障）指令,
  * 以确保所有内存操作都已完成.
@@ -88,6 +88,8 @@ __asm volatile (
 #define SCnSCB_ICTR  ((uint32_t volatile *)0xE000E004)
 #define SCB_SYSPRI   ((uint32_t volatile *)0xE000ED14)
 #define NVIC_IP      ((uint32_t volatile *)0xE000E400)
+#define DEMCR        ((uint32_t volatile *)0xE000EDFC)
+#define DWT_CTRL     ((uint32_t volatile *)0xE0001000)
 
 /*
 * Initialize the exception priorities and IRQ priorities to safe values.
@@ -126,6 +128,12 @@ void QV_init(void) {
         NVIC_IP[n] = (QF_BASEPRI << 24) | (QF_BASEPRI << 16)
                      | (QF_BASEPRI << 8) | QF_BASEPRI;
     } while (n != 0);
+
+#ifdef QV_CYCCNT_USED
+    /* enable the DWT cycle counter (DEMCR.TRCENA, DWT_CTRL.CYCCNTENA) */
+    *DEMCR |= (1U << 24);
+    *DWT_CTRL |= 1U;
+#endif
 }
 
 #endif /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M)? */
@@ -63,6 +63,11 @@
     #define QV_INIT() QV_init()
     void QV_init(void);
 
+    /* DWT CYCCNT cycle counter used by the optional QV features
+    * (enabled in QV_init() when QV_CYCCNT_USED is defined)
+    */
+    #define QV_CYCCNT_GET() (*(uint32_t volatile *)0xE0001004U)
+
     /* The following macro implements the recommended workaround for the
     * ARM Erratum 838869. Specifically, for Cortex-M3/M4/M7 the DSB
     * (memory barrier) instruction needs to be added before exiting an ISR.
@@ -0,0 +1,389 @@
+/**
+ * @file
+ * @brief QXK/C port to ARM Cortex-M, ARM-KEIL toolset
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.8.0
+ * Last updated on  2020-01-25
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2020 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses/>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+/* This QXK port is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+#include "qassert.h"
+
+#include <stddef.h> /* offsetof() */
+
+#if (__TARGET_ARCH_THUMB == 3) /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+
+/* Cortex-M0/M0+/M1(v6-M, v6S-M) 的汇编手工优化快速 LOG2 函数 */
+// clang-format off
+__asm uint_fast8_t QF_qlog2(uint32_t x) {
+    MOVS    r1,#0
+
+#if (QF_MAX_ACTIVE > 16)
+    LSRS    r2,r0,#16
+    BEQ.N   QF_qlog2_1
+    MOVS    r1,#16
+    MOVS    r0,r2
+QF_qlog2_1
+#endif
+#if (QF_MAX_ACTIVE > 8)
+    LSRS    r2,r0,#8
+    BEQ.N   QF_qlog2_2
+    ADDS    r1,r1,#8
+    MOVS    r0,r2
+QF_qlog2_2
+#endif
+    LSRS    r2,r0,#4
+    BEQ.N   QF_qlog2_3
+    ADDS    r1,r1,#4
+    MOVS    r0,r2
+QF_qlog2_3
+    LDR     r2,=QF_qlog2_LUT
+    LDRB    r0,[r2,r0]
+    ADDS    r0,r1,r0
+    BX      lr
+
+    ALIGN
+
+QF_qlog2_LUT
+    DCB     0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4
+}
+// clang-format on
+
+#endif /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+
+/* 函数原型 -----------------------------------------------------------------*/
+void PendSV_Handler(void);
+void NMI_Handler(void);
+
+#define SCnSCB_ICTR ((uint32_t volatile *)0xE000E004)
+
+/* 函数原型 -----------------------------------------------------------------*/
+void PendSV_Handler(void);
+void NMI_Handler(void);
+
+#define SCnSCB_ICTR ((uint32_t volatile *)0xE000E004)
+#define SCB_SYSPRI  ((uint32_t volatile *)0xE000ED14)
+#define NVIC_IP     ((uint32_t volatile *)0xE000E400)
+
+/* PendSV_Handler 中直接访问的 QXK_attr_.nextPrio 的偏移, 见 NOTE1 */
+#define QXK_NEXT_PRIO_OFFS 13
+
+Q_ASSERT_STATIC(offsetof(QXK_PrivAttr, nextPrio) == QXK_NEXT_PRIO_OFFS);
+
+/*
+ * 初始化异常优先级和 IRQ 优先级为安全值.
+ *
+ * 说明:
+ * 对于 Cortex-M3/M4/M7, 这个 QXK 移植使用 BASEPRI 寄存器来禁止中断.
+ * 但是 BASEPRI 不能屏蔽优先级为 0 的中断, 而默认所有中断复位后优先级为 0.
+ * 以下代码将 SysTick 和所有 IRQ 优先级设置为 QF_BASEPRI,
+ * 这样 QF 的临界区(critical section)可以有效屏蔽它们.
+ *
+ * 对所有 Cortex-M 内核, 用于上下文切换和异步抢占的 PendSV 异常被设置为
+ * 最低优先级(0xFF), 使其只在所有嵌套中断返回之后(尾链)才执行.
+ *
+ * 应用程序可以在之后修改 QXK_init() 设置的中断优先级, 但 PendSV 除外.
+ */
+void QXK_init(void)
+{
+#if (__TARGET_ARCH_THUMB != 3) /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    uint32_t n;
+
+    /* 将异常优先级设置为 QF_BASEPRI...
+     * SCB_SYSPRI1: 使用故障、总线故障、内存管理故障
+     */
+    SCB_SYSPRI[1] |= (QF_BASEPRI << 16) | (QF_BASEPRI << 8) | QF_BASEPRI;
+
+    /* SCB_SYSPRI2: SVCall */
+    SCB_SYSPRI[2] |= (QF_BASEPRI << 24);
+
+    /* SCB_SYSPRI3:  SysTick, PendSV, Debug */
+    SCB_SYSPRI[3] |= (QF_BASEPRI << 24) | (QF_BASEPRI << 16) | QF_BASEPRI;
+
+    // 从 SCnSCB_ICTR 寄存器读取已实现的 IRQ 数量
+    n = 8U + ((*SCnSCB_ICTR & 0x7U) << 3); /* (# NVIC_PRIO registers)/4 */
+    /* set all implemented IRQ priories to QF_BASEPRI... */
+    do {
+        --n;
+        NVIC_IP[n] = (QF_BASEPRI << 24) | (QF_BASEPRI << 16) | (QF_BASEPRI << 8) | QF_BASEPRI;
+    } while (n != 0);
+#endif /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M) */
+
+    /* PendSV 设为最低优先级 0xFF */
+    SCB_SYSPRI[3] |= (0xFFU << 16);
+}
+
+/*****************************************************************************
+ * 在扩展线程的私有栈上构造初始上下文, 使线程看起来像刚被 PendSV_Handler
+ * 切换出去. 第一次恢复该上下文时, 线程从 handler(thr) 开始执行,
+ * handler 返回时进入 QXK_threadExit_().
+ *
+ * 上下文由 8 个字的异常栈帧 (xpsr, pc, lr, r12, r3-r0) 和其下方
+ * PendSV_Handler 保存的 10 个字 (EXC_RETURN, r11-r4 和一个栈对齐字) 组成.
+ *
+ * 注意: 所有线程都使用主栈指针 (MSP), 因此每个私有栈还必须为最坏情况下的
+ * 中断嵌套预留空间.
+ */
+void QXK_stackInit_(void *thr, QXThreadHandler handler,
+                    void *stkSto, uint_fast16_t stkSize)
+{
+    /* 栈顶向下对齐到 8 字节 (Cortex-M 的栈向低地址增长) */
+    uint32_t *sp = (uint32_t *)((((uint32_t)stkSto + stkSize) >> 3U) << 3U);
+    uint32_t *sp_limit;
+
+    /* 异常栈帧, 见 NOTE2 */
+    *(--sp) = (1U << 24);                  /* xPSR (仅 THUMB 位) */
+    *(--sp) = (uint32_t)handler & ~1U;     /* PC (线程处理函数) */
+    *(--sp) = (uint32_t)&QXK_threadExit_;  /* LR (处理函数返回后) */
+    *(--sp) = 0x0000000CU;                 /* R12 */
+    *(--sp) = 0x00000003U;                 /* R3 */
+    *(--sp) = 0x00000002U;                 /* R2 */
+    *(--sp) = 0x00000001U;                 /* R1 */
+    *(--sp) = (uint32_t)thr;               /* R0 (处理函数的参数) */
+
+    /* PendSV_Handler 保存的寄存器 */
+    *(--sp) = 0xFFFFFFF9U;                 /* EXC_RETURN (线程模式, MSP) */
+    *(--sp) = 0x0000000BU;                 /* R11 */
+    *(--sp) = 0x0000000AU;                 /* R10 */
+    *(--sp) = 0x00000009U;                 /* R9 */
+    *(--sp) = 0x00000008U;                 /* R8 */
+    *(--sp) = 0x00000007U;                 /* R7 */
+    *(--sp) = 0x00000006U;                 /* R6 */
+    *(--sp) = 0x00000005U;                 /* R5 */
+    *(--sp) = 0x00000004U;                 /* R4 */
+    *(--sp) = 0x00000003U;                 /* 栈对齐字 */
+
+    /* 栈指针保存在线程的 osObject 中 */
+    ((QActive *)thr)->osObject = sp;
+
+    /* 用 0xDEADBEEF 填充栈的未用部分, 便于检查栈的使用深度 */
+    sp_limit = (uint32_t *)((((uint32_t)stkSto - 1U) >> 3U) + 1U);
+    sp_limit = (uint32_t *)((uint32_t)sp_limit << 3U);
+    for (; sp >= sp_limit; --sp) {
+        *sp = 0xDEADBEEFU;
+    }
+}
+
+/*****************************************************************************
+ * PendSV_Handler 在扩展线程和"基本上下文" (AO 和空闲循环共用的主栈) 之间
+ * 切换上下文, 并以与 QK 相同的方式处理 AO 的异步抢占.
+ *
+ * PendSV 必须是整个系统中优先级最低的异常(0xFF, 见 QXK_init()). 所有
+ * "QF aware"的 ISR 必须在退出时调用 QXK_ISR_EXIT(), 该宏在发现需要切换
+ * 上下文或抢占时挂起 PendSV.
+ *
+ * PendSV_Handler 把当前上下文的其余部分 (r4-r11, EXC_RETURN, 使用过 FPU 时
+ * 还有 s16-s31) 保存在当前栈上, 把栈指针传给 QXK_contextSw_(), 后者返回要
+ * 恢复的上下文的栈指针. 如果恢复的是基本上下文并且需要激活 AO
+ * (QXK_attr_.nextPrio 非零), PendSV_Handler 与 QK 移植相同, 构造一个返回
+ * 地址为 QXK_activate_() 的异常栈帧, 通过异常返回切换到线程模式.
+ */
+// clang-format off
+__asm void PendSV_Handler(void) {
+    IMPORT  QXK_contextSw_        /* 外部引用 */
+    IMPORT  QXK_activate_
+    IMPORT  QXK_attr_
+    PRESERVE8                     /* 调用 C 函数时栈按 8 字节对齐 */
+
+    /* 进入临界区之前准备寄存器常量 */
+    LDR     r3,=0xE000ED04        /* 中断控制与状态寄存器 ICSR */
+    MOVS    r1,#1
+    LSLS    r1,r1,#27             /* r1 := (1 << 27) (UNPENDSVSET 位) */
+
+    /*<<<<<<<<<<<<<<<<<<<<<<< 临界区开始 <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+  IF {TARGET_ARCH_THUMB} == 3     /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    CPSID   i                     /* 关中断(置 PRIMASK) */
+  ELSE                            /* M3/M4/M7 */
+    MOVS    r0,#QF_BASEPRI
+    CPSID   i                     /* 用 BASEPRI 选择性关中断 */
+    MSR     BASEPRI,r0            /* 规避 Cortex-M7 勘误 837070 */
+    CPSIE   i                     /* (见 SDEN-1068427) */
+  ENDIF                           /* M3/M4/M7 */
+
+    /* PendSV 可能被中断抢占并被再次挂起, 这里清除这种多余的挂起 */
+    STR     r1,[r3]               /* ICSR[27] := 1 (清除 PendSV 挂起) */
+
+    /* 保存当前上下文的其余部分 (见 NOTE2) */
+  IF {TARGET_ARCH_THUMB} == 3     /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    SUB     sp,sp,#10*4           /* 为上下文预留空间 */
+    MOV     r0,sp
+    STM     r0!,{r3-r7}           /* 保存栈对齐字和 r4-r7 */
+    MOV     r3,r8
+    MOV     r4,r9
+    MOV     r5,r10
+    MOV     r6,r11
+    MOV     r7,lr
+    STM     r0!,{r3-r7}           /* 保存 r8-r11 和 EXC_RETURN */
+  ELSE                            /* M3/M4/M7 */
+  IF {TARGET_FPU_VFP} = {TRUE}    /* 有 VFP? */
+    TST     lr,#(1 << 4)          /* 是 VFP 栈帧吗? */
+    IT      EQ                    /* lr[4] 为 0 时... */
+    VSTMDBEQ sp!,{s16-s31}        /* ... 保存 VFP 寄存器 s16-s31 */
+  ENDIF                           /* VFP available */
+    PUSH    {r3-r11,lr}           /* 保存栈对齐字, r4-r11, EXC_RETURN */
+  ENDIF                           /* M3/M4/M7 */
+
+    /* 切换到下一个上下文的栈 */
+    MOV     r0,sp                 /* r0 := 当前的栈指针 */
+    BL      QXK_contextSw_        /* r0 := QXK_contextSw_(r0) */
+    MOV     sp,r0                 /* sp := 要恢复的栈指针 */
+
+    /* 恢复下一个上下文 */
+  IF {TARGET_ARCH_THUMB} == 3     /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    MOV     r1,r0
+    ADDS    r1,r1,#5*4            /* r1 := 保存的 r8 的地址 */
+    LDM     r1!,{r3-r7}           /* 恢复 r8-r11 和 EXC_RETURN */
+    MOV     r8,r3
+    MOV     r9,r4
+    MOV     r10,r5
+    MOV     r11,r6
+    MOV     lr,r7
+    LDM     r0!,{r3-r7}           /* 恢复栈对齐字和 r4-r7 */
+    MOV     sp,r1                 /* 从栈中移除上下文 */
+  ELSE                            /* M3/M4/M7 */
+    POP     {r3-r11,lr}           /* 恢复栈对齐字, r4-r11, EXC_RETURN */
+  IF {TARGET_FPU_VFP} = {TRUE}    /* 有 VFP? */
+    TST     lr,#(1 << 4)          /* 是 VFP 栈帧吗? */
+    IT      EQ                    /* lr[4] 为 0 时... */
+    VLDMIAEQ sp!,{s16-s31}        /* ... 恢复 VFP 寄存器 s16-s31 */
+  ENDIF                           /* VFP available */
+  ENDIF                           /* M3/M4/M7 */
+
+    /* 基本上下文需要激活 AO 吗? */
+    LDR     r0,=QXK_attr_
+    LDRB    r0,[r0,#QXK_NEXT_PRIO_OFFS]
+    CMP     r0,#0
+    BNE     PendSV_activate
+
+    /* 不需要激活, 直接返回恢复的上下文 */
+  IF {TARGET_ARCH_THUMB} == 3     /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    CPSIE   i                     /* 开中断 (清除 PRIMASK) */
+  ELSE                            /* M3/M4/M7 */
+    MOVS    r0,#0
+    MSR     BASEPRI,r0            /* 开中断 (清除 BASEPRI) */
+    DSB                           /* ARM 勘误 838869 */
+  ENDIF                           /* M3/M4/M7 */
+    /*>>>>>>>>>>>>>>>>>>>>>>>> 临界区结束 >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+    BX      lr                    /* 异常返回到下一个上下文 */
+
+    /* 构造异常栈帧, 异常返回到 QXK_activate_() (关中断调用, 关中断返回) */
+PendSV_activate
+  IF {TARGET_FPU_VFP} = {TRUE}    /* 有 VFP? */
+    PUSH    {r0,lr}               /* 压入 lr 及栈对齐字 */
+  ENDIF                           /* VFP available */
+    MOVS    r3,#1
+    LSLS    r3,r3,#24             /* r3 := (1 << 24), T 位 (新 xpsr) */
+    LDR     r2,=QXK_activate_     /* QXK_activate_ 的地址 */
+    SUBS    r2,r2,#1              /* Thumb 地址按半字对齐 (新 pc) */
+    LDR     r1,=QXK_thread_ret    /* QXK_activate_ 的返回地址 (新 lr) */
+
+    SUB     sp,sp,#8*4            /* 为异常栈帧预留空间 */
+    ADD     r0,sp,#5*4            /* r0 := 栈顶下方 5 个寄存器处 */
+    STM     r0!,{r1-r3}           /* 保存 xpsr, pc, lr */
+
+    MOVS    r0,#6
+    MVNS    r0,r0                 /* r0 := ~6 == 0xFFFFFFF9 */
+  IF {TARGET_ARCH_THUMB} != 3     /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    DSB                           /* ARM 勘误 838869 */
+  ENDIF
+    BX      r0                    /* 异常返回到 QXK 激活器 */
+
+    ALIGN                         /* 确保文字池对齐 */
+}
+// clang-format on
+
+/*****************************************************************************
+ * QXK_thread_ret 在 QXK 激活器返回后执行(线程模式, 关中断).
+ *
+ * 返回到被抢占的 AO (或空闲循环) 必须通过异常返回完成, 因此这里挂起 NMI,
+ * 由 NMI_Handler 丢弃伪造的异常栈帧.
+ */
+// clang-format off
+__asm void QXK_thread_ret(void) {
+
+  IF {TARGET_FPU_VFP} = {TRUE}    /* 有 VFP? */
+    /* 确保随后的 NMI 不使用 VFP 栈帧 */
+    MRS     r0,CONTROL            /* r0 := CONTROL */
+    BICS    r0,r0,#4              /* r0 := r0 & ~4 (FPCA 位) */
+    MSR     CONTROL,r0            /* CONTROL := r0 (清除 CONTROL[2] FPCA) */
+    ISB                           /* MSR CONTROL 之后需要 ISB */
+  ENDIF                           /* VFP available */
+
+    /* 触发 NMI 返回被抢占的代码 (NMI 在关中断状态下触发) */
+    LDR     r0,=0xE000ED04        /* 中断控制与状态寄存器 ICSR */
+    MOVS    r1,#1
+    LSLS    r1,r1,#31             /* r1 := (1 << 31) (NMI 位) */
+    STR     r1,[r0]               /* ICSR[31] := 1 (挂起 NMI) */
+    B       .                     /* 等待 NMI 抢占 */
+
+    ALIGN                         /* 确保文字池对齐 */
+}
+// clang-format on
+
+/*****************************************************************************
+ * NMI_Handler 用于返回到被抢占的 AO (或空闲循环): 它丢弃 PendSV 伪造的
+ * 异常栈帧, 然后利用栈顶处原始的中断栈帧异常返回. NMI 在关中断状态下进入,
+ * 因此返回前需要重新开中断. 因此 NMI 异常不能再被应用程序使用.
+ */
+// clang-format off
+__asm void NMI_Handler(void) {
+
+    ADD     sp,sp,#(8*4)          /* 移除一个 8 寄存器的异常栈帧 */
+
+  IF {TARGET_ARCH_THUMB} == 3     /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    CPSIE   i                     /* 开中断 (清除 PRIMASK) */
+    BX      lr                    /* 返回被抢占的代码 */
+  ELSE                            /* M3/M4/M7 */
+    MOVS    r0,#0
+    MSR     BASEPRI,r0            /* 开中断 (清除 BASEPRI) */
+  IF {TARGET_FPU_VFP} = {TRUE}    /* 有 VFP? */
+    POP     {r0,pc}               /* 弹出栈对齐字, EXC_RETURN 装入 pc */
+  ELSE                            /* no VFP */
+    BX      lr                    /* 返回被抢占的代码 */
+  ENDIF                           /* VFP available */
+  ENDIF                           /* M3/M4/M7 */
+}
+// clang-format on
+
+/*****************************************************************************
+ * \b NOTE1:
+ * PendSV_Handler 在汇编中直接读取 QXK_attr_.nextPrio, 因此在编译期检查该
+ * 成员在 ::QXK_PrivAttr 中的偏移 (3 个指针之后依次是 actPrio, nextPrio).
+ *
+ * \b NOTE2:
+ * 所有上下文 (基本上下文和扩展线程的私有栈) 都在主栈指针 (MSP) 上切换.
+ * PendSV_Handler 保存的上下文占 10 个字 (栈对齐字, r4-r11 和 EXC_RETURN),
+ * 使调用 QXK_contextSw_() 时栈保持 8 字节对齐. 带 VFP 的内核只在被切换出去
+ * 的上下文使用过 VFP (EXC_RETURN[4] == 0) 时才额外保存 s16-s31.
+ */
@@ -0,0 +1,87 @@
+/**
+ * @file
+ * @brief QXK/C port to ARM Cortex-M, ARM-KEIL toolset
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.1
+ * Last updated on  2020-09-23
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2020 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses/>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+#ifndef QXK_PORT_H
+#define QXK_PORT_H
+
+/* 判断当前是否处于 ISR 上下文(IPSR 非零即处于异常处理模式) */
+#define QXK_ISR_CONTEXT_() (QXK_get_IPSR() != 0U)
+
+/* 读取 IPSR 寄存器的内联函数 */
+static __inline uint32_t QXK_get_IPSR(void)
+{
+    register uint32_t __regIPSR __asm("ipsr");
+    return __regIPSR;
+}
+
+/* 请求上下文切换: 挂起 PendSV (ICSR[28]) */
+#define QXK_CONTEXT_SWITCH_() \
+    (*Q_UINT2PTR_CAST(uint32_t, 0xE000ED04U) = (1U << 28U))
+
+/* QXK 中断进入宏: Cortex-M 由硬件处理中断嵌套, 无需额外操作 */
+#define QXK_ISR_ENTRY() ((void)0)
+
+/* QXK 中断退出宏: 需要切换上下文或抢占时挂起 PendSV */
+#define QXK_ISR_EXIT()               \
+    do {                             \
+        QF_INT_DISABLE();            \
+        if (QXK_sched_() != 0U) {    \
+            QXK_CONTEXT_SWITCH_();   \
+        }                            \
+        QF_INT_ENABLE();             \
+        QXK_ARM_ERRATUM_838869();    \
+    } while (false)
+
+#if (__TARGET_ARCH_THUMB == 3) /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+#define QXK_ARM_ERRATUM_838869() ((void)0)
+#else /* Cortex-M3/M4/M7(v7-M) */
+/* 宏: 处理 ARM Erratum 838869 的推荐方法
+ * 说明: 对于 Cortex-M3/M4/M7, 需要在 ISR 结束前执行 DSB（数据同步屏障）指令.
+ */
+#define QXK_ARM_ERRATUM_838869() __asm("dsb")
+#endif
+
+/* 初始化 QXK 内核(异常优先级, PendSV 最低优先级) */
+#define QXK_INIT() QXK_init()
+void QXK_init(void);
+
+/* QXK 激活器返回后的辅助函数, 见 qxk_port.c */
+void QXK_thread_ret(void);
+
+#include "qxk.h" /* QXK 平台无关公共接口 */
+
+#endif /* QXK_PORT_H */
@@ -0,0 +1,434 @@
+/**
+* @file
+* @brief QXK/C port to ARM Cortex-M, GNU-ARM toolset
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+/* This QXK port is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+#include "qassert.h"
+
+#include <stddef.h> /* for offsetof() */
+
+#if (__ARM_ARCH == 6) /* Cortex-M0/M0+/M1 (v6-M, v6S-M)? */
+
+/*
+* Hand-optimized quick LOG2 in assembly (M0/M0+ have no CLZ instruction)
+*
+* NOTE:
+* The inline GNU assembler does not accept mnemonics MOVS, LSRS and ADDS,
+* but for Cortex-M0/M0+/M1 the mnemonics MOV, LSR and ADD always set the
+* condition flags in the PSR.
+*/
+__attribute__ ((naked, optimize("-fno-stack-protector")))
+uint_fast8_t QF_qlog2(uint32_t x) {
+__asm volatile (
+    "  MOV     r1,#0            \n"
+#if (QF_MAX_ACTIVE > 16U)
+    "  LSR     r2,r0,#16        \n"
+    "  BEQ     QF_qlog2_1       \n"
+    "  MOV     r1,#16           \n"
+    "  MOV     r0,r2            \n"
+    "QF_qlog2_1:                \n"
+#endif
+#if (QF_MAX_ACTIVE > 8U)
+    "  LSR     r2,r0,#8         \n"
+    "  BEQ     QF_qlog2_2       \n"
+    "  ADD     r1, r1,#8        \n"
+    "  MOV     r0, r2           \n"
+    "QF_qlog2_2:                \n"
+#endif
+    "  LSR     r2,r0,#4         \n"
+    "  BEQ     QF_qlog2_3       \n"
+    "  ADD     r1,r1,#4         \n"
+    "  MOV     r0,r2            \n"
+    "QF_qlog2_3:                \n"
+    "  LDR     r2,=QF_qlog2_LUT \n"
+    "  LDRB    r0,[r2,r0]       \n"
+    "  ADD     r0,r1,r0         \n"
+    "  BX      lr               \n"
+    "  .align                   \n"
+    "QF_qlog2_LUT:              \n"
+    "  .byte 0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4"
+    );
+}
+
+#endif /* Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+
+/* prototypes --------------------------------------------------------------*/
+/* prototypes --------------------------------------------------------------*/
+void PendSV_Handler(void);
+void NMI_Handler(void);
+void QXK_thread_ret(void);
+
+#define SCnSCB_ICTR  ((uint32_t volatile *)0xE000E004)
+#define SCB_SYSPRI   ((uint32_t volatile *)0xE000ED14)
+#define NVIC_IP      ((uint32_t volatile *)0xE000E400)
+
+/* offset of QXK_attr_.nextPrio used by PendSV_Handler (see NOTE1) */
+#define QXK_NEXT_PRIO_OFFS 13
+
+Q_ASSERT_STATIC(offsetof(QXK_PrivAttr, nextPrio) == QXK_NEXT_PRIO_OFFS);
+
+/* helper macros to "stringify" values */
+#define VAL(x) #x
+#define STRINGIFY(x) VAL(x)
+
+/*
+* Initialize the exception priorities and IRQ priorities to safe values.
+*
+* Description:
+* On Cortex-M3/M4/M7, this QXK port disables interrupts by means of the
+* BASEPRI register. However, this method cannot disable interrupt
+* priority zero, which is the default for all interrupts out of reset.
+* The following code changes the SysTick priority and all IRQ priorities
+* to the safe value QF_BASEPRI, wich the QF critical section can disable.
+* This avoids breaching of the QF critical sections in case the
+* application programmer forgets to explicitly set priorities of all
+* "kernel aware" interrupts.
+*
+* On all Cortex-M cores, the PendSV exception used for the context switches
+* and the asynchronous preemption is set to the lowest priority (0xFF),
+* so that it runs only after all nested interrupts have completed.
+*
+* The interrupt priorities established in QXK_init() can be later
+* changed by the application-level code, except for PendSV.
+*/
+void QXK_init(void) {
+#if (__ARM_ARCH != 6) /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M)? */
+    uint32_t n;
+
+    /* set exception priorities to QF_BASEPRI...
+    * SCB_SYSPRI1: Usage-fault, Bus-fault, Memory-fault
+    */
+    SCB_SYSPRI[1] |= (QF_BASEPRI << 16) | (QF_BASEPRI << 8) | QF_BASEPRI;
+
+    /* SCB_SYSPRI2: SVCall */
+    SCB_SYSPRI[2] |= (QF_BASEPRI << 24);
+
+    /* SCB_SYSPRI3:  SysTick, PendSV, Debug */
+    SCB_SYSPRI[3] |= (QF_BASEPRI << 24) | (QF_BASEPRI << 16) | QF_BASEPRI;
+
+    /* set all implemented IRQ priories to QF_BASEPRI... */
+    n = 8U + ((*SCnSCB_ICTR & 0x7U) << 3); /* (# NVIC_PRIO registers)/4 */
+    do {
+        --n;
+        NVIC_IP[n] = (QF_BASEPRI << 24) | (QF_BASEPRI << 16)
+                     | (QF_BASEPRI << 8) | QF_BASEPRI;
+    } while (n != 0);
+#endif /* NOT Cortex-M0/M0+/M1(v6-M, v6S-M) */
+
+    /* set the PendSV priority to 0xFF (lowest) */
+    SCB_SYSPRI[3] |= (0xFFU << 16);
+}
+
+/*****************************************************************************
+* Build the initial context of an extended thread on its private stack, so
+* that the thread looks as if it has been switched out by PendSV_Handler.
+* When the context is restored for the first time, the thread starts in
+* handler(thr) and returns to QXK_threadExit_().
+*
+* The context consists of the 8-word exception stack frame (xpsr, pc, lr,
+* r12, r3-r0) and, below it, the 10 words saved by PendSV_Handler
+* (EXC_RETURN, r11-r4 and a stack-aligner in place of r3).
+*
+* NOTE: all threads run on the main stack pointer (MSP), so every private
+* stack must also have room for the worst-case nesting of the interrupts.
+*/
+void QXK_stackInit_(void *thr, QXThreadHandler handler,
+                    void *stkSto, uint_fast16_t stkSize)
+{
+    /* round down the top of the stack to the 8-byte boundary
+    * NOTE: ARM Cortex-M stack grows down from hi -> low memory
+    */
+    uint32_t *sp = (uint32_t *)((((uint32_t)stkSto + stkSize) >> 3U) << 3U);
+    uint32_t *sp_limit;
+
+    /* exception stack frame, see NOTE2 */
+    *(--sp) = (1U << 24);                  /* xPSR (just the THUMB bit) */
+    *(--sp) = (uint32_t)handler & ~1U;     /* PC (the thread handler) */
+    *(--sp) = (uint32_t)&QXK_threadExit_;  /* LR (return from the handler) */
+    *(--sp) = 0x0000000CU;                 /* R12 */
+    *(--sp) = 0x00000003U;                 /* R3 */
+    *(--sp) = 0x00000002U;                 /* R2 */
+    *(--sp) = 0x00000001U;                 /* R1 */
+    *(--sp) = (uint32_t)thr;               /* R0 (argument to the handler) */
+
+    /* registers saved by PendSV_Handler */
+    *(--sp) = 0xFFFFFFF9U;                 /* EXC_RETURN (Thread mode, MSP) */
+    *(--sp) = 0x0000000BU;                 /* R11 */
+    *(--sp) = 0x0000000AU;                 /* R10 */
+    *(--sp) = 0x00000009U;                 /* R9 */
+    *(--sp) = 0x00000008U;                 /* R8 */
+    *(--sp) = 0x00000007U;                 /* R7 */
+    *(--sp) = 0x00000006U;                 /* R6 */
+    *(--sp) = 0x00000005U;                 /* R5 */
+    *(--sp) = 0x00000004U;                 /* R4 */
+    *(--sp) = 0x00000003U;                 /* stack-aligner */
+
+    /* save the top of the stack in the thread's attibute */
+    ((QActive *)thr)->osObject = sp;
+
+    /* pre-fill the unused part of the stack with 0xDEADBEEF */
+    sp_limit = (uint32_t *)((((uint32_t)stkSto - 1U) >> 3U) + 1U);
+    sp_limit = (uint32_t *)((uint32_t)sp_limit << 3U);
+    for (; sp >= sp_limit; --sp) {
+        *sp = 0xDEADBEEFU;
+    }
+}
+
+/*****************************************************************************
+* The PendSV_Handler exception handler performs the context switches between
+* the extended threads and the "basic context" (the main stack, where the
+* AOs and the idle loop run), and it handles the asynchronous preemption of
+* the AOs in the same way as the QK kernel.
+*
+* The PendSV exception should have the lowest priority in the whole system
+* (0xFF, see QXK_init()). All other exceptions and interrupts should have
+* higher priority. Also, *all* "kernel aware" ISRs in the QXK application
+* must call the QXK_ISR_EXIT() macro, which triggers PendSV when it detects
+* a need for a context switch or asynchronous preemption.
+*
+* PendSV_Handler saves the rest of the current context (r4-r11, EXC_RETURN
+* and s16-s31 if the FPU was used) on the current stack, and passes the stack
+* pointer to QXK_contextSw_(), which returns the stack pointer of the context
+* to restore. When the restored context is the basic context and an AO needs
+* to be activated (QXK_attr_.nextPrio != 0), PendSV_Handler returns to
+* QXK_activate_() in the Thread mode via a fabricated exception stack frame,
+* exactly as the QK port does.
+*/
+__attribute__ ((naked))
+void PendSV_Handler(void) {
+__asm volatile (
+
+    /* Prepare constants in registers before entering critical section */
+    "  LDR     r3,=0xE000ED04   \n" /* Interrupt Control and State Register */
+    "  MOV     r1,#1            \n"
+    "  LSL     r1,r1,#27        \n" /* r1 := (1 << 27) (UNPENDSVSET bit) */
+
+    /*<<<<<<<<<<<<<<<<<<<<<<< CRITICAL SECTION BEGIN <<<<<<<<<<<<<<<<<<<<<<<<*/
+#if (__ARM_ARCH == 6) /* Cortex-M0/M0+/M1 (v6-M, v6S-M)? */
+    "  CPSID   i                \n" /* disable interrupts (set PRIMASK) */
+#else                 /* M3/M4/M7 */
+    "  MOV     r0,#" STRINGIFY(QF_BASEPRI) "\n"
+    "  CPSID   i                \n" /* selectively disable interrutps with BASEPRI */
+    "  MSR     BASEPRI,r0       \n" /* apply the workaround the Cortex-M7 erraturm */
+    "  CPSIE   i                \n" /* 837070, see SDEN-1068427. */
+#endif                /* M3/M4/M7 */
+
+    /* The PendSV exception handler can be preempted by an interrupt,
+    * which might pend PendSV exception again. The following write to
+    * ICSR[27] un-pends any such spurious instance of PendSV.
+    */
+    "  STR     r1,[r3]          \n" /* ICSR[27] := 1 (unpend PendSV) */
+
+    /* save the rest of the current context (see NOTE2)... */
+#if (__ARM_ARCH == 6) /* Cortex-M0/M0+/M1 (v6-M, v6S-M)? */
+    "  SUB     sp,sp,#10*4      \n" /* reserve space for the context */
+    "  MOV     r0,sp            \n"
+    "  STM     r0!,{r3-r7}      \n" /* save the aligner and r4-r7 */
+    "  MOV     r3,r8            \n"
+    "  MOV     r4,r9            \n"
+    "  MOV     r5,r10           \n"
+    "  MOV     r6,r11           \n"
+    "  MOV     r7,lr            \n"
+    "  STM     r0!,{r3-r7}      \n" /* save r8-r11 and EXC_RETURN */
+#else                 /* M3/M4/M7 */
+#if (__ARM_FP != 0)   /* if VFP available... */
+    "  TST     lr,#(1 << 4)     \n" /* is it the VFP stack frame? */
+    "  IT      EQ               \n" /* if lr[4] is zero... */
+    "  VSTMDBEQ sp!,{s16-s31}   \n" /* ... save VFP registers s16..s31 */
+#endif                /* VFP available */
+    "  PUSH    {r3-r11,lr}      \n" /* save the aligner, r4-r11, EXC_RETURN */
+#endif                /* M3/M4/M7 */
+
+    /* switch the stack pointer to the next context */
+    "  MOV     r0,sp            \n" /* r0 := the current stack pointer */
+    "  BL      QXK_contextSw_   \n" /* r0 := QXK_contextSw_(r0) */
+    "  MOV     sp,r0            \n" /* sp := the stack pointer to restore */
+
+    /* restore the next context... */
+#if (__ARM_ARCH == 6) /* Cortex-M0/M0+/M1 (v6-M, v6S-M)? */
+    "  MOV     r1,r0            \n"
+    "  ADD     r1,r1,#5*4       \n" /* r1 := &saved r8 */
+    "  LDM     r1!,{r3-r7}      \n" /* restore r8-r11 and EXC_RETURN */
+    "  MOV     r8,r3            \n"
+    "  MOV     r9,r4            \n"
+    "  MOV     r10,r5           \n"
+    "  MOV     r11,r6           \n"
+    "  MOV     lr,r7            \n"
+    "  LDM     r0!,{r3-r7}      \n" /* restore the aligner and r4-r7 */
+    "  MOV     sp,r1            \n" /* remove the context from the stack */
+#else                 /* M3/M4/M7 */
+    "  POP     {r3-r11,lr}      \n" /* restore the aligner, r4-r11, EXC_RETURN */
+#if (__ARM_FP != 0)   /* if VFP available... */
+    "  TST     lr,#(1 << 4)     \n" /* is it the VFP stack frame? */
+    "  IT      EQ               \n" /* if lr[4] is zero... */
+    "  VLDMIAEQ sp!,{s16-s31}   \n" /* ... restore VFP registers s16..s31 */
+#endif                /* VFP available */
+#endif                /* M3/M4/M7 */
+
+    /* does the basic context need to activate an AO? */
+    "  LDR     r0,=QXK_attr_    \n"
+    "  LDRB    r0,[r0,#" STRINGIFY(QXK_NEXT_PRIO_OFFS) "]\n"
+    "  CMP     r0,#0            \n"
+    "  BNE     PendSV_activate  \n"
+
+    /* no activation, just return to the restored context */
+#if (__ARM_ARCH == 6) /* Cortex-M0/M0+/M1 (v6-M, v6S-M)? */
+    "  CPSIE   i                \n" /* enable interrupts (clear PRIMASK) */
+#else                 /* M3/M4/M7 */
+    "  MOV     r0,#0            \n"
+    "  MSR     BASEPRI,r0       \n" /* enable interrupts (clear BASEPRI) */
+    "  DSB                      \n" /* ARM Erratum 838869 */
+#endif                /* M3/M4/M7 */
+    /*>>>>>>>>>>>>>>>>>>>>>>>> CRITICAL SECTION END >>>>>>>>>>>>>>>>>>>>>>>>>*/
+    "  BX      lr               \n" /* exception-return to the next context */
+
+    /* The QXK activator must be called in a Thread mode, while this code
+    * executes in the Handler mode of the PendSV exception. The switch
+    * to the Thread mode is accomplished by returning from PendSV using
+    * a fabricated exception stack frame, where the return address is
+    * QXK_activate_().
+    *
+    * NOTE: the QXK activator is called with interrupts DISABLED and also
+    * returns with interrupts DISABLED.
+    */
+    "PendSV_activate:           \n"
+#if (__ARM_FP != 0)   /* if VFP available... */
+    "  PUSH    {r0,lr}          \n" /* ... push lr plus stack-aligner */
+#endif                /* VFP available */
+    "  MOV     r3,#1            \n"
+    "  LSL     r3,r3,#24        \n" /* r3 := (1 << 24), set the T bit (new xpsr) */
+    "  LDR     r2,=QXK_activate_ \n" /* address of QXK_activate_ */
+    "  SUB     r2,r2,#1         \n" /* align Thumb-address at halfword (new pc) */
+    "  LDR     r1,=QXK_thread_ret \n" /* return address after the call (new lr) */
+
+    "  SUB     sp,sp,#8*4       \n" /* reserve space for exception stack frame */
+    "  ADD     r0,sp,#5*4       \n" /* r0 := 5 registers below the top of stack */
+    "  STM     r0!,{r1-r3}      \n" /* save xpsr,pc,lr */
+
+    "  MOV     r0,#6            \n"
+    "  MVN     r0,r0            \n" /* r0 := ~6 == 0xFFFFFFF9 */
+#if (__ARM_ARCH != 6) /* NOT Cortex-M0/M0+/M1 (v6-M, v6S-M)? */
+    "  DSB                      \n" /* ARM Erratum 838869 */
+#endif                /* NOT (v6-M, v6S-M) */
+    "  BX      r0               \n" /* exception-return to the QXK activator */
+    );
+}
+
+/*****************************************************************************
+* QXK_thread_ret is a helper function executed when the QXK activator returns.
+*
+* NOTE: QXK_thread_ret does not execute in the PendSV context!
+* NOTE: QXK_thread_ret executes entirely with interrupts DISABLED.
+*/
+__attribute__ ((naked))
+void QXK_thread_ret(void) {
+__asm volatile (
+
+    /* After the QXK activator returns, we need to resume the preempted
+    * AO (or the idle loop). However, this must be accomplished by a
+    * return-from-exception, while we are still in the thread context.
+    * The switch to the exception contex is accomplished by triggering
+    * the NMI exception.
+    */
+
+#if (__ARM_FP != 0)   /* if VFP available... */
+    /* make sure that the following NMI will NOT use the VFP stack frame */
+    "  MRS     r0,CONTROL       \n" /* r0 := CONTROL */
+    "  BIC     r0,r0,#4         \n" /* r0 := r0 & ~4 (FPCA bit) */
+    "  MSR     CONTROL,r0       \n" /* CONTROL := r0 (clear CONTROL[2] FPCA bit) */
+    "  ISB                      \n" /* ISB after MSR CONTROL (ARM AN321,Sect.4.16) */
+#endif                /* VFP available */
+
+    /* trigger NMI to return to preempted task...
+    * NOTE: The NMI exception is triggered with nterrupts DISABLED
+    */
+    "  LDR     r0,=0xE000ED04   \n" /* Interrupt Control and State Register */
+    "  MOV     r1,#1            \n"
+    "  LSL     r1,r1,#31        \n" /* r1 := (1 << 31) (NMI bit) */
+    "  STR     r1,[r0]          \n" /* ICSR[31] := 1 (pend NMI) */
+    "  B       .                \n" /* wait for preemption by NMI */
+    );
+}
+
+/*****************************************************************************
+* The NMI_Handler exception handler is used for returning back to the
+* interrupted AO (or the idle loop). The NMI exception simply removes its
+* own interrupt stack frame from the stack and returns to the preempted
+* code using the interrupt stack frame that must be at the top of the stack.
+*
+* NOTE: The NMI exception is entered with interrupts DISABLED, so it needs
+* to re-enable interrupts before it returns to the preempted task.
+* Consequently, the NMI exception is not available for the application.
+*/
+__attribute__ ((naked))
+void NMI_Handler(void) {
+__asm volatile (
+
+    "  ADD     sp,sp,#(8*4)     \n" /* remove one 8-register exception frame */
+
+#if (__ARM_ARCH == 6) /* Cortex-M0/M0+/M1 (v6-M, v6S-M)? */
+    "  CPSIE   i                \n" /* enable interrupts (clear PRIMASK) */
+    "  BX      lr               \n" /* return to the preempted task */
+#else                 /* M3/M4/M7 */
+    "  MOV     r0,#0            \n"
+    "  MSR     BASEPRI,r0       \n" /* enable interrupts (clear BASEPRI) */
+#if (__ARM_FP != 0)   /* if VFP available... */
+    "  POP     {r0,pc}          \n" /* pop stack aligner and EXC_RETURN to pc */
+#else                 /* no VFP */
+    "  BX      lr               \n" /* return to the preempted task */
+#endif                /* VFP available */
+#endif                /* M3/M4/M7 */
+    );
+}
+
+/*****************************************************************************
+* NOTE1:
+* The PendSV_Handler reads QXK_attr_.nextPrio directly in assembly, so the
+* offset of this member is checked at compile time against the layout of
+* the QXK_PrivAttr structure (3 pointers followed by actPrio, nextPrio).
+*
+* NOTE2:
+* All the contexts (the basic context and the private stacks of the extended
+* threads) are switched on the main stack pointer (MSP). The context saved by
+* PendSV_Handler takes 10 words (an aligner, r4-r11 and EXC_RETURN), which
+* keeps the stack aligned at the 8-byte boundary for the call to
+* QXK_contextSw_(). On the cores with the VFP, the registers s16-s31 are
+* additionally saved only when the preempted context has used the VFP
+* (EXC_RETURN[4] == 0).
+*/
@@ -0,0 +1,278 @@
+/**
+* @file
+* @brief QF/C port to POSIX, cooperative QV kernel (single-threaded)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#ifndef QF_PORT_H
+#define QF_PORT_H
+
+/* The maximum number of active objects in the application, see NOTE1 */
+#define QF_MAX_ACTIVE           64U
+
+/* The maximum number of system clock tick rates */
+#define QF_MAX_TICK_RATE        2U
+
+/* epoll reactor for file descriptors and timerfd ticks (Linux), see NOTE4 */
+/*#define QF_EPOLL*/
+
+/* independent QF instances selected per thread, see NOTE5 */
+/*#define QF_CONTEXT*/
+#define QF_MAX_CONTEXT          64U
+#define QF_THREAD_LOCAL         __thread
+
+/* discrete-event simulation in virtual time (host testing), see NOTE6 */
+/*#define QF_SIM*/
+
+/* QF interrupt disable/enable, see NOTE2 */
+#define QF_INT_DISABLE()        QF_enterCriticalSection_()
+#define QF_INT_ENABLE()         QF_leaveCriticalSection_()
+
+/* QF critical section entry/exit (unconditional, one global mutex) */
+/*#define QF_CRIT_STAT_TYPE not defined */
+#define QF_CRIT_ENTRY(dummy)    QF_enterCriticalSection_()
+#define QF_CRIT_EXIT(dummy)     QF_leaveCriticalSection_()
+
+/* GCC/Clang builtin for fast LOG2 */
+#define QF_LOG2(n_) ((uint_fast8_t)(32U - __builtin_clz((unsigned)(n_))))
+
+#include "qep_port.h" /* QEP port */
+
+#ifdef QF_CONTEXT /* see NOTE5 */
+#ifdef QF_EPOLL
+#error "QF_CONTEXT is not supported together with QF_EPOLL"
+#endif
+
+#include <pthread.h>
+
+/* the port state of one QF instance context */
+typedef struct {
+    pthread_mutex_t mutex;  /* the "interrupt" mutex of the instance */
+    pthread_cond_t condVar; /* the QV thread sleeps on it */
+    bool isIdle;            /* QV thread sleeps in QV_sleep_() */
+    bool wakeup;            /* another thread ran a critical section */
+    bool tickRunning;       /* ticker thread started */
+    long tickNsec;          /* clock tick period [ns] */
+    pthread_t tickThread;
+} QFPortCtx;
+
+#define QF_PORT_CTX_TYPE_ QFPortCtx
+#endif /* QF_CONTEXT */
+
+/* enter/leave the critical section (lock/unlock the global mutex) */
+void QF_enterCriticalSection_(void);
+void QF_leaveCriticalSection_(void);
+
+/* set the clock tick rate and start the ticker, see NOTE3 and NOTE4 */
+void QF_setTickRate(uint32_t ticksPerSec, int_t tickPrio);
+
+/* clock tick callback (implemented in the BSP), see NOTE3 */
+void QF_onClockTick(void);
+
+/* abstractions for console access... */
+void QF_consoleSetup(void);
+void QF_consoleCleanup(void);
+int QF_consoleGetKey(void);
+
+#include "qv_port.h"  /* QV cooperative kernel port */
+#include "qf.h"       /* QF platform-independent public interface */
+
+#ifdef QF_EPOLL /* see NOTE4 */
+
+#ifndef QF_IO_MAX
+#define QF_IO_MAX               16U /* max number of registered descriptors */
+#endif
+#ifndef QF_IO_DATA_SIZE
+#define QF_IO_DATA_SIZE         64U /* max data in one QFIoDataEvt */
+#endif
+#ifndef QF_EPOLL_POLL_NS
+#define QF_EPOLL_POLL_NS        100000U /* min time between polls [ns] */
+#endif
+
+/* readiness event, posted when a descriptor registered with QF_ioAdd() is
+* ready (the AO does the I/O itself and calls QF_ioRearm() when done)
+*/
+typedef struct {
+    QEvt super;      /* inherits QEvt */
+    int fd;          /* the ready file descriptor */
+    uint32_t events; /* ready events (EPOLLIN, EPOLLOUT, EPOLLHUP, ...) */
+    uint32_t stamp;  /* QV_CYCCNT_GET() when the readiness was detected */
+} QFIoEvt;
+
+/* data event (dynamic), posted when the reactor has read data from a
+* descriptor registered with QF_ioAddData() (len == 0 means end of file)
+*/
+typedef struct {
+    QEvt super;      /* inherits QEvt */
+    int fd;          /* the file descriptor the data was read from */
+    uint32_t stamp;  /* QV_CYCCNT_GET() when the readiness was detected */
+    uint16_t len;    /* number of bytes in data[] */
+    uint8_t data[QF_IO_DATA_SIZE]; /* the data */
+} QFIoDataEvt;
+
+/* post a QFIoEvt with signal sig to act when fd is ready for events */
+void QF_ioAdd(int fd, uint32_t events, QActive *const act, enum_t const sig);
+
+/* post a QFIoDataEvt with signal sig to act with the data read from fd */
+void QF_ioAddData(int fd, QActive *const act, enum_t const sig);
+
+/* re-enable the readiness events of fd (after handling a QFIoEvt) */
+void QF_ioRearm(int fd);
+
+/* stop watching fd (the descriptor is not closed) */
+void QF_ioRemove(int fd);
+
+#endif /* QF_EPOLL */
+
+#ifdef QF_SIM /* see NOTE6 */
+#if (defined QF_EPOLL) || (defined QF_CONTEXT) || (defined QV_TT)
+#error "QF_SIM cannot be combined with QF_EPOLL, QF_CONTEXT or QV_TT"
+#endif
+
+#ifndef QF_SIM_MAX_STIM
+#define QF_SIM_MAX_STIM         32U /* max number of pending stimuli */
+#endif
+
+/* external stimulus, called at its virtual time like an ISR */
+typedef void (*QFSimHandler)(void *par);
+
+/* simulation statistics */
+typedef struct {
+    uint64_t simTime;  /* virtual time [ns] */
+    uint64_t wallTime; /* wall-clock time since QF_init() [ns] */
+    uint32_t nTicks;   /* clock ticks delivered (QF_onClockTick() calls) */
+    uint32_t nSkipped; /* clock ticks skipped, see QF_tickSkipX() */
+    uint32_t nStim;    /* stimuli delivered */
+} QFSimStat;
+
+/* call handler(par) at the virtual time at [ns] */
+void QF_simAt(uint64_t at, QFSimHandler handler, void *par);
+
+/* current virtual time [ns] */
+uint64_t QF_simNow(void);
+
+/* end the simulation at the virtual time end [ns] */
+void QF_simSetEnd(uint64_t end);
+
+/* statistics of the simulation so far */
+void QF_simGetStat(QFSimStat *stat);
+
+/* end-of-simulation callback (implemented in the BSP), see NOTE6 */
+void QF_onSimEnd(QFSimStat const *stat);
+
+#endif /* QF_SIM */
+
+/*****************************************************************************
+* NOTE1:
+* The maximum number of active objects QF_MAX_ACTIVE is set to the highest
+* value (64U) supported by the framework, because RAM is not a concern in
+* a hosted environment.
+*
+* NOTE2:
+* The "interrupts" of this port are other threads of the process (the ticker
+* thread and any threads created by the application), which interact with
+* the framework only inside critical sections. All critical sections are
+* protected by a single global mutex, so "disabling interrupts" means locking
+* that mutex. The critical sections do not nest, exactly as on the target.
+*
+* NOTE3:
+* The port provides the system clock tick from a separate ticker thread,
+* which is started by QF_setTickRate() (typically called from
+* QF_onStartup()). The ticker thread sleeps until an absolute deadline, so
+* the tick does not drift, and then calls QF_onClockTick(), which plays the
+* role of the SysTick ISR in the BSP. The tickPrio parameter requests the
+* SCHED_FIFO priority for the ticker thread (0 means the default policy);
+* if the process has no permission for real-time scheduling, the default
+* policy is used silently.
+*
+* NOTE4:
+* With QF_EPOLL defined (Linux only), the port needs no threads at all.
+* QV_CPU_SLEEP() blocks in epoll_wait() on:
+* - a timerfd (QF_setTickRate()), which replaces the ticker thread; the
+*   expirations are counted by the kernel, so ticks are delivered late
+*   but not lost when the QV thread is busy (tickPrio is ignored);
+* - the descriptors registered with QF_ioAdd()/QF_ioAddData(); their
+*   events are posted to the AOs with the normal QACTIVE_POST();
+* - an eventfd, which any other thread of the application signals when it
+*   leaves a critical section while the QV thread sleeps (see NOTE2).
+* While the AOs are busy, the same descriptors are polled between the RTC
+* steps (QV_PORT_POLL(), at most every QF_EPOLL_POLL_NS nanoseconds).
+* The QF_io...() functions may only be called by the QV thread (from the
+* AOs or before QF_run()). QF_ioAdd() uses EPOLLONESHOT, so the static
+* QFIoEvt of the descriptor is posted once until QF_ioRearm(). QF_ioAddData()
+* makes the descriptor non-blocking and reads it once per readiness into
+* a QFIoDataEvt allocated with Q_NEW(), so an event pool for QFIoDataEvt
+* is required.
+*
+* NOTE5:
+* With QF_CONTEXT defined, all the state of QF, of the QV kernel and of
+* this port (including the global mutex, the condition variable and the
+* ticker thread) is kept in a QFContext, and every thread selects its
+* context with QF_ctxSet(). This allows dozens of independent "nodes" to
+* run in parallel threads of one process: the main thread allocates the
+* contexts with QF_ctxNew(), and each node thread calls QF_ctxSet(),
+* QF_init() ... QF_run() with the context of its node. QF_setTickRate()
+* starts a ticker thread per node, which calls QF_onClockTick() in the
+* context of that node. A thread posting to an AO of a node must select
+* the context of the node first, and events must be allocated from the
+* pools of the destination node (events crossing nodes are copied). The
+* console functions remain global. QF_EPOLL is not supported in this mode.
+*
+* NOTE6:
+* With QF_SIM defined, the port runs the application in virtual time, for
+* deterministic tests that finish much faster than real time. There are no
+* threads: whenever all AOs are idle, QV_CPU_SLEEP() advances the virtual
+* clock directly to the next thing that can happen, which is either
+* - the next clock tick at which a time event of rate 0 (or a timeout of
+*   the timeout service) expires; the ticks before it are skipped with
+*   QF_tickSkipX() and QF_onClockTick() is called for that tick only, or
+* - the next stimulus scheduled with QF_simAt(); its handler is called
+*   like an ISR (it may post or publish events and schedule more stimuli).
+* A tick is delivered before a stimulus at the same virtual time, and
+* stimuli at the same time are delivered in the order of QF_simAt() calls,
+* so the run is deterministic. QF_simAt() may only be called by the QV
+* thread (before QF_run(), from the AOs or from the stimulus handlers).
+* The simulation ends at the time set with QF_simSetEnd(), or when nothing
+* is left to happen; the port then calls QF_onSimEnd() with the statistics
+* (the ratio simTime/wallTime is the speedup over real time), and, if the
+* callback returns, QF_stop() and exit(0).
+* QV_CYCCNT_GET() returns the virtual time, so the RTC steps take no time.
+* Side effects of QF_onClockTick() other than the rate-0 clock tick (e.g.
+* polling the console or driving other tick rates) happen only on the
+* ticks that are not skipped; QV_TT, which needs every tick, is therefore
+* not supported.
+*/
+
+#endif /* QF_PORT_H */
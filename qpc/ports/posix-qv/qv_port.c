@@ -0,0 +1,626 @@
+/**
+* @file
+* @brief QV/C port to POSIX (single-threaded)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#define _POSIX_C_SOURCE 200809L /* clock_nanosleep(), pthreads */
+
+/* This QV port is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+#include "qassert.h"
+#ifdef QF_CONTEXT
+#include "qf_pkg.h"
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef QF_EPOLL
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+#ifdef QF_SIM
+#include <stdlib.h> /* for exit() */
+#endif
+
+Q_DEFINE_THIS_MODULE("qv_port")
+
+/* Local objects ***********************************************************/
+#ifdef QF_CONTEXT /* in the current QF instance, see NOTE5 in qf_port.h */
+
+#define l_pThreadMutex (QF_ctx_->port.mutex)
+#define l_isIdle       (QF_ctx_->port.isIdle)
+#define l_condVar      (QF_ctx_->port.condVar)
+#define l_wakeup       (QF_ctx_->port.wakeup)
+#define l_tickThread   (QF_ctx_->port.tickThread)
+#define l_tickRunning  (QF_ctx_->port.tickRunning)
+#define l_tickNsec     (QF_ctx_->port.tickNsec)
+
+static void *ticker_(void *arg);
+
+#else
+
+static pthread_mutex_t l_pThreadMutex = PTHREAD_MUTEX_INITIALIZER;
+static bool l_isIdle;          /* QV thread sleeps in QV_sleep_() */
+
+#ifdef QF_EPOLL
+
+/* descriptor registered in the reactor */
+typedef struct {
+    QActive *act;    /* the AO to post to (NULL: free entry) */
+    QFIoEvt evt;     /* readiness event (static), or the fd and the signal */
+    uint32_t events; /* the events of interest */
+    bool isData;     /* read the data in the reactor (QF_ioAddData()) */
+} QFIo;
+
+static QFIo l_io[QF_IO_MAX];
+static pthread_t l_qvThread;   /* the thread executing QF_run() */
+static int l_epfd = -1;        /* the epoll instance */
+static int l_tickFd = -1;      /* timerfd of the clock tick */
+static int l_wakeFd = -1;      /* eventfd signalled by the other threads */
+static uint32_t l_lastPoll;    /* QV_cyccnt_() of the last poll */
+
+static void reactorInit_(void);
+static void reactor_(int timeout);
+static QFIo *ioFind_(int fd);
+static void ioAdd_(int fd, uint32_t events, QActive *const act,
+                   enum_t const sig, bool isData);
+
+#else
+
+static pthread_cond_t l_condVar = PTHREAD_COND_INITIALIZER;
+static bool l_wakeup;          /* another thread ran a critical section */
+
+static long l_tickNsec;        /* clock tick period [ns] */
+
+#ifndef QF_SIM
+static pthread_t l_tickThread;
+static bool l_tickRunning;     /* ticker thread started */
+
+static void *ticker_(void *arg);
+#endif
+
+#endif /* QF_EPOLL */
+#endif /* QF_CONTEXT */
+
+#ifdef QF_SIM /* see NOTE6 in qf_port.h */
+
+/* pending stimulus */
+typedef struct {
+    uint64_t at;          /* virtual time [ns] */
+    uint32_t seq;         /* QF_simAt() order, for stimuli at the same time */
+    QFSimHandler handler;
+    void *par;
+} QFSimStim;
+
+static QFSimStim l_stim[QF_SIM_MAX_STIM]; /* binary min-heap */
+static uint_fast16_t l_nStim;  /* number of pending stimuli */
+static uint32_t l_stimSeq;     /* sequence number of the next stimulus */
+static uint64_t l_simNow;      /* the virtual time [ns] */
+static uint64_t l_simEnd;      /* end of the simulation [ns] */
+static uint64_t l_tickNext;    /* virtual time of the next clock tick [ns] */
+static uint64_t l_wall0;       /* wall-clock time of QF_init() [ns] */
+static QFSimStat l_simStat;
+
+static void simStep_(void);
+static uint64_t wallNow_(void);
+
+#endif /* QF_SIM */
+
+static struct termios l_tsav;  /* structure with saved terminal attributes */
+static bool l_console;         /* console set up for raw input */
+
+/****************************************************************************/
+void QF_enterCriticalSection_(void) {
+    pthread_mutex_lock(&l_pThreadMutex);
+}
+/****************************************************************************/
+void QF_leaveCriticalSection_(void) {
+#ifdef QF_EPOLL
+    /* QV thread waiting for an "interrupt" from another thread? */
+    if (l_isIdle && !pthread_equal(pthread_self(), l_qvThread)) {
+        uint64_t const one = 1U;
+        (void)write(l_wakeFd, &one, sizeof(one)); /* end epoll_wait() */
+    }
+#else
+    if (l_isIdle) { /* QV thread waiting for an "interrupt"? */
+        l_wakeup = true;
+        pthread_cond_signal(&l_condVar);
+    }
+#endif
+    pthread_mutex_unlock(&l_pThreadMutex);
+}
+
+/****************************************************************************/
+/* NOTE: called with the global mutex locked (from QV_onIdle()) */
+void QV_sleep_(void) {
+#ifdef QF_EPOLL
+    reactorInit_();
+    l_qvThread = pthread_self();
+    l_isIdle = true; /* the other threads must write to l_wakeFd */
+    pthread_mutex_unlock(&l_pThreadMutex); /* "enable interrupts" */
+
+    reactor_(-1); /* block until a descriptor, tick or other thread */
+
+    pthread_mutex_lock(&l_pThreadMutex);
+    l_isIdle = false;
+    pthread_mutex_unlock(&l_pThreadMutex);
+#elif (defined QF_SIM)
+    pthread_mutex_unlock(&l_pThreadMutex); /* "enable interrupts" */
+    simStep_(); /* no waiting in virtual time */
+#else
+    l_isIdle = true;
+    l_wakeup = false;
+    while (!l_wakeup) {
+        pthread_cond_wait(&l_condVar, &l_pThreadMutex);
+    }
+    l_isIdle = false;
+    pthread_mutex_unlock(&l_pThreadMutex); /* "enable interrupts" */
+#endif
+}
+
+/****************************************************************************/
+#ifdef QF_CONTEXT
+void QV_ctxInit_(void) {
+    Q_ALLEGE_ID(10, pthread_mutex_init(&l_pThreadMutex,
+                                       (pthread_mutexattr_t *)0) == 0);
+    Q_ALLEGE_ID(20, pthread_cond_init(&l_condVar,
+                                      (pthread_condattr_t *)0) == 0);
+}
+#endif
+
+/****************************************************************************/
+uint32_t QV_cyccnt_(void) {
+#ifdef QF_SIM
+    return (uint32_t)l_simNow; /* the virtual time */
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint32_t)ts.tv_sec * 1000000000U
+                      + (uint32_t)ts.tv_nsec);
+#endif
+}
+
+/****************************************************************************/
+#ifdef QF_EPOLL
+
+void QF_setTickRate(uint32_t ticksPerSec, int_t tickPrio) {
+    struct itimerspec its;
+    long nsec;
+
+    Q_REQUIRE_ID(100, ticksPerSec != 0U);
+    (void)tickPrio; /* no ticker thread, see NOTE4 in qf_port.h */
+
+    nsec = (long)(1000000000U / ticksPerSec);
+    reactorInit_();
+    if (l_tickFd < 0) {
+        struct epoll_event ev;
+        l_tickFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+        Q_ASSERT_ID(110, l_tickFd >= 0);
+        ev.events   = EPOLLIN;
+        ev.data.ptr = &l_tickFd;
+        Q_ALLEGE_ID(120, epoll_ctl(l_epfd, EPOLL_CTL_ADD, l_tickFd, &ev) == 0);
+    }
+    its.it_interval.tv_sec  = nsec / 1000000000L;
+    its.it_interval.tv_nsec = nsec % 1000000000L;
+    its.it_value = its.it_interval; /* periodic, from now on */
+    Q_ALLEGE_ID(130, timerfd_settime(l_tickFd, 0, &its,
+                                     (struct itimerspec *)0) == 0);
+}
+
+/****************************************************************************/
+void QF_ioAdd(int fd, uint32_t events, QActive *const act, enum_t const sig) {
+    ioAdd_(fd, events, act, sig, false);
+}
+/****************************************************************************/
+void QF_ioAddData(int fd, QActive *const act, enum_t const sig) {
+    int const flags = fcntl(fd, F_GETFL);
+    Q_ALLEGE_ID(200, (flags >= 0)
+                     && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0));
+    ioAdd_(fd, (uint32_t)EPOLLIN, act, sig, true);
+}
+/****************************************************************************/
+void QF_ioRearm(int fd) {
+    QFIo *const io = ioFind_(fd);
+    struct epoll_event ev;
+
+    /** @pre the descriptor must be registered with QF_ioAdd() */
+    Q_REQUIRE_ID(210, (io != (QFIo *)0) && (!io->isData));
+
+    ev.events   = io->events | (uint32_t)EPOLLONESHOT;
+    ev.data.ptr = io;
+    Q_ALLEGE_ID(220, epoll_ctl(l_epfd, EPOLL_CTL_MOD, fd, &ev) == 0);
+}
+/****************************************************************************/
+void QF_ioRemove(int fd) {
+    QFIo *const io = ioFind_(fd);
+
+    /** @pre the descriptor must be registered */
+    Q_REQUIRE_ID(230, io != (QFIo *)0);
+
+    (void)epoll_ctl(l_epfd, EPOLL_CTL_DEL, fd, (struct epoll_event *)0);
+    io->act = (QActive *)0; /* free the entry */
+}
+
+/****************************************************************************/
+void QV_poll_(void) {
+    uint32_t const now = QV_cyccnt_();
+    if ((l_epfd >= 0) && ((now - l_lastPoll) >= QF_EPOLL_POLL_NS)) {
+        l_lastPoll = now;
+        reactor_(0); /* service whatever is ready, without blocking */
+    }
+}
+
+/****************************************************************************/
+static void reactorInit_(void) {
+    if (l_epfd < 0) {
+        struct epoll_event ev;
+        l_epfd = epoll_create1(EPOLL_CLOEXEC);
+        Q_ASSERT_ID(300, l_epfd >= 0);
+        l_wakeFd = eventfd(0U, EFD_NONBLOCK);
+        Q_ASSERT_ID(310, l_wakeFd >= 0);
+        ev.events   = EPOLLIN;
+        ev.data.ptr = &l_wakeFd;
+        Q_ALLEGE_ID(320, epoll_ctl(l_epfd, EPOLL_CTL_ADD, l_wakeFd, &ev) == 0);
+    }
+}
+/****************************************************************************/
+static void ioAdd_(int fd, uint32_t events, QActive *const act,
+                   enum_t const sig, bool isData)
+{
+    QFIo *io = ioFind_(fd);
+    struct epoll_event ev;
+    uint_fast8_t n;
+
+    /** @pre the descriptor must be valid and not registered yet, and the
+    * AO must be provided
+    */
+    Q_REQUIRE_ID(400, (fd >= 0) && (io == (QFIo *)0)
+                      && (act != (QActive *)0));
+
+    for (n = 0U; (n < QF_IO_MAX) && (l_io[n].act != (QActive *)0); ++n) {
+    }
+    Q_ASSERT_ID(410, n < QF_IO_MAX); /* must have a free entry */
+
+    io = &l_io[n];
+    io->act              = act;
+    io->isData           = isData;
+    io->evt.super.sig    = (QSignal)sig;
+    io->evt.super.poolId_ = 0U; /* static event */
+    io->evt.super.refCtr_ = 0U;
+    io->evt.fd           = fd;
+    io->evt.events       = 0U;
+    io->events           = events;
+
+    reactorInit_();
+    ev.events   = isData ? events : (events | (uint32_t)EPOLLONESHOT);
+    ev.data.ptr = io;
+    Q_ALLEGE_ID(420, epoll_ctl(l_epfd, EPOLL_CTL_ADD, fd, &ev) == 0);
+}
+/****************************************************************************/
+static QFIo *ioFind_(int fd) {
+    uint_fast8_t n;
+    for (n = 0U; n < QF_IO_MAX; ++n) {
+        if ((l_io[n].act != (QActive *)0) && (l_io[n].evt.fd == fd)) {
+            return &l_io[n];
+        }
+    }
+    return (QFIo *)0;
+}
+/****************************************************************************/
+/* wait for the descriptors (timeout in ms, -1: forever, 0: poll) and post
+* the corresponding events; called with the global mutex unlocked
+*/
+static void reactor_(int timeout) {
+    struct epoll_event ev[QF_IO_MAX + 2U];
+    int const n = epoll_wait(l_epfd, ev, (int)(QF_IO_MAX + 2U), timeout);
+    uint32_t const stamp = QV_cyccnt_();
+    int i;
+
+    for (i = 0; i < n; ++i) {
+        if (ev[i].data.ptr == &l_tickFd) { /* clock tick(s)? */
+            uint64_t nTicks;
+            if (read(l_tickFd, &nTicks, sizeof(nTicks))
+                == (ssize_t)sizeof(nTicks))
+            {
+                for (; nTicks != 0U; --nTicks) {
+                    QF_onClockTick(); /* the "SysTick ISR" in the BSP */
+                }
+            }
+        }
+        else if (ev[i].data.ptr == &l_wakeFd) { /* other thread? */
+            uint64_t cnt;
+            (void)read(l_wakeFd, &cnt, sizeof(cnt)); /* just clear it */
+        }
+        else {
+            QFIo *const io = (QFIo *)ev[i].data.ptr;
+            QActive *const act = io->act;
+            if (act == (QActive *)0) {
+                /* removed by an AO during this poll */
+            }
+            else if (io->isData) {
+                QFIoDataEvt *de = Q_NEW(QFIoDataEvt, io->evt.super.sig);
+                ssize_t const len = read(io->evt.fd, de->data,
+                                         sizeof(de->data));
+                if ((len < 0) && (errno == EAGAIN)) {
+                    QF_gc(&de->super); /* spurious readiness */
+                }
+                else {
+                    de->fd    = io->evt.fd;
+                    de->stamp = stamp;
+                    de->len   = (len > 0) ? (uint16_t)len : 0U;
+                    if (len <= 0) { /* end of file or error? */
+                        QF_ioRemove(io->evt.fd);
+                    }
+                    QACTIVE_POST(act, &de->super, (void *)0);
+                }
+            }
+            else { /* readiness (disarmed until QF_ioRearm()) */
+                io->evt.events = ev[i].events;
+                io->evt.stamp  = stamp;
+                QACTIVE_POST(act, &io->evt.super, (void *)0);
+            }
+        }
+    }
+}
+
+#elif (defined QF_SIM)
+
+void QF_setTickRate(uint32_t ticksPerSec, int_t tickPrio) {
+    Q_REQUIRE_ID(100, ticksPerSec != 0U);
+    (void)tickPrio; /* no ticker thread, see NOTE6 in qf_port.h */
+
+    l_tickNsec = (long)(1000000000U / ticksPerSec);
+    l_tickNext = l_simNow + (uint64_t)l_tickNsec;
+}
+
+/****************************************************************************/
+void QV_simInit_(void) {
+    l_nStim    = 0U;
+    l_stimSeq  = 0U;
+    l_simNow   = 0U;
+    l_simEnd   = UINT64_MAX; /* no end */
+    l_tickNsec = 0;          /* no clock tick */
+    l_wall0    = wallNow_();
+    QF_bzero(&l_simStat, sizeof(l_simStat));
+}
+
+/****************************************************************************/
+void QF_simAt(uint64_t at, QFSimHandler handler, void *par) {
+    uint_fast16_t i;
+
+    /** @pre the handler must be provided, the time must not be in the past
+    * and there must be room for the stimulus
+    */
+    Q_REQUIRE_ID(500, (handler != (QFSimHandler)0) && (at >= l_simNow)
+                      && (l_nStim < QF_SIM_MAX_STIM));
+
+    /* sift up from the new leaf */
+    for (i = l_nStim; i != 0U; i = (i - 1U) / 2U) {
+        QFSimStim const *const up = &l_stim[(i - 1U) / 2U];
+        if (up->at <= at) { /* earlier, or the same time but earlier seq */
+            break;
+        }
+        l_stim[i] = *up;
+    }
+    l_stim[i].at      = at;
+    l_stim[i].seq     = l_stimSeq;
+    l_stim[i].handler = handler;
+    l_stim[i].par     = par;
+    ++l_stimSeq;
+    ++l_nStim;
+}
+/****************************************************************************/
+uint64_t QF_simNow(void) {
+    return l_simNow;
+}
+/****************************************************************************/
+void QF_simSetEnd(uint64_t end) {
+    l_simEnd = end;
+}
+/****************************************************************************/
+void QF_simGetStat(QFSimStat *stat) {
+    *stat = l_simStat;
+    stat->simTime  = l_simNow;
+    stat->wallTime = wallNow_() - l_wall0;
+}
+
+/****************************************************************************/
+/* advance the virtual time to the next tick with an expiring time event or
+* to the next stimulus, whichever comes first; called when all AOs are idle
+*/
+static void simStep_(void) {
+    uint64_t const next = (l_nStim != 0U) ? l_stim[0].at : UINT64_MAX;
+    uint64_t const lim  = (next < l_simEnd) ? next : l_simEnd;
+
+    if ((l_tickNsec != 0) && (l_tickNext <= lim)) {
+        uint64_t const nTicks = ((lim - l_tickNext) / (uint64_t)l_tickNsec)
+                                + 1U; /* tick instants until lim */
+        uint32_t const max = (nTicks < UINT32_MAX)
+                             ? (uint32_t)nTicks : UINT32_MAX;
+        uint32_t const n = QF_tickSkipX(0U, max);
+
+        l_tickNext += (uint64_t)n * (uint64_t)l_tickNsec;
+        l_simStat.nSkipped += n;
+        if (n < max) { /* a time event expires at l_tickNext? */
+            l_simNow = l_tickNext;
+            l_tickNext += (uint64_t)l_tickNsec;
+            ++l_simStat.nTicks;
+            QF_onClockTick(); /* the "SysTick ISR" in the BSP */
+            return;
+        }
+    }
+
+    if ((l_nStim != 0U) && (next <= l_simEnd)) { /* stimulus before the end? */
+        QFSimStim const stim = l_stim[0];
+        QFSimStim last;
+        uint_fast16_t i = 0U;
+
+        /* remove the root of the heap (sift the last element down) */
+        --l_nStim;
+        last = l_stim[l_nStim];
+        for (;;) {
+            uint_fast16_t c = (2U * i) + 1U;
+            if (c >= l_nStim) {
+                break;
+            }
+            if (((c + 1U) < l_nStim)
+                && ((l_stim[c + 1U].at < l_stim[c].at)
+                    || ((l_stim[c + 1U].at == l_stim[c].at)
+                        && (l_stim[c + 1U].seq < l_stim[c].seq))))
+            {
+                ++c; /* the earlier child */
+            }
+            if ((last.at < l_stim[c].at)
+                || ((last.at == l_stim[c].at) && (last.seq < l_stim[c].seq)))
+            {
+                break;
+            }
+            l_stim[i] = l_stim[c];
+            i = c;
+        }
+        l_stim[i] = last;
+
+        l_simNow = stim.at;
+        ++l_simStat.nStim;
+        (*stim.handler)(stim.par); /* the "ISR" of the stimulus */
+        return;
+    }
+
+    /* end of the simulation, or nothing left to happen */
+    if (l_simEnd != UINT64_MAX) {
+        l_simNow = l_simEnd;
+    }
+    QF_simGetStat(&l_simStat);
+    QF_onSimEnd(&l_simStat);
+    QF_stop(); /* calls QF_onCleanup() */
+    exit(0);
+}
+
+/****************************************************************************/
+static uint64_t wallNow_(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+#else /* ticker thread */
+
+void QF_setTickRate(uint32_t ticksPerSec, int_t tickPrio) {
+    Q_REQUIRE_ID(100, ticksPerSec != 0U);
+
+    l_tickNsec = (long)(1000000000U / ticksPerSec);
+    if (!l_tickRunning) {
+#ifdef QF_CONTEXT
+        /* the ticker thread runs in the context of this instance */
+        Q_ALLEGE_ID(110, pthread_create(&l_tickThread, (pthread_attr_t *)0,
+                                        &ticker_, QF_ctxGet()) == 0);
+#else
+        Q_ALLEGE_ID(110, pthread_create(&l_tickThread, (pthread_attr_t *)0,
+                                        &ticker_, (void *)0) == 0);
+#endif
+        l_tickRunning = true;
+
+        if (tickPrio > 0) { /* real-time priority requested? */
+            struct sched_param param;
+            param.sched_priority = tickPrio;
+            /* NOTE: fails silently without the permission */
+            (void)pthread_setschedparam(l_tickThread, SCHED_FIFO, &param);
+        }
+    }
+}
+
+/****************************************************************************/
+static void *ticker_(void *arg) { /* the expected P-Thread signature */
+    struct timespec next;
+
+#ifdef QF_CONTEXT
+    QF_ctxSet((QFContext *)arg);
+#else
+    (void)arg;
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (;;) {
+        next.tv_nsec += l_tickNsec;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            ++next.tv_sec;
+        }
+        /* sleep until the absolute deadline, so the tick does not drift */
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+                               &next, (struct timespec *)0) != 0) {
+        }
+        QF_onClockTick(); /* the "SysTick ISR" in the BSP */
+    }
+    return (void *)0; /* return success */
+}
+
+#endif /* QF_EPOLL */
+
+/****************************************************************************/
+void QF_consoleSetup(void) {
+    if (isatty(STDIN_FILENO)) {
+        struct termios tio;
+        tcgetattr(STDIN_FILENO, &l_tsav);
+        tio = l_tsav;
+        tio.c_lflag &= ~(ICANON | ECHO); /* no line buffering, no echo */
+        tio.c_cc[VMIN]  = 0U; /* non-blocking reads */
+        tio.c_cc[VTIME] = 0U;
+        tcsetattr(STDIN_FILENO, TCSANOW, &tio);
+        l_console = true;
+    }
+}
+/****************************************************************************/
+void QF_consoleCleanup(void) {
+    if (l_console) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &l_tsav);
+        l_console = false;
+    }
+}
+/****************************************************************************/
+int QF_consoleGetKey(void) {
+    char ch;
+    if (l_console && (read(STDIN_FILENO, &ch, 1U) == 1)) {
+        return (int)(unsigned char)ch;
+    }
+    return 0; /* no input at this time */
+}
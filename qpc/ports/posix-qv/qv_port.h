@@ -0,0 +1,103 @@
+/**
+* @file
+* @brief QV/C port to POSIX (single-threaded)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#ifndef QV_PORT_H
+#define QV_PORT_H
+
+/* macro to put the QV thread to sleep inside QV_onIdle(), see NOTE1/NOTE4 */
+#define QV_CPU_SLEEP() QV_sleep_()
+void QV_sleep_(void);
+
+/* CLOCK_MONOTONIC in nanoseconds (wraps around every ~4.3 s) used as
+* the cycle counter by the optional QV features, see NOTE2
+*/
+#define QV_CYCCNT_GET() QV_cyccnt_()
+uint32_t QV_cyccnt_(void);
+
+#ifdef QF_EPOLL
+/* poll the epoll reactor between the RTC steps, see NOTE3 */
+#define QV_PORT_POLL() QV_poll_()
+void QV_poll_(void);
+#endif
+
+#ifdef QF_CONTEXT
+/* initialize the port state of the current QF instance (from QF_init()) */
+#define QV_INIT() QV_ctxInit_()
+void QV_ctxInit_(void);
+#endif
+
+#ifdef QF_SIM
+/* reset the virtual time and the statistics (from QF_init()) */
+#define QV_INIT() QV_simInit_()
+void QV_simInit_(void);
+#endif
+
+/* no ARM Erratum 838869 on POSIX */
+#define QV_ARM_ERRATUM_838869() ((void)0)
+
+#include "qv.h" /* QV platform-independent public interface */
+
+/*****************************************************************************
+* NOTE1:
+* QV_CPU_SLEEP() must be called with "interrupts disabled" (the global
+* mutex locked), as QV_onIdle() is called. It waits on a condition variable,
+* which atomically unlocks the mutex, just like WFI on Cortex-M wakes up with
+* interrupts still masked by PRIMASK. Any critical section executed by
+* another thread while the QV thread sleeps wakes it up (the equivalent of
+* "any interrupt ends WFI"), so events posted from the ticker thread or
+* from application threads are processed immediately. On return the mutex
+* is unlocked.
+*
+* NOTE2:
+* All QV "cycle" quantities (RTC budgets, load windows, EDF deadlines,
+* aging thresholds, ...) are in nanoseconds in this port.
+*
+* NOTE3:
+* With QF_EPOLL (see NOTE4 in qf_port.h), QV_CPU_SLEEP() waits in
+* epoll_wait() instead of on the condition variable, and QV_poll_() checks
+* the same descriptors without blocking after an RTC step, so that the I/O
+* and the clock tick are serviced even when the AOs never become idle.
+*
+* NOTE4:
+* With QF_SIM (see NOTE6 in qf_port.h), QV_CPU_SLEEP() does not wait,
+* but advances the virtual time to the next clock tick with an expiring
+* time event or to the next stimulus, and QV_CYCCNT_GET() returns the
+* virtual time in nanoseconds.
+*/
+
+#endif /* QV_PORT_H */
@@ -0,0 +1,408 @@
+/**
+* @file
+* @brief Shared-memory event transport between QF applications (POSIX)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#define _GNU_SOURCE /* syscall(), shm_open(), pthreads */
+
+/* This module is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+#include "qf_pkg.h"
+#include "qassert.h"
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+#include "qf_shm.h"
+
+#include <stdatomic.h>     /* C11 atomics */
+#include <string.h>        /* memcpy() */
+#include <errno.h>
+#include <fcntl.h>         /* O_* constants */
+#include <time.h>          /* nanosleep() */
+#include <unistd.h>        /* syscall(), ftruncate(), close() */
+#include <sys/mman.h>      /* shm_open(), mmap() */
+#include <sys/stat.h>      /* fstat() */
+#include <sys/syscall.h>   /* SYS_futex */
+#include <linux/futex.h>   /* FUTEX_WAIT, FUTEX_WAKE */
+
+Q_DEFINE_THIS_MODULE("qf_shm")
+
+#define QF_SHM_MAGIC  0x51534D31U /* "QSM1", set when the segment is ready */
+#define SLOT_HDR_     16U         /* slot header, keeps the event aligned */
+
+/* the shared header, the indices are on separate cache lines (the size
+* is a multiple of the cache line, so the slots start on a new line)
+*/
+typedef struct QFShmHdr {
+    atomic_uint magic;             /* QF_SHM_MAGIC when initialized */
+    uint32_t nSlots;               /* number of slots (power of 2) */
+    uint32_t slotSize;             /* size of one slot [bytes] */
+    uint32_t evtSize;              /* maximum size of an event [bytes] */
+    _Alignas(64) atomic_uint head; /* next slot to fill (the futex word) */
+    atomic_uint isWaiting;         /* the consumer sleeps on head */
+    atomic_uint nMin;              /* minimum number of free slots */
+    _Alignas(64) atomic_uint tail; /* next slot to deliver */
+} QFShmHdr;
+
+/* the header of each slot, followed by the event */
+typedef struct {
+    uint16_t size; /* size of the event [bytes] */
+    uint8_t dst;   /* priority of the AO to post to (0 to publish) */
+} SlotHdr;
+
+static QEvt *copy_(uint8_t const *const slot);
+static long futex_(atomic_uint *const addr, int const op, unsigned val,
+                   struct timespec const *const timeout);
+
+/****************************************************************************/
+bool QF_shmOpen(QFShm *const me, char const *const name,
+                uint_fast16_t const nSlots, uint_fast16_t const evtSize)
+{
+    struct stat st;
+    void *map;
+    int fd;
+
+    /** @pre the number of slots must be a power of 2 (or 0 to attach)
+    * and the event must fit a slot
+    */
+    Q_REQUIRE_ID(100, ((nSlots & (nSlots - 1U)) == 0U)
+                      && ((nSlots == 0U) || (evtSize >= sizeof(QEvt)))
+                      && (evtSize <= 0xFFF0U));
+
+    me->name = name;
+    me->isOwner = (nSlots != 0U);
+    if (me->isOwner) {
+        me->slotSize = (uint32_t)((SLOT_HDR_ + evtSize + 15U) & ~15U);
+        me->mapSize = sizeof(QFShmHdr) + ((size_t)nSlots * me->slotSize);
+
+        shm_unlink(name); /* remove a stale segment of a crashed process */
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        Q_ASSERT_ID(110, fd >= 0);
+        Q_ALLEGE_ID(120, ftruncate(fd, (off_t)me->mapSize) == 0);
+    }
+    else {
+        fd = shm_open(name, O_RDWR, 0);
+        if (fd < 0) {
+            Q_ASSERT_ID(130, errno == ENOENT);
+            return false; /* not created yet */
+        }
+        Q_ALLEGE_ID(140, fstat(fd, &st) == 0);
+        if ((size_t)st.st_size < sizeof(QFShmHdr)) { /* not sized yet? */
+            close(fd);
+            return false;
+        }
+        me->mapSize = (size_t)st.st_size;
+    }
+
+    map = mmap((void *)0, me->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+               fd, 0);
+    close(fd); /* the mapping keeps the segment */
+    Q_ASSERT_ID(150, map != MAP_FAILED);
+    me->hdr   = (QFShmHdr *)map;
+    me->slots = (uint8_t *)map + sizeof(QFShmHdr);
+
+    if (me->isOwner) {
+        me->hdr->nSlots   = (uint32_t)nSlots;
+        me->hdr->slotSize = me->slotSize;
+        me->hdr->evtSize  = (uint32_t)evtSize;
+        atomic_init(&me->hdr->head, 0U);
+        atomic_init(&me->hdr->tail, 0U);
+        atomic_init(&me->hdr->isWaiting, 0U);
+        atomic_init(&me->hdr->nMin, (unsigned)nSlots);
+        atomic_store_explicit(&me->hdr->magic, QF_SHM_MAGIC,
+                              memory_order_release);
+    }
+    else if (atomic_load_explicit(&me->hdr->magic, memory_order_acquire)
+             != QF_SHM_MAGIC)
+    {
+        munmap(map, me->mapSize); /* the creator is not done yet */
+        return false;
+    }
+    else {
+        me->slotSize = me->hdr->slotSize;
+        /* the segment must hold all the slots */
+        Q_ASSERT_ID(160, me->mapSize >= (sizeof(QFShmHdr)
+                         + ((size_t)me->hdr->nSlots * me->slotSize)));
+    }
+    me->mask    = me->hdr->nSlots - 1U;
+    me->evtSize = (uint16_t)me->hdr->evtSize;
+    pthread_mutex_init(&me->lock, (pthread_mutexattr_t *)0);
+    return true;
+}
+/*..........................................................................*/
+void QF_shmClose(QFShm *const me) {
+    munmap(me->hdr, me->mapSize);
+    if (me->isOwner) {
+        shm_unlink(me->name);
+    }
+    pthread_mutex_destroy(&me->lock);
+    me->hdr = (QFShmHdr *)0;
+}
+
+/****************************************************************************/
+/* NOTE: returns with the producer lock held, unless it returns NULL */
+QEvt *QF_shmNewX_(QFShm *const me, uint_fast16_t const evtSize,
+                  uint_fast16_t const margin, enum_t const sig)
+{
+    QFShmHdr *const hdr = me->hdr;
+    unsigned head;
+    unsigned nFree;
+    uint8_t *slot;
+    QEvt *e;
+
+    /** @pre the event must fit the slots of the channel */
+    Q_REQUIRE_ID(200, (sizeof(QEvt) <= evtSize) && (evtSize <= me->evtSize));
+
+    pthread_mutex_lock(&me->lock);
+    head  = atomic_load_explicit(&hdr->head, memory_order_relaxed);
+    nFree = hdr->nSlots - (head - atomic_load_explicit(&hdr->tail,
+                                      memory_order_acquire));
+
+    if ((margin == QF_NO_MARGIN) ? (nFree == 0U) : (nFree <= margin)) {
+        pthread_mutex_unlock(&me->lock);
+
+        /* assert if the event cannot be sent and dropping is not OK */
+        Q_ASSERT_ID(210, margin != QF_NO_MARGIN);
+        return (QEvt *)0;
+    }
+    if ((nFree - 1U) < (unsigned)atomic_load_explicit(&hdr->nMin,
+                                            memory_order_relaxed))
+    {
+        atomic_store_explicit(&hdr->nMin, nFree - 1U, memory_order_relaxed);
+    }
+
+    slot = &me->slots[(size_t)(head & me->mask) * me->slotSize];
+    ((SlotHdr *)slot)->size = (uint16_t)evtSize;
+    e = (QEvt *)&slot[SLOT_HDR_];
+    e->sig     = (QSignal)sig;
+    e->poolId_ = 0U;
+    e->refCtr_ = 0U;
+    return e;
+}
+/*..........................................................................*/
+void QF_shmCommit(QFShm *const me, uint_fast8_t const dst) {
+    QFShmHdr *const hdr = me->hdr;
+    unsigned const head = atomic_load_explicit(&hdr->head,
+                                               memory_order_relaxed);
+
+    ((SlotHdr *)&me->slots[(size_t)(head & me->mask) * me->slotSize])->dst
+        = (uint8_t)dst;
+
+    /* publish the slot, then check the consumer (pairs with QF_shmRecv()) */
+    atomic_store(&hdr->head, head + 1U);
+    if (atomic_load(&hdr->isWaiting) != 0U) {
+        (void)futex_(&hdr->head, FUTEX_WAKE, 1U, (struct timespec *)0);
+    }
+    pthread_mutex_unlock(&me->lock);
+}
+/*..........................................................................*/
+bool QF_shmPostX(QFShm *const me, QEvt const *const e,
+                 uint_fast16_t const evtSize, uint_fast8_t const dst,
+                 uint_fast16_t const margin)
+{
+    QEvt *const s = QF_shmNewX_(me, evtSize, margin, (enum_t)e->sig);
+
+    if (s == (QEvt *)0) {
+        return false;
+    }
+    memcpy((uint8_t *)s + sizeof(QEvt), (uint8_t const *)e + sizeof(QEvt),
+           evtSize - sizeof(QEvt));
+    QF_shmCommit(me, dst);
+    return true;
+}
+
+/****************************************************************************/
+uint_fast16_t QF_shmRecv(QFShm *const me, int_t const timeoutMs) {
+    QFShmHdr *const hdr = me->hdr;
+    unsigned tail = atomic_load_explicit(&hdr->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&hdr->head, memory_order_acquire);
+    uint_fast16_t n = 0U;
+
+    if ((head == tail) && (timeoutMs != 0)) { /* wait for an event? */
+        struct timespec ts;
+        ts.tv_sec  = (time_t)(timeoutMs / 1000);
+        ts.tv_nsec = (long)(timeoutMs % 1000) * 1000000L;
+
+        /* announce the sleep before the last check of the head, so that
+        * either the check sees the new event, or the producer sees the flag
+        */
+        atomic_store(&hdr->isWaiting, 1U);
+        head = atomic_load(&hdr->head);
+        if (head == tail) {
+            /* sleeps only while the head still equals tail */
+            (void)futex_(&hdr->head, FUTEX_WAIT, tail,
+                         (timeoutMs < 0) ? (struct timespec *)0 : &ts);
+        }
+        atomic_store_explicit(&hdr->isWaiting, 0U, memory_order_relaxed);
+        head = atomic_load_explicit(&hdr->head, memory_order_acquire);
+    }
+
+    for (; tail != head; ++tail, ++n) {
+        uint8_t const *const slot =
+            &me->slots[(size_t)(tail & me->mask) * me->slotSize];
+        SlotHdr const *const sh = (SlotHdr const *)slot;
+
+        if (sh->dst == 0U) {
+            QF_PUBLISH(copy_(slot), me);
+        }
+        else {
+            QActive *const act = QF_active_[sh->dst];
+
+            /* the destination AO must exist in this process */
+            Q_ASSERT_ID(300, act != (QActive *)0);
+
+            /* while the queue of the AO is full, the event stays in the
+            * channel, which pushes back on the producer, see NOTE1
+            */
+            while (!QACTIVE_POST_X(act, copy_(slot), 0U, me)) {
+                static struct timespec const backoff = {
+                    0, (long)QF_SHM_BACKOFF_NS
+                };
+                nanosleep(&backoff, (struct timespec *)0); /* let it run */
+            }
+        }
+
+        /* the event is delivered, give the slot back to the producer */
+        atomic_store_explicit(&hdr->tail, tail + 1U, memory_order_release);
+    }
+    return n;
+}
+/*..........................................................................*/
+uint_fast16_t QF_shmGetMin(QFShm const *const me) {
+    return (uint_fast16_t)atomic_load_explicit(&me->hdr->nMin,
+                                               memory_order_relaxed);
+}
+/*..........................................................................*/
+/* copy the event in the slot into a new dynamic event of this process */
+static QEvt *copy_(uint8_t const *const slot) {
+    SlotHdr const *const sh = (SlotHdr const *)slot;
+    QEvt const *const s = (QEvt const *)&slot[SLOT_HDR_];
+    QEvt *const e = QF_newX_((uint_fast16_t)sh->size, QF_NO_MARGIN,
+                             (enum_t)s->sig);
+
+    memcpy((uint8_t *)e + sizeof(QEvt), (uint8_t const *)s + sizeof(QEvt),
+           (size_t)sh->size - sizeof(QEvt));
+    return e;
+}
+/*..........................................................................*/
+static long futex_(atomic_uint *const addr, int const op, unsigned val,
+                   struct timespec const *const timeout)
+{
+    /* not FUTEX_PRIVATE_FLAG: the futex word is shared between processes */
+    return syscall(SYS_futex, (unsigned *)addr, op, val, timeout,
+                   (unsigned *)0, 0);
+}
+
+/****************************************************************************/
+#ifdef Q_SPY
+static void QShmProxy_init_(QHsm *const me, void const *par,
+                            uint_fast8_t const qs_id);
+static void QShmProxy_dispatch_(QHsm *const me, QEvt const *const e,
+                                uint_fast8_t const qs_id);
+#else
+static void QShmProxy_init_(QHsm *const me, void const *par);
+static void QShmProxy_dispatch_(QHsm *const me, QEvt const *const e);
+#endif
+
+/*..........................................................................*/
+void QShmProxy_ctor(QShmProxy *const me, QFShm *const shm,
+                    uint_fast8_t const dst)
+{
+    static QActiveVtable const vtable = { /* QActive virtual table */
+        { &QShmProxy_init_,
+          &QShmProxy_dispatch_
+#ifdef Q_SPY
+          ,&QHsm_getStateHandler_
+#endif
+        },
+        &QActive_start_,
+        &QActive_post_,
+        &QActive_postLIFO_
+    };
+    QActive_ctor(&me->super, Q_STATE_CAST(0)); /* superclass' ctor */
+    me->super.super.vptr = &vtable.super;      /* hook the vptr */
+    me->shm = shm;
+    me->dst = (uint8_t)dst;
+}
+/*..........................................................................*/
+#ifdef Q_SPY
+static void QShmProxy_init_(QHsm *const me, void const *par,
+                            uint_fast8_t const qs_id)
+#else
+static void QShmProxy_init_(QHsm *const me, void const *par)
+#endif
+{
+    (void)me;  /* unused parameter */
+    (void)par; /* unused parameter */
+#ifdef Q_SPY
+    (void)qs_id; /* unused parameter */
+#endif
+}
+/*..........................................................................*/
+#ifdef Q_SPY
+static void QShmProxy_dispatch_(QHsm *const me, QEvt const *const e,
+                                uint_fast8_t const qs_id)
+#else
+static void QShmProxy_dispatch_(QHsm *const me, QEvt const *const e)
+#endif
+{
+    QShmProxy *const proxy = (QShmProxy *)me;
+    uint_fast16_t evtSize = (uint_fast16_t)sizeof(QEvt);
+
+#ifdef Q_SPY
+    (void)qs_id; /* unused parameter */
+#endif
+
+    if (e->poolId_ != 0U) { /* dynamic event? see NOTE2 in qf_shm.h */
+        evtSize = QF_EPOOL_EVENT_SIZE_(QF_pool_[e->poolId_ - 1U]);
+        if (evtSize > proxy->shm->evtSize) {
+            evtSize = proxy->shm->evtSize;
+        }
+    }
+    /* while the channel is full, wait for the consumer, see NOTE2 */
+    while (!QF_shmPostX(proxy->shm, e, evtSize, (uint_fast8_t)proxy->dst,
+                        0U))
+    {
+        static struct timespec const backoff = {
+            0, (long)QF_SHM_BACKOFF_NS
+        };
+        nanosleep(&backoff, (struct timespec *)0);
+    }
+}
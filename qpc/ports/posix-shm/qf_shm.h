@@ -0,0 +1,165 @@
+/**
+* @file
+* @brief Shared-memory event transport between QF applications (POSIX)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#ifndef QF_SHM_H
+#define QF_SHM_H
+
+/* This header must be included after "qpc.h" of one of the POSIX ports
+* (posix, posix-qv or posix-ws), see NOTE1
+*/
+#if !defined(__STDC_VERSION__) || (__STDC_VERSION__ < 201112L)
+#error "qf_shm requires C11 atomics (compile with -std=c11)"
+#endif
+
+#include <stddef.h>  /* size_t */
+#include <pthread.h> /* POSIX-thread API */
+
+#ifndef QF_SHM_BACKOFF_NS
+/* sleep of QF_shmRecv() while the destination queue is full, see NOTE1 */
+#define QF_SHM_BACKOFF_NS    50000U
+#endif
+
+struct QFShmHdr; /* shared part of the channel, defined in qf_shm.c */
+
+/*! one-way event channel between two processes, see NOTE1 */
+typedef struct {
+    struct QFShmHdr *hdr;  /* shared header of the mapped segment */
+    uint8_t *slots;        /* shared slots of the mapped segment */
+    size_t mapSize;        /* size of the mapped segment [bytes] */
+    char const *name;      /* name of the segment (the creator unlinks it) */
+    pthread_mutex_t lock;  /* serializes the producers of this process */
+    uint32_t slotSize;     /* size of one slot [bytes] */
+    uint32_t mask;         /* number of slots - 1 */
+    uint16_t evtSize;      /* maximum size of an event [bytes] */
+    bool isOwner;          /* this process created the segment */
+} QFShm;
+
+/*! create (@p nSlots != 0) or attach to (@p nSlots == 0) a channel */
+bool QF_shmOpen(QFShm *const me, char const *const name,
+                uint_fast16_t const nSlots, uint_fast16_t const evtSize);
+
+/*! unmap the channel (and remove it, if this process created it) */
+void QF_shmClose(QFShm *const me);
+
+/*! allocate an event directly in the next free slot (producer) */
+QEvt *QF_shmNewX_(QFShm *const me, uint_fast16_t const evtSize,
+                  uint_fast16_t const margin, enum_t const sig);
+
+/*! send the event allocated by QF_shmNewX_() to @p dst (producer) */
+void QF_shmCommit(QFShm *const me, uint_fast8_t const dst);
+
+/*! copy a QP event into the channel and send it to @p dst (producer) */
+bool QF_shmPostX(QFShm *const me, QEvt const *const e,
+                 uint_fast16_t const evtSize, uint_fast8_t const dst,
+                 uint_fast16_t const margin);
+
+/*! deliver the received events to the AOs of this process (consumer) */
+uint_fast16_t QF_shmRecv(QFShm *const me, int_t const timeoutMs);
+
+/*! minimum number of free slots in the channel so far */
+uint_fast16_t QF_shmGetMin(QFShm const *const me);
+
+/*! allocate an event of type @p evtT_ in the channel (asserts if full) */
+#define Q_SHM_NEW(me_, evtT_, sig_) \
+    ((evtT_ *)QF_shmNewX_((me_), (uint_fast16_t)sizeof(evtT_), \
+                          QF_NO_MARGIN, (sig_)))
+
+/*! allocate an event of type @p evtT_ in the channel with a margin */
+#define Q_SHM_NEW_X(e_, me_, evtT_, margin_, sig_) \
+    ((e_) = (evtT_ *)QF_shmNewX_((me_), (uint_fast16_t)sizeof(evtT_), \
+                                 (margin_), (sig_)))
+
+/****************************************************************************/
+/*! proxy active object that forwards its events into a channel, see NOTE2 */
+typedef struct {
+    QActive super;  /* inherits ::QActive */
+    QFShm *shm;     /* the channel to forward the events to */
+    uint8_t dst;    /* priority of the remote AO (0 to publish remotely) */
+} QShmProxy;
+
+/*! constructor of the ::QShmProxy active object */
+void QShmProxy_ctor(QShmProxy *const me, QFShm *const shm,
+                    uint_fast8_t const dst);
+
+/*****************************************************************************
+* NOTE1:
+* A channel is a POSIX shared-memory segment (shm_open()/mmap()) holding a
+* single-producer/single-consumer ring of nSlots (a power of 2) slots of
+* evtSize bytes. One process creates it (nSlots != 0); the other attaches
+* to it (nSlots == 0), which returns false until the segment exists. One
+* process produces and the other consumes: a pair of channels connects two
+* processes both ways. Events are copied in place (the processes share the
+* event declarations), pointers inside the events are not meaningful in
+* the other process.
+*
+* The producer builds the event directly in the slot with Q_SHM_NEW() and
+* sends it with QF_shmCommit() (no copy on the producer side), or copies a
+* QP event with QF_shmPostX(). The threads of the producing process are
+* serialized by a process-local mutex, held from QF_shmNewX_() until
+* QF_shmCommit(). The consumer (one thread, e.g. a dedicated receive
+* thread, which is an "interrupt" for the posix-qv port) calls QF_shmRecv()
+* that waits on a futex on the head index of the ring while the channel is
+* empty, and delivers each event with the only copy: into an event from the
+* local event pools (Q_NEW()), posted to QF_active_[dst] or published when
+* dst == 0. The delivered events are ordinary dynamic events, so the
+* receiving AOs need no change. The producer issues the futex wake-up
+* system call only when the consumer actually sleeps.
+*
+* A slot is freed only after its event is delivered: while the queue of
+* the destination AO is full, QF_shmRecv() keeps the event in the channel
+* and retries every QF_SHM_BACKOFF_NS (sleeping, so that the AO can run
+* even on a single CPU), so a slow AO pushes back on the producing process
+* (published events are not flow-controlled: QF_publish_() asserts on
+* overflow). On the producer side, as for the AO queues, the margin
+* QF_NO_MARGIN asserts when the channel is full (size the channel with
+* QF_shmGetMin()), any other margin drops the event and returns
+* NULL/false.
+*
+* NOTE2:
+* QShmProxy is an active object of the producing process that stands for a
+* remote AO (or the remote publish-subscribe, dst == 0). The local AOs post
+* or publish events to the proxy (it subscribes like any AO), the proxy
+* forwards each event into the channel with QF_shmPostX(). While the
+* channel is full, the proxy retries every QF_SHM_BACKOFF_NS, so its own
+* queue fills up and the back-pressure reaches the local producers (with
+* the posix-qv port, the whole process waits for the consumer). The size
+* of a dynamic event is the block size of its pool, a static event is
+* forwarded as a plain QEvt; at most evtSize bytes of the channel are
+* copied, so the channel must fit the largest forwarded event.
+*/
+#endif /* QF_SHM_H */
@@ -0,0 +1,394 @@
+/**
+* @file
+* @brief QF/C port to POSIX, work-stealing pool of worker threads
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#define _POSIX_C_SOURCE 200809L /* clock_nanosleep(), sysconf(), pthreads */
+
+/* This QF port is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+#include "qf_pkg.h"
+#include "qassert.h"
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+#include <sched.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+Q_DEFINE_THIS_MODULE("qf_port")
+
+/* scheduling states of an AO (stored in QActive.osObject) */
+enum {
+    AO_IDLE,    /* event queue empty, not in any ready set */
+    AO_READY,   /* in the ready set of the worker QActive.thread */
+    AO_RUNNING  /* executing an RTC step on the worker QActive.thread */
+};
+
+/* worker thread */
+typedef struct {
+    QPSet readySet;      /* AOs ready to run on this worker */
+    pthread_cond_t cond; /* signalled when work may be available */
+    bool isIdle;         /* blocked on cond, waiting for work */
+    QFWorkerStat stat;   /* statistics */
+} QFWorker;
+
+/* Local objects ===========================================================*/
+static pthread_mutex_t l_pThreadMutex = PTHREAD_MUTEX_INITIALIZER;
+static QFWorker l_worker[QF_MAX_WORKERS];
+static uint_fast8_t l_nWorkers;   /* number of workers */
+static uint_fast8_t l_nIdle;      /* number of idle workers */
+static bool l_isRunning;          /* flag indicating when QF is running */
+static long l_tickNsec;           /* clock tick period [ns] */
+static int_t l_tickPrio;          /* SCHED_FIFO priority of the ticker */
+
+static struct termios l_tsav;  /* structure with saved terminal attributes */
+static bool l_console;         /* console set up for raw input */
+
+static void *worker_(void *arg);
+static QActive *take_(uint_fast8_t const w);
+static void wakeIdle_(void);
+
+/****************************************************************************/
+void QF_enterCriticalSection_(void) {
+    pthread_mutex_lock(&l_pThreadMutex);
+}
+/****************************************************************************/
+void QF_leaveCriticalSection_(void) {
+    pthread_mutex_unlock(&l_pThreadMutex);
+}
+
+/****************************************************************************/
+void QF_init(void) {
+    QF_maxPool_      = 0U;
+    QF_subscrList_   = (QSubscrList *)0;
+    QF_maxPubSignal_ = 0;
+#ifdef QF_PS_SPARSE
+    QF_subscrNum_ = 0U;
+#endif
+#if (QF_MAX_PS_GROUP > 0U)
+    QF_psGroupNum_ = 0U;
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    QF_psFilterNum_ = 0U;
+#endif
+
+    QF_bzero(&QF_timeEvtHead_[0], sizeof(QF_timeEvtHead_));
+    QF_bzero((void *)&QF_tickCtr_[0], sizeof(QF_tickCtr_));
+#ifdef QF_TMO_WHEEL_SIZE
+    QF_bzero(&QF_tmo_, sizeof(QF_tmo_));
+#endif
+    QF_bzero(&QF_active_[0], sizeof(QF_active_));
+
+    QF_bzero(&l_worker[0], sizeof(l_worker));
+    l_nIdle    = 0U;
+    l_nWorkers = 0U; /* default: one worker per online CPU */
+    l_tickNsec = 1000000000L / 100L; /* default clock tick 100 Hz */
+    l_tickPrio = 0;
+}
+
+/****************************************************************************/
+void QF_setWorkers(uint_fast8_t n) {
+    Q_REQUIRE_ID(300, (0U < n) && (n <= QF_MAX_WORKERS) && (!l_isRunning));
+    l_nWorkers = n;
+}
+/****************************************************************************/
+QFWorkerStat const *QF_getWorkerStat(uint_fast8_t n) {
+    Q_REQUIRE_ID(310, n < l_nWorkers);
+    return &l_worker[n].stat;
+}
+/****************************************************************************/
+void QF_setTickRate(uint32_t ticksPerSec, int_t tickPrio) {
+    Q_REQUIRE_ID(320, ticksPerSec != 0U);
+    l_tickNsec = (long)(1000000000U / ticksPerSec);
+    l_tickPrio = tickPrio;
+}
+
+/****************************************************************************/
+int_t QF_run(void) {
+    struct timespec next;
+    uint_fast8_t n;
+
+    QF_onStartup(); /* application-specific startup callback */
+
+    if (l_nWorkers == 0U) { /* number of workers not set? */
+        long const ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        l_nWorkers = (ncpu < 1) ? 1U
+                     : ((ncpu > (long)QF_MAX_WORKERS) ? QF_MAX_WORKERS
+                        : (uint_fast8_t)ncpu);
+    }
+
+    QF_enterCriticalSection_();
+    /* distribute the AOs over the workers (some may already be ready) */
+    for (n = 0U; n < QF_MAX_WORKERS; ++n) {
+        QPSet_setEmpty(&l_worker[n].readySet);
+    }
+    for (n = 1U; n <= QF_MAX_ACTIVE; ++n) {
+        QActive *const a = QF_active_[n];
+        if (a != (QActive *)0) {
+            a->thread = (uint8_t)(n % l_nWorkers);
+            if (a->osObject == (uint8_t)AO_READY) {
+                QPSet_insert(&l_worker[a->thread].readySet, n);
+            }
+        }
+    }
+    l_isRunning = true;
+    for (n = 0U; n < l_nWorkers; ++n) {
+        pthread_t thread;
+        pthread_cond_init(&l_worker[n].cond, (pthread_condattr_t *)0);
+        Q_ALLEGE_ID(330, pthread_create(&thread, (pthread_attr_t *)0,
+                                        &worker_, &l_worker[n]) == 0);
+        pthread_detach(thread);
+    }
+    QF_leaveCriticalSection_();
+
+    if (l_tickPrio > 0) { /* real-time priority requested for the ticker? */
+        struct sched_param param;
+        param.sched_priority = l_tickPrio;
+        /* NOTE: fails silently without the permission */
+        (void)pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    }
+
+    /* the clock tick loop... */
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (l_isRunning) {
+        next.tv_nsec += l_tickNsec;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            ++next.tv_sec;
+        }
+        /* sleep until the absolute deadline, so the tick does not drift */
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+                               &next, (struct timespec *)0) != 0) {
+        }
+        QF_onClockTick(); /* the "SysTick ISR" in the BSP */
+    }
+
+    QF_onCleanup(); /* invoke cleanup callback */
+
+    return 0; /* return success */
+}
+/****************************************************************************/
+void QF_stop(void) {
+    l_isRunning = false; /* stop the loop in QF_run() */
+}
+
+/****************************************************************************/
+void QActive_start_(QActive *const me, uint_fast8_t prio,
+                    QEvt const **const qSto, uint_fast16_t const qLen,
+                    void *const stkSto, uint_fast16_t const stkSize,
+                    void const *const par)
+{
+    (void)stkSize; /* unused parameter */
+
+    /** @pre the priority must be in range and the stack storage must not
+    * be provided, because the AOs run on the stacks of the workers
+    */
+    Q_REQUIRE_ID(600, (0U < prio) && (prio <= QF_MAX_ACTIVE)
+                      && (stkSto == (void *)0));
+
+    QEQueue_init(&me->eQueue, qSto, qLen);
+    me->osObject = (uint8_t)AO_IDLE;
+
+    /* initial affinity; an AO started while QF is running must get one of
+    * the running workers, because take_() steals only from those
+    */
+    QF_enterCriticalSection_();
+    me->thread = (uint8_t)(prio % (l_isRunning ? l_nWorkers
+                                               : QF_MAX_WORKERS));
+    QF_leaveCriticalSection_();
+
+    me->prio = (uint8_t)prio;
+    QF_add_(me); /* make QF aware of this active object */
+
+    QHSM_INIT(&me->super, par, me->prio); /* take the top-most initial tran. */
+    QS_FLUSH(); /* flush the trace buffer to the host */
+}
+
+/****************************************************************************/
+/* NOTE: called inside the critical section, when the event queue of the AO
+* becomes not empty
+*/
+void QF_wsReady_(QActive *const a) {
+    if (a->osObject == (uint8_t)AO_IDLE) { /* not ready or running yet? */
+        QFWorker *w;
+
+        w = &l_worker[a->thread];
+        a->osObject = (uint8_t)AO_READY;
+        QPSet_insert(&w->readySet, a->prio);
+
+        if (w->isIdle) { /* the affine worker waits for work? */
+            w->isIdle = false;
+            --l_nIdle;
+            pthread_cond_signal(&w->cond);
+        }
+        else if (l_nIdle != 0U) { /* let an idle worker steal the AO */
+            wakeIdle_();
+        }
+        else {
+            /* all workers busy, the AO waits in the ready set */
+        }
+    }
+}
+
+/****************************************************************************/
+static void *worker_(void *arg) { /* the expected P-Thread signature */
+    QFWorker *const me = (QFWorker *)arg;
+    uint_fast8_t const w = (uint_fast8_t)(me - &l_worker[0]);
+
+    QF_enterCriticalSection_();
+    for (;;) {
+        QActive *const a = take_(w);
+
+        if (a != (QActive *)0) {
+            QEvt const *e;
+
+            a->osObject = (uint8_t)AO_RUNNING;
+            a->thread   = (uint8_t)w; /* the AO now prefers this worker */
+            QF_leaveCriticalSection_();
+
+            e = QActive_get_(a); /* the queue is not empty, see NOTE4 */
+            QHSM_DISPATCH(&a->super, e, a->prio); /* dispatch to the AO */
+            QF_gc(e); /* check if the event is garbage, and collect it */
+
+            QF_enterCriticalSection_();
+            ++me->stat.nDispatch;
+            if (a->eQueue.frontEvt != (QEvt *)0) { /* more events? */
+                bool const busy = QPSet_notEmpty(&me->readySet);
+                a->osObject = (uint8_t)AO_READY;
+                QPSet_insert(&me->readySet, a->prio);
+                if (busy && (l_nIdle != 0U)) { /* more than one AO here? */
+                    wakeIdle_(); /* let an idle worker steal one */
+                }
+            }
+            else {
+                a->osObject = (uint8_t)AO_IDLE;
+            }
+        }
+        else { /* no work anywhere --> block until some AO becomes ready */
+            ++me->stat.nSleep;
+            me->isIdle = true;
+            ++l_nIdle;
+            while (me->isIdle) {
+                pthread_cond_wait(&me->cond, &l_pThreadMutex);
+            }
+        }
+    }
+    return (void *)0; /* not reached */
+}
+
+/****************************************************************************/
+/* NOTE: called inside the critical section */
+static QActive *take_(uint_fast8_t const w) {
+    QActive *a = (QActive *)0;
+    uint_fast8_t p;
+
+    if (QPSet_notEmpty(&l_worker[w].readySet)) { /* own work first */
+        QPSet_findMax(&l_worker[w].readySet, p);
+        QPSet_remove(&l_worker[w].readySet, p);
+        a = QF_active_[p];
+    }
+    else { /* steal the highest-priority AO of another worker */
+        uint_fast8_t k;
+        for (k = 1U; k < l_nWorkers; ++k) {
+            uint_fast8_t v = w + k;
+            if (v >= l_nWorkers) {
+                v -= l_nWorkers;
+            }
+            if (QPSet_notEmpty(&l_worker[v].readySet)) {
+                QPSet_findMax(&l_worker[v].readySet, p);
+                QPSet_remove(&l_worker[v].readySet, p);
+                a = QF_active_[p];
+                ++l_worker[w].stat.nSteal;
+                break;
+            }
+        }
+    }
+
+    /* the AO must be ready, so it cannot run on another worker */
+    Q_ASSERT_ID(400, (a == (QActive *)0)
+                     || (a->osObject == (uint8_t)AO_READY));
+    return a;
+}
+
+/****************************************************************************/
+/* NOTE: called inside the critical section with l_nIdle != 0 */
+static void wakeIdle_(void) {
+    uint_fast8_t n;
+    for (n = 0U; n < l_nWorkers; ++n) {
+        if (l_worker[n].isIdle) {
+            l_worker[n].isIdle = false;
+            --l_nIdle;
+            pthread_cond_signal(&l_worker[n].cond);
+            break;
+        }
+    }
+}
+
+/****************************************************************************/
+void QF_consoleSetup(void) {
+    if (isatty(STDIN_FILENO)) {
+        struct termios tio;
+        tcgetattr(STDIN_FILENO, &l_tsav);
+        tio = l_tsav;
+        tio.c_lflag &= ~(ICANON | ECHO); /* no line buffering, no echo */
+        tio.c_cc[VMIN]  = 0U; /* non-blocking reads */
+        tio.c_cc[VTIME] = 0U;
+        tcsetattr(STDIN_FILENO, TCSANOW, &tio);
+        l_console = true;
+    }
+}
+/****************************************************************************/
+void QF_consoleCleanup(void) {
+    if (l_console) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &l_tsav);
+        l_console = false;
+    }
+}
+/****************************************************************************/
+int QF_consoleGetKey(void) {
+    char ch;
+    if (l_console && (read(STDIN_FILENO, &ch, 1U) == 1)) {
+        return (int)(unsigned char)ch;
+    }
+    return 0; /* no input at this time */
+}
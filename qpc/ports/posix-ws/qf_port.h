@@ -0,0 +1,165 @@
+/**
+* @file
+* @brief QF/C port to POSIX, work-stealing pool of worker threads
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#ifndef QF_PORT_H
+#define QF_PORT_H
+
+/* POSIX work-stealing event queue and scheduling attributes, see NOTE1 */
+#define QF_EQUEUE_TYPE       QEQueue
+#define QF_OS_OBJECT_TYPE    uint8_t
+#define QF_THREAD_TYPE       uint8_t
+
+/* The maximum number of active objects in the application */
+#define QF_MAX_ACTIVE        64U
+
+/* The maximum number of system clock tick rates */
+#define QF_MAX_TICK_RATE     2U
+
+/* The maximum number of worker threads */
+#ifndef QF_MAX_WORKERS
+#define QF_MAX_WORKERS       16U
+#endif
+
+/* QF critical section entry/exit for POSIX, see NOTE2 */
+/*#define QF_CRIT_STAT_TYPE not defined */
+#define QF_CRIT_ENTRY(dummy) QF_enterCriticalSection_()
+#define QF_CRIT_EXIT(dummy)  QF_leaveCriticalSection_()
+
+/* "interrupt" disabling is the same as the critical section */
+#define QF_INT_DISABLE()     QF_enterCriticalSection_()
+#define QF_INT_ENABLE()      QF_leaveCriticalSection_()
+
+/* GCC/Clang builtin for fast LOG2 */
+#define QF_LOG2(n_) ((uint_fast8_t)(32U - __builtin_clz((unsigned)(n_))))
+
+#include <pthread.h>  /* POSIX-thread API */
+#include "qep_port.h" /* QEP port */
+#include "qequeue.h"  /* this port uses the native QF event queue */
+#include "qmpool.h"   /* this port uses the native QF memory pool */
+#include "qpset.h"    /* this port uses the native QF priority set */
+#include "qf.h"       /* QF platform-independent public interface */
+
+/* enter/leave the critical section (lock/unlock the global mutex) */
+void QF_enterCriticalSection_(void);
+void QF_leaveCriticalSection_(void);
+
+/* set the clock tick rate and the priority of the ticker, see NOTE3 */
+void QF_setTickRate(uint32_t ticksPerSec, int_t tickPrio);
+
+/* clock tick callback (implemented in the BSP), see NOTE3 */
+void QF_onClockTick(void);
+
+/* set the number of worker threads (before QF_run() starts them) */
+void QF_setWorkers(uint_fast8_t n);
+
+/* statistics of one worker thread, see QF_getWorkerStat() */
+typedef struct {
+    uint32_t nDispatch; /* RTC steps executed by the worker */
+    uint32_t nSteal;    /* AOs taken from the ready sets of other workers */
+    uint32_t nSleep;    /* times the worker found no work and blocked */
+} QFWorkerStat;
+
+/* statistics of the worker thread n (0..number of workers - 1) */
+QFWorkerStat const *QF_getWorkerStat(uint_fast8_t n);
+
+/* abstractions for console access... */
+void QF_consoleSetup(void);
+void QF_consoleCleanup(void);
+int QF_consoleGetKey(void);
+
+/****************************************************************************/
+/* interface used only inside QF, but not in applications */
+#ifdef QP_IMPL
+
+    /* scheduler locking (not needed in this port) */
+    #define QF_SCHED_STAT_
+    #define QF_SCHED_LOCK_(dummy) ((void)0)
+    #define QF_SCHED_UNLOCK_()    ((void)0)
+
+    /* native QF event queue operations, see NOTE4 */
+    #define QACTIVE_EQUEUE_WAIT_(me_) \
+        Q_ASSERT_ID(110, (me_)->eQueue.frontEvt != (QEvt *)0)
+
+    #define QACTIVE_EQUEUE_SIGNAL_(me_) QF_wsReady_((me_))
+
+    /* native QF event pool operations */
+    #define QF_EPOOL_TYPE_            QMPool
+    #define QF_EPOOL_INIT_(p_, poolSto_, poolSize_, evtSize_) \
+        (QMPool_init(&(p_), (poolSto_), (poolSize_), (evtSize_)))
+    #define QF_EPOOL_EVENT_SIZE_(p_)  ((uint_fast16_t)(p_).blockSize)
+    #define QF_EPOOL_GET_(p_, e_, m_, qs_id_) \
+        ((e_) = (QEvt *)QMPool_get(&(p_), (m_), (qs_id_)))
+    #define QF_EPOOL_PUT_(p_, e_, qs_id_) \
+        (QMPool_put(&(p_), (e_), (qs_id_)))
+
+    /* make the AO ready to run on a worker (inside the critical section) */
+    void QF_wsReady_(QActive *const a);
+
+#endif /* QP_IMPL */
+
+/*****************************************************************************
+* NOTE1:
+* The active objects do not have their own threads. A fixed pool of worker
+* threads (QF_setWorkers(), by default one per online CPU) executes the RTC
+* steps of all AOs. The osObject member holds the scheduling state of the
+* AO (idle, ready or running) and the thread member the index of the worker
+* that the AO is queued on, or ran on last (affinity). An AO is in at most
+* one ready set and never while it runs, so one AO is never dispatched
+* concurrently by two workers.
+*
+* Every worker has its own ready set (a QPSet, so the highest QActive.prio
+* is taken first). A worker that runs out of work steals the highest-
+* priority AO from the ready set of another worker, and blocks only when
+* all ready sets are empty.
+*
+* NOTE2:
+* All QF critical sections, including the ready sets of the workers, are
+* protected by one global mutex. The state machines run outside of it.
+*
+* NOTE3:
+* QF_run() starts the workers and executes the clock tick loop in the
+* calling (main) thread: it sleeps until an absolute CLOCK_MONOTONIC
+* deadline (no drift) and calls QF_onClockTick(), which plays the role of
+* the SysTick ISR in the BSP. QF_run() returns after QF_stop() is called.
+*
+* NOTE4:
+* QActive_get_() is only called by a worker for an AO that is ready, so
+* the event queue can never be empty at this point.
+*/
+
+#endif /* QF_PORT_H */
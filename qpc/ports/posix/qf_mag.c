@@ -0,0 +1,215 @@
+/**
+* @file
+* @brief Thread-local caches of the event pools (POSIX port)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#define _POSIX_C_SOURCE 200809L /* pthreads */
+
+/* This QF port is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+#include "qf_pkg.h"
+#include "qassert.h"
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+#ifdef QF_POOL_MAG /* see NOTE6 in qf_port.h */
+
+Q_DEFINE_THIS_MODULE("qf_mag")
+
+/* magazine: the free blocks of one event pool cached by one thread */
+typedef struct {
+    void *blk[QF_POOL_MAG]; /* the cached blocks (used as a stack) */
+    uint_fast16_t n;        /* number of cached blocks */
+    uint_fast16_t batch;    /* blocks moved in one refill/flush */
+} QFMag;
+
+/* Local objects ===========================================================*/
+static __thread QFMag l_mag[QF_MAX_EPOOL]; /* magazines of this thread */
+static __thread bool l_isReg;  /* thread registered for the flush at exit */
+static pthread_key_t l_magKey; /* key with the destructor flushing the cache */
+static pthread_once_t l_magOnce = PTHREAD_ONCE_INIT;
+
+static QFMag *mag_(QMPool const *const pool);
+static void reg_(void);
+static void flush_(QMPool *const pool, QFMag *const mag,
+                   uint_fast16_t const k);
+
+/****************************************************************************/
+void *QF_magGet_(QMPool *const pool, uint_fast16_t const margin) {
+    QFMag *const mag = mag_(pool);
+
+    if (mag->n == 0U) { /* magazine empty? refill it from the pool */
+        QMPoolCtr nFree;
+        QF_CRIT_STAT_
+
+        if (!l_isReg) {
+            reg_();
+        }
+
+        QF_CRIT_E_();
+        nFree = pool->nFree;
+        if (nFree > (QMPoolCtr)margin) { /* enough blocks above margin? */
+            uint_fast16_t k = (uint_fast16_t)(nFree - (QMPoolCtr)margin);
+            if (k > mag->batch) {
+                k = mag->batch; /* take one batch at most */
+            }
+
+            /* the cached blocks count as used, so nMin can only be lower
+            * than the true minimum of the free blocks (conservative)
+            */
+            nFree -= (QMPoolCtr)k;
+            pool->nFree = nFree;
+            if (pool->nMin > nFree) {
+                pool->nMin = nFree;
+            }
+
+            for (; mag->n < k; ++mag->n) {
+                QFreeBlock *const fb = (QFreeBlock *)pool->free_head;
+
+                /* the pool must have this many free blocks */
+                Q_ASSERT_CRIT_(310, (fb != (QFreeBlock *)0)
+                       && QF_PTR_RANGE_((void *)fb, pool->start, pool->end));
+
+                pool->free_head = fb->next;
+                mag->blk[mag->n] = fb;
+            }
+        }
+        QF_CRIT_X_();
+
+        if (mag->n == 0U) {
+            return (void *)0; /* not enough free blocks */
+        }
+    }
+
+    --mag->n;
+    return mag->blk[mag->n];
+}
+/****************************************************************************/
+void QF_magPut_(QMPool *const pool, void *const b) {
+    QFMag *const mag = mag_(pool);
+
+    /** @pre the block must belong to the pool */
+    Q_REQUIRE_ID(200, QF_PTR_RANGE_(b, pool->start, pool->end));
+
+    if (!l_isReg) {
+        reg_();
+    }
+    if (mag->n == (2U * mag->batch)) { /* magazine full? */
+        flush_(pool, mag, mag->batch); /* return half of it */
+    }
+    mag->blk[mag->n] = b;
+    ++mag->n;
+}
+/****************************************************************************/
+void QF_poolFlushCache(void) {
+    uint_fast8_t i;
+    for (i = 0U; i < QF_maxPool_; ++i) {
+        if (l_mag[i].n != 0U) {
+            flush_(&QF_pool_[i], &l_mag[i], l_mag[i].n);
+        }
+    }
+}
+
+/****************************************************************************/
+static QFMag *mag_(QMPool const *const pool) {
+    uint_fast8_t const idx = (uint_fast8_t)(pool - &QF_pool_[0]);
+    QFMag *const mag = &l_mag[idx];
+
+    /** @pre the pool must be one of the event pools */
+    Q_REQUIRE_ID(100, idx < QF_maxPool_);
+
+    if (mag->batch == 0U) { /* first use of the pool in this thread? */
+        /* a small pool gets a small magazine, so that few blocks are
+        * stranded in the caches of the other threads
+        */
+        mag->batch = (uint_fast16_t)(pool->nTot / 16U);
+        if (mag->batch == 0U) {
+            mag->batch = 1U;
+        }
+        else if (mag->batch > (QF_POOL_MAG / 2U)) {
+            mag->batch = QF_POOL_MAG / 2U;
+        }
+        else {
+            /* batch in range */
+        }
+    }
+    return mag;
+}
+/****************************************************************************/
+/* return the k most recently cached blocks to the pool */
+static void flush_(QMPool *const pool, QFMag *const mag,
+                   uint_fast16_t const k)
+{
+    uint_fast16_t i;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+
+    /* the pool cannot get more free blocks than it has */
+    Q_ASSERT_CRIT_(210, ((uint_fast32_t)pool->nFree + k)
+                        <= (uint_fast32_t)pool->nTot);
+
+    for (i = 0U; i < k; ++i) {
+        QFreeBlock *const fb = (QFreeBlock *)mag->blk[--mag->n];
+        fb->next = (QFreeBlock *)pool->free_head;
+        pool->free_head = fb;
+    }
+    pool->nFree += (QMPoolCtr)k;
+    QF_CRIT_X_();
+}
+/****************************************************************************/
+static void magExit_(void *arg) {
+    (void)arg; /* unused parameter */
+    QF_poolFlushCache(); /* the thread is exiting, return all its blocks */
+}
+/****************************************************************************/
+static void magKeyInit_(void) {
+    Q_ALLEGE_ID(400, pthread_key_create(&l_magKey, &magExit_) == 0);
+}
+/****************************************************************************/
+/* make sure the cache of this thread is flushed when the thread exits */
+static void reg_(void) {
+    pthread_once(&l_magOnce, &magKeyInit_);
+    pthread_setspecific(l_magKey, &l_mag[0]); /* any non-NULL value */
+    l_isReg = true;
+}
+
+#endif /* QF_POOL_MAG */
@@ -0,0 +1,377 @@
+/**
+* @file
+* @brief Lock-free MPSC event queue of the active objects (POSIX port)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#define _POSIX_C_SOURCE 200809L /* sched_yield(), pthreads */
+
+/* This QF port is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+#include "qf_pkg.h"
+#include "qassert.h"
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+#ifdef QF_MPSC_QUEUE /* see NOTE5 in qf_port.h */
+
+#include <sched.h>
+
+Q_DEFINE_THIS_MODULE("qf_mpsc")
+
+static bool reserve_(QFMpscQueue *const q, uint_fast16_t const margin,
+                     bool *const wasEmpty);
+static void put_(QFMpscQueue *const q, QEvt const *const e);
+static void publish_(QActive *const me, QEvt const *const e,
+                     bool const wasEmpty);
+
+/****************************************************************************/
+void QF_mpscInit_(QFMpscQueue *const q,
+                  QEvt const **const qSto, uint_fast16_t const qLen)
+{
+    uint_fast16_t i;
+
+    /* the atomic slots must have the layout of the event pointers */
+    Q_REQUIRE_ID(100, sizeof(QEvt const *_Atomic) == sizeof(QEvt const *));
+
+    if (qLen != 0U) {
+        q->ring = (QEvt const *_Atomic *)qSto;
+        q->end  = qLen;
+    }
+    else { /* no storage (QTicker), use the built-in slot */
+        q->ring = &q->one;
+        q->end  = 1U;
+    }
+    for (i = 0U; i < q->end; ++i) {
+        atomic_init(&q->ring[i], (QEvt const *)0);
+    }
+    /* start at end (not 0), so that tail - 1 never wraps, see postLIFO */
+    atomic_init(&q->head, (uint_least64_t)q->end);
+    q->tail = (uint_least64_t)q->end;
+    atomic_init(&q->nFree, q->end);
+    atomic_init(&q->nMin, q->end);
+    atomic_init(&q->nTicks, 0U);
+    atomic_init(&q->isWaiting, false);
+}
+
+/****************************************************************************/
+/* reserve one slot, keeping at least margin slots free (or asserting) */
+static bool reserve_(QFMpscQueue *const q, uint_fast16_t const margin,
+                     bool *const wasEmpty)
+{
+    uint_fast16_t nFree = atomic_load_explicit(&q->nFree,
+                                               memory_order_relaxed);
+    uint_fast16_t nMin;
+
+    do {
+        if ((margin == QF_NO_MARGIN) ? (nFree == 0U) : (nFree <= margin)) {
+            return false; /* cannot post */
+        }
+    } while (!atomic_compare_exchange_weak(&q->nFree, &nFree, nFree - 1U));
+
+    *wasEmpty = (nFree == q->end);
+
+    --nFree; /* the number of free slots after the reservation */
+    nMin = atomic_load_explicit(&q->nMin, memory_order_relaxed);
+    while ((nFree < nMin)
+           && !atomic_compare_exchange_weak_explicit(&q->nMin, &nMin, nFree,
+                  memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+    return true;
+}
+/****************************************************************************/
+/* put the event into the next slot (after a successful reservation) */
+static void put_(QFMpscQueue *const q, QEvt const *const e) {
+    uint_least64_t const seq = atomic_fetch_add_explicit(&q->head, 1U,
+                                   memory_order_relaxed);
+
+    /* the slot is free, because the reservation succeeded */
+    atomic_store_explicit(&q->ring[seq % q->end], e, memory_order_release);
+}
+/****************************************************************************/
+/* put the event into the queue and wake up the consumer if needed */
+static void publish_(QActive *const me, QEvt const *const e,
+                     bool const wasEmpty)
+{
+    put_(&me->eQueue, e);
+
+    /* the consumer can block only on the empty queue */
+    if (wasEmpty && atomic_load(&me->eQueue.isWaiting)) {
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+        pthread_cond_signal(&me->osObject);
+        QF_CRIT_X_();
+    }
+}
+
+/****************************************************************************/
+#ifndef Q_SPY
+bool QActive_post_(QActive *const me, QEvt const *const e,
+                   uint_fast16_t const margin)
+#else
+bool QActive_post_(QActive *const me, QEvt const *const e,
+                   uint_fast16_t const margin, void const *const sender)
+#endif
+{
+    bool wasEmpty;
+    bool status;
+
+#ifdef Q_SPY
+    (void)sender; /* unused parameter */
+#endif
+
+    /** @pre event pointer must be valid */
+    Q_REQUIRE_ID(200, e != (QEvt *)0);
+
+    if (e->poolId_ != 0U) { /* is it a dynamic event? */
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+        QF_EVT_REF_CTR_INC_(e); /* increment the reference counter */
+        QF_CRIT_X_();
+    }
+
+    status = reserve_(&me->eQueue, margin, &wasEmpty);
+    if (status) {
+        publish_(me, e, wasEmpty);
+    }
+    else {
+        /** @note assert if event cannot be posted and dropping events is
+        * not acceptable
+        */
+        Q_ASSERT_ID(210, margin != QF_NO_MARGIN);
+
+        QF_gc(e); /* recycle the event to avoid a leak */
+    }
+    return status;
+}
+/****************************************************************************/
+/* NOTE: called inside the critical section by QF_publish_() */
+#ifndef Q_SPY
+bool QActive_insertFIFO_(QActive *const me, QEvt const *const e)
+#else
+bool QActive_insertFIFO_(QActive *const me, QEvt const *const e,
+                         void const *const sender)
+#endif
+{
+    bool wasEmpty;
+
+#ifdef Q_SPY
+    (void)sender; /* unused parameter */
+#endif
+
+    /* the event must be posted (overflow is an error) */
+    Q_ALLEGE_ID(220, reserve_(&me->eQueue, QF_NO_MARGIN, &wasEmpty));
+
+    put_(&me->eQueue, e); /* the caller signals the consumer (if wasEmpty) */
+    return wasEmpty;
+}
+/****************************************************************************/
+/* NOTE: may only be called by the AO itself (e.g. in QActive_recall()) */
+void QActive_postLIFO_(QActive *const me, QEvt const *const e) {
+    QFMpscQueue *const q = &me->eQueue;
+    bool wasEmpty;
+
+    if (e->poolId_ != 0U) { /* is it a dynamic event? */
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+        QF_EVT_REF_CTR_INC_(e); /* increment the reference counter */
+        QF_CRIT_X_();
+    }
+
+    /* the queue must be able to accept the event (cannot overflow) */
+    Q_ALLEGE_ID(300, reserve_(q, QF_NO_MARGIN, &wasEmpty));
+
+    /* the slot before the tail is free: the AO has already taken the event
+    * from it and no producer can reach it while this slot is reserved
+    */
+    --q->tail;
+    atomic_store_explicit(&q->ring[q->tail % q->end], e,
+                          memory_order_release);
+}
+/****************************************************************************/
+QEvt const *QActive_get_(QActive *const me) {
+    QFMpscQueue *const q = &me->eQueue;
+    QEvt const *_Atomic *const slot = &q->ring[q->tail % q->end];
+    QEvt const *e;
+
+    if (atomic_load(&q->nFree) == q->end) { /* queue empty? */
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+        atomic_store(&q->isWaiting, true);
+        while (atomic_load(&q->nFree) == q->end) {
+            pthread_cond_wait(&me->osObject, &QF_pThreadMutex_);
+        }
+        atomic_store(&q->isWaiting, false);
+        QF_CRIT_X_();
+    }
+
+    /* the slot is reserved, but the producer might not have published the
+    * event yet (it was preempted in between)
+    */
+    for (e = atomic_load_explicit(slot, memory_order_acquire);
+         e == (QEvt *)0;
+         e = atomic_load_explicit(slot, memory_order_acquire))
+    {
+        sched_yield();
+    }
+    atomic_store_explicit(slot, (QEvt const *)0, memory_order_relaxed);
+    ++q->tail;
+    atomic_fetch_add_explicit(&q->nFree, 1U, memory_order_release);
+
+    /* a time event armed at absolute time has been taken from the queue:
+    * clear its "pending" flag, see QTimeEvt_armAtX()
+    */
+    if ((e->poolId_ == 0U) && ((e->refCtr_ & TE_IS_PENDING) != 0U)) {
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+        QF_EVT_CONST_CAST_(e)->refCtr_ &= (uint8_t)(~TE_IS_PENDING & 0xFFU);
+        QF_CRIT_X_();
+    }
+    return e;
+}
+/****************************************************************************/
+uint_fast16_t QF_getQueueMin(uint_fast8_t const prio) {
+    Q_REQUIRE_ID(400, (prio <= QF_MAX_ACTIVE)
+                      && (QF_active_[prio] != (QActive *)0));
+    return (uint_fast16_t)atomic_load_explicit(&QF_active_[prio]->eQueue.nMin,
+                                               memory_order_relaxed);
+}
+
+/****************************************************************************/
+#ifdef Q_SPY
+static void QTicker_init_(QHsm *const me, void const *par,
+                          uint_fast8_t const qs_id);
+static void QTicker_dispatch_(QHsm *const me, QEvt const *const e,
+                              uint_fast8_t const qs_id);
+static bool QTicker_post_(QActive *const me, QEvt const *const e,
+                          uint_fast16_t const margin, void const *const sender);
+#else
+static void QTicker_init_(QHsm *const me, void const *par);
+static void QTicker_dispatch_(QHsm *const me, QEvt const *const e);
+static bool QTicker_post_(QActive *const me, QEvt const *const e,
+                          uint_fast16_t const margin);
+#endif
+static void QTicker_postLIFO_(QActive *const me, QEvt const *const e);
+
+/*..........................................................................*/
+void QTicker_ctor(QTicker *const me, uint_fast8_t tickRate) {
+    static QActiveVtable const vtable = { /* QActive virtual table */
+        { &QTicker_init_,
+          &QTicker_dispatch_
+#ifdef Q_SPY
+          ,&QHsm_getStateHandler_
+#endif
+        },
+        &QActive_start_,
+        &QTicker_post_,
+        &QTicker_postLIFO_
+    };
+    QActive_ctor(&me->super, Q_STATE_CAST(0)); /* superclass' ctor */
+    me->super.super.vptr = &vtable.super;      /* hook the vptr */
+    me->super.eQueue.tickRate = (uint8_t)tickRate;
+}
+/*..........................................................................*/
+#ifdef Q_SPY
+static void QTicker_init_(QHsm *const me, void const *par,
+                          uint_fast8_t const qs_id)
+#else
+static void QTicker_init_(QHsm *const me, void const *par)
+#endif
+{
+    (void)par; /* unused parameter */
+#ifdef Q_SPY
+    (void)qs_id; /* unused parameter */
+#endif
+    atomic_store(&((QActive *)me)->eQueue.nTicks, 0U);
+}
+/*..........................................................................*/
+#ifdef Q_SPY
+static void QTicker_dispatch_(QHsm *const me, QEvt const *const e,
+                              uint_fast8_t const qs_id)
+#else
+static void QTicker_dispatch_(QHsm *const me, QEvt const *const e)
+#endif
+{
+    QFMpscQueue *const q = &((QActive *)me)->eQueue;
+    uint_fast16_t nTicks = atomic_exchange(&q->nTicks, 0U); /* # ticks */
+
+    (void)e; /* unused parameter */
+#ifdef Q_SPY
+    (void)qs_id; /* unused parameter */
+#endif
+
+    for (; nTicks > 0U; --nTicks) {
+        QF_TICK_X((uint_fast8_t)q->tickRate, me);
+    }
+}
+/*..........................................................................*/
+#ifndef Q_SPY
+static bool QTicker_post_(QActive *const me, QEvt const *const e,
+                          uint_fast16_t const margin)
+#else
+static bool QTicker_post_(QActive *const me, QEvt const *const e,
+                          uint_fast16_t const margin,
+                          void const *const sender)
+#endif
+{
+    (void)e;      /* unused parameter */
+    (void)margin; /* unused parameter */
+#ifdef Q_SPY
+    (void)sender; /* unused parameter */
+#endif
+
+    /* the first tick not processed yet posts the (only) tick event */
+    if (atomic_fetch_add(&me->eQueue.nTicks, 1U) == 0U) {
+        static QEvt const tickEvt = QEVT_INITIALIZER(0U);
+        bool wasEmpty;
+        Q_ALLEGE_ID(500, reserve_(&me->eQueue, QF_NO_MARGIN, &wasEmpty));
+        publish_(me, &tickEvt, wasEmpty);
+    }
+    return true; /* the event is always posted correctly */
+}
+/*..........................................................................*/
+static void QTicker_postLIFO_(QActive *const me, QEvt const *const e) {
+    (void)me; /* unused parameter */
+    (void)e;  /* unused parameter */
+    Q_ERROR_ID(510);
+}
+
+#endif /* QF_MPSC_QUEUE */
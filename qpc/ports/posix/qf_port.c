@@ -0,0 +1,261 @@
+/**
+* @file
+* @brief QF/C port to POSIX, thread per active object (multi-core)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#define _POSIX_C_SOURCE 200809L /* clock_nanosleep(), pthreads */
+
+/* This QF port is part of the internal QP implementation */
+#define QP_IMPL 1U
+#include "qf_port.h"
+#include "qf_pkg.h"
+#include "qassert.h"
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+#include <limits.h>   /* for PTHREAD_STACK_MIN */
+#include <sched.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+Q_DEFINE_THIS_MODULE("qf_port")
+
+/* Global objects ==========================================================*/
+pthread_mutex_t QF_pThreadMutex_ = PTHREAD_MUTEX_INITIALIZER;
+
+/* Local objects ===========================================================*/
+static pthread_mutex_t l_startupMutex = PTHREAD_MUTEX_INITIALIZER;
+static bool l_isRunning;       /* flag indicating when QF is running */
+static long l_tickNsec;        /* clock tick period [ns] */
+static int_t l_tickPrio;       /* SCHED_FIFO priority of the ticker */
+
+static struct termios l_tsav;  /* structure with saved terminal attributes */
+static bool l_console;         /* console set up for raw input */
+
+static void *thread_routine_(void *arg);
+
+/****************************************************************************/
+void QF_enterCriticalSection_(void) {
+    pthread_mutex_lock(&QF_pThreadMutex_);
+}
+/****************************************************************************/
+void QF_leaveCriticalSection_(void) {
+    pthread_mutex_unlock(&QF_pThreadMutex_);
+}
+
+/****************************************************************************/
+void QF_init(void) {
+    QF_maxPool_      = 0U;
+    QF_subscrList_   = (QSubscrList *)0;
+    QF_maxPubSignal_ = 0;
+#ifdef QF_PS_SPARSE
+    QF_subscrNum_ = 0U;
+#endif
+#if (QF_MAX_PS_GROUP > 0U)
+    QF_psGroupNum_ = 0U;
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    QF_psFilterNum_ = 0U;
+#endif
+
+    QF_bzero(&QF_timeEvtHead_[0], sizeof(QF_timeEvtHead_));
+    QF_bzero((void *)&QF_tickCtr_[0], sizeof(QF_tickCtr_));
+#ifdef QF_TMO_WHEEL_SIZE
+    QF_bzero(&QF_tmo_, sizeof(QF_tmo_));
+#endif
+    QF_bzero(&QF_active_[0], sizeof(QF_active_));
+
+    /* lock the startup mutex to block any active objects started before
+    * calling QF_run()
+    */
+    pthread_mutex_lock(&l_startupMutex);
+
+    l_tickNsec = 1000000000L / 100L; /* default clock tick 100 Hz */
+    l_tickPrio = 0;
+}
+
+/****************************************************************************/
+int_t QF_run(void) {
+    struct timespec next;
+
+    QF_onStartup(); /* application-specific startup callback */
+
+    if (l_tickPrio > 0) { /* real-time priority requested for the ticker? */
+        struct sched_param param;
+        param.sched_priority = l_tickPrio;
+        /* NOTE: fails silently without the permission */
+        (void)pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    }
+
+    /* release the startup mutex to unblock any active objects started so far
+    * (the AOs started from now on are not blocked by the startup mutex)
+    */
+    l_isRunning = true;
+    pthread_mutex_unlock(&l_startupMutex);
+
+    /* the clock tick loop... */
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (l_isRunning) {
+        next.tv_nsec += l_tickNsec;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            ++next.tv_sec;
+        }
+        /* sleep until the absolute deadline, so the tick does not drift */
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+                               &next, (struct timespec *)0) != 0) {
+        }
+        QF_onClockTick(); /* the "SysTick ISR" in the BSP */
+    }
+
+#ifdef QF_POOL_MAG
+    QF_poolFlushCache(); /* return the blocks cached by this thread */
+#endif
+    QF_onCleanup(); /* invoke cleanup callback */
+    pthread_mutex_destroy(&l_startupMutex);
+
+    return 0; /* return success */
+}
+/****************************************************************************/
+void QF_stop(void) {
+    l_isRunning = false; /* stop the loop in QF_run() */
+}
+/****************************************************************************/
+void QF_setTickRate(uint32_t ticksPerSec, int_t tickPrio) {
+    Q_REQUIRE_ID(300, ticksPerSec != 0U);
+    l_tickNsec = (long)(1000000000U / ticksPerSec);
+    l_tickPrio = tickPrio;
+}
+
+/****************************************************************************/
+static void *thread_routine_(void *arg) { /* the expected P-Thread signature */
+    QActive *act = (QActive *)arg;
+
+    /* block this thread until the startup mutex is unlocked from QF_run() */
+    pthread_mutex_lock(&l_startupMutex);
+    pthread_mutex_unlock(&l_startupMutex);
+
+    /* the event-loop of the active object thread */
+    while (act->thread != 0U) { /* not stopped, see QActive_stop() */
+        QEvt const *e = QActive_get_(act); /* wait for event */
+        QHSM_DISPATCH(&act->super, e, act->prio); /* dispatch to the AO's SM */
+        QF_gc(e); /* check if the event is garbage, and collect it if so */
+    }
+
+    QF_remove_(act); /* remove this object from QF */
+    pthread_cond_destroy(&act->osObject);
+    return (void *)0; /* return success */
+}
+
+/****************************************************************************/
+void QActive_start_(QActive *const me, uint_fast8_t prio,
+                    QEvt const **const qSto, uint_fast16_t const qLen,
+                    void *const stkSto, uint_fast16_t const stkSize,
+                    void const *const par)
+{
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    /** @pre the priority must be in range and the stack storage must not
+    * be provided, because the POSIX thread allocates its own stack
+    */
+    Q_REQUIRE_ID(600, (0U < prio) && (prio <= QF_MAX_ACTIVE)
+                      && (stkSto == (void *)0));
+
+#ifdef QF_MPSC_QUEUE
+    QF_mpscInit_(&me->eQueue, qSto, qLen); /* see NOTE5 in qf_port.h */
+#else
+    QEQueue_init(&me->eQueue, qSto, qLen);
+#endif
+    pthread_cond_init(&me->osObject, (pthread_condattr_t *)0);
+
+    me->prio = (uint8_t)prio;
+    QF_add_(me); /* make QF aware of this active object */
+
+    QHSM_INIT(&me->super, par, me->prio); /* take the top-most initial tran. */
+    QS_FLUSH(); /* flush the trace buffer to the host */
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (stkSize != 0U) { /* stack size requested? */
+        pthread_attr_setstacksize(&attr,
+            (stkSize < PTHREAD_STACK_MIN) ? PTHREAD_STACK_MIN : stkSize);
+    }
+
+    me->thread = 1U; /* the thread is running, see QActive_stop() */
+    Q_ALLEGE_ID(610, pthread_create(&thread, &attr,
+                                    &thread_routine_, me) == 0);
+    pthread_attr_destroy(&attr);
+}
+/****************************************************************************/
+void QActive_stop(QActive *const me) {
+    QActive_unsubscribeAll(me); /* unsubscribe from all events */
+    me->thread = 0U; /* stop the thread loop (see thread_routine_()) */
+}
+
+/****************************************************************************/
+void QF_consoleSetup(void) {
+    if (isatty(STDIN_FILENO)) {
+        struct termios tio;
+        tcgetattr(STDIN_FILENO, &l_tsav);
+        tio = l_tsav;
+        tio.c_lflag &= ~(ICANON | ECHO); /* no line buffering, no echo */
+        tio.c_cc[VMIN]  = 0U; /* non-blocking reads */
+        tio.c_cc[VTIME] = 0U;
+        tcsetattr(STDIN_FILENO, TCSANOW, &tio);
+        l_console = true;
+    }
+}
+/****************************************************************************/
+void QF_consoleCleanup(void) {
+    if (l_console) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &l_tsav);
+        l_console = false;
+    }
+}
+/****************************************************************************/
+int QF_consoleGetKey(void) {
+    char ch;
+    if (l_console && (read(STDIN_FILENO, &ch, 1U) == 1)) {
+        return (int)(unsigned char)ch;
+    }
+    return 0; /* no input at this time */
+}
@@ -0,0 +1,249 @@
+/**
+* @file
+* @brief QF/C port to POSIX, thread per active object (multi-core)
+* @cond
+******************************************************************************
+* Last updated for version 6.9.3
+* Last updated on  2021-04-08
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <www.gnu.org/licenses/>.
+*
+* Contact information:
+* <www.state-machine.com/licensing>
+* <info@state-machine.com>
+******************************************************************************
+* @endcond
+*/
+#ifndef QF_PORT_H
+#define QF_PORT_H
+
+/* lock-free MPSC event queues of the active objects (opt-in), see NOTE5 */
+/*#define QF_MPSC_QUEUE*/
+
+/* thread-local caches (magazines) of the event pools (opt-in), see NOTE6
+* (the value is the capacity of one magazine)
+*/
+/*#define QF_POOL_MAG          16U*/
+
+#ifdef QF_POOL_MAG /* thread-local storage of the magazines */
+    #if !defined(__GNUC__)
+    #error "QF_POOL_MAG requires the __thread storage class (GCC or Clang)"
+    #endif
+#endif
+
+/* POSIX event queue and thread types, see NOTE1 */
+#ifdef QF_MPSC_QUEUE
+    #if !defined(__STDC_VERSION__) || (__STDC_VERSION__ < 201112L) \
+        || defined(__STDC_NO_ATOMICS__)
+    #error "QF_MPSC_QUEUE requires C11 atomics (compile with -std=c11)"
+    #endif
+    #define QF_EQUEUE_TYPE   QFMpscQueue
+#else
+    #define QF_EQUEUE_TYPE   QEQueue
+#endif
+#define QF_OS_OBJECT_TYPE    pthread_cond_t
+#define QF_THREAD_TYPE       uint8_t
+
+/* The maximum number of active objects in the application */
+#define QF_MAX_ACTIVE        64U
+
+/* The maximum number of system clock tick rates */
+#define QF_MAX_TICK_RATE     2U
+
+/* active objects can be stopped, see QActive_stop() */
+#define QF_ACTIVE_STOP       1
+
+/* QF critical section entry/exit for POSIX, see NOTE2 */
+/*#define QF_CRIT_STAT_TYPE not defined */
+#define QF_CRIT_ENTRY(dummy) QF_enterCriticalSection_()
+#define QF_CRIT_EXIT(dummy)  QF_leaveCriticalSection_()
+
+/* "interrupt" disabling is the same as the critical section */
+#define QF_INT_DISABLE()     QF_enterCriticalSection_()
+#define QF_INT_ENABLE()      QF_leaveCriticalSection_()
+
+/* GCC/Clang builtin for fast LOG2 */
+#define QF_LOG2(n_) ((uint_fast8_t)(32U - __builtin_clz((unsigned)(n_))))
+
+#include <pthread.h>  /* POSIX-thread API */
+#include "qep_port.h" /* QEP port */
+#include "qequeue.h"  /* POSIX port uses the native QF event queue */
+#include "qmpool.h"   /* POSIX port uses the native QF memory pool */
+#include "qpset.h"    /* POSIX port uses the native QF priority set */
+
+#ifdef QF_MPSC_QUEUE
+#include <stdatomic.h> /* C11 atomics */
+
+/* bounded lock-free multi-producer/single-consumer event queue, see NOTE5 */
+typedef struct {
+    QEvt const *_Atomic *ring;   /* ring buffer (qSto), NULL is a free slot */
+    QEvt const *_Atomic one;     /* the ring used when qLen == 0 (QTicker) */
+    atomic_uint_least64_t head;  /* sequence number of the next producer */
+    uint_least64_t tail;         /* sequence number of the next event */
+    atomic_uint_fast16_t nFree;  /* number of free slots */
+    atomic_uint_fast16_t nMin;   /* minimum number of free slots so far */
+    atomic_uint_fast16_t nTicks; /* ticks not processed yet (QTicker only) */
+    atomic_bool isWaiting;       /* consumer blocked on the empty queue */
+    uint_fast16_t end;           /* number of slots in the ring */
+    uint8_t tickRate;            /* tick rate (QTicker only) */
+} QFMpscQueue;
+#endif /* QF_MPSC_QUEUE */
+
+#include "qf.h"       /* QF platform-independent public interface */
+
+/* enter/leave the critical section (lock/unlock the global mutex) */
+void QF_enterCriticalSection_(void);
+void QF_leaveCriticalSection_(void);
+
+/* set the clock tick rate and the priority of the ticker, see NOTE3 */
+void QF_setTickRate(uint32_t ticksPerSec, int_t tickPrio);
+
+/* clock tick callback (implemented in the BSP), see NOTE3 */
+void QF_onClockTick(void);
+
+#ifdef QF_POOL_MAG
+/* return the blocks cached by the calling thread to the event pools */
+void QF_poolFlushCache(void);
+#endif /* QF_POOL_MAG */
+
+/* abstractions for console access... */
+void QF_consoleSetup(void);
+void QF_consoleCleanup(void);
+int QF_consoleGetKey(void);
+
+/****************************************************************************/
+/* interface used only inside QF, but not in applications */
+#ifdef QP_IMPL
+
+    /* POSIX-specific scheduler locking (not needed in this port) */
+    #define QF_SCHED_STAT_
+    #define QF_SCHED_LOCK_(dummy) ((void)0)
+    #define QF_SCHED_UNLOCK_()    ((void)0)
+
+    /* native QF event queue operations, see NOTE4 */
+    #define QACTIVE_EQUEUE_WAIT_(me_)                                 \
+        while ((me_)->eQueue.frontEvt == (QEvt *)0) {                 \
+            pthread_cond_wait(&(me_)->osObject, &QF_pThreadMutex_);   \
+        }
+
+    #define QACTIVE_EQUEUE_SIGNAL_(me_) \
+        pthread_cond_signal(&(me_)->osObject)
+
+    /* native QF event pool operations */
+    #define QF_EPOOL_TYPE_            QMPool
+    #define QF_EPOOL_INIT_(p_, poolSto_, poolSize_, evtSize_) \
+        (QMPool_init(&(p_), (poolSto_), (poolSize_), (evtSize_)))
+    #define QF_EPOOL_EVENT_SIZE_(p_)  ((uint_fast16_t)(p_).blockSize)
+#ifdef QF_POOL_MAG
+    #define QF_EPOOL_GET_(p_, e_, m_, qs_id_) \
+        ((e_) = (QEvt *)QF_magGet_(&(p_), (m_)))
+    #define QF_EPOOL_PUT_(p_, e_, qs_id_) \
+        (QF_magPut_(&(p_), (e_)))
+
+    /* get/put a block through the magazine of the calling thread */
+    void *QF_magGet_(QMPool *const pool, uint_fast16_t const margin);
+    void QF_magPut_(QMPool *const pool, void *const b);
+#else
+    #define QF_EPOOL_GET_(p_, e_, m_, qs_id_) \
+        ((e_) = (QEvt *)QMPool_get(&(p_), (m_), (qs_id_)))
+    #define QF_EPOOL_PUT_(p_, e_, qs_id_) \
+        (QMPool_put(&(p_), (e_), (qs_id_)))
+#endif /* QF_POOL_MAG */
+
+    extern pthread_mutex_t QF_pThreadMutex_; /* mutex for QF critical section */
+
+#ifdef QF_MPSC_QUEUE
+    /* initialize the MPSC event queue of an AO (in QActive_start_()) */
+    void QF_mpscInit_(QFMpscQueue *const q,
+                      QEvt const **const qSto, uint_fast16_t const qLen);
+#endif /* QF_MPSC_QUEUE */
+
+#endif /* QP_IMPL */
+
+/*****************************************************************************
+* NOTE1:
+* Every active object executes in its own POSIX thread, which blocks on the
+* native QF event queue of the AO. The condition variable in osObject is
+* signalled when the queue becomes not empty. The thread member is used as
+* the "running" flag, which QActive_stop() clears to end the thread loop.
+* The AOs run truly in parallel on a multi-core CPU, while each AO still
+* processes its events in run-to-completion steps, one at a time.
+*
+* NOTE2:
+* All QF critical sections are protected by one global mutex (the same
+* mutex the AO threads use to wait on their condition variables), so the
+* event reference counters (QF_gc(), QF_publish_()), the event pools, the
+* time events and the subscriber lists are all thread-safe without changes
+* to the platform-independent code. The critical sections are short and
+* the state machines execute outside of them, so the AOs scale with the
+* number of cores as long as their RTC steps dominate the framework time.
+*
+* NOTE3:
+* QF_run() executes the clock tick loop in the calling (main) thread: it
+* sleeps until an absolute CLOCK_MONOTONIC deadline (no drift) and calls
+* QF_onClockTick(), which plays the role of the SysTick ISR in the BSP.
+* QF_run() returns after QF_stop() is called. The tickPrio parameter of
+* QF_setTickRate() requests the SCHED_FIFO priority for the main thread
+* (0 means the default policy); without the permission for real-time
+* scheduling, the default policy is used silently.
+*
+* NOTE4:
+* QACTIVE_EQUEUE_WAIT_() is called inside the critical section, so
+* pthread_cond_wait() atomically releases the global mutex while the AO
+* thread is blocked and re-acquires it before returning.
+*
+* NOTE5:
+* With QF_MPSC_QUEUE defined (e.g. -DQF_MPSC_QUEUE -std=c11), qf_mpsc.c
+* replaces the native AO event queue (qf_actq.c compiles to nothing), so
+* posting does not serialize the producers on the global mutex. The queue
+* is a bounded ring of qLen slots (1 slot for qLen == 0) stored in qSto:
+* a producer reserves a slot by decrementing nFree with CAS (which is also
+* the overflow/margin test), takes the next sequence number from head and
+* publishes the event into the slot (seq % qLen). The consumer (the AO
+* thread) takes the events in sequence order and frees the slots. The
+* mutex is still used to block the consumer on the empty queue, to wake it
+* up (only if it actually blocks) and to increment the reference counter
+* of dynamic events (which QF_gc() decrements under the same mutex).
+* QACTIVE_POST_LIFO() (QActive_recall()) may only be used by the AO
+* itself; it puts the event in front of the queue, before the tail.
+*
+* NOTE6:
+* With QF_POOL_MAG defined, qf_mag.c puts a per-thread cache (magazine of
+* QF_POOL_MAG blocks) in front of every event pool. Q_NEW() takes a block
+* from the magazine of the calling thread and QF_gc() returns it there,
+* without the global mutex. An empty magazine is refilled with one batch
+* of blocks and a full magazine (two batches) returns one batch to the
+* pool, each in one critical section. The batch is 1/16 of the pool
+* (1..QF_POOL_MAG/2 blocks). The blocks in the magazines count as used in
+* the pool, so:
+* - the pools must be larger by up to two batches per thread;
+* - the margin of Q_NEW_X() is only checked when the magazine is refilled;
+* - QF_getPoolMin() is conservative: it can be lower than the true minimum
+*   by the number of blocks cached in the magazines at that time.
+* A thread returns its blocks when it exits (also after QActive_stop()),
+* QF_run() before returning, or any thread by calling QF_poolFlushCache().
+*/
+
+#endif /* QF_PORT_H */
@@ -67,10 +67,10 @@ enum {
  * 用于执行入口动作, 退出动作和初始转换.
  */
 static QEvt const QEP_reservedEvt_[] = {
-    {(QSignal)QEP_EMPTY_SIG_, 0U, 0U},
-    {(QSignal)Q_ENTRY_SIG, 0U, 0U},
-    {(QSignal)Q_EXIT_SIG, 0U, 0U},
-    {(QSignal)Q_INIT_SIG, 0U, 0U}};
+    QEVT_INITIALIZER(QEP_EMPTY_SIG_),
+    QEVT_INITIALIZER(Q_ENTRY_SIG),
+    QEVT_INITIALIZER(Q_EXIT_SIG),
+    QEVT_INITIALIZER(Q_INIT_SIG)};
 
 /** 在一个状态转换函数中执行 保留事件动作
  *	QEP_TRIG_(me->temp.fun, QEP_EMPTY_SIG_)
@@ -51,7 +51,42 @@
 Q_DEFINE_THIS_MODULE("qf_act")
 
 /* public objects ***********************************************************/
+#ifndef QF_CONTEXT
 QActive *QF_active_[QF_MAX_ACTIVE + 1U]; /* 仅供 QF 移植层使用 */
+#else
+static QFContext l_ctxSto[QF_MAX_CONTEXT]; /* 上下文存储, [0] 为默认上下文 */
+static uint_fast8_t l_ctxNum = 1U;         /* 已分配的上下文数 */
+QF_THREAD_LOCAL QFContext *QF_ctx_ = &l_ctxSto[0];
+
+/****************************************************************************/
+/**
+ * @description
+ * 上下文从静态存储中按顺序分配, 内容已清零 (QF_init() 会再次初始化).
+ *
+ * @note 应该在启动节点线程之前, 在一个线程中依次分配所有上下文.
+ */
+QFContext *QF_ctxNew(void)
+{
+    /** @pre 上下文数量不得超过 #QF_MAX_CONTEXT */
+    Q_REQUIRE_ID(300, l_ctxNum < QF_MAX_CONTEXT);
+    ++l_ctxNum;
+    return &l_ctxSto[l_ctxNum - 1U];
+}
+
+/****************************************************************************/
+void QF_ctxSet(QFContext *const ctx)
+{
+    /** @pre 上下文必须由 QF_ctxNew() 分配 (或者是默认上下文) */
+    Q_REQUIRE_ID(310, (&l_ctxSto[0] <= ctx) && (ctx < &l_ctxSto[l_ctxNum]));
+    QF_ctx_ = ctx;
+}
+
+/****************************************************************************/
+QFContext *QF_ctxGet(void)
+{
+    return QF_ctx_;
+}
+#endif /* QF_CONTEXT */
 
 /****************************************************************************/
 /**
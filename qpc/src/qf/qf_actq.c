@@ -53,6 +53,9 @@
 #include "qs_dummy.h" /* disable the QS software tracing */
 #endif                /* Q_SPY */
 
+/* 移植层提供了自己的活动对象事件队列 (例如 POSIX 移植的 QF_MPSC_QUEUE)? */
+#ifndef QF_MPSC_QUEUE
+
 Q_DEFINE_THIS_MODULE("qf_actq")
 
 /****************************************************************************/
@@ -146,6 +149,9 @@ bool QActive_post_(QActive *const me, QEvt const *const e,
         }
 #endif
 
+#ifdef QV_EDF
+        QV_edfPut_(me, e); /* 记录事件的截止期限 */
+#endif
         /* empty queue? */
         if (me->eQueue.frontEvt == (QEvt *)0) {
             me->eQueue.frontEvt = e;    /* 直接投递事件 */
@@ -191,6 +197,73 @@ bool QActive_post_(QActive *const me, QEvt const *const e,
     return status;
 }
 
+/****************************************************************************/
+/**
+ * @brief
+ * QF_publish_() 多播快速路径使用的内部函数: 将事件按 FIFO 策略插入
+ * 活动对象 @p me 的原生事件队列. 与 QActive_post_() 不同, 该函数
+ * 必须在临界区内调用, 不增加事件的引用计数, 也不发出就绪信号,
+ * 这些都由调用者对所有订阅者一次性完成.
+ *
+ * @param[in,out] me     指针
+ * @param[in]     e      指向要插入的事件的指针
+ * @param[in]     sender 发送者 (发布者) 对象, 仅用于 QS 跟踪
+ *
+ * @returns
+ * 'true' 表示插入前队列为空, 调用者需要将 @p me 标记为就绪.
+ *
+ * @note
+ * 与 QACTIVE_POST() 相同, 队列溢出时触发断言.
+ */
+#ifdef Q_SPY
+bool QActive_insertFIFO_(QActive *const me, QEvt const *const e,
+                         void const *const sender)
+#else
+bool QActive_insertFIFO_(QActive *const me, QEvt const *const e)
+#endif
+{
+    QEQueueCtr nFree = me->eQueue.nFree; /* 将 volatile 变量复制到临时变量 */
+    bool wasEmpty;
+
+    /* 必须能够投递事件 */
+    Q_ASSERT_CRIT_(120, nFree > 0U);
+
+    --nFree;                  /* 占用一个空闲槽 */
+    me->eQueue.nFree = nFree; /* 更新 volatile 变量 */
+    if (me->eQueue.nMin > nFree) {
+        me->eQueue.nMin = nFree; /* 更新迄今最小空闲槽数 */
+    }
+
+    QS_BEGIN_NOCRIT_PRE_(QS_QF_ACTIVE_POST, me->prio)
+    QS_TIME_PRE_();                      /* 时间戳 */
+    QS_OBJ_PRE_(sender);                 /* 发送者对象 */
+    QS_SIG_PRE_(e->sig);                 /* 事件信号 */
+    QS_OBJ_PRE_(me);                     /* 接收者 AO 对象 */
+    QS_2U8_PRE_(e->poolId_, e->refCtr_); /* 池 ID 和引用计数 */
+    QS_EQC_PRE_(nFree);                  /* 当前空闲槽数 */
+    QS_EQC_PRE_(me->eQueue.nMin);        /* 历史最小空闲槽数 */
+    QS_END_NOCRIT_PRE_()
+
+#ifdef QV_EDF
+    QV_edfPut_(me, e); /* 记录事件的截止期限 */
+#endif
+    /* empty queue? */
+    if (me->eQueue.frontEvt == (QEvt *)0) {
+        me->eQueue.frontEvt = e; /* 直接投递事件 */
+        wasEmpty            = true;
+    } else {
+        /* 队列非空，将事件插入环形缓冲区(FIFO) */
+        QF_PTR_AT_(me->eQueue.ring, me->eQueue.head) = e;
+
+        if (me->eQueue.head == 0U) {          /* need to wrap head? */
+            me->eQueue.head = me->eQueue.end; /* wrap around */
+        }
+        --me->eQueue.head; /* advance the head (counter clockwise) */
+        wasEmpty = false;
+    }
+    return wasEmpty;
+}
+
 /****************************************************************************/
 /**
  * @brief
@@ -252,6 +325,9 @@ void QActive_postLIFO_(QActive *const me, QEvt const *const e)
     }
 #endif
 
+#ifdef QV_EDF
+    QV_edfPutLIFO_(me, e); /* 记录事件的截止期限 */
+#endif
     frontEvt            = me->eQueue.frontEvt; /* 将 volatile 读取到临时变量 */
     me->eQueue.frontEvt = e;                   /* 直接将事件放到队列头 */
 
@@ -305,6 +381,9 @@ QEvt const *QActive_get_(QActive *const me)
     if (nFree <= me->eQueue.end) {
 
         /* 从队列尾部取出事件 */
+#ifdef QV_EDF
+        QV_edfGet_(me); /* 新队首事件的截止期限 */
+#endif
         me->eQueue.frontEvt = QF_PTR_AT_(me->eQueue.ring, me->eQueue.tail);
         if (me->eQueue.tail == 0U) {          /* need to wrap the tail? */
             me->eQueue.tail = me->eQueue.end; /* wrap around */
@@ -331,6 +410,11 @@ QEvt const *QActive_get_(QActive *const me)
         QS_2U8_PRE_(e->poolId_, e->refCtr_); /* 池 ID 和引用计数 */
         QS_END_NOCRIT_PRE_()
     }
+
+    /* 绝对时间事件已被取出: 清除"待处理"标志, 参见 QTimeEvt_armAtX() */
+    if ((e->poolId_ == 0U) && ((e->refCtr_ & TE_IS_PENDING) != 0U)) {
+        QF_EVT_CONST_CAST_(e)->refCtr_ &= (uint8_t)(~TE_IS_PENDING & 0xFFU);
+    }
     QF_CRIT_X_();
     return e;
 }
@@ -471,7 +555,10 @@ static bool QTicker_post_(QActive *const me, QEvt const *const e,
     QF_CRIT_E_();
     if (me->eQueue.frontEvt == (QEvt *)0) {
 
-        static QEvt const tickEvt = {0U, 0U, 0U};
+        static QEvt const tickEvt = QEVT_INITIALIZER(0U);
+#ifdef QV_EDF
+        QV_edfPut_(me, &tickEvt); /* record the deadline */
+#endif
         me->eQueue.frontEvt       = &tickEvt; /* deliver event directly */
         --me->eQueue.nFree;                   /* one less free event */
 
@@ -501,3 +588,5 @@ static void QTicker_postLIFO_(QActive *const me, QEvt const *const e)
     (void)e;  /* unused parameter */
     Q_ERROR_ID(900);
 }
+
+#endif /* QF_MPSC_QUEUE */
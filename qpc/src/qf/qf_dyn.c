@@ -51,8 +51,10 @@
 Q_DEFINE_THIS_MODULE("qf_dyn")
 
 /* Package-scope objects ****************************************************/
+#ifndef QF_CONTEXT /* 否则在 QF 实例上下文中, 见 qf_pkg.h */
 QF_EPOOL_TYPE_ QF_pool_[QF_MAX_EPOOL]; /* 分配事件池 */
 uint_fast8_t QF_maxPool_;              /* 已初始化的事件池数量 */
+#endif
 
 /****************************************************************************/
 #ifdef Q_EVT_CTOR /* 是否提供 ::QEvt 类的构造函数? */
@@ -171,6 +173,9 @@ QEvt *QF_newX_(uint_fast16_t const evtSize,
         e->sig     = (QSignal)sig;        /* 设置事件信号 */
         e->poolId_ = (uint8_t)(idx + 1U); /* 存储事件池 ID */
         e->refCtr_ = 0U;                  /* 设置引用计数为 0 */
+#ifdef QV_EDF
+        e->deadline = 0U; /* 使用接收 AO 的默认截止期限 */
+#endif
 
         QS_BEGIN_PRE_(QS_QF_NEW, (uint_fast8_t)QS_EP_ID + e->poolId_)
         QS_TIME_PRE_();       /* 时间戳 */
@@ -51,8 +51,58 @@
 Q_DEFINE_THIS_MODULE("qf_ps")
 
 /* Package-scope objects ****************************************************/
+#ifndef QF_CONTEXT /* 否则在 QF 实例上下文中, 见 qf_pkg.h */
 QSubscrList *QF_subscrList_;
 enum_t QF_maxPubSignal_;
+#endif
+
+#if (QF_MAX_PS_GROUP > 0U)
+#ifndef QF_CONTEXT /* 否则在 QF 实例上下文中, 见 qf_pkg.h */
+QPSGroup QF_psGroup_[QF_MAX_PS_GROUP]; /* 信号组订阅表 */
+uint_fast8_t QF_psGroupNum_;           /* 已使用的信号组数 */
+#endif
+
+/*! 将活动对象加入/移出信号组订阅表中的一个组 */
+static void QF_psGroupSet_(QActive const *const me, bool const insert,
+                           QSignal const lo, QSignal const hi,
+                           QSignal const mask, QSignal const match);
+#endif
+
+#if (QF_MAX_PS_FILTER > 0U)
+#ifndef QF_CONTEXT /* 否则在 QF 实例上下文中, 见 qf_pkg.h */
+QPSFilterRec QF_psFilter_[QF_MAX_PS_FILTER]; /* 订阅内容过滤表 */
+uint_fast8_t QF_psFilterNum_;                /* 已使用的过滤器数 */
+#endif
+
+/*! 设置活动对象对一个信号的订阅过滤器 */
+static void QF_psFilterSet_(QActive const *const me, QSignal const sig,
+                            QPSFilter const pred, uint_fast16_t const offset,
+                            uint_fast8_t const size, uint32_t const key);
+
+/*! 删除优先级 @p p 对信号 @p sig 的过滤器(必须在临界区内调用) */
+static void QF_psFilterDrop_(uint_fast8_t const p, QSignal const sig,
+                             bool const all);
+
+/*! 把信号 @p sig 的订阅者的过滤器复制到 @p snap 中(必须在临界区内调用) */
+static uint_fast8_t QF_psFilterSnap_(QSignal const sig,
+                                     QPSet const *const subscrList,
+                                     QPSFilterRec *const snap);
+
+/*! 用过滤器快照从订阅者集合中去掉不需要事件 @p e 的订阅者 */
+static void QF_psFilterApply_(QEvt const *const e, QPSet *const subscrList,
+                              QPSFilterRec const *const snap,
+                              uint_fast8_t const nSnap);
+#endif
+
+#ifdef QF_PS_SPARSE
+#ifndef QF_CONTEXT /* 否则在 QF 实例上下文中, 见 qf_pkg.h */
+uint_fast16_t QF_subscrNum_;                /* 已使用的元素数 */
+uint16_t QF_subscrCnt_[QF_MAX_ACTIVE + 1U]; /* 反向索引: 每个 AO 订阅的信号数 */
+#endif
+
+/*! 在稀疏订阅存储中二分查找信号(必须在临界区内调用) */
+static bool QF_psFind_(QSignal const sig, uint_fast16_t *const idx);
+#endif
 
 /****************************************************************************/
 /**
@@ -60,7 +110,9 @@ enum_t QF_maxPubSignal_;
  * 此函数用于初始化 QF 的发布-订阅机制. 必须在应用程序中发生任何订阅或发布操作之前 \b 且仅调用一次
  *
  * @param[in] subscrSto 指向订阅者列表数组的指针
- * @param[in] maxSignal 订阅者数组的长度, 同时也是能够发布或订阅的最大信号值
+ * @param[in] maxSignal 订阅者数组的长度, 同时也是能够发布或订阅的最大信号值.
+ *                      定义 #QF_PS_SPARSE 时, 表示可同时被订阅的不同信号的最大数量,
+ *                      信号值本身不受限制.
  *
  * 订阅者列表数组通过信号进行索引, 用于建立信号和订阅者列表之间的映射关系.
  * 每个订阅者列表(::QSubscrList 类型)是一个位掩码, 其中每一位对应一个活动对象的唯一优先级.
@@ -79,6 +131,17 @@ void QF_psInit(QSubscrList *const subscrSto, enum_t const maxSignal)
      * 正确清除未初始化数据, 框架仍然可以正常运行.
      */
     QF_bzero(subscrSto, (uint_fast16_t)maxSignal * sizeof(QSubscrList));
+
+#ifdef QF_PS_SPARSE
+    QF_subscrNum_ = 0U;
+    QF_bzero(&QF_subscrCnt_[0], sizeof(QF_subscrCnt_));
+#endif
+#if (QF_MAX_PS_GROUP > 0U)
+    QF_psGroupNum_ = 0U;
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    QF_psFilterNum_ = 0U;
+#endif
 }
 
 /****************************************************************************/
@@ -93,6 +156,19 @@ void QF_psInit(QSubscrList *const subscrSto, enum_t const maxSignal)
  * 为了避免投递到 AO 队列中的事件发生意外的重新排序, 多播过程中调度器会被 \b 锁定.
  * 不过, 调度器只会被锁定到订阅者中的最高优先级, 因此未订阅该事件的更高优先级 AO 不会受到影响.
  *
+ * @note
+ * 对使用原生 QActive_post_() 的订阅者(绝大多数 AO), 多播走快速路径:
+ * 在 \b 一个 临界区内把事件插入所有这些订阅者的队列, 一次性把订阅者数
+ * 加到 refCtr_ 上, 并用一次集合"或"运算把它们标记为就绪.
+ * 只有自定义投递操作的订阅者(例如 ::QTicker)才逐个通过虚表 QACTIVE_POST() 投递.
+ * 快速路径临界区的长度与原生订阅者的数量成正比.
+ *
+ * @note
+ * 定义了 #QF_MAX_PS_FILTER 时, 订阅内容过滤器在任何投递之前(临界区之外)
+ * 求值, 被拦截的订阅者不占用队列空间, 不增加引用计数, 也不会被调度.
+ * 求值使用在复制订阅者列表的同一个临界区内取得的过滤器快照(栈上最多
+ * #QF_MAX_PS_FILTER 个元素), 因此与其他线程或 ISR 修改过滤表无关.
+ *
  * @attention
  * 此函数应当仅通过宏 QF_PUBLISH() 调用.
  */
@@ -104,10 +180,16 @@ void QF_publish_(QEvt const *const e,
 #endif
 {
     QPSet subscrList; /* 订阅者列表的本地可修改副本 */
+#if (QF_MAX_PS_FILTER > 0U)
+    QPSFilterRec snap[QF_MAX_PS_FILTER]; /* 订阅者过滤器的快照 */
+    uint_fast8_t nSnap;
+#endif
     QF_CRIT_STAT_
 
+#ifndef QF_PS_SPARSE
     /** @pre 发布的信号必须在配置范围内 */
     Q_REQUIRE_ID(200, e->sig < (QSignal)QF_maxPubSignal_);
+#endif
 
     QF_CRIT_E_();
 
@@ -128,30 +210,103 @@ void QF_publish_(QEvt const *const e,
     }
 
     /* 复制订阅者列表的本地可修改副本 */
+#ifndef QF_PS_SPARSE
     subscrList = QF_PTR_AT_(QF_subscrList_, e->sig);
+#else
+    {
+        uint_fast16_t i;
+        if (QF_psFind_(e->sig, &i)) {
+            subscrList = QF_PTR_AT_(QF_subscrList_, i).set;
+        } else {
+            QPSet_setEmpty(&subscrList); /* 该信号没有订阅者 */
+        }
+    }
+#endif
+
+#if (QF_MAX_PS_GROUP > 0U)
+    {
+        /* 并入包含该信号的信号组的订阅者(每组两次比较和一次"或") */
+        uint_fast8_t g;
+        for (g = 0U; g < QF_psGroupNum_; ++g) {
+            QPSGroup const *const grp = &QF_psGroup_[g];
+            if ((QSignal)(e->sig - grp->lo) <= (QSignal)(grp->hi - grp->lo)
+                && ((QSignal)(e->sig & grp->mask) == grp->match)) {
+                QPSet_insertSet(&subscrList, &grp->set);
+            }
+        }
+    }
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    nSnap = QF_psFilterSnap_(e->sig, &subscrList, &snap[0]);
+#endif
     QF_CRIT_X_();
 
+#if (QF_MAX_PS_FILTER > 0U)
+    if (nSnap != 0U) {
+        /* 在投递之前去掉被过滤的订阅者 */
+        QF_psFilterApply_(e, &subscrList, &snap[0], nSnap);
+    }
+#endif
+
     if (QPSet_notEmpty(&subscrList)) { /* 有订阅者? */
+        QPSet rest = subscrList; /* 尚未检查的订阅者 */
+        QPSet ready;             /* 队列由空变为非空的原生订阅者 */
+        uint_fast8_t nNative = 0U;
         uint_fast8_t p;
         QF_SCHED_STAT_
 
         QPSet_findMax(&subscrList, p); /* 找到最高优先级订阅者 */
+        QPSet_setEmpty(&ready);
 
         QF_SCHED_LOCK_(p); /* 锁定调度器到优先级 p */
-        do {               /* 遍历所有订阅者 */
+
+        /* 快速路径: 在一个临界区内插入所有原生订阅者的队列 */
+        QF_CRIT_E_();
+        do {
+            QActive *const a = QF_active_[p];
+
             /* AO 的优先级必须已经在框架中注册 */
-            Q_ASSERT_ID(210, QF_active_[p] != (QActive *)0);
+            Q_ASSERT_CRIT_(210, a != (QActive *)0);
 
-            /* QACTIVE_POST() 内部会断言以防队列溢出 */
-            QACTIVE_POST(QF_active_[p], e, sender);
+            if (((QActiveVtable const *)a->super.vptr)->post == &QActive_post_) {
+                if (QACTIVE_INSERT_FIFO_(a, e, sender)) { /* 队列原先为空? */
+#ifdef QACTIVE_EQUEUE_SIGNAL_SET_
+                    QPSet_insert(&ready, p);
+#else
+                    QACTIVE_EQUEUE_SIGNAL_(a); /* 内核不支持集合信号 */
+#endif
+                }
+                ++nNative;
+                QPSet_remove(&subscrList, p); /* 只保留需要虚表投递的订阅者 */
+            }
 
-            QPSet_remove(&subscrList, p);      /* 移除已处理的订阅者 */
-            if (QPSet_notEmpty(&subscrList)) { /* 还有订阅者吗? */
-                QPSet_findMax(&subscrList, p); /* 找下一个最高优先级订阅者 */
+            QPSet_remove(&rest, p);      /* 移除已处理的订阅者 */
+            if (QPSet_notEmpty(&rest)) { /* 还有订阅者吗? */
+                QPSet_findMax(&rest, p); /* 找下一个最高优先级订阅者 */
             } else {
                 p = 0U; /* 没有更多订阅者 */
             }
         } while (p != 0U);
+
+        if ((e->poolId_ != 0U) && (nNative != 0U)) {
+            /* 一次性增加所有原生订阅者的引用 */
+            QF_EVT_CONST_CAST_(e)->refCtr_
+                = (uint8_t)(e->refCtr_ + nNative);
+        }
+#ifdef QACTIVE_EQUEUE_SIGNAL_SET_
+        QACTIVE_EQUEUE_SIGNAL_SET_(&ready); /* 一次"或"运算发出就绪信号 */
+#endif
+        QF_CRIT_X_();
+
+        /* 慢速路径: 自定义投递操作的订阅者(例如 QTicker) */
+        while (QPSet_notEmpty(&subscrList)) {
+            QPSet_findMax(&subscrList, p);
+
+            /* QACTIVE_POST() 内部会断言以防队列溢出 */
+            QACTIVE_POST(QF_active_[p], e, sender);
+
+            QPSet_remove(&subscrList, p); /* 移除已处理的订阅者 */
+        }
         QF_SCHED_UNLOCK_(); /* 解锁调度器 */
     }
 
@@ -174,7 +329,13 @@ void QActive_subscribe(QActive const *const me, enum_t const sig)
     uint_fast8_t p = (uint_fast8_t)me->prio;
     QF_CRIT_STAT_
 
+#ifndef QF_PS_SPARSE
     Q_REQUIRE_ID(300, ((enum_t)Q_USER_SIG <= sig) && (sig < QF_maxPubSignal_) && (0U < p) && (p <= QF_MAX_ACTIVE) && (QF_active_[p] == me));
+#else
+    uint_fast16_t i;
+
+    Q_REQUIRE_ID(300, ((enum_t)Q_USER_SIG <= sig) && (0U < p) && (p <= QF_MAX_ACTIVE) && (QF_active_[p] == me));
+#endif
 
     QF_CRIT_E_();
 
@@ -184,8 +345,29 @@ void QActive_subscribe(QActive const *const me, enum_t const sig)
     QS_OBJ_PRE_(me);  /* this active object */
     QS_END_NOCRIT_PRE_()
 
+#ifndef QF_PS_SPARSE
     /* set the priority bit */
     QPSet_insert(&QF_PTR_AT_(QF_subscrList_, sig), p);
+#else
+    if (!QF_psFind_((QSignal)sig, &i)) { /* 该信号尚无订阅者? */
+        uint_fast16_t j;
+
+        /* 存储不能溢出 */
+        Q_ASSERT_CRIT_(310, QF_subscrNum_ < (uint_fast16_t)QF_maxPubSignal_);
+
+        /* 在位置 i 处插入新元素, 保持按信号排序 */
+        for (j = QF_subscrNum_; j > i; --j) {
+            QF_PTR_AT_(QF_subscrList_, j) = QF_PTR_AT_(QF_subscrList_, j - 1U);
+        }
+        QPSet_setEmpty(&QF_PTR_AT_(QF_subscrList_, i).set);
+        QF_PTR_AT_(QF_subscrList_, i).sig = (QSignal)sig;
+        ++QF_subscrNum_;
+    }
+    if (!QPSet_hasElement(&QF_PTR_AT_(QF_subscrList_, i).set, p)) {
+        QPSet_insert(&QF_PTR_AT_(QF_subscrList_, i).set, p);
+        ++QF_subscrCnt_[p];
+    }
+#endif
 
     QF_CRIT_X_();
 }
@@ -214,7 +396,13 @@ void QActive_unsubscribe(QActive const *const me, enum_t const sig)
     QF_CRIT_STAT_
 
     /** @pre 信号和优先级必须在合法范围内，且该活动对象必须已在框架中注册 */
+#ifndef QF_PS_SPARSE
     Q_REQUIRE_ID(400, ((enum_t)Q_USER_SIG <= sig) && (sig < QF_maxPubSignal_) && (0U < p) && (p <= QF_MAX_ACTIVE) && (QF_active_[p] == me));
+#else
+    uint_fast16_t i;
+
+    Q_REQUIRE_ID(400, ((enum_t)Q_USER_SIG <= sig) && (0U < p) && (p <= QF_MAX_ACTIVE) && (QF_active_[p] == me));
+#endif
 
     QF_CRIT_E_();
 
@@ -224,8 +412,27 @@ void QActive_unsubscribe(QActive const *const me, enum_t const sig)
     QS_OBJ_PRE_(me);  /* this active object */
     QS_END_NOCRIT_PRE_()
 
+#ifndef QF_PS_SPARSE
     /* clear priority bit */
     QPSet_remove(&QF_PTR_AT_(QF_subscrList_, sig), p);
+#else
+    if (QF_psFind_((QSignal)sig, &i)
+        && QPSet_hasElement(&QF_PTR_AT_(QF_subscrList_, i).set, p)) {
+        QPSet_remove(&QF_PTR_AT_(QF_subscrList_, i).set, p);
+        --QF_subscrCnt_[p];
+
+        /* 最后一个订阅者? 删除元素, 保持按信号排序 */
+        if (QPSet_isEmpty(&QF_PTR_AT_(QF_subscrList_, i).set)) {
+            --QF_subscrNum_;
+            for (; i < QF_subscrNum_; ++i) {
+                QF_PTR_AT_(QF_subscrList_, i) = QF_PTR_AT_(QF_subscrList_, i + 1U);
+            }
+        }
+    }
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    QF_psFilterDrop_(p, (QSignal)sig, false); /* 过滤器属于订阅 */
+#endif
 
     QF_CRIT_X_();
 }
@@ -249,6 +456,7 @@ void QActive_unsubscribe(QActive const *const me, enum_t const sig)
 void QActive_unsubscribeAll(QActive const *const me)
 {
     uint_fast8_t p = (uint_fast8_t)me->prio;
+#ifndef QF_PS_SPARSE
     enum_t sig;
 
     Q_REQUIRE_ID(500, (0U < p) && (p <= QF_MAX_ACTIVE) && (QF_active_[p] == me));
@@ -270,4 +478,520 @@ void QActive_unsubscribeAll(QActive const *const me)
         /* prevent merging critical sections */
         QF_CRIT_EXIT_NOP();
     }
+#else
+    uint_fast16_t i = 0U;
+    bool done;
+
+    Q_REQUIRE_ID(500, (0U < p) && (p <= QF_MAX_ACTIVE) && (QF_active_[p] == me));
+
+    /* 只扫描已订阅的信号, 且在反向索引(订阅计数)归零时提前结束.
+     * 每个元素单独使用一个临界区; 其他 AO 并发订阅/取消订阅可能移动元素,
+     * 因此扫描到末尾而计数仍未归零时从头再扫描.
+     */
+    do {
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+        if (QF_subscrCnt_[p] == 0U) {
+            done = true;
+        } else {
+            if (i >= QF_subscrNum_) {
+                i = 0U; /* 重新扫描 */
+            }
+            if (QPSet_hasElement(&QF_PTR_AT_(QF_subscrList_, i).set, p)) {
+                QSignal const sig = QF_PTR_AT_(QF_subscrList_, i).sig;
+
+                QPSet_remove(&QF_PTR_AT_(QF_subscrList_, i).set, p);
+                --QF_subscrCnt_[p];
+
+                QS_BEGIN_NOCRIT_PRE_(QS_QF_ACTIVE_UNSUBSCRIBE, me->prio)
+                QS_TIME_PRE_();   /* timestamp */
+                QS_SIG_PRE_(sig); /* the signal of this event */
+                QS_OBJ_PRE_(me);  /* this active object */
+                QS_END_NOCRIT_PRE_()
+
+                if (QPSet_isEmpty(&QF_PTR_AT_(QF_subscrList_, i).set)) {
+                    uint_fast16_t j;
+                    --QF_subscrNum_;
+                    for (j = i; j < QF_subscrNum_; ++j) {
+                        QF_PTR_AT_(QF_subscrList_, j) = QF_PTR_AT_(QF_subscrList_, j + 1U);
+                    }
+                    /* 不移动 i, 下一个元素已移到位置 i */
+                } else {
+                    ++i;
+                }
+#ifndef Q_SPY
+                (void)sig; /* 仅用于 QS 跟踪 */
+#endif
+            } else {
+                ++i;
+            }
+            done = false;
+        }
+        QF_CRIT_X_();
+
+        /* prevent merging critical sections */
+        QF_CRIT_EXIT_NOP();
+    } while (!done);
+#endif /* QF_PS_SPARSE */
+
+#if (QF_MAX_PS_GROUP > 0U)
+    {
+        /* 从所有信号组中移除. 移除最后一个订阅者时会把最后一个组移到该位置,
+         * 因此逆序扫描.
+         */
+        uint_fast8_t g;
+        QF_CRIT_STAT_
+
+        QF_CRIT_E_();
+        for (g = QF_psGroupNum_; g > 0U; --g) {
+            QPSGroup *const grp = &QF_psGroup_[g - 1U];
+            QPSet_remove(&grp->set, p);
+            if (QPSet_isEmpty(&grp->set)) {
+                --QF_psGroupNum_;
+                *grp = QF_psGroup_[QF_psGroupNum_];
+            }
+        }
+        QF_CRIT_X_();
+    }
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    {
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+        QF_psFilterDrop_(p, 0U, true);
+        QF_CRIT_X_();
+    }
+#endif
+}
+
+#if (QF_MAX_PS_GROUP > 0U)
+/****************************************************************************/
+/**
+ * @brief
+ * 订阅一个范围内的所有信号. 整个范围在信号组订阅表中只占一个元素,
+ * 而不是每个信号写一次订阅者列表; QF_publish_() 用每组两次比较判断
+ * 信号是否属于该组, 并将组的订阅者集合并入本次多播.
+ *
+ * @param[in] me    指针
+ * @param[in] sigLo 范围内的第一个信号
+ * @param[in] sigHi 范围内的最后一个信号(包含)
+ *
+ * @note
+ * 多个活动对象订阅同一个范围时共享同一个组. 同时通过单个信号和信号组
+ * 订阅同一信号的活动对象每次发布只收到一个事件.
+ * 信号组订阅表的大小由 #QF_MAX_PS_GROUP 配置.
+ */
+void QActive_subscribeRange(QActive const *const me,
+                            enum_t const sigLo, enum_t const sigHi)
+{
+#ifndef QF_PS_SPARSE
+    /** @pre 范围必须有效, 且必须在 QF_psInit() 配置的信号范围内 */
+    Q_REQUIRE_ID(600, ((enum_t)Q_USER_SIG <= sigLo) && (sigLo <= sigHi) && (sigHi < QF_maxPubSignal_));
+#else
+    /** @pre 范围必须有效 */
+    Q_REQUIRE_ID(600, ((enum_t)Q_USER_SIG <= sigLo) && (sigLo <= sigHi));
+#endif
+    QF_psGroupSet_(me, true, (QSignal)sigLo, (QSignal)sigHi, 0U, 0U);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 取消 QActive_subscribeRange() 建立的范围订阅. 范围必须与订阅时完全相同.
+ *
+ * @param[in] me    指针
+ * @param[in] sigLo 范围内的第一个信号
+ * @param[in] sigHi 范围内的最后一个信号(包含)
+ */
+void QActive_unsubscribeRange(QActive const *const me,
+                              enum_t const sigLo, enum_t const sigHi)
+{
+    /** @pre 范围必须有效 */
+    Q_REQUIRE_ID(700, ((enum_t)Q_USER_SIG <= sigLo) && (sigLo <= sigHi));
+    QF_psGroupSet_(me, false, (QSignal)sigLo, (QSignal)sigHi, 0U, 0U);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 订阅满足 (sig & @p sigMask) == @p sigMatch 的所有信号. 适用于按位域编码的
+ * 信号族, 例如所有报警信号使用同一个高位前缀.
+ *
+ * @param[in] me       指针
+ * @param[in] sigMask  参与比较的信号位
+ * @param[in] sigMatch 这些位必须等于的值
+ *
+ * @note
+ * 与单个信号订阅一样, 只有不小于 ::Q_USER_SIG 的信号会被发布. 在没有定义
+ * #QF_PS_SPARSE 时, 仍然只能发布小于 QF_psInit() 中 maxSignal 的信号.
+ */
+void QActive_subscribeMask(QActive const *const me,
+                           enum_t const sigMask, enum_t const sigMatch)
+{
+    /** @pre 掩码非零, 且匹配值不能包含掩码之外的位 */
+    Q_REQUIRE_ID(800, (sigMask != 0) && ((sigMatch & ~sigMask) == 0));
+    QF_psGroupSet_(me, true, (QSignal)Q_USER_SIG, (QSignal)(~(QSignal)0),
+                   (QSignal)sigMask, (QSignal)sigMatch);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 取消 QActive_subscribeMask() 建立的信号组订阅. 掩码和匹配值必须与订阅时相同.
+ *
+ * @param[in] me       指针
+ * @param[in] sigMask  参与比较的信号位
+ * @param[in] sigMatch 这些位必须等于的值
+ */
+void QActive_unsubscribeMask(QActive const *const me,
+                             enum_t const sigMask, enum_t const sigMatch)
+{
+    /** @pre 掩码非零, 且匹配值不能包含掩码之外的位 */
+    Q_REQUIRE_ID(900, (sigMask != 0) && ((sigMatch & ~sigMask) == 0));
+    QF_psGroupSet_(me, false, (QSignal)Q_USER_SIG, (QSignal)(~(QSignal)0),
+                   (QSignal)sigMask, (QSignal)sigMatch);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 在信号组订阅表中查找由 (@p lo, @p hi, @p mask, @p match) 标识的组,
+ * 并将活动对象 @p me 加入(@p insert 为 'true')或移出该组.
+ * 新组在第一次订阅时分配, 最后一个订阅者移出时释放(由表中最后一个组填补).
+ */
+static void QF_psGroupSet_(QActive const *const me, bool const insert,
+                           QSignal const lo, QSignal const hi,
+                           QSignal const mask, QSignal const match)
+{
+    uint_fast8_t const p = (uint_fast8_t)me->prio;
+    uint_fast8_t g;
+    QF_CRIT_STAT_
+
+    /** @pre 活动对象必须已在框架中注册 */
+    Q_REQUIRE_ID(610, (0U < p) && (p <= QF_MAX_ACTIVE) && (QF_active_[p] == me));
+
+    QF_CRIT_E_();
+    for (g = 0U; g < QF_psGroupNum_; ++g) {
+        QPSGroup const *const grp = &QF_psGroup_[g];
+        if ((grp->lo == lo) && (grp->hi == hi)
+            && (grp->mask == mask) && (grp->match == match)) {
+            break;
+        }
+    }
+
+    if (insert) {
+        if (g == QF_psGroupNum_) { /* 新的信号组? */
+            /* 信号组订阅表不能溢出 */
+            Q_ASSERT_CRIT_(620, QF_psGroupNum_ < QF_MAX_PS_GROUP);
+
+            QPSet_setEmpty(&QF_psGroup_[g].set);
+            QF_psGroup_[g].lo    = lo;
+            QF_psGroup_[g].hi    = hi;
+            QF_psGroup_[g].mask  = mask;
+            QF_psGroup_[g].match = match;
+            ++QF_psGroupNum_;
+        }
+        QPSet_insert(&QF_psGroup_[g].set, p);
+    } else if (g < QF_psGroupNum_) {
+        QPSet_remove(&QF_psGroup_[g].set, p);
+        if (QPSet_isEmpty(&QF_psGroup_[g].set)) { /* 最后一个订阅者? */
+            --QF_psGroupNum_;
+            QF_psGroup_[g] = QF_psGroup_[QF_psGroupNum_];
+        }
+    } else {
+        /* 取消订阅不存在的信号组: 什么也不做 */
+    }
+    QF_CRIT_X_();
+}
+#endif /* QF_MAX_PS_GROUP */
+
+#if (QF_MAX_PS_FILTER > 0U)
+/****************************************************************************/
+/**
+ * @brief
+ * 为活动对象 @p me 对信号 @p sig 的订阅设置谓词过滤器. QF_publish_() 在投递
+ * 之前调用 @p filter, 返回 'false' 时该事件不会进入 @p me 的队列.
+ *
+ * @param[in] me     指针
+ * @param[in] sig    被过滤的信号
+ * @param[in] filter 谓词, 在发布者的上下文中(临界区之外)调用
+ *
+ * @note
+ * 谓词必须简短, 不能有副作用, 也不能发布或投递事件; 它可能在 ISR 中被调用.
+ * 与订阅一样, 过滤器应在活动对象的初始转换中设置, 不能在 ISR 中修改.
+ * 重复设置会替换原有的过滤器, 取消订阅该信号时过滤器被一并删除.
+ * 过滤表的大小由 #QF_MAX_PS_FILTER 配置.
+ */
+void QActive_setFilter(QActive const *const me, enum_t const sig,
+                       QPSFilter const filter)
+{
+    /** @pre 信号合法, 且谓词不能为空 */
+    Q_REQUIRE_ID(1000, ((enum_t)Q_USER_SIG <= sig)
+                       && (filter != (QPSFilter)0));
+    QF_psFilterSet_(me, (QSignal)sig, filter, 0U, 0U, 0U);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 为活动对象 @p me 对信号 @p sig 的订阅设置键匹配过滤器: 只有事件中
+ * 偏移 @p offset 处 @p size 字节的无符号整数等于 @p key 时才投递.
+ * 键匹配过滤器不调用用户代码, 代价为一次读取和一次比较.
+ *
+ * @param[in] me     指针
+ * @param[in] sig    被过滤的信号
+ * @param[in] offset 键在事件结构体中的偏移, 通常为 offsetof(XxxEvt, member)
+ * @param[in] size   键的字节数: 1, 2 或 4, 通常为 sizeof(member)
+ * @param[in] key    期望的键值
+ *
+ * @usage
+ * @code
+ * QActive_setFilterKey(&me->super, EAT_SIG,
+ *                      offsetof(TableEvt, philoNum), 1U, PHILO_ID(me));
+ * @endcode
+ */
+void QActive_setFilterKey(QActive const *const me, enum_t const sig,
+                          uint_fast16_t const offset, uint_fast8_t const size,
+                          uint32_t const key)
+{
+    /** @pre 信号合法, 键的长度为 1, 2 或 4 字节且按其长度对齐 */
+    Q_REQUIRE_ID(1100, ((enum_t)Q_USER_SIG <= sig)
+                       && ((size == 1U) || (size == 2U) || (size == 4U))
+                       && ((offset & (size - 1U)) == 0U)
+                       && (offset <= 0xFFFFU));
+    QF_psFilterSet_(me, (QSignal)sig, (QPSFilter)0, offset, size, key);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 删除活动对象 @p me 对信号 @p sig 的订阅过滤器, 此后该信号的所有已发布事件
+ * 都会再次投递给 @p me. 删除不存在的过滤器什么也不做.
+ *
+ * @param[in] me  指针
+ * @param[in] sig 被过滤的信号
+ */
+void QActive_clearFilter(QActive const *const me, enum_t const sig)
+{
+    uint_fast8_t const p = (uint_fast8_t)me->prio;
+    QF_CRIT_STAT_
+
+    /** @pre 活动对象必须已在框架中注册 */
+    Q_REQUIRE_ID(1200, (0U < p) && (p <= QF_MAX_ACTIVE) && (QF_active_[p] == me));
+
+    QF_CRIT_E_();
+    QF_psFilterDrop_(p, (QSignal)sig, false);
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回活动对象 @p me 对信号 @p sig 的订阅过滤器自设置以来拦截的事件数,
+ * 即因过滤而节省的队列插入和分发次数. 没有过滤器时返回 0.
+ *
+ * @param[in] me  指针
+ * @param[in] sig 被过滤的信号
+ *
+ * @returns 被拦截的事件数(32 位回绕)
+ */
+uint32_t QActive_getFiltered(QActive const *const me, enum_t const sig)
+{
+    uint_fast8_t const p = (uint_fast8_t)me->prio;
+    uint32_t n           = 0U;
+    uint_fast8_t f;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+    for (f = 0U; f < QF_psFilterNum_; ++f) {
+        if ((QF_psFilter_[f].sig == (QSignal)sig)
+            && (QF_psFilter_[f].prio == (uint8_t)p)) {
+            n = QF_psFilter_[f].nFiltered;
+            break;
+        }
+    }
+    QF_CRIT_X_();
+    return n;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 查找活动对象 @p me 对信号 @p sig 的过滤器, 不存在时分配一个新元素,
+ * 然后写入谓词或键. 整个更新在一个临界区内完成, QF_publish_() 在临界区内
+ * 取得过滤器快照, 因此任何上下文(ISR, 抢占的 AO 或其他线程)中发布的事件
+ * 都只会看到更新之前或之后的过滤器. 被拦截计数在替换过滤器时清零.
+ */
+static void QF_psFilterSet_(QActive const *const me, QSignal const sig,
+                            QPSFilter const pred, uint_fast16_t const offset,
+                            uint_fast8_t const size, uint32_t const key)
+{
+    uint_fast8_t const p = (uint_fast8_t)me->prio;
+    uint_fast8_t f;
+    QF_CRIT_STAT_
+
+    /** @pre 活动对象必须已在框架中注册 */
+    Q_REQUIRE_ID(1010, (0U < p) && (p <= QF_MAX_ACTIVE) && (QF_active_[p] == me));
+
+    QF_CRIT_E_();
+    for (f = 0U; f < QF_psFilterNum_; ++f) {
+        if ((QF_psFilter_[f].sig == sig) && (QF_psFilter_[f].prio == (uint8_t)p)) {
+            break;
+        }
+    }
+    if (f == QF_psFilterNum_) { /* 新的过滤器? */
+        /* 过滤表不能溢出 */
+        Q_ASSERT_CRIT_(1020, QF_psFilterNum_ < QF_MAX_PS_FILTER);
+
+        QF_psFilter_[f].sig  = sig;
+        QF_psFilter_[f].prio = (uint8_t)p;
+        ++QF_psFilterNum_;
+    }
+    QF_psFilter_[f].pred      = pred;
+    QF_psFilter_[f].key       = key;
+    QF_psFilter_[f].offset    = (uint16_t)offset;
+    QF_psFilter_[f].size      = (uint8_t)size;
+    QF_psFilter_[f].nFiltered = 0U;
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 删除优先级 @p p 对信号 @p sig 的过滤器(@p all 为 'true' 时删除 @p p 的
+ * 所有过滤器). 被删除的元素由表中最后一个元素填补, 因此逆序扫描.
+ *
+ * @note 必须在临界区内调用
+ */
+static void QF_psFilterDrop_(uint_fast8_t const p, QSignal const sig,
+                             bool const all)
+{
+    uint_fast8_t f;
+
+    for (f = QF_psFilterNum_; f > 0U; --f) {
+        QPSFilterRec *const rec = &QF_psFilter_[f - 1U];
+        if ((rec->prio == (uint8_t)p) && (all || (rec->sig == sig))) {
+            --QF_psFilterNum_;
+            *rec = QF_psFilter_[QF_psFilterNum_];
+        }
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由 QF_publish_() 在复制订阅者列表的临界区内调用: 把信号为 @p sig 且
+ * 订阅者在 @p subscrList 中的过滤器复制到 @p snap 中.
+ *
+ * @returns 复制的过滤器数(最多 #QF_MAX_PS_FILTER)
+ */
+static uint_fast8_t QF_psFilterSnap_(QSignal const sig,
+                                     QPSet const *const subscrList,
+                                     QPSFilterRec *const snap)
+{
+    uint_fast8_t n = 0U;
+    uint_fast8_t f;
+
+    for (f = 0U; f < QF_psFilterNum_; ++f) {
+        if ((QF_psFilter_[f].sig == sig)
+            && QPSet_hasElement(subscrList, (uint_fast8_t)QF_psFilter_[f].prio)) {
+            snap[n] = QF_psFilter_[f];
+            ++n;
+        }
+    }
+    return n;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 对快照中的每个过滤器求值, 并从 @p subscrList 中去掉拒绝事件 @p e 的
+ * 订阅者. 谓词在临界区之外调用, 只读取快照, 不访问过滤表.
+ * 被拦截计数最后在一个临界区内按 (信号, 优先级) 重新查找并更新,
+ * 因此在求值期间被删除或移动的过滤器不会被错误计数.
+ */
+static void QF_psFilterApply_(QEvt const *const e, QPSet *const subscrList,
+                              QPSFilterRec const *const snap,
+                              uint_fast8_t const nSnap)
+{
+    QPSet dropped; /* 被拦截的订阅者 */
+    uint_fast8_t f;
+
+    QPSet_setEmpty(&dropped);
+    for (f = 0U; f < nSnap; ++f) {
+        QPSFilterRec const *const rec = &snap[f];
+        uint_fast8_t const p          = (uint_fast8_t)rec->prio;
+        bool pass;
+
+        if (rec->size == 0U) { /* 谓词过滤器? */
+            pass = (*rec->pred)(QF_active_[p], e);
+        } else { /* 键匹配过滤器 */
+            uint8_t const *const k = (uint8_t const *)e + rec->offset;
+            uint32_t v;
+            if (rec->size == 1U) {
+                v = (uint32_t)*k;
+            } else if (rec->size == 2U) {
+                v = (uint32_t)*(uint16_t const *)k;
+            } else {
+                v = *(uint32_t const *)k;
+            }
+            pass = (v == rec->key);
+        }
+
+        if (!pass) {
+            QPSet_remove(subscrList, p); /* 不投递给该订阅者 */
+            QPSet_insert(&dropped, p);
+        }
+    }
+
+    if (QPSet_notEmpty(&dropped)) {
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+        for (f = 0U; f < QF_psFilterNum_; ++f) {
+            if ((QF_psFilter_[f].sig == e->sig)
+                && QPSet_hasElement(&dropped, (uint_fast8_t)QF_psFilter_[f].prio)) {
+                ++QF_psFilter_[f].nFiltered;
+            }
+        }
+        QF_CRIT_X_();
+    }
+}
+#endif /* QF_MAX_PS_FILTER */
+
+#ifdef QF_PS_SPARSE
+/****************************************************************************/
+/**
+ * @brief
+ * 在按信号排序的稀疏订阅存储中二分查找信号 @p sig, 代价为 O(log n),
+ * n 为当前至少有一个订阅者的信号数.
+ *
+ * @param[in]  sig 要查找的信号
+ * @param[out] idx 找到时为元素的位置; 否则为保持排序的插入位置
+ *
+ * @returns 'true' 表示找到该信号
+ *
+ * @note 必须在临界区内调用
+ */
+static bool QF_psFind_(QSignal const sig, uint_fast16_t *const idx)
+{
+    uint_fast16_t lo = 0U;
+    uint_fast16_t hi = QF_subscrNum_;
+    bool found       = false;
+
+    while (lo < hi) {
+        uint_fast16_t const mid = (lo + hi) >> 1;
+        QSignal const s         = QF_PTR_AT_(QF_subscrList_, mid).sig;
+        if (s < sig) {
+            lo = mid + 1U;
+        } else if (s > sig) {
+            hi = mid;
+        } else {
+            lo    = mid;
+            found = true;
+            break;
+        }
+    }
+    *idx = lo;
+    return found;
 }
+#endif /* QF_PS_SPARSE */
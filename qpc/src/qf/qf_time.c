@@ -51,7 +51,10 @@
 Q_DEFINE_THIS_MODULE("qf_time")
 
 /* Package-scope objects ****************************************************/
-QTimeEvt QF_timeEvtHead_[QF_MAX_TICK_RATE]; /* 时间事件链表头 */
+#ifndef QF_CONTEXT /* 否则在 QF 实例上下文中, 见 qf_pkg.h */
+QTimeEvt QF_timeEvtHead_[QF_MAX_TICK_RATE];       /* 时间事件链表头 */
+uint32_t volatile QF_tickCtr_[QF_MAX_TICK_RATE]; /* 单调滴答计数器 */
+#endif
 
 /****************************************************************************/
 #ifdef Q_SPY
@@ -80,6 +83,8 @@ void QF_tickX_(uint_fast8_t const tickRate)
 
     QF_CRIT_E_();
 
+    ++QF_tickCtr_[tickRate]; /* 推进单调时基 */
+
     QS_BEGIN_NOCRIT_PRE_(QS_QF_TICK, 0U)
     ++prev->ctr;
     QS_TEC_PRE_(prev->ctr); /* 滴答计数器 */
@@ -141,18 +146,48 @@ void QF_tickX_(uint_fast8_t const tickRate)
                     QS_END_NOCRIT_PRE_()
                 }
 
-                QS_BEGIN_NOCRIT_PRE_(QS_QF_TIMEEVT_POST, act->prio)
-                QS_TIME_PRE_();            /* timestamp */
-                QS_OBJ_PRE_(t);            /* the time event object */
-                QS_SIG_PRE_(t->super.sig); /* signal of this time event */
-                QS_OBJ_PRE_(act);          /* the target AO */
-                QS_U8_PRE_(tickRate);      /* tick rate */
-                QS_END_NOCRIT_PRE_()
+                /* 绝对时间事件的上一次投递仍未被取出? */
+                if ((t->super.refCtr_ & (TE_IS_ABS | TE_IS_PENDING))
+                    == (TE_IS_ABS | TE_IS_PENDING)) {
+                    /* 不重复投递, 只记录超限(饱和计数), 相位保持不变 */
+                    if (t->overrun != (QTimeEvtCtr)(~(QTimeEvtCtr)0)) {
+                        ++t->overrun;
+                    }
+                    QF_CRIT_X_(); /* 退出临界区以减少延迟 */
+
+                    /* 防止临界区合并, 参见 NOTE1 */
+                    QF_CRIT_EXIT_NOP();
+                } else {
+                    if ((t->super.refCtr_ & TE_IS_ABS) != 0U) {
+                        t->super.refCtr_ |= TE_IS_PENDING; /* 在 QActive_get_() 中清除 */
+                    }
+
+                    QS_BEGIN_NOCRIT_PRE_(QS_QF_TIMEEVT_POST, act->prio)
+                    QS_TIME_PRE_();            /* timestamp */
+                    QS_OBJ_PRE_(t);            /* the time event object */
+                    QS_SIG_PRE_(t->super.sig); /* signal of this time event */
+                    QS_OBJ_PRE_(act);          /* the target AO */
+                    QS_U8_PRE_(tickRate);      /* tick rate */
+                    QS_END_NOCRIT_PRE_()
 
-                QF_CRIT_X_(); /* 在投递事件前退出临界区 */
+#ifdef QXK_H
+                    /* 扩展线程的阻塞超时? (内部信号小于 Q_USER_SIG) */
+                    if ((enum_t)t->super.sig < (enum_t)Q_USER_SIG) {
+                        QXThread_timeout_(act); /* 解除线程的阻塞 */
+                        QF_CRIT_X_();
+                    } else {
+                        QF_CRIT_X_(); /* 在投递事件前退出临界区 */
+
+                        /* QACTIVE_POST() 内部会在队列溢出时断言 */
+                        QACTIVE_POST(act, &t->super, sender);
+                    }
+#else
+                    QF_CRIT_X_(); /* 在投递事件前退出临界区 */
 
-                /* QACTIVE_POST() 内部会在队列溢出时断言 */
-                QACTIVE_POST(act, &t->super, sender);
+                    /* QACTIVE_POST() 内部会在队列溢出时断言 */
+                    QACTIVE_POST(act, &t->super, sender);
+#endif /* QXK_H */
+                }
             } else {
                 prev = t;     /* 移动到该时间事件 */
                 QF_CRIT_X_(); /* 退出临界区以减少延迟 */
@@ -164,6 +199,14 @@ void QF_tickX_(uint_fast8_t const tickRate)
         QF_CRIT_E_(); /* 重新进入临界区继续处理 */
     }
     QF_CRIT_X_();
+
+#ifdef QF_TMO_WHEEL_SIZE
+#ifdef Q_SPY
+    QF_tmoTick_(tickRate, sender); /* 推进超时服务的时间轮 */
+#else
+    QF_tmoTick_(tickRate); /* 推进超时服务的时间轮 */
+#endif
+#endif
 }
 
 /*****************************************************************************
@@ -203,6 +246,102 @@ bool QF_noTimeEvtsActiveX(uint_fast8_t const tickRate)
     return inactive;
 }
 
+/****************************************************************************/
+/**
+ * @brief
+ * 读取给定滴答速率的单调时基, 即自 QF_init() 以来 QF_tickX_() 被调用的次数.
+ * 该计数器为 32 位, 回绕后继续计数; 比较两个时刻时应使用无符号差值.
+ *
+ * @param[in] tickRate  系统时钟滴答速率.
+ *
+ * @returns 给定速率下已处理的时钟滴答数(对 2^32 取模).
+ *
+ * @note
+ * 时基统计的是 \b 已处理 的滴答. 当滴答由 ::QTicker 处理时,
+ * 尚在 QTicker 中累积的滴答不计入, 直到 QTicker_dispatch_() 处理它们.
+ */
+uint32_t QF_getTickCtrX(uint_fast8_t const tickRate)
+{
+    uint32_t ret;
+    QF_CRIT_STAT_
+
+    /** @pre 滴答速率必须在有效范围内 */
+    Q_REQUIRE_ID(100, tickRate < QF_MAX_TICK_RATE);
+
+    QF_CRIT_E_();
+    ret = QF_tickCtr_[tickRate];
+    QF_CRIT_X_();
+
+    return ret;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 在一个临界区内把给定速率的时基向前推进 n 个滴答, 效果与调用 n 次
+ * QF_tickX_() 相同, 其中 n 是不超过 @p maxTicks 的最大值, 使得被跳过的
+ * 滴答中没有任何时间事件 (以及超时服务的记录) 到期. 下一个到期的滴答
+ * 仍然要由 QF_tickX_() 处理. 用于无滴答空闲, 或者在主机仿真中直接跳到
+ * 下一个到期时刻 (见 ports/posix-qv 的 QF_SIM).
+ *
+ * @param[in] tickRate 系统时钟滴答速率
+ * @param[in] maxTicks 最多跳过的滴答数
+ *
+ * @returns 实际跳过的滴答数 n. 如果 n < @p maxTicks, 则第 n + 1 个滴答
+ * 会有超时到期.
+ *
+ * @note 执行时间与该速率下已启动的时间事件数 (和超时服务时间轮的
+ * 槽数) 成正比. 不能与同一速率的 QF_tickX_() 并发调用.
+ */
+uint32_t QF_tickSkipX(uint_fast8_t const tickRate, uint32_t const maxTicks)
+{
+    uint32_t n = maxTicks;
+    uint_fast8_t pass;
+    uint_fast8_t list;
+    QTimeEvt *t;
+    QF_CRIT_STAT_
+
+    /** @pre 滴答速率必须在有效范围内 */
+    Q_REQUIRE_ID(200, tickRate < QF_MAX_TICK_RATE);
+
+    QF_CRIT_E_();
+
+    /* 第一遍求出能跳过的滴答数, 第二遍推进计数器; 两个链表 (已链接的和
+     * 新激活的) 在每个滴答中都会被递减, 因此同样处理.
+     * ctr 为 0 的时间事件等待移除, 不参与.
+     */
+    for (pass = 0U; pass < 2U; ++pass) {
+        t = QF_timeEvtHead_[tickRate].next;
+        for (list = 0U; list < 2U; ++list) {
+            for (; t != (QTimeEvt *)0; t = t->next) {
+                if (t->ctr == 0U) {
+                    /* 等待移除 */
+                } else if (pass == 0U) {
+                    if (((uint32_t)t->ctr - 1U) < n) {
+                        n = (uint32_t)t->ctr - 1U;
+                    }
+                } else {
+                    t->ctr -= (QTimeEvtCtr)n;
+                }
+            }
+            t = (QTimeEvt *)QF_timeEvtHead_[tickRate].act;
+        }
+#ifdef QF_TMO_WHEEL_SIZE
+        if (pass == 0U) {
+            n = QF_tmoSkip_(tickRate, n); /* 同时推进超时服务的时间轮 */
+        }
+#endif
+    }
+
+    QF_tickCtr_[tickRate] += n;
+#ifdef Q_SPY
+    QF_timeEvtHead_[tickRate].ctr += (QTimeEvtCtr)n; /* QS 的滴答计数 */
+#endif
+    QF_CRIT_X_();
+
+    return n;
+}
+
 /****************************************************************************/
 /**
  * @brief
@@ -227,6 +366,7 @@ void QTimeEvt_ctorX(QTimeEvt *const me, QActive *const act,
     me->next      = (QTimeEvt *)0; /* 下一个时间事件指针置空 */
     me->ctr       = 0U;            /* 计数器置零 */
     me->interval  = 0U;            /* 周期间隔置零 */
+    me->overrun   = 0U;            /* 超限计数置零 */
     me->super.sig = (QSignal)sig;  /* 记录事件信号 */
 
     /* 为了向后兼容 QTimeEvt_ctor(), 活动对象指针可以未初始化(NULL),
@@ -242,6 +382,9 @@ void QTimeEvt_ctorX(QTimeEvt *const me, QActive *const act,
      */
     /* 时间事件不使用 refCtr_, 因此可重用来保存 tickRate 及其他信息 */
     me->super.refCtr_ = (uint8_t)tickRate;
+#ifdef QV_EDF
+    me->super.deadline = 0U; /* 使用接收 AO 的默认截止期限 */
+#endif
 }
 
 /****************************************************************************/
@@ -281,6 +424,7 @@ void QTimeEvt_armX(QTimeEvt *const me,
     QF_CRIT_E_();
     me->ctr      = nTicks;   /* 设置计数器 */
     me->interval = interval; /* 设置周期间隔 */
+    me->super.refCtr_ &= (uint8_t)(~TE_IS_ABS & 0xFFU); /* 相对时间模式 */
 
     /* 判断时间事件是否未链接? */
     /* 注意: 在单个指定滴答速率的滴答周期中, 时间事件可能已解除激活但仍在列表中,
@@ -310,6 +454,178 @@ void QTimeEvt_armX(QTimeEvt *const me,
     QF_CRIT_X_();
 }
 
+/****************************************************************************/
+/**
+ * @brief
+ * 在给定滴答速率单调时基(见 QF_getTickCtrX())的绝对时刻 @p tick 激活时间事件,
+ * 并可设置周期间隔. 与 QTimeEvt_armX() 不同, 到期时刻与调用时机无关,
+ * 因此控制回路可以用 "上次到期时刻 + 周期" 来精确保持节拍.
+ *
+ * @param[in,out] me       指向时间事件对象的指针
+ * @param[in]     tick     到期的绝对时钟滴答(按关联的滴答速率计)
+ * @param[in]     interval 周期时间事件的间隔(单位: 时钟滴答数), 0 表示一次性
+ *
+ * @note
+ * 如果 @p tick 已经过去(含当前滴答): 一次性时间事件在下一个滴答到期;
+ * 周期时间事件按 @p tick + k * @p interval 跳到下一个未来时刻, 保持原有相位,
+ * 错过的 k 次到期计入超限计数.
+ *
+ * @note
+ * 用本函数启动的时间事件到期时, 如果上一次投递的事件仍在活动对象的队列中,
+ * 则不再重复投递, 只增加超限计数(见 QTimeEvt_getOverrun()).
+ * 这样在负载较重(例如 ::QTicker 集中处理累积的滴答)时,
+ * 队列中最多只有一个该时间事件, 且周期相位不会漂移.
+ */
+void QTimeEvt_armAtX(QTimeEvt *const me,
+                     uint32_t const tick, QTimeEvtCtr const interval)
+{
+    uint_fast8_t tickRate = ((uint_fast8_t)me->super.refCtr_ & TE_TICK_RATE);
+    uint32_t delta;
+#ifdef Q_SPY
+    uint_fast8_t const qs_id = ((QActive *)(me->act))->prio;
+#endif
+    QF_CRIT_STAT_
+
+    /** @pre 宿主 AO 必须有效, 时间事件必须未激活, 信号必须有效 */
+    Q_REQUIRE_ID(700, (me->act != (void *)0) && (me->ctr == 0U) && (tickRate < (uint_fast8_t)QF_MAX_TICK_RATE) && (me->super.sig >= (QSignal)Q_USER_SIG));
+
+    QF_CRIT_E_();
+    delta = tick - QF_tickCtr_[tickRate]; /* 到期前剩余的滴答数(模 2^32) */
+
+    /* 到期时刻已经过去(或就是当前滴答)? */
+    if ((delta == 0U) || (delta > 0x7FFFFFFFU)) {
+        if (interval != 0U) {
+            uint32_t const late   = (uint32_t)(0U - delta);
+            uint32_t const missed = (late / (uint32_t)interval) + 1U;
+            uint32_t const ovr    = (uint32_t)me->overrun + missed;
+
+            delta = (missed * (uint32_t)interval) - late; /* [1..interval] */
+            me->overrun = (ovr < (uint32_t)(QTimeEvtCtr)(~(QTimeEvtCtr)0))
+                              ? (QTimeEvtCtr)ovr
+                              : (QTimeEvtCtr)(~(QTimeEvtCtr)0);
+        } else {
+            delta = 1U; /* 一次性: 在下一个滴答到期 */
+        }
+    }
+
+    /** @pre 剩余滴答数必须能用 ::QTimeEvtCtr 表示 */
+    Q_REQUIRE_CRIT_(710, delta <= (uint32_t)(QTimeEvtCtr)(~(QTimeEvtCtr)0));
+
+    me->ctr      = (QTimeEvtCtr)delta;
+    me->interval = interval;
+    me->super.refCtr_ |= TE_IS_ABS; /* 绝对时间模式 */
+
+    /* 时间事件未链接? 参见 QTimeEvt_armX() 中的说明 */
+    if ((me->super.refCtr_ & TE_IS_LINKED) == 0U) {
+        me->super.refCtr_ |= TE_IS_LINKED; /* 标记为已链接 */
+        me->next                      = (QTimeEvt *)QF_timeEvtHead_[tickRate].act;
+        QF_timeEvtHead_[tickRate].act = me;
+    }
+
+    QS_BEGIN_NOCRIT_PRE_(QS_QF_TIMEEVT_ARM, qs_id)
+    QS_TIME_PRE_();        /* timestamp */
+    QS_OBJ_PRE_(me);       /* this time event object */
+    QS_OBJ_PRE_(me->act);  /* the active object */
+    QS_TEC_PRE_(me->ctr);  /* the number of ticks */
+    QS_TEC_PRE_(interval); /* the interval */
+    QS_U8_PRE_(tickRate);  /* tick rate */
+    QS_END_NOCRIT_PRE_()
+
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 与 QTimeEvt_armX() 相同, 但允许时间事件在窗口
+ * [@p nTicks, @p nTicks + @p slack] 内的任意滴答到期.
+ * 框架在窗口内选择单调时基(见 QF_getTickCtrX())上 2^k 的整数倍滴答,
+ * 其中 2^k 是不大于 @p slack + 1 的最大 2 的幂. 这样, 大量对精确到期时刻
+ * 不敏感的超时会自然地对齐到少数共同的滴答上, 在同一次 QF_tickX_()
+ * 中集中投递, 减少产生投递的滴答数以及滴答中断的突发负载.
+ *
+ * @param[in,out] me       指向时间事件对象的指针
+ * @param[in]     nTicks   最早到期的时钟滴答数(按关联的滴答速率计)
+ * @param[in]     interval 周期时间事件的间隔(单位: 时钟滴答数)
+ * @param[in]     slack    允许延后的最大滴答数, 0 等价于 QTimeEvt_armX()
+ *
+ * @note
+ * 对齐只在启动时进行一次. 周期时间事件的 @p interval 如果是对齐粒度的
+ * 整数倍, 之后的每次到期仍保持对齐.
+ */
+void QTimeEvt_armSlackX(QTimeEvt *const me,
+                        QTimeEvtCtr const nTicks, QTimeEvtCtr const interval,
+                        QTimeEvtCtr const slack)
+{
+    uint_fast8_t tickRate = ((uint_fast8_t)me->super.refCtr_ & TE_TICK_RATE);
+    uint32_t gran = 1U; /* 对齐粒度, 2 的幂 */
+    uint32_t now;
+    uint32_t delta;
+#ifdef Q_SPY
+    uint_fast8_t const qs_id = ((QActive *)(me->act))->prio;
+#endif
+    QF_CRIT_STAT_
+
+    /** @pre 与 QTimeEvt_armX() 相同, 且到期窗口的末端不能超出计数器范围 */
+    Q_REQUIRE_ID(800, (me->act != (void *)0) && (me->ctr == 0U) && (nTicks != 0U) && (tickRate < (uint_fast8_t)QF_MAX_TICK_RATE) && (me->super.sig >= (QSignal)Q_USER_SIG) && (((uint32_t)nTicks + (uint32_t)slack) <= (uint32_t)(QTimeEvtCtr)(~(QTimeEvtCtr)0)));
+
+    while ((gran <= 0x8000U) && ((gran << 1) <= ((uint32_t)slack + 1U))) {
+        gran <<= 1;
+    }
+
+    QF_CRIT_E_();
+    now   = QF_tickCtr_[tickRate];
+    delta = ((now + (uint32_t)nTicks + (uint32_t)slack) & ~(gran - 1U)) - now;
+
+    me->ctr      = (QTimeEvtCtr)delta; /* delta 落在 [nTicks, nTicks + slack] */
+    me->interval = interval;
+    me->super.refCtr_ &= (uint8_t)(~TE_IS_ABS & 0xFFU); /* 相对时间模式 */
+
+    /* 时间事件未链接? 参见 QTimeEvt_armX() 中的说明 */
+    if ((me->super.refCtr_ & TE_IS_LINKED) == 0U) {
+        me->super.refCtr_ |= TE_IS_LINKED; /* 标记为已链接 */
+        me->next                      = (QTimeEvt *)QF_timeEvtHead_[tickRate].act;
+        QF_timeEvtHead_[tickRate].act = me;
+    }
+
+    QS_BEGIN_NOCRIT_PRE_(QS_QF_TIMEEVT_ARM, qs_id)
+    QS_TIME_PRE_();        /* timestamp */
+    QS_OBJ_PRE_(me);       /* this time event object */
+    QS_OBJ_PRE_(me->act);  /* the active object */
+    QS_TEC_PRE_(me->ctr);  /* the number of ticks */
+    QS_TEC_PRE_(interval); /* the interval */
+    QS_U8_PRE_(tickRate);  /* tick rate */
+    QS_END_NOCRIT_PRE_()
+
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 读取并清零时间事件的超限计数, 即由于上一次投递尚未被处理,
+ * 或 QTimeEvt_armAtX() 的到期时刻已经过去而被合并掉的到期次数.
+ *
+ * @param[in,out] me   指向时间事件对象的指针
+ *
+ * @returns 自上次调用以来的超限次数(饱和于 ::QTimeEvtCtr 的最大值).
+ *
+ * @note
+ * 该函数是线程安全的, 通常在处理该时间事件的状态中调用.
+ */
+QTimeEvtCtr QTimeEvt_getOverrun(QTimeEvt *const me)
+{
+    QTimeEvtCtr ret;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+    ret         = me->overrun;
+    me->overrun = 0U;
+    QF_CRIT_X_();
+
+    return ret;
+}
+
 /****************************************************************************/
 /**
  * @brief
@@ -0,0 +1,376 @@
+/**
+ * @file
+ * @brief QF timeout service (QF_tmoInit(), QActive_armTmo(), QActive_cancelTmo())
+ * @ingroup qf
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2020 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#define QP_IMPL      /* this is QP implementation */
+#include "qf_port.h" /* QF port */
+#include "qf_pkg.h"  /* QF package-scope interface */
+#include "qassert.h" /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+#ifdef QF_TMO_WHEEL_SIZE /* 是否启用超时服务? */
+
+Q_DEFINE_THIS_MODULE("qf_tmo")
+
+/* Package-scope objects ****************************************************/
+#ifndef QF_CONTEXT /* 否则在 QF 实例上下文中, 见 qf_pkg.h */
+QTmoSvc QF_tmo_; /* 超时服务 */
+#endif
+
+#define TMO_NONE     0xFFFFU /* 空索引 */
+#define TMO_FREE     0xFFFFU /* QTmo.slot: 记录空闲 */
+#define TMO_EXPIRING 0xFFFEU /* QTmo.slot: 已到期, 正在投递 */
+
+#if (QF_TMO_WHEEL_SIZE > 0x8000U)
+#error "QF_TMO_WHEEL_SIZE exceeds the maximum of 0x8000"
+#endif
+
+/*! 由记录索引和代数组成句柄, 低 16 位为 (索引 + 1), 因此句柄永远不为 0 */
+#define TMO_HANDLE_(idx_, gen_) \
+    (((QTmoHandle)(gen_) << 16) | (QTmoHandle)((idx_) + 1U))
+
+/*! 将记录归还到空闲链表(必须在临界区内调用) */
+static void QF_tmoFree_(uint_fast16_t const idx);
+
+/*! 将记录从时间轮的槽链表中摘除(必须在临界区内调用) */
+static void QF_tmoUnlink_(QTmo *const t);
+
+/****************************************************************************/
+/**
+ * @brief
+ * 初始化超时服务: 提供超时记录池的存储, 并指定驱动时间轮的滴答速率.
+ * 之后每次对该速率调用 QF_tickX_() 时, 时间轮前进一个槽.
+ *
+ * @param[in] tmoSto   超时记录数组
+ * @param[in] tmoLen   记录数量, 即可同时启动的超时的最大数量
+ * @param[in] tickRate 驱动时间轮的系统时钟滴答速率
+ *
+ * @note
+ * 每个时钟滴答只处理一个槽, 并且在一个临界区内完成, 临界区的长度
+ * 与该槽中的记录数成正比. 选择 #QF_TMO_WHEEL_SIZE 时应使
+ * (同时启动的超时数 / #QF_TMO_WHEEL_SIZE) 保持较小.
+ *
+ * @note
+ * 超时到期事件从事件池中分配, 因此 QF_poolInit() 必须提供
+ * 块大小不小于 sizeof(::QTmoEvt) 的事件池.
+ */
+void QF_tmoInit(QTmo *const tmoSto, uint_fast16_t const tmoLen,
+                uint_fast8_t const tickRate)
+{
+    uint_fast16_t i;
+    QF_CRIT_STAT_
+
+    /** @pre 存储必须有效, 记录数必须在范围内, 滴答速率必须有效 */
+    Q_REQUIRE_ID(100, (tmoSto != (QTmo *)0) && (tmoLen > 0U) && (tmoLen < TMO_NONE) && (tickRate < QF_MAX_TICK_RATE));
+
+    /* 将所有记录串成空闲链表 */
+    for (i = 0U; i < tmoLen; ++i) {
+        tmoSto[i].act    = (QActive *)0;
+        tmoSto[i].rounds = 0U;
+        tmoSto[i].next   = (uint16_t)(i + 1U);
+        tmoSto[i].prev   = (uint16_t)TMO_NONE;
+        tmoSto[i].slot   = (uint16_t)TMO_FREE;
+        tmoSto[i].gen    = 0U;
+    }
+    tmoSto[tmoLen - 1U].next = (uint16_t)TMO_NONE;
+
+    QF_CRIT_E_();
+    for (i = 0U; i < QF_TMO_WHEEL_SIZE; ++i) {
+        QF_tmo_.wheel[i] = (uint16_t)TMO_NONE;
+    }
+    QF_tmo_.len      = (uint16_t)tmoLen;
+    QF_tmo_.freeHead = 0U;
+    QF_tmo_.nFree    = (uint16_t)tmoLen;
+    QF_tmo_.nMin     = (uint16_t)tmoLen;
+    QF_tmo_.cursor   = 0U;
+    QF_tmo_.tickRate = (uint8_t)tickRate;
+    QF_tmo_.sto      = tmoSto; /* 最后设置, QF_tmoTick_() 据此判断是否已初始化 */
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 为活动对象启动一个一次性超时. 超时记录从 QF_tmoInit() 提供的记录池中取出,
+ * 到期时框架分配一个 ::QTmoEvt 事件, 以信号 @p sig 投递(FIFO)给 @p me,
+ * 然后自动归还记录.
+ *
+ * @param[in,out] me     指向活动对象的指针
+ * @param[in]     sig    超时事件的信号
+ * @param[in]     nTicks 到期前的时钟滴答数(按 QF_tmoInit() 指定的速率计)
+ *
+ * @returns
+ * 标识该超时的句柄, 可用于 QActive_cancelTmo(), 也会出现在到期事件中.
+ *
+ * @note
+ * 如果记录池耗尽, 该函数会触发断言. 可以用 QF_getTmoMin() 确定记录池的大小.
+ */
+QTmoHandle QActive_armTmo(QActive *const me, enum_t const sig,
+                          QTimeEvtCtr const nTicks)
+{
+    QTmo *t;
+    uint_fast16_t idx;
+    uint_fast16_t slot;
+    QTmoHandle handle;
+    QF_CRIT_STAT_
+
+    /** @pre 超时服务必须已初始化, 滴答数不能为零, 信号必须有效 */
+    Q_REQUIRE_ID(200, (QF_tmo_.sto != (QTmo *)0) && (nTicks != 0U) && (sig >= (enum_t)Q_USER_SIG));
+
+    QF_CRIT_E_();
+    idx = QF_tmo_.freeHead;
+
+    /* 记录池不能耗尽 */
+    Q_ASSERT_CRIT_(210, idx != TMO_NONE);
+
+    t                = &QF_tmo_.sto[idx];
+    QF_tmo_.freeHead = t->next;
+    --QF_tmo_.nFree;
+    if (QF_tmo_.nMin > QF_tmo_.nFree) {
+        QF_tmo_.nMin = QF_tmo_.nFree; /* 记录最小空闲数 */
+    }
+
+    t->act    = me;
+    t->sig    = (QSignal)sig;
+    t->rounds = (QTimeEvtCtr)((nTicks - 1U) / QF_TMO_WHEEL_SIZE);
+    slot      = ((uint_fast16_t)QF_tmo_.cursor + nTicks)
+           & (QF_TMO_WHEEL_SIZE - 1U);
+
+    /* 插入到槽链表的头部 */
+    t->slot = (uint16_t)slot;
+    t->prev = (uint16_t)TMO_NONE;
+    t->next = QF_tmo_.wheel[slot];
+    if (t->next != TMO_NONE) {
+        QF_tmo_.sto[t->next].prev = (uint16_t)idx;
+    }
+    QF_tmo_.wheel[slot] = (uint16_t)idx;
+
+    handle = TMO_HANDLE_(idx, t->gen);
+    QF_CRIT_X_();
+
+    return handle;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 按句柄取消活动对象的超时, 时间复杂度 O(1).
+ *
+ * @param[in] me     指向活动对象的指针(必须是启动该超时的活动对象)
+ * @param[in] handle QActive_armTmo() 返回的句柄
+ *
+ * @returns
+ * 'true' 表示超时确实被取消, 不会再收到到期事件.
+ * 'false' 表示超时已经到期(到期事件已经或即将投递)或已被取消,
+ * 与 QTimeEvt_disarm() 的返回值含义相同.
+ *
+ * @note
+ * 句柄中包含记录的代数, 因此对已到期记录的旧句柄调用该函数是安全的,
+ * 即使该记录已经被其他超时重新使用.
+ */
+bool QActive_cancelTmo(QActive const *const me, QTmoHandle const handle)
+{
+    uint_fast16_t const idx = (uint_fast16_t)(handle & 0xFFFFU) - 1U;
+    QTmo *t;
+    bool wasArmed;
+    QF_CRIT_STAT_
+
+    /** @pre 超时服务必须已初始化, 句柄必须在范围内 */
+    Q_REQUIRE_ID(300, (QF_tmo_.sto != (QTmo *)0) && ((handle & 0xFFFFU) != 0U) && (idx < QF_tmo_.len));
+
+    QF_CRIT_E_();
+    t = &QF_tmo_.sto[idx];
+
+    /* 句柄仍然有效, 且记录仍在时间轮中? */
+    if ((t->gen == (uint16_t)(handle >> 16)) && (t->slot < QF_TMO_WHEEL_SIZE)) {
+
+        /* 只有启动超时的活动对象才能取消它 */
+        Q_ASSERT_CRIT_(310, t->act == me);
+
+        QF_tmoUnlink_(t);
+        QF_tmoFree_(idx);
+        wasArmed = true;
+    } else {
+        wasArmed = false;
+    }
+    QF_CRIT_X_();
+
+    return wasArmed;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 查询超时记录池自 QF_tmoInit() 以来的最小空闲记录数("低水位").
+ *
+ * @returns 最小空闲记录数
+ */
+uint_fast16_t QF_getTmoMin(void)
+{
+    uint_fast16_t min;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+    min = QF_tmo_.nMin;
+    QF_CRIT_X_();
+
+    return min;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 推进时间轮一个槽, 并投递该槽中所有到期的超时.
+ * 到期的记录先在一个临界区内从时间轮中摘下, 然后在临界区外分配并投递事件,
+ * 最后归还记录. 正在投递的记录处于 TMO_EXPIRING 状态, 不能被取消.
+ *
+ * @param[in] tickRate 本次 QF_tickX_() 服务的时钟滴答速率
+ * @param[in] sender   指向发送者对象的指针(仅用于 QS 跟踪)
+ */
+#ifdef Q_SPY
+void QF_tmoTick_(uint_fast8_t const tickRate, void const *const sender)
+#else
+void QF_tmoTick_(uint_fast8_t const tickRate)
+#endif
+{
+    uint_fast16_t expired = TMO_NONE; /* 已到期记录的链表 */
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+    if ((QF_tmo_.sto != (QTmo *)0) && (tickRate == QF_tmo_.tickRate)) {
+        uint_fast16_t i;
+
+        QF_tmo_.cursor = (uint16_t)((QF_tmo_.cursor + 1U)
+                                    & (QF_TMO_WHEEL_SIZE - 1U));
+        i = QF_tmo_.wheel[QF_tmo_.cursor];
+        while (i != TMO_NONE) {
+            QTmo *t = &QF_tmo_.sto[i];
+            uint_fast16_t const next = t->next;
+
+            if (t->rounds == 0U) { /* 本圈到期? */
+                QF_tmoUnlink_(t);
+                t->slot = (uint16_t)TMO_EXPIRING;
+                t->next = (uint16_t)expired;
+                expired = i;
+            } else {
+                --t->rounds;
+            }
+            i = next;
+        }
+    }
+    QF_CRIT_X_();
+
+    while (expired != TMO_NONE) {
+        QTmo *t = &QF_tmo_.sto[expired];
+        uint_fast16_t const next = t->next;
+        QTmoEvt *te = (QTmoEvt *)QF_newX_((uint_fast16_t)sizeof(QTmoEvt),
+                                          QF_NO_MARGIN, (enum_t)t->sig);
+        te->handle = TMO_HANDLE_(expired, t->gen);
+
+        /* QACTIVE_POST() 内部会在队列溢出时断言 */
+        QACTIVE_POST(t->act, &te->super, sender);
+
+        QF_CRIT_E_();
+        QF_tmoFree_(expired);
+        QF_CRIT_X_();
+
+        expired = next;
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 只跳过下一个非空槽之前的空槽 (非空槽中的记录即使还要转几圈,
+ * 也需要 QF_tmoTick_() 递减它们的圈数), 因此跳过的滴答数少于
+ * #QF_TMO_WHEEL_SIZE. 时间轮中没有记录时可以跳过任意多个滴答.
+ *
+ * @returns 可以跳过的滴答数 (不超过 @p maxTicks), 时间轮已按此推进.
+ */
+uint32_t QF_tmoSkip_(uint_fast8_t const tickRate, uint32_t const maxTicks)
+{
+    uint32_t n = maxTicks;
+
+    if ((QF_tmo_.sto != (QTmo *)0) && (tickRate == QF_tmo_.tickRate)
+        && (QF_tmo_.nFree != QF_tmo_.len))
+    {
+        uint32_t d;
+        for (d = 0U; d < n; ++d) { /* 第 d + 1 个滴答处理的槽是否为空? */
+            if (QF_tmo_.wheel[(QF_tmo_.cursor + d + 1U)
+                              & (QF_TMO_WHEEL_SIZE - 1U)] != TMO_NONE) {
+                n = d;
+            }
+        }
+        QF_tmo_.cursor = (uint16_t)((QF_tmo_.cursor + n)
+                                    & (QF_TMO_WHEEL_SIZE - 1U));
+    }
+    return n;
+}
+
+/****************************************************************************/
+static void QF_tmoUnlink_(QTmo *const t)
+{
+    if (t->prev != TMO_NONE) {
+        QF_tmo_.sto[t->prev].next = t->next;
+    } else {
+        QF_tmo_.wheel[t->slot] = t->next;
+    }
+    if (t->next != TMO_NONE) {
+        QF_tmo_.sto[t->next].prev = t->prev;
+    }
+}
+
+/****************************************************************************/
+static void QF_tmoFree_(uint_fast16_t const idx)
+{
+    QTmo *t = &QF_tmo_.sto[idx];
+
+    t->act  = (QActive *)0;
+    t->slot = (uint16_t)TMO_FREE;
+    ++t->gen; /* 使该记录的旧句柄失效 */
+    t->next          = QF_tmo_.freeHead;
+    QF_tmo_.freeHead = (uint16_t)idx;
+    ++QF_tmo_.nFree;
+}
+
+#endif /* QF_TMO_WHEEL_SIZE */
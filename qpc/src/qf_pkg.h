@@ -130,21 +130,101 @@ bool QActive_post_(QActive *const me, QEvt const *const e,
 /*! 活动对象的事件投递(LIFO)操作实现 */
 void QActive_postLIFO_(QActive *const me, QEvt const *const e);
 
+/*! 在临界区内将事件 FIFO 插入原生事件队列(不增加引用计数, 不发出就绪信号) */
+#ifdef Q_SPY
+bool QActive_insertFIFO_(QActive *const me, QEvt const *const e,
+                         void const *const sender);
+
+/*! 调用 QActive_insertFIFO_() (QS 跟踪时记录发送者) */
+#define QACTIVE_INSERT_FIFO_(me_, e_, sender_) \
+    QActive_insertFIFO_((me_), (e_), (sender_))
+#else
+bool QActive_insertFIFO_(QActive *const me, QEvt const *const e);
+
+#define QACTIVE_INSERT_FIFO_(me_, e_, dummy) \
+    QActive_insertFIFO_((me_), (e_))
+#endif
+
 /****************************************************************************/
 /*! 每个时钟节拍速率对应的时间事件链表头 */
 extern QTimeEvt QF_timeEvtHead_[QF_MAX_TICK_RATE];
 
+/*! 每个时钟节拍速率对应的 32 位单调滴答计数器(每次 QF_tickX_() 加 1) */
+extern uint32_t volatile QF_tickCtr_[QF_MAX_TICK_RATE];
+
 /** 以下标志和位掩码用于 QTimeEvt(继承自 QEvt)中 refCtr_ 属性.
  * 该属性不用于时间事件的引用计数, 因为 @c poolId_ 属性为 0(“静态事件”).
  */
 #define TE_IS_LINKED    (1U << 7)
 #define TE_WAS_DISARMED (1U << 6)
+#define TE_IS_ABS       (1U << 5) /*!< 由 QTimeEvt_armAtX() 启动(绝对时间) */
+#define TE_IS_PENDING   (1U << 4) /*!< 已投递但尚未从队列中取出 */
 #define TE_TICK_RATE    0x0FU
 
+#ifdef QF_TMO_WHEEL_SIZE
+/*! 超时服务的内部状态, 参见 QF_tmoInit() */
+typedef struct {
+    QTmo *sto;                          /*!< 超时记录池存储 */
+    uint16_t len;                       /*!< 记录总数 */
+    uint16_t freeHead;                  /*!< 空闲记录链表头 */
+    uint16_t nFree;                     /*!< 空闲记录数 */
+    uint16_t nMin;                      /*!< 最小空闲记录数 */
+    uint16_t cursor;                    /*!< 时间轮当前位置 */
+    uint8_t tickRate;                   /*!< 驱动时间轮的滴答速率 */
+    uint16_t wheel[QF_TMO_WHEEL_SIZE];  /*!< 每个槽的链表头 */
+} QTmoSvc;
+
+extern QTmoSvc QF_tmo_; /*!< 超时服务 */
+
+/*! 由 QF_tickX_() 调用, 推进超时时间轮 */
+#ifdef Q_SPY
+void QF_tmoTick_(uint_fast8_t const tickRate, void const *const sender);
+#else
+void QF_tmoTick_(uint_fast8_t const tickRate);
+#endif
+
+/*! 由 QF_tickSkipX() 在临界区内调用, 跳过时间轮中最多 @p maxTicks 个空槽 */
+uint32_t QF_tmoSkip_(uint_fast8_t const tickRate, uint32_t const maxTicks);
+#endif /* QF_TMO_WHEEL_SIZE */
+
 extern QF_EPOOL_TYPE_ QF_pool_[QF_MAX_EPOOL]; /*!< 分配事件池 */
 extern uint_fast8_t QF_maxPool_;              /*!< 已初始化的事件池数量 */
 extern QSubscrList *QF_subscrList_;           /*!< 订阅者列表数组 */
 extern enum_t QF_maxPubSignal_;               /*!< 最大已发布信号 */
+#if (QF_MAX_PS_GROUP > 0U)
+/*! 信号组订阅表的元素: 满足 lo <= sig <= hi 且 (sig & mask) == match 的信号 */
+typedef struct {
+    QPSet set;     /*!< 订阅了该信号组的活动对象集合 */
+    QSignal lo;    /*!< 范围下限 */
+    QSignal hi;    /*!< 范围上限 */
+    QSignal mask;  /*!< 信号掩码 */
+    QSignal match; /*!< 掩码匹配值 */
+} QPSGroup;
+
+extern QPSGroup QF_psGroup_[QF_MAX_PS_GROUP]; /*!< 信号组订阅表 */
+extern uint_fast8_t QF_psGroupNum_;           /*!< 已使用的信号组数 */
+#endif
+
+#if (QF_MAX_PS_FILTER > 0U)
+/*! 订阅内容过滤表的元素: 活动对象 prio 对信号 sig 的过滤器 */
+typedef struct {
+    QPSFilter pred;     /*!< 谓词过滤器; 键匹配过滤时为 NULL */
+    uint32_t key;       /*!< 键匹配过滤器的键值 */
+    uint32_t nFiltered; /*!< 被拦截(未投递)的事件数 */
+    QSignal sig;        /*!< 被过滤的信号 */
+    uint16_t offset;    /*!< 键在事件中的字节偏移 */
+    uint8_t prio;       /*!< 订阅者的优先级 */
+    uint8_t size;       /*!< 键的字节数(1, 2 或 4); 谓词过滤时为 0 */
+} QPSFilterRec;
+
+extern QPSFilterRec QF_psFilter_[QF_MAX_PS_FILTER]; /*!< 订阅内容过滤表 */
+extern uint_fast8_t QF_psFilterNum_;                /*!< 已使用的过滤器数 */
+#endif
+
+#ifdef QF_PS_SPARSE
+extern uint_fast16_t QF_subscrNum_; /*!< 稀疏订阅存储中已使用的元素数 */
+extern uint16_t QF_subscrCnt_[QF_MAX_ACTIVE + 1U]; /*!< 每个 AO 订阅的信号数 */
+#endif
 
 /*! 表示 Native QF 内存池中一个空闲块的结构体 */
 typedef struct QFreeBlock {
@@ -171,4 +251,68 @@ typedef struct QFreeBlock {
  */
 #define QF_PTR_RANGE_(x_, min_, max_) (((min_) <= (x_)) && ((x_) <= (max_)))
 
+#ifdef QF_CONTEXT
+/****************************************************************************/
+/* QF 实例上下文, 见 QF_ctxNew() */
+#ifndef QF_KERNEL_CTX_TYPE_
+#error "QF_CONTEXT is not supported by this kernel"
+#endif
+#ifndef QF_PORT_CTX_TYPE_
+#error "QF_CONTEXT is not supported by this port"
+#endif
+
+/*! 一个 QF 实例的全部状态 */
+/**
+ * @brief
+ * 各成员与非上下文模式下的同名全局对象一一对应, 下面的宏把这些名字
+ * 重定向到当前线程所选上下文中的成员, 因此 QF 代码不需要修改.
+ * 内核 (@c kernel) 和移植层 (@c port) 的状态类型分别由内核头文件和
+ * qf_port.h 提供.
+ */
+struct QFContext {
+    QActive *active[QF_MAX_ACTIVE + 1U];
+    QF_EPOOL_TYPE_ pool[QF_MAX_EPOOL];
+    uint_fast8_t maxPool;
+    QSubscrList *subscrList;
+    enum_t maxPubSignal;
+#if (QF_MAX_PS_GROUP > 0U)
+    QPSGroup psGroup[QF_MAX_PS_GROUP];
+    uint_fast8_t psGroupNum;
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    QPSFilterRec psFilter[QF_MAX_PS_FILTER];
+    uint_fast8_t psFilterNum;
+#endif
+#ifdef QF_PS_SPARSE
+    uint_fast16_t subscrNum;
+    uint16_t subscrCnt[QF_MAX_ACTIVE + 1U];
+#endif
+    QTimeEvt timeEvtHead[QF_MAX_TICK_RATE];
+    uint32_t volatile tickCtr[QF_MAX_TICK_RATE];
+#ifdef QF_TMO_WHEEL_SIZE
+    QTmoSvc tmo;
+#endif
+    QF_KERNEL_CTX_TYPE_ kernel; /*!< 内核状态 */
+    QF_PORT_CTX_TYPE_ port;     /*!< 移植层状态 */
+};
+
+/*! 调用线程当前选中的上下文 */
+extern QF_THREAD_LOCAL QFContext *QF_ctx_;
+
+#define QF_active_       (QF_ctx_->active)
+#define QF_pool_         (QF_ctx_->pool)
+#define QF_maxPool_      (QF_ctx_->maxPool)
+#define QF_subscrList_   (QF_ctx_->subscrList)
+#define QF_maxPubSignal_ (QF_ctx_->maxPubSignal)
+#define QF_psGroup_      (QF_ctx_->psGroup)
+#define QF_psGroupNum_   (QF_ctx_->psGroupNum)
+#define QF_psFilter_     (QF_ctx_->psFilter)
+#define QF_psFilterNum_  (QF_ctx_->psFilterNum)
+#define QF_subscrNum_    (QF_ctx_->subscrNum)
+#define QF_subscrCnt_    (QF_ctx_->subscrCnt)
+#define QF_timeEvtHead_  (QF_ctx_->timeEvtHead)
+#define QF_tickCtr_      (QF_ctx_->tickCtr)
+#define QF_tmo_          (QF_ctx_->tmo)
+#endif /* QF_CONTEXT */
+
 #endif /* QF_PKG_H */
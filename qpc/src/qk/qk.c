@@ -0,0 +1,438 @@
+/**
+ * @file
+ * @brief QK preemptive kernel implementation
+ * @ingroup qk
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#define QP_IMPL      /* this is QP implementation */
+#include "qf_port.h" /* QF port */
+#include "qf_pkg.h"  /* QF package-scope internal interface */
+#include "qassert.h" /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+/* 防止在错误的项目中包含此源文件 */
+#ifndef QK_H
+#error "Source file included in a project NOT based on the QK kernel"
+#endif /* QK_H */
+
+Q_DEFINE_THIS_MODULE("qk")
+
+/* Public-scope objects *****************************************************/
+QK_PrivAttr QK_attr_; /* QK 内核的私有属性 */
+
+/* Local-scope objects ******************************************************/
+/*! 在 QF_run() 中解锁调度器并处理启动期间投递的事件 */
+static void initial_events(void);
+
+/****************************************************************************/
+/**
+ * @brief
+ * 初始化 QF, 必须在调用其他任何 QF 函数之前且仅调用一次.
+ * 通常在 main() 中调用 QF_init(), 甚至在初始化板级支持包 (BSP) 之前.
+ *
+ * @note QF_init() 会清零内部的 QF 变量, 这样即使启动代码没有清零未初始化数据
+ * (C 标准要求的), 框架仍然可以正确启动. QK 调度器在 QF_run() 之前保持加锁,
+ * 因此 main() 中投递的事件不会引起抢占.
+ */
+void QF_init(void)
+{
+    QF_maxPool_      = 0U;
+    QF_subscrList_   = (QSubscrList *)0;
+    QF_maxPubSignal_ = 0;
+#ifdef QF_PS_SPARSE
+    QF_subscrNum_ = 0U;
+#endif
+#if (QF_MAX_PS_GROUP > 0U)
+    QF_psGroupNum_ = 0U;
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    QF_psFilterNum_ = 0U;
+#endif
+
+    QF_bzero(&QF_timeEvtHead_[0], sizeof(QF_timeEvtHead_));
+    QF_bzero((void *)&QF_tickCtr_[0], sizeof(QF_tickCtr_));
+#ifdef QF_TMO_WHEEL_SIZE
+    QF_bzero(&QF_tmo_, sizeof(QF_tmo_));
+#endif
+    QF_bzero(&QF_active_[0], sizeof(QF_active_));
+    QF_bzero(&QK_attr_, sizeof(QK_attr_));
+
+    /* QK 调度器在 QF_run() 之前保持加锁 */
+    QK_attr_.lockPrio = (uint8_t)(QF_MAX_ACTIVE + 1U);
+
+#ifdef QK_INIT
+    QK_INIT(); /* port-specific initialization of the QK kernel */
+#endif
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 该函数用于停止 QF 应用程序. 调用此函数后, QF 会尝试优雅地关闭应用程序.
+ *
+ * @attention
+ * 调用 QF_stop() 后, 应用程序必须终止, 不能继续运行.
+ * 特别地, QF_stop() 不应该之后再调用 QF_init() 来"复活"应用程序.
+ */
+void QF_stop(void)
+{
+    QF_onCleanup(); /* 应用程序特定的清理回调 */
+    /* 对于 QK 内核无需其他操作 */
+}
+
+/****************************************************************************/
+static void initial_events(void)
+{
+    QK_attr_.lockPrio = 0U; /* 解锁调度器 */
+
+    /* 有 AO 在启动期间收到了事件吗? */
+    if (QK_sched_() != 0U) {
+        QK_activate_(); /* 激活 AO 处理这些事件 */
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 通常在 main() 中调用 QF_run(), 在初始化 QF 并通过 QACTIVE_START()
+ * 至少启动一个活动对象之后.
+ *
+ * @returns 在 QK 内核中, QF_run() 函数不会返回.
+ */
+int_t QF_run(void)
+{
+    QF_INT_DISABLE();
+    initial_events(); /* 处理所有在启动期间投递的事件 */
+    QF_INT_ENABLE();
+
+    QF_onStartup(); /* 应用程序特定的启动回调 */
+
+    /* QK 的空闲循环... */
+    for (;;) {
+        QK_onIdle(); /* 应用程序特定的 QK 空闲回调 */
+    }
+#ifdef __GNUC__ /* GNU compiler? */
+    return 0;
+#endif
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 启动活动对象 (AO) 的执行, 并将 AO 注册到框架中.
+ * 同时执行 AO 状态机中的最顶层初始转换.
+ *
+ * @param[in,out] me      指针
+ * @param[in]     prio    启动活动对象时的优先级
+ * @param[in]     qSto    指向事件队列环形缓冲区的存储指针
+ *                        (仅用于内置的 ::QEQueue)
+ * @param[in]     qLen    事件队列长度 [事件数]
+ * @param[in]     stkSto  栈存储指针 (在 QK 内核中必须为 NULL)
+ * @param[in]     stkSize 栈大小 [字节]
+ * @param[in]     par     额外参数指针 (可以为 NULL)
+ *
+ * @note 此函数应通过宏 QACTIVE_START() 调用.
+ */
+void QActive_start_(QActive *const me, uint_fast8_t prio,
+                    QEvt const **const qSto, uint_fast16_t const qLen,
+                    void *const stkSto, uint_fast16_t const stkSize,
+                    void const *const par)
+{
+    QF_CRIT_STAT_
+
+    (void)stkSize; /* unused parameter */
+
+    /** @pre AO 不能在 ISR 中启动, 优先级必须在范围内,
+     * 并且不能提供栈存储, 因为所有 AO 共用同一个栈
+     */
+    Q_REQUIRE_ID(300, (!QK_ISR_CONTEXT_())
+                      && (0U < prio) && (prio <= QF_MAX_ACTIVE)
+                      && (stkSto == (void *)0));
+
+    QEQueue_init(&me->eQueue, qSto, qLen); /* 初始化内置队列 */
+    me->prio = (uint8_t)prio;              /* 设置 AO 当前的优先级 */
+    QF_add_(me);                           /* 添加到 QF */
+
+    QHSM_INIT(&me->super, par, me->prio); /* 执行最顶层初始转换 */
+    QS_FLUSH();                           /* 将跟踪缓冲区刷新到主机 */
+
+    /* QK 已经运行时, 检查该 AO 是否需要立即运行 */
+    QF_CRIT_E_();
+    if (QK_sched_() != 0U) { /* 同步抢占? */
+        QK_activate_();      /* 激活 AO 处理事件 */
+    }
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 该函数锁定 QK 调度器, 使优先级不高于 @p ceiling 的 AO 不能抢占当前 AO,
+ * 而更高优先级的 AO 和中断仍然可以运行 (选择性调度器锁, 即优先级天花板).
+ * 与禁止中断相比, 这种锁只影响可能与当前 AO 共享资源的 AO.
+ *
+ * @param[in] ceiling 调度器锁的天花板优先级
+ *
+ * @returns 调度器锁之前的状态, 必须原样传给 QK_schedUnlock()
+ *
+ * @note 调度器锁可以嵌套, 但必须按后进先出的顺序解锁. 持有调度器锁时,
+ * 当前 AO 不能阻塞 (QK 中的 AO 本来就不阻塞).
+ *
+ * @note 只能在线程级调用, 不能在 ISR 中调用. QF_publish_() 使用同样的锁,
+ * 使多播期间不会发生订阅者之间的抢占.
+ *
+ * @usage
+ * @code
+ * QSchedStatus lockStat;
+ * lockStat = QK_schedLock(N_PHILO + 2U); // 锁定到 Table 的优先级
+ * ... // 访问与 Table 共享的资源
+ * QK_schedUnlock(lockStat);
+ * @endcode
+ */
+QSchedStatus QK_schedLock(uint_fast8_t const ceiling)
+{
+    QSchedStatus stat;
+    QF_CRIT_STAT_
+    QF_CRIT_E_();
+
+    /** @pre 不能在 ISR 中调用调度器锁 */
+    Q_REQUIRE_CRIT_(600, !QK_ISR_CONTEXT_());
+
+    /* 天花板高于当前的锁? */
+    if (QK_attr_.lockPrio < ceiling) {
+        stat              = ((QSchedStatus)QK_attr_.lockPrio << 8);
+        QK_attr_.lockPrio = (uint8_t)ceiling;
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_LOCK, 0U)
+        QS_TIME_PRE_(); /* timestamp */
+        QS_2U8_PRE_(stat >> 8,           /* the previous lock prio */
+                    QK_attr_.lockPrio);  /* the new lock prio */
+        QS_END_NOCRIT_PRE_()
+
+        /* 保存锁持有者 */
+        stat |= (QSchedStatus)QK_attr_.lockHolder;
+        QK_attr_.lockHolder = QK_attr_.actPrio;
+    } else {
+        stat = 0xFFU; /* 调度器没有被锁定 */
+    }
+    QF_CRIT_X_();
+
+    return stat; /* 返回之前的状态 */
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 该函数恢复 QK_schedLock() 之前的调度器锁, 并在需要时立即运行
+ * 锁定期间就绪的更高优先级 AO.
+ *
+ * @param[in] stat QK_schedLock() 返回的调度器锁状态
+ *
+ * @note 只能在线程级调用, 不能在 ISR 中调用.
+ */
+void QK_schedUnlock(QSchedStatus const stat)
+{
+    /* 锁是否由 QK_schedLock() 真正加上? */
+    if (stat != 0xFFU) {
+        uint_fast8_t const lockPrio = (uint_fast8_t)QK_attr_.lockPrio;
+        uint_fast8_t const prevPrio = (uint_fast8_t)(stat >> 8);
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+
+        /** @pre 不能在 ISR 中解锁, 且当前的锁必须高于之前的锁 */
+        Q_REQUIRE_CRIT_(700, (!QK_ISR_CONTEXT_()) && (lockPrio > prevPrio));
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_UNLOCK, 0U)
+        QS_TIME_PRE_();                /* timestamp */
+        QS_2U8_PRE_(lockPrio,          /* lock prio */
+                    prevPrio);         /* previous lock prio */
+        QS_END_NOCRIT_PRE_()
+
+        /* 恢复之前的锁和锁持有者 */
+        QK_attr_.lockPrio   = (uint8_t)prevPrio;
+        QK_attr_.lockHolder = (uint8_t)(stat & 0xFFU);
+
+        /* 锁定期间有更高优先级的 AO 就绪? */
+        if (QK_sched_() != 0U) {
+            QK_activate_(); /* 同步抢占 */
+        }
+
+        QF_CRIT_X_();
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 找出就绪集合中的最高优先级 AO, 如果它可以抢占当前 AO (优先级高于
+ * 当前 AO 和调度器锁的天花板), 将其记录为下一个要运行的 AO.
+ *
+ * @returns 下一个要运行的 AO 的优先级, 或 0 表示不需要抢占
+ *
+ * @note 必须在临界区内调用
+ */
+uint_fast8_t QK_sched_(void)
+{
+    uint_fast8_t p;
+
+    if (QPSet_isEmpty(&QK_attr_.readySet)) {
+        p = 0U; /* 没有就绪的 AO */
+    } else {
+        /* 找出就绪集合中的最高优先级 AO */
+        QPSet_findMax(&QK_attr_.readySet, p);
+
+        /* 不高于当前 AO? */
+        if (p <= (uint_fast8_t)QK_attr_.actPrio) {
+            p = 0U; /* 没有需要抢占的 AO */
+        } else if (p <= (uint_fast8_t)QK_attr_.lockPrio) { /* 被锁定? */
+            p = 0U; /* 不能抢占 */
+        } else {
+            QK_attr_.nextPrio = (uint8_t)p; /* 下一个要运行的 AO */
+        }
+    }
+    return p;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 从 QK_attr_.nextPrio 开始, 依次运行优先级高于当前 AO 的所有就绪 AO 的
+ * RTC 步骤, 然后返回被抢占的 AO. 同步抢占 (在线程级投递事件) 时由
+ * QACTIVE_EQUEUE_SIGNAL_() 调用; 异步抢占 (在 ISR 中投递事件) 时由
+ * 移植层 (例如 ARM Cortex-M 上的 PendSV) 在线程模式下调用.
+ *
+ * @note 必须在临界区内调用, 返回时也处于临界区内.
+ */
+void QK_activate_(void)
+{
+    uint_fast8_t const pin = (uint_fast8_t)QK_attr_.actPrio; /* 保存被抢占的优先级 */
+    uint_fast8_t p         = (uint_fast8_t)QK_attr_.nextPrio;
+    QActive *a;
+#if (defined QK_ON_CONTEXT_SW) || (defined Q_SPY)
+    uint_fast8_t pprev = pin;
+#endif /* QK_ON_CONTEXT_SW || Q_SPY */
+
+    /** @pre QK_attr_.nextPrio 必须已经由 QK_sched_() 设置 */
+    Q_REQUIRE_ID(500, (pin < QF_MAX_ACTIVE) && (0U < p) && (p <= QF_MAX_ACTIVE));
+
+    QK_attr_.nextPrio = 0U; /* 清除 nextPrio, 表示已处理 */
+
+    /* 依次运行就绪集合中优先级高于 pin 的 AO */
+    do {
+        QEvt const *e;
+        a = QF_active_[p]; /* 下一个 AO */
+
+        QK_attr_.actPrio = (uint8_t)p; /* 该 AO 成为当前运行的 AO */
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_NEXT, a->prio)
+        QS_TIME_PRE_();     /* timestamp */
+        QS_2U8_PRE_(p,      /* priority of the scheduled AO */
+                    pprev); /* previous priority */
+        QS_END_NOCRIT_PRE_()
+
+#if (defined QK_ON_CONTEXT_SW) || (defined Q_SPY)
+        if (p != pprev) { /* 切换到另一个 AO? */
+#ifdef QK_ON_CONTEXT_SW
+            QK_onContextSw(((pprev != 0U) ? QF_active_[pprev] : (QActive *)0), a);
+#endif /* QK_ON_CONTEXT_SW */
+            pprev = p; /* 更新上一次的优先级 */
+        }
+#endif /* QK_ON_CONTEXT_SW || Q_SPY */
+
+        QF_INT_ENABLE(); /* 在 RTC 步骤中使能中断 */
+
+        /* 执行完成运行(RTC)步骤:
+         * 1. 从活动对象的事件队列中取出事件, 此时队列必须非空.
+         * 2. 将事件分发到活动对象的状态机.
+         * 3. 判断事件是否为垃圾, 如果是则回收.
+         */
+        e = QActive_get_(a);
+        QHSM_DISPATCH(&a->super, e, a->prio);
+        QF_gc(e);
+
+        /* 找出下一个要运行的 AO... */
+        QF_INT_DISABLE();
+
+        if (a->eQueue.frontEvt == (QEvt *)0) { /* 事件队列空? */
+            QPSet_remove(&QK_attr_.readySet, p);
+        }
+
+        if (QPSet_isEmpty(&QK_attr_.readySet)) {
+            p = 0U; /* 没有就绪的 AO */
+        } else {
+            QPSet_findMax(&QK_attr_.readySet, p);
+
+            if (p <= pin) {      /* 不高于被抢占的 AO? */
+                p = 0U;          /* 返回被抢占的 AO */
+            } else if (p <= (uint_fast8_t)QK_attr_.lockPrio) { /* 被锁定? */
+                p = 0U;          /* 不能抢占 */
+            } else {
+                Q_ASSERT_ID(510, p <= QF_MAX_ACTIVE);
+            }
+        }
+    } while (p != 0U);
+
+    QK_attr_.actPrio = (uint8_t)pin; /* 恢复被抢占的优先级 */
+
+#if (defined QK_ON_CONTEXT_SW) || (defined Q_SPY)
+    if (pin != 0U) { /* 恢复一个 AO? */
+        a = QF_active_[pin];
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_RESUME, a->prio)
+        QS_TIME_PRE_();     /* timestamp */
+        QS_2U8_PRE_(pin,    /* priority of the resumed AO */
+                    pprev); /* previous priority */
+        QS_END_NOCRIT_PRE_()
+    } else { /* 恢复到空闲循环 */
+        a = (QActive *)0;
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_IDLE, 0U)
+        QS_TIME_PRE_();    /* timestamp */
+        QS_U8_PRE_(pprev); /* previous priority */
+        QS_END_NOCRIT_PRE_()
+    }
+
+#ifdef QK_ON_CONTEXT_SW
+    QK_onContextSw(QF_active_[pprev], a);
+#endif /* QK_ON_CONTEXT_SW */
+
+#endif /* QK_ON_CONTEXT_SW || Q_SPY */
+}
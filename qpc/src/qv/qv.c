@@ -57,7 +57,107 @@
 Q_DEFINE_THIS_MODULE("qv")
 
 /* Package-scope objects ****************************************************/
+/* 定义 QF_CONTEXT 时, 以下对象都在 QF 实例上下文 (QVContext) 中, 见 qv.h */
+#ifndef QF_CONTEXT
 QPSet QV_readySet_; /* QV 活动对象的就绪集合 */
+#endif
+
+#ifdef QV_RTC_BUDGET
+#ifndef QF_CONTEXT
+static QVRtcStat QV_rtcStat_[QF_MAX_ACTIVE + 1U]; /* 每个 AO 的 RTC 统计 */
+#if (QV_MAX_RTC_SIG > 0U)
+static QVRtcSig QV_rtcSig_[QV_MAX_RTC_SIG]; /* 按信号设置的 RTC 预算 */
+static uint_fast8_t QV_rtcSigNum_; /* 已使用的元素数 */
+#endif
+#endif /* QF_CONTEXT */
+
+/*! 记录一次分发的耗时, 并在超出预算时调用 QV_onRtcOverrun() */
+static void QV_rtcCheck_(uint_fast8_t const p, QEvt const *const e,
+                         union QHsmAttr const state, uint32_t const cycles);
+#endif /* QV_RTC_BUDGET */
+
+#ifdef QV_LOAD_STAT
+#ifndef QF_CONTEXT
+uint8_t volatile QV_isrNest_;  /* 中断嵌套深度 */
+uint32_t QV_isrStart_;         /* 最外层中断进入时的周期计数 */
+uint32_t volatile QV_isrCyc_;  /* 中断中花费的累计周期 */
+
+static QVLoadWin QV_loadCur_;  /* 正在累计的窗口 */
+static QVLoadWin QV_loadLast_; /* 最近完成的窗口 */
+
+/* 每个 AO 的 RTC 步骤周期的 log2 直方图 */
+static uint16_t QV_loadHist_[QF_MAX_ACTIVE + 1U][QV_LOAD_HIST_BINS];
+#endif /* QF_CONTEXT */
+
+/*! 把上一时间段(扣除中断)记到优先级 @p p (0 表示空闲) 上 */
+static void QV_loadAdd_(uint_fast8_t const p);
+
+/*! 把 @p part 换算成窗口长度 @p total 的百分比 */
+static uint_fast8_t QV_loadPct_(uint32_t const part, uint32_t const total);
+#endif /* QV_LOAD_STAT */
+
+#if (defined QV_SCHED_LOCK) && (!defined QF_CONTEXT)
+static uint8_t volatile QV_actPrio_;    /* 正在运行 RTC 步骤的 AO 的优先级 (0 表示不在 RTC 步骤中) */
+static uint8_t volatile QV_lockPrio_;   /* 调度器锁的天花板优先级 (0 表示未加锁) */
+static uint8_t volatile QV_lockHolder_; /* 持有调度器锁的 AO 的优先级 */
+static QVLockStat QV_lockStat_;         /* 调度器锁的统计 */
+static QPSet QV_deferSet_;              /* 被调度器锁推迟的就绪 AO (不在就绪集合中) */
+#ifdef QV_CYCCNT_GET
+static uint32_t QV_lockStart_;          /* 最外层加锁时的周期计数 */
+#endif
+#endif /* QV_SCHED_LOCK && !QF_CONTEXT */
+
+#ifdef QV_SCHED_LOCK
+/*! 把不再被锁定的 AO 从推迟集合移回就绪集合 (必须在临界区内调用) */
+static void QV_lockRelease_(void);
+#endif
+
+#ifdef QV_EDF
+#ifndef QF_CONTEXT
+static QVEdf QV_edf_[QF_MAX_ACTIVE + 1U];         /* 每个 AO 的 EDF 属性 */
+static QVEdfStat QV_edfStat_[QF_MAX_ACTIVE + 1U]; /* 每个 AO 的 EDF 统计 */
+static uint8_t QV_edfHeap_[QF_MAX_ACTIVE];        /* 按截止期限排列的就绪 AO */
+static uint_fast8_t QV_edfNum_;                   /* 堆中的 AO 数 */
+#endif
+
+/*! 在堆的下标 @p i 处恢复堆的性质 (必须在临界区内调用) */
+static void QV_edfFix_(uint_fast8_t i);
+
+/*! 把优先级为 @p prio 的 AO 从堆中删除 (必须在临界区内调用) */
+static void QV_edfRemove_(uint_fast8_t const prio);
+
+/*! 截止期限在时间轴上的比较 (允许周期计数器回绕) */
+#define QV_EDF_BEFORE_(a_, b_) ((int32_t)((uint32_t)(a_) - (uint32_t)(b_)) < 0)
+#endif /* QV_EDF */
+
+#ifdef QV_AGING
+#ifndef QF_CONTEXT
+uint32_t QV_readySince_[QF_MAX_ACTIVE + 1U]; /* AO 开始等待的时刻 */
+static QVAgingStat QV_agingStat_[QF_MAX_ACTIVE + 1U]; /* 每个 AO 的老化统计 */
+static QPSet QV_agedSet_; /* 被提升的 AO */
+#endif
+
+/*! 把等待超过老化阈值的就绪 AO 加入 QV_agedSet_ (必须在临界区内调用) */
+static void QV_agingScan_(uint32_t const now);
+#endif /* QV_AGING */
+
+#ifdef QV_TT
+#ifndef QF_CONTEXT
+QPSet QV_ttPend_;                        /* 就绪但不在窗口内的 AO */
+uint8_t QV_ttGroup_[QF_MAX_ACTIVE + 1U]; /* 每个 AO 所属的组 */
+uint8_t QV_ttOn_[QV_TT_MAX_GROUP + 1U];  /* 当前窗口内允许分发的组 */
+static QVTtWindow const *QV_ttTab_;      /* 调度表 */
+static uint_fast8_t QV_ttLen_;           /* 调度表中的窗口数 (0 表示没有调度表) */
+static uint_fast8_t QV_ttIdx_;           /* 当前窗口 */
+static uint_fast8_t QV_ttLeft_;          /* 当前窗口剩余的节拍数 */
+static uint32_t QV_ttStart_;             /* 当前窗口开始时的周期计数 */
+static bool QV_ttFirst_;                 /* 当前窗口的组还没有被分发 */
+static QVTtStat QV_ttStat_[QV_TT_MAX_WIN]; /* 每个窗口的统计 */
+#endif /* QF_CONTEXT */
+
+/*! 按 QV_ttOn_[] 重新划分就绪集合和挂起集合 (必须在临界区内调用) */
+static bool QV_ttSort_(uint_fast8_t const group);
+#endif /* QV_TT */
 
 /****************************************************************************/
 /**
@@ -73,10 +173,66 @@ void QF_init(void)
     QF_maxPool_      = 0U;
     QF_subscrList_   = (QSubscrList *)0;
     QF_maxPubSignal_ = 0;
+#ifdef QF_PS_SPARSE
+    QF_subscrNum_ = 0U;
+#endif
+#if (QF_MAX_PS_GROUP > 0U)
+    QF_psGroupNum_ = 0U;
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    QF_psFilterNum_ = 0U;
+#endif
 
     QF_bzero(&QF_timeEvtHead_[0], sizeof(QF_timeEvtHead_));
+    QF_bzero((void *)&QF_tickCtr_[0], sizeof(QF_tickCtr_));
+#ifdef QF_TMO_WHEEL_SIZE
+    QF_bzero(&QF_tmo_, sizeof(QF_tmo_));
+#endif
     QF_bzero(&QF_active_[0], sizeof(QF_active_));
     QF_bzero(&QV_readySet_, sizeof(QV_readySet_));
+#ifdef QV_RTC_BUDGET
+    QF_bzero(&QV_rtcStat_[0], sizeof(QV_rtcStat_));
+#if (QV_MAX_RTC_SIG > 0U)
+    QV_rtcSigNum_ = 0U;
+#endif
+#endif
+#ifdef QV_LOAD_STAT
+    QV_isrNest_ = 0U;
+    QV_isrCyc_  = 0U;
+    QF_bzero(&QV_loadCur_, sizeof(QV_loadCur_));
+    QF_bzero(&QV_loadLast_, sizeof(QV_loadLast_));
+    QF_bzero(&QV_loadHist_[0][0], sizeof(QV_loadHist_));
+#endif
+#ifdef QV_SCHED_LOCK
+    QV_actPrio_    = 0U;
+    QV_lockPrio_   = 0U;
+    QV_lockHolder_ = 0U;
+    QF_bzero(&QV_lockStat_, sizeof(QV_lockStat_));
+    QF_bzero(&QV_deferSet_, sizeof(QV_deferSet_));
+#endif
+#ifdef QV_BG_JOB
+    QV_jobHead_ = (QVJob *)0;
+    QV_jobTail_ = (QVJob *)0;
+#endif
+#ifdef QV_EDF
+    QF_bzero(&QV_edf_[0], sizeof(QV_edf_));
+    QF_bzero(&QV_edfStat_[0], sizeof(QV_edfStat_));
+    QV_edfNum_ = 0U;
+#endif
+#ifdef QV_AGING
+    QF_bzero(&QV_readySince_[0], sizeof(QV_readySince_));
+    QF_bzero(&QV_agingStat_[0], sizeof(QV_agingStat_));
+    QF_bzero(&QV_agedSet_, sizeof(QV_agedSet_));
+#endif
+#ifdef QV_TT
+    QF_bzero(&QV_ttPend_, sizeof(QV_ttPend_));
+    QF_bzero(&QV_ttGroup_[0], sizeof(QV_ttGroup_));
+    QF_bzero(&QV_ttOn_[0], sizeof(QV_ttOn_));
+    QV_ttOn_[0] = 1U; /* 没有调度表时只分发组 0 */
+    QV_ttTab_   = (QVTtWindow const *)0;
+    QV_ttLen_   = 0U;
+    QV_ttFirst_ = false;
+#endif
 
 #ifdef QV_INIT
     QV_INIT(); /* port-specific initialization of the QV kernel */
@@ -124,14 +280,59 @@ int_t QF_run(void)
     QS_BEGIN_NOCRIT_PRE_(QS_QF_RUN, 0U)
     QS_END_NOCRIT_PRE_()
 
+#ifdef QV_LOAD_STAT
+    QV_loadCur_.start    = QV_CYCCNT_GET(); /* 第一个统计窗口 */
+    QV_loadCur_.isrStart = QV_isrCyc_;
+    QV_loadCur_.t0       = QV_loadCur_.start;
+    QV_loadCur_.isr0     = QV_loadCur_.isrStart;
+#endif
+
     for (;;) {
         QEvt const *e;
         QActive *a;
         uint_fast8_t p;
+#ifdef QV_EDF
+        uint32_t dl; /* 被分发事件的绝对截止期限 */
+#endif
+#ifdef QV_AGING
+        uint32_t now; /* 调度时刻 */
+#endif
 
         /* 找出就绪状态中优先级最高的活动对象 */
+        p = 0U;
         if (QPSet_notEmpty(&QV_readySet_)) {
+#ifdef QV_EDF
+            p = (uint_fast8_t)QV_edfHeap_[0]; /* 截止期限最早的 AO */
+#elif (defined QV_AGING)
+            now = QV_CYCCNT_GET();
+            QV_agingScan_(now);
+            if (QPSet_notEmpty(&QV_agedSet_)) { /* 有被提升的 AO? */
+                QPSet_findMax(&QV_agedSet_, p);
+            } else {
+                QPSet_findMax(&QV_readySet_, p);
+            }
+#else
             QPSet_findMax(&QV_readySet_, p);
+#endif
+#ifdef QV_SCHED_LOCK
+            /* 被调度器锁推迟? 只有锁持有者和天花板之上的 AO 可以运行.
+             * 被推迟的 AO 移入推迟集合, 这样空闲判断和后台作业只看到
+             * 可以运行的 AO; 解锁时由 QV_lockRelease_() 移回就绪集合.
+             * 投递给它的事件不会把它重新插入就绪集合 (队列不为空).
+             */
+            if ((p <= (uint_fast8_t)QV_lockPrio_) && (p != (uint_fast8_t)QV_lockHolder_)) {
+                QPSet_remove(&QV_readySet_, p);
+#ifdef QV_AGING
+                QPSet_remove(&QV_agedSet_, p);
+#endif
+                QPSet_insert(&QV_deferSet_, p);
+                ++QV_lockStat_.nDefer;
+                continue; /* 重新选择 (中断仍然禁止) */
+            }
+#endif
+        }
+
+        if (p != 0U) {
             a = QF_active_[p];
 
 #ifdef Q_SPY
@@ -144,6 +345,35 @@ int_t QF_run(void)
             pprev = p; /* 更新上一次优先级 */
 #endif                 /* Q_SPY */
 
+#ifdef QV_SCHED_LOCK
+            QV_actPrio_ = (uint8_t)p;
+#endif
+#ifdef QV_EDF
+            dl = QV_edf_[p].front;
+#endif
+#ifdef QV_AGING
+            QPSet_remove(&QV_agedSet_, p); /* 只提升一个 RTC 步骤 */
+            if ((now - QV_readySince_[p]) > QV_agingStat_[p].waitMax) {
+                QV_agingStat_[p].waitMax = now - QV_readySince_[p];
+            }
+#endif
+#ifdef QV_TT
+            /* 窗口内第一次分发该窗口的组? */
+            if (QV_ttFirst_
+                && (QV_ttGroup_[p] == QV_ttTab_[QV_ttIdx_].group))
+            {
+                uint32_t const lat  = QV_CYCCNT_GET() - QV_ttStart_;
+                QVTtStat *const st = &QV_ttStat_[QV_ttIdx_];
+                QV_ttFirst_ = false;
+                ++st->nRun;
+                if (lat < st->latMin) {
+                    st->latMin = lat;
+                }
+                if (lat > st->latMax) {
+                    st->latMax = lat;
+                }
+            }
+#endif
             QF_INT_ENABLE();
 
             /* 执行完成运行(RTC)步骤：
@@ -152,14 +382,60 @@ int_t QF_run(void)
              * 3. 判断事件是否为垃圾, 如果是则回收。
              */
             e = QActive_get_(a);
+#ifdef QV_RTC_BUDGET
+            {
+                union QHsmAttr const state = a->super.state; /* 分发前的状态 */
+                uint32_t const t0          = QV_CYCCNT_GET();
+                QHSM_DISPATCH(&a->super, e, a->prio);
+                QV_rtcCheck_(p, e, state, QV_CYCCNT_GET() - t0);
+            }
+#else
             QHSM_DISPATCH(&a->super, e, a->prio);
+#endif
             QF_gc(e);
 
+#ifdef QV_PORT_POLL
+            /* 移植层在 RTC 步骤之间轮询外部事件源 (中断使能),
+             * 例如 POSIX 移植的 epoll, 见 ports/posix-qv/qv_port.h
+             */
+            QV_PORT_POLL();
+#endif
+
             QF_INT_DISABLE();
+#ifdef QV_SCHED_LOCK
+            QV_actPrio_ = 0U;
+#endif
+#ifdef QV_EDF
+            {
+                uint32_t const late = QV_CYCCNT_GET() - dl;
+                ++QV_edfStat_[p].nDispatch;
+                if ((int32_t)late > 0) { /* 错过截止期限? */
+                    ++QV_edfStat_[p].nMiss;
+                    if (late > QV_edfStat_[p].lateMax) {
+                        QV_edfStat_[p].lateMax = late;
+                    }
+                }
+            }
+#endif
+#ifdef QV_LOAD_STAT
+            QV_loadAdd_(p); /* 计入该 AO 的 RTC 步骤 */
+#endif
 
             if (a->eQueue.frontEvt == (QEvt *)0) { /* 事件队列空? */
                 QPSet_remove(&QV_readySet_, p);
+#ifdef QV_EDF
+                QV_edfRemove_(p);
+#endif
+#ifdef QV_TT
+                /* 窗口可能在 RTC 步骤期间结束, 该 AO 已被移入挂起集合 */
+                QPSet_remove(&QV_ttPend_, p);
+#endif
             }
+#ifdef QV_AGING
+            else {
+                QV_readySince_[p] = QV_CYCCNT_GET(); /* 下一个事件开始等待 */
+            }
+#endif
         } else { /* 没有就绪的活动对象 --> 空闲 */
 #ifdef Q_SPY
             if (pprev != 0U) {
@@ -179,6 +455,9 @@ int_t QF_run(void)
             QV_onIdle();
 
             QF_INT_DISABLE();
+#ifdef QV_LOAD_STAT
+            QV_loadAdd_(0U); /* 计入空闲时间 */
+#endif
         }
     }
 #ifdef __GNUC__ /* GNU compiler? */
@@ -221,3 +500,1036 @@ void QActive_start_(QActive *const me, uint_fast8_t prio,
     QHSM_INIT(&me->super, par, me->prio); /* 执行最顶层初始转换 */
     QS_FLUSH();                           /* 将跟踪缓冲区刷新到主机 */
 }
+
+#ifdef QV_RTC_BUDGET
+/****************************************************************************/
+/**
+ * @brief
+ * 设置优先级为 @p prio 的活动对象每次分发(一个 RTC 步骤)的预算.
+ * 分发耗时由移植层的 QV_CYCCNT_GET() 测量, 单位与其相同
+ * (ARM Cortex-M3/M4/M7 上为 CPU 时钟周期).
+ *
+ * @param[in] prio   活动对象的优先级
+ * @param[in] cycles 预算[周期], 0 表示只记录最长分发时间而不检查预算
+ *
+ * @note 应在线程级(例如 main() 或活动对象中)调用, 不能在 ISR 中调用.
+ */
+void QV_setRtcBudget(uint_fast8_t const prio, uint32_t const cycles)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(600, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    QV_rtcStat_[prio].budget = cycles;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 为信号 @p sig 设置单独的分发预算, 用于个别合理地需要较长时间的事件
+ * (例如处理一整帧数据). 查找顺序: 该活动对象对 @p sig 的预算,
+ * 所有活动对象对 @p sig 的预算, 最后是 QV_setRtcBudget() 设置的预算.
+ *
+ * @param[in] prio   活动对象的优先级, 0 表示所有活动对象
+ * @param[in] sig    信号
+ * @param[in] cycles 预算[周期], 0 表示删除该信号的预算
+ *
+ * @note 表的大小由 #QV_MAX_RTC_SIG 配置.
+ */
+void QV_setRtcSigBudget(uint_fast8_t const prio, enum_t const sig,
+                        uint32_t const cycles)
+{
+#if (QV_MAX_RTC_SIG > 0U)
+    uint_fast8_t i;
+
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(610, prio <= QF_MAX_ACTIVE);
+
+    for (i = 0U; i < QV_rtcSigNum_; ++i) {
+        if ((QV_rtcSig_[i].sig == (QSignal)sig) && (QV_rtcSig_[i].prio == (uint8_t)prio)) {
+            break;
+        }
+    }
+    if (cycles == 0U) { /* 删除? */
+        if (i < QV_rtcSigNum_) {
+            --QV_rtcSigNum_;
+            QV_rtcSig_[i] = QV_rtcSig_[QV_rtcSigNum_];
+        }
+    } else {
+        if (i == QV_rtcSigNum_) { /* 新元素? */
+            /** @pre 按信号的预算表不能溢出 */
+            Q_REQUIRE_ID(620, QV_rtcSigNum_ < QV_MAX_RTC_SIG);
+            QV_rtcSig_[i].sig  = (QSignal)sig;
+            QV_rtcSig_[i].prio = (uint8_t)prio;
+            ++QV_rtcSigNum_;
+        }
+        QV_rtcSig_[i].budget = cycles;
+    }
+#else
+    (void)prio;
+    (void)sig;
+    (void)cycles;
+    Q_ERROR_ID(610); /* 按信号的预算表未配置 */
+#endif
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回优先级为 @p prio 的活动对象的 RTC 统计: 预算, 最长分发时间(WCET),
+ * 产生 WCET 的信号和当时状态机所处的状态(QHsm 中为状态处理函数
+ * @c state.fun), 以及超限次数.
+ *
+ * @param[in] prio 活动对象的优先级
+ *
+ * @returns 指向统计数据的指针(只读)
+ */
+QVRtcStat const *QV_getRtcStat(uint_fast8_t const prio)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(630, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    return &QV_rtcStat_[prio];
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 清除优先级为 @p prio 的活动对象的最长分发时间和超限次数, 预算保持不变.
+ * 例如在启动阶段结束后调用, 以排除初始化期间的长时间分发.
+ *
+ * @param[in] prio 活动对象的优先级
+ */
+void QV_resetRtcStat(uint_fast8_t const prio)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(640, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    QV_rtcStat_[prio].wcet      = 0U;
+    QV_rtcStat_[prio].nOverrun  = 0U;
+    QV_rtcStat_[prio].state.fun = Q_STATE_CAST(0);
+    QV_rtcStat_[prio].sig       = 0U;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 在每次分发之后(中断使能时)由 QF_run() 调用. 统计只在 QV 的事件循环中
+ * 更新, 因此不需要临界区.
+ */
+static void QV_rtcCheck_(uint_fast8_t const p, QEvt const *const e,
+                         union QHsmAttr const state, uint32_t const cycles)
+{
+    QVRtcStat *const st = &QV_rtcStat_[p];
+    uint32_t budget     = st->budget;
+
+#if (QV_MAX_RTC_SIG > 0U)
+    if (QV_rtcSigNum_ != 0U) {
+        uint_fast8_t i;
+        bool exact = false;
+        for (i = 0U; (i < QV_rtcSigNum_) && (!exact); ++i) {
+            if (QV_rtcSig_[i].sig == e->sig) {
+                if (QV_rtcSig_[i].prio == (uint8_t)p) {
+                    budget = QV_rtcSig_[i].budget;
+                    exact  = true; /* 该活动对象自己的预算优先 */
+                } else if (QV_rtcSig_[i].prio == 0U) {
+                    budget = QV_rtcSig_[i].budget;
+                } else {
+                    /* 其他活动对象的预算 */
+                }
+            }
+        }
+    }
+#endif
+
+    if (cycles > st->wcet) { /* 新的最长分发时间? */
+        st->wcet  = cycles;
+        st->state = state;
+        st->sig   = e->sig;
+    }
+    if ((budget != 0U) && (cycles > budget)) { /* 超出预算? */
+        ++st->nOverrun;
+        QV_onRtcOverrun(p, e, cycles);
+    }
+}
+#endif /* QV_RTC_BUDGET */
+
+#ifdef QV_LOAD_STAT
+/****************************************************************************/
+/**
+ * @brief
+ * 返回最近完成的统计窗口中 CPU 的利用率, 即不在 QV_onIdle() 中的时间
+ * (包括 RTC 步骤, 中断和 QV 内核本身)所占的百分比.
+ *
+ * @returns 0..100
+ *
+ * @note 统计窗口的长度由 #QV_LOAD_WINDOW 配置; 窗口在 QF_run() 中
+ * 每次 RTC 步骤或空闲返回之后翻转, 因此每个窗口至少为 QV_LOAD_WINDOW 个周期.
+ */
+uint_fast8_t QV_getCpuLoad(void)
+{
+    return (uint_fast8_t)(100U - QV_loadPct_(QV_loadLast_.idle,
+                                             QV_loadLast_.total));
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回最近完成的统计窗口中在使用 QV_ISR_ENTRY()/QV_ISR_EXIT() 的
+ * 中断中花费的时间所占的百分比.
+ *
+ * @returns 0..100
+ */
+uint_fast8_t QV_getIsrLoad(void)
+{
+    return QV_loadPct_(QV_loadLast_.isr, QV_loadLast_.total);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回最近完成的统计窗口中优先级为 @p prio 的活动对象的 RTC 步骤
+ * (调度, 取事件, 分发和回收, 扣除其间的中断)所占的百分比.
+ *
+ * @param[in] prio 活动对象的优先级
+ *
+ * @returns 0..100
+ */
+uint_fast8_t QV_getAoLoad(uint_fast8_t const prio)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(700, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    return QV_loadPct_(QV_loadLast_.busy[prio], QV_loadLast_.total);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回优先级为 @p prio 的活动对象的 RTC 步骤时间直方图, 共
+ * #QV_LOAD_HIST_BINS 个计数(饱和于 0xFFFF). 第 0 格统计小于
+ * 2^#QV_LOAD_HIST_SHIFT 周期的步骤, 第 k 格统计
+ * [2^(SHIFT+k-1), 2^(SHIFT+k)) 周期的步骤, 最后一格包括所有更长的步骤.
+ *
+ * @param[in] prio 活动对象的优先级
+ *
+ * @returns 指向直方图的指针(只读)
+ */
+uint16_t const *QV_getLoadHist(uint_fast8_t const prio)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(710, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    return &QV_loadHist_[prio][0];
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 清零优先级为 @p prio 的活动对象的 RTC 步骤时间直方图.
+ *
+ * @param[in] prio 活动对象的优先级
+ */
+void QV_resetLoadHist(uint_fast8_t const prio)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(720, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    QF_bzero(&QV_loadHist_[prio][0], sizeof(QV_loadHist_[prio]));
+}
+
+#ifdef QF_CONTEXT
+/****************************************************************************/
+/*! QV_ISR_ENTRY() 的函数形式 (中断统计变量在 QF 实例上下文中) */
+void QV_isrEntry_(void)
+{
+    QF_INT_DISABLE();
+    if (QV_isrNest_ == 0U) {
+        QV_isrStart_ = QV_CYCCNT_GET();
+    }
+    ++QV_isrNest_;
+    QF_INT_ENABLE();
+}
+
+/*! QV_ISR_EXIT() 的函数形式 */
+void QV_isrExit_(void)
+{
+    QF_INT_DISABLE();
+    --QV_isrNest_;
+    if (QV_isrNest_ == 0U) {
+        QV_isrCyc_ += QV_CYCCNT_GET() - QV_isrStart_;
+    }
+    QF_INT_ENABLE();
+}
+#endif /* QF_CONTEXT */
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由 QF_run() 在中断禁止时调用. 时间段首尾相接: 每段从上一段结束开始,
+ * 因此调度开销计入随后的 RTC 步骤或空闲时间, 每段只需读一次周期计数器.
+ * 统计只在 QV 的事件循环中更新, 读取函数也在线程级调用,
+ * 因此不需要另外的临界区.
+ */
+static void QV_loadAdd_(uint_fast8_t const p)
+{
+    uint32_t const now = QV_CYCCNT_GET();
+    uint32_t const isr = QV_isrCyc_;
+    uint32_t const cyc = (now - QV_loadCur_.t0) - (isr - QV_loadCur_.isr0); /* 扣除中断时间 */
+
+    QV_loadCur_.t0   = now;
+    QV_loadCur_.isr0 = isr;
+
+    if (p == 0U) { /* 空闲? */
+        QV_loadCur_.idle += cyc;
+    } else {
+        uint16_t *const hist = &QV_loadHist_[p][0];
+        uint32_t v           = cyc >> QV_LOAD_HIST_SHIFT;
+        uint_fast8_t bin     = 0U;
+
+        QV_loadCur_.busy[p] += cyc;
+
+        while ((v != 0U) && (bin < (QV_LOAD_HIST_BINS - 1U))) {
+            v >>= 1;
+            ++bin;
+        }
+        if (hist[bin] != 0xFFFFU) {
+            ++hist[bin];
+        }
+    }
+
+    if ((now - QV_loadCur_.start) >= (uint32_t)QV_LOAD_WINDOW) { /* 窗口结束? */
+        QV_loadCur_.total = now - QV_loadCur_.start;
+        QV_loadCur_.isr   = isr - QV_loadCur_.isrStart;
+        QV_loadLast_      = QV_loadCur_;
+
+        QF_bzero(&QV_loadCur_, sizeof(QV_loadCur_));
+        QV_loadCur_.t0       = now;
+        QV_loadCur_.isr0     = isr;
+        QV_loadCur_.start    = now;
+        QV_loadCur_.isrStart = isr;
+    }
+}
+
+/****************************************************************************/
+static uint_fast8_t QV_loadPct_(uint32_t const part, uint32_t const total)
+{
+    uint_fast8_t pct = 0U;
+    if (total != 0U) {
+        pct = (uint_fast8_t)(((uint64_t)part * 100U) / total);
+        if (pct > 100U) {
+            pct = 100U;
+        }
+    }
+    return pct;
+}
+#endif /* QV_LOAD_STAT */
+
+#ifdef QV_SCHED_LOCK
+/****************************************************************************/
+/**
+ * @brief
+ * 该函数把调度器锁的天花板提高到 @p ceiling. 在解锁之前, QF_run() 不会
+ * 分发优先级不高于 @p ceiling 的 AO, 锁持有者 (调用 QV_schedLock() 的 AO)
+ * 除外; 优先级高于天花板的 AO 照常运行. 期间投递给被锁定 AO 的事件留在
+ * 它们的队列中, 解锁后按优先级依次处理.
+ *
+ * 典型用法是"多事件事务": 一个 AO 在一个或几个 RTC 步骤中 (例如借助
+ * 投递给自己的事件) 向多个 AO 投递一组事件, 接收者只有在整组事件都到齐
+ * 之后才运行, 不会处理中间状态, 也不会因此重复计算.
+ *
+ * 调度器锁可以嵌套: 只有天花板高于当前的锁时才真正加锁,
+ * 否则返回的状态表示"没有加锁", 对应的 QV_schedUnlock() 不做任何操作.
+ *
+ * @param[in] ceiling 天花板优先级
+ *
+ * @returns 之前的调度器锁状态, 必须传给 QV_schedUnlock()
+ *
+ * @note 只能在线程级 (RTC 步骤, QV_onIdle() 或 QF_run() 之前的 main())
+ * 中调用, 不能在 ISR 中调用. 在 RTC 步骤之外加锁时没有锁持有者,
+ * 所有不高于天花板的 AO 都被推迟.
+ *
+ * @note 加锁期间锁持有者必须保证最终会解锁 (例如用时间事件限制事务的
+ * 长度), 否则被锁定的 AO 将永远得不到运行.
+ *
+ * @usage
+ * @code
+ * QSchedStatus lockStat;
+ * lockStat = QV_schedLock(N_PHILO); // 推迟所有 Philo 的处理
+ * ... // 向各个 Philo 投递事件, 可以跨多个 RTC 步骤
+ * QV_schedUnlock(lockStat);
+ * @endcode
+ */
+QSchedStatus QV_schedLock(uint_fast8_t const ceiling)
+{
+    QSchedStatus stat;
+    QF_CRIT_STAT_
+    QF_CRIT_E_();
+
+    /** @pre 天花板必须在范围内 */
+    Q_REQUIRE_CRIT_(800, ceiling <= QF_MAX_ACTIVE);
+
+    /* 天花板高于当前的锁? */
+    if (QV_lockPrio_ < ceiling) {
+        stat = ((QSchedStatus)QV_lockPrio_ << 8);
+
+        if (QV_lockPrio_ == 0U) { /* 最外层的锁? */
+            ++QV_lockStat_.nLock;
+#ifdef QV_CYCCNT_GET
+            QV_lockStart_ = QV_CYCCNT_GET();
+#endif
+        }
+        QV_lockPrio_ = (uint8_t)ceiling;
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_LOCK, 0U)
+        QS_TIME_PRE_();                 /* timestamp */
+        QS_2U8_PRE_(stat >> 8,          /* the previous lock prio */
+                    QV_lockPrio_);      /* the new lock prio */
+        QS_END_NOCRIT_PRE_()
+
+        /* 保存锁持有者 */
+        stat |= (QSchedStatus)QV_lockHolder_;
+        QV_lockHolder_ = QV_actPrio_;
+    } else {
+        stat = 0xFFU; /* 调度器没有被锁定 */
+    }
+    QF_CRIT_X_();
+
+    return stat; /* 返回之前的状态 */
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 该函数恢复 QV_schedLock() 之前的调度器锁. 锁定期间就绪的 AO 在当前
+ * RTC 步骤结束后由 QF_run() 按优先级分发 (QV 是协作式内核,
+ * 解锁不会立即切换).
+ *
+ * @param[in] stat QV_schedLock() 返回的调度器锁状态
+ *
+ * @note 只能在线程级调用, 不能在 ISR 中调用.
+ */
+void QV_schedUnlock(QSchedStatus const stat)
+{
+    /* 锁是否由 QV_schedLock() 真正加上? */
+    if (stat != 0xFFU) {
+        uint_fast8_t const lockPrio = (uint_fast8_t)QV_lockPrio_;
+        uint_fast8_t const prevPrio = (uint_fast8_t)(stat >> 8);
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+
+        /** @pre 当前的锁必须高于之前的锁 */
+        Q_REQUIRE_CRIT_(810, lockPrio > prevPrio);
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_UNLOCK, 0U)
+        QS_TIME_PRE_();                /* timestamp */
+        QS_2U8_PRE_(lockPrio,          /* lock prio */
+                    prevPrio);         /* previous lock prio */
+        QS_END_NOCRIT_PRE_()
+
+        /* 恢复之前的锁和锁持有者 */
+        QV_lockPrio_   = (uint8_t)prevPrio;
+        QV_lockHolder_ = (uint8_t)(stat & 0xFFU);
+        QV_lockRelease_();
+
+#ifdef QV_CYCCNT_GET
+        if (prevPrio == 0U) { /* 最外层的锁? */
+            uint32_t const hold = QV_CYCCNT_GET() - QV_lockStart_;
+            QV_lockStat_.holdTotal += hold;
+            if (hold > QV_lockStat_.holdMax) {
+                QV_lockStat_.holdMax = hold;
+            }
+        }
+#endif
+        QF_CRIT_X_();
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由 QV_schedUnlock() 在恢复之前的锁之后调用. 移回的 AO 保留在各自队列
+ * 中的事件, 由 QF_run() 按优先级分发; 仍然被锁定的 AO 留在推迟集合中.
+ */
+static void QV_lockRelease_(void)
+{
+    QPSet set = QV_deferSet_;
+    uint_fast8_t p;
+
+    while (QPSet_notEmpty(&set)) {
+        QPSet_findMax(&set, p);
+        QPSet_remove(&set, p);
+        if ((p > (uint_fast8_t)QV_lockPrio_) || (p == (uint_fast8_t)QV_lockHolder_)) {
+            QPSet_remove(&QV_deferSet_, p);
+            QPSet_insert(&QV_readySet_, p);
+        }
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回调度器锁的统计: 最外层加锁的次数, 因为加锁而被推迟的 AO 数
+ * (一个就绪的 AO 被锁推迟时加 1, 在它被解锁移回就绪集合之前不再重复
+ * 计数, 与 QF_run() 的循环次数无关), 以及持锁时间.
+ *
+ * @returns 指向统计数据的指针(只读)
+ *
+ * @note 持锁时间用移植层的 QV_CYCCNT_GET() 测量, 从最外层的
+ * QV_schedLock() 到对应的 QV_schedUnlock(). 移植层没有定义
+ * QV_CYCCNT_GET() 时 (例如 Cortex-M0/M0+) 持锁时间始终为 0.
+ */
+QVLockStat const *QV_getLockStat(void)
+{
+    return &QV_lockStat_;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 清零调度器锁的统计.
+ */
+void QV_resetLockStat(void)
+{
+    QF_CRIT_STAT_
+    QF_CRIT_E_();
+    QF_bzero(&QV_lockStat_, sizeof(QV_lockStat_));
+    QF_CRIT_X_();
+}
+#endif /* QV_SCHED_LOCK */
+
+#ifdef QV_EDF
+/****************************************************************************/
+/**
+ * @brief
+ * 设置优先级为 @p prio 的 AO 的默认相对截止期限, 并提供保存队列中
+ * 各事件绝对截止期限的存储. 应在 QACTIVE_START() 之后, QF_run() 之前调用.
+ *
+ * @param[in] prio        活动对象的优先级
+ * @param[in] relDeadline 默认相对截止期限[周期], 用于 QEvt.deadline 为 0
+ *                        的事件; 0 表示 #QV_EDF_DL_DEFAULT
+ * @param[in] dlSto       截止期限存储, 长度必须等于 QACTIVE_START() 的
+ *                        事件队列长度 @c qLen
+ * @param[in] dlLen       @p dlSto 的长度
+ *
+ * @note @p dlSto 可以为 NULL, 以节省 RAM. 此时只有队首事件的截止期限是
+ * 准确的: 队列中的后续事件的截止期限从它们成为队首时开始计算,
+ * 因此该 AO 在积压时会显得不那么紧迫. 没有调用 QV_edfSet() 的 AO
+ * 使用 #QV_EDF_DL_DEFAULT 且没有截止期限存储.
+ *
+ * @note 截止期限用移植层的 QV_CYCCNT_GET() 计时, 相对截止期限必须
+ * 小于周期计数器回绕周期的一半.
+ */
+void QV_edfSet(uint_fast8_t const prio, uint32_t const relDeadline,
+               uint32_t *const dlSto, uint_fast16_t const dlLen)
+{
+    QActive const *a;
+    QF_CRIT_STAT_
+
+    /** @pre 优先级必须在范围内, AO 必须已经启动, 相对截止期限必须小于
+     * 周期计数器回绕周期的一半, 截止期限存储的长度必须与事件队列的长度一致
+     */
+    Q_REQUIRE_ID(900, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    a = QF_active_[prio];
+    Q_REQUIRE_ID(910, (a != (QActive *)0) && (relDeadline < 0x80000000U)
+                 && ((dlSto == (uint32_t *)0) || (dlLen == (uint_fast16_t)a->eQueue.end)));
+
+    QF_CRIT_E_();
+    QV_edf_[prio].rel   = relDeadline;
+    QV_edf_[prio].dlSto = dlSto;
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回优先级为 @p prio 的 AO 的 EDF 统计: 分发的事件数, 在截止期限之后
+ * 才处理完 (RTC 步骤结束时已超过截止期限) 的事件数, 以及最长的超时.
+ *
+ * @param[in] prio 活动对象的优先级
+ *
+ * @returns 指向统计数据的指针(只读)
+ */
+QVEdfStat const *QV_getEdfStat(uint_fast8_t const prio)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(920, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    return &QV_edfStat_[prio];
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 清零优先级为 @p prio 的 AO 的 EDF 统计.
+ *
+ * @param[in] prio 活动对象的优先级
+ */
+void QV_resetEdfStat(uint_fast8_t const prio)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(930, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    QF_bzero(&QV_edfStat_[prio], sizeof(QV_edfStat_[prio]));
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由投递操作在临界区内, 事件入队之前调用: 事件将成为队首时记录在
+ * QVEdf.front 中, 否则记录在与环形缓冲区的 head 对应的存储中.
+ */
+void QV_edfPut_(QActive const *const me, QEvt const *const e)
+{
+    QVEdf *const edf = &QV_edf_[me->prio];
+    uint32_t rel     = e->deadline;
+    uint32_t dl;
+
+    if (rel == 0U) {
+        rel = (edf->rel != 0U) ? edf->rel : (uint32_t)QV_EDF_DL_DEFAULT;
+    }
+    dl = QV_CYCCNT_GET() + rel;
+
+    if (me->eQueue.frontEvt == (QEvt *)0) { /* 事件将成为队首? */
+        edf->front = dl;
+    } else if (edf->dlSto != (uint32_t *)0) {
+        edf->dlSto[me->eQueue.head] = dl;
+    } else {
+        /* 没有存储, 成为队首时再计算 */
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由 QActive_postLIFO_() 在临界区内, 事件入队之前调用: 原来的队首事件
+ * 被放回环形缓冲区的 tail + 1 处, 它的截止期限也随之移动. 队首的截止
+ * 期限改变后, 如果 AO 已经在堆中, 立即调整它在堆中的位置.
+ */
+void QV_edfPutLIFO_(QActive const *const me, QEvt const *const e)
+{
+    QVEdf *const edf = &QV_edf_[me->prio];
+    uint32_t rel     = e->deadline;
+
+    if (rel == 0U) {
+        rel = (edf->rel != 0U) ? edf->rel : (uint32_t)QV_EDF_DL_DEFAULT;
+    }
+
+    if ((me->eQueue.frontEvt != (QEvt *)0) && (edf->dlSto != (uint32_t *)0)) {
+        QEQueueCtr tail = me->eQueue.tail + 1U;
+        if (tail == me->eQueue.end) {
+            tail = 0U; /* wrap around */
+        }
+        edf->dlSto[tail] = edf->front;
+    }
+    edf->front = QV_CYCCNT_GET() + rel;
+
+    if (edf->pos != 0U) { /* 已经在堆中? */
+        QV_edfFix_((uint_fast8_t)edf->pos - 1U);
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由 QActive_get_() 在临界区内, 环形缓冲区的 tail 事件移到队首之前调用.
+ * 队首的截止期限改变后立即调整 AO 在堆中的位置, 这样 RTC 步骤期间
+ * 投递 (包括中断中的投递) 看到的堆总是有效的.
+ */
+void QV_edfGet_(QActive const *const me)
+{
+    QVEdf *const edf = &QV_edf_[me->prio];
+
+    if (edf->dlSto != (uint32_t *)0) {
+        edf->front = edf->dlSto[me->eQueue.tail];
+    } else {
+        edf->front = QV_CYCCNT_GET()
+                     + ((edf->rel != 0U) ? edf->rel : (uint32_t)QV_EDF_DL_DEFAULT);
+    }
+    if (edf->pos != 0U) { /* 在堆中? */
+        QV_edfFix_((uint_fast8_t)edf->pos - 1U);
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由 QACTIVE_EQUEUE_SIGNAL_() 在临界区内调用. AO 可能已经在堆中
+ * (在自己的 RTC 步骤中取出最后一个事件后又收到事件), 此时只调整位置.
+ */
+void QV_edfInsert_(uint_fast8_t const prio)
+{
+    QVEdf *const edf = &QV_edf_[prio];
+
+    if (edf->pos == 0U) { /* 不在堆中? */
+        QV_edfHeap_[QV_edfNum_] = (uint8_t)prio;
+        ++QV_edfNum_;
+        edf->pos = (uint8_t)QV_edfNum_;
+    }
+    QV_edfFix_((uint_fast8_t)edf->pos - 1U);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 先上浮再下沉. 截止期限相同时, 优先级高的 AO 在前, 因此所有截止期限
+ * 相同时 EDF 退化为固定优先级调度.
+ */
+static void QV_edfFix_(uint_fast8_t i)
+{
+    uint_fast8_t const p = (uint_fast8_t)QV_edfHeap_[i];
+    uint32_t const dl    = QV_edf_[p].front;
+
+    while (i > 0U) { /* 上浮 */
+        uint_fast8_t const parent = (i - 1U) >> 1;
+        uint_fast8_t const q      = (uint_fast8_t)QV_edfHeap_[parent];
+        if (QV_EDF_BEFORE_(dl, QV_edf_[q].front)
+            || ((dl == QV_edf_[q].front) && (p > q)))
+        {
+            QV_edfHeap_[i] = (uint8_t)q;
+            QV_edf_[q].pos = (uint8_t)(i + 1U);
+            i              = parent;
+        } else {
+            break;
+        }
+    }
+    for (;;) { /* 下沉 */
+        uint_fast8_t c = (i << 1) + 1U;
+        uint_fast8_t q;
+        if (c >= QV_edfNum_) {
+            break;
+        }
+        q = (uint_fast8_t)QV_edfHeap_[c];
+        if ((c + 1U) < QV_edfNum_) { /* 选择较早的子节点 */
+            uint_fast8_t const r = (uint_fast8_t)QV_edfHeap_[c + 1U];
+            if (QV_EDF_BEFORE_(QV_edf_[r].front, QV_edf_[q].front)
+                || ((QV_edf_[r].front == QV_edf_[q].front) && (r > q)))
+            {
+                ++c;
+                q = r;
+            }
+        }
+        if (QV_EDF_BEFORE_(QV_edf_[q].front, dl)
+            || ((QV_edf_[q].front == dl) && (q > p)))
+        {
+            QV_edfHeap_[i] = (uint8_t)q;
+            QV_edf_[q].pos = (uint8_t)(i + 1U);
+            i              = c;
+        } else {
+            break;
+        }
+    }
+    QV_edfHeap_[i] = (uint8_t)p;
+    QV_edf_[p].pos = (uint8_t)(i + 1U);
+}
+
+/****************************************************************************/
+static void QV_edfRemove_(uint_fast8_t const prio)
+{
+    uint_fast8_t const i = (uint_fast8_t)QV_edf_[prio].pos - 1U;
+
+    QV_edf_[prio].pos = 0U;
+    --QV_edfNum_;
+    if (i < QV_edfNum_) { /* 不是最后一个? 用最后一个元素填补 */
+        uint_fast8_t const last = (uint_fast8_t)QV_edfHeap_[QV_edfNum_];
+        QV_edfHeap_[i]          = (uint8_t)last;
+        QV_edf_[last].pos       = (uint8_t)(i + 1U);
+        QV_edfFix_(i);
+    }
+}
+#endif /* QV_EDF */
+
+#ifdef QV_AGING
+/****************************************************************************/
+/**
+ * @brief
+ * 设置优先级为 @p prio 的活动对象的老化阈值. 该 AO 就绪后 (或上一次被
+ * 分发后仍有事件) 等待超过 @p cycles 时, QF_run() 把它提升到所有未提升
+ * 的 AO 之上运行一个 RTC 步骤. 因此在持续的高优先级负载下, 它每个阈值
+ * 周期至少能处理一个事件.
+ *
+ * @param[in] prio   活动对象的优先级
+ * @param[in] cycles 老化阈值[周期] (由移植层的 QV_CYCCNT_GET() 测量),
+ *                   0 表示不提升 (只统计等待时间)
+ *
+ * @note 阈值应当明显大于高优先级 AO 的正常突发长度, 否则老化会频繁地
+ * 打乱固定优先级的顺序.
+ */
+void QV_setAgingThreshold(uint_fast8_t const prio, uint32_t const cycles)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(1000, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    QV_agingStat_[prio].threshold = cycles;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回优先级为 @p prio 的活动对象的老化统计: 阈值, 就绪后等待分发的
+ * 最长时间 (无论是否设置了阈值都会统计), 以及被提升的次数.
+ * 如果该 AO 正在等待, 最长等待时间也包括当前这一次等待,
+ * 因此一直没有得到运行的 AO 也能看出饥饿.
+ *
+ * @param[in] prio 活动对象的优先级
+ *
+ * @returns 指向统计数据的指针(只读)
+ */
+QVAgingStat const *QV_getAgingStat(uint_fast8_t const prio)
+{
+    QF_CRIT_STAT_
+
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(1010, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+
+    QF_CRIT_E_();
+    if (QPSet_hasElement(&QV_readySet_, prio) /* 正在等待? */
+#ifdef QV_SCHED_LOCK
+        || QPSet_hasElement(&QV_deferSet_, prio)
+#endif
+        )
+    {
+        uint32_t const wait = QV_CYCCNT_GET() - QV_readySince_[prio];
+        if (wait > QV_agingStat_[prio].waitMax) {
+            QV_agingStat_[prio].waitMax = wait;
+        }
+    }
+    QF_CRIT_X_();
+
+    return &QV_agingStat_[prio];
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 清零优先级为 @p prio 的活动对象的最长等待时间和提升次数, 阈值保持不变.
+ *
+ * @param[in] prio 活动对象的优先级
+ */
+void QV_resetAgingStat(uint_fast8_t const prio)
+{
+    /** @pre 优先级必须在范围内 */
+    Q_REQUIRE_ID(1020, (0U < prio) && (prio <= QF_MAX_ACTIVE));
+    QV_agingStat_[prio].waitMax = 0U;
+    QV_agingStat_[prio].nBoost  = 0U;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由 QF_run() 在每次调度时调用, 开销与就绪 AO 的数量成正比.
+ */
+static void QV_agingScan_(uint32_t const now)
+{
+    QPSet set = QV_readySet_;
+    uint_fast8_t p;
+
+    while (QPSet_notEmpty(&set)) {
+        QPSet_findMax(&set, p);
+        QPSet_remove(&set, p);
+        if ((QV_agingStat_[p].threshold != 0U)
+            && ((now - QV_readySince_[p]) > QV_agingStat_[p].threshold)
+            && (!QPSet_hasElement(&QV_agedSet_, p)))
+        {
+            QPSet_insert(&QV_agedSet_, p);
+            ++QV_agingStat_[p].nBoost;
+        }
+    }
+}
+#endif /* QV_AGING */
+
+#ifdef QV_TT
+/****************************************************************************/
+/**
+ * @brief
+ * 设置时间触发的调度表. 调度表从下一次 QV_ttTick() 开始, 由窗口 0 起
+ * 循环执行, 所有窗口的统计被清零.
+ *
+ * @param[in] tab 调度表 (通常是 const 数组, 运行期间必须保持有效)
+ * @param[in] len 调度表中的窗口数 (1..#QV_TT_MAX_WIN)
+ *
+ * @usage
+ * @code
+ * static QVTtWindow const l_sched[] = {
+ *     { 1U, 0U, 1U }, // 保护带: 1 个节拍, 不开始新的 RTC 步骤
+ *     { 1U, 1U, 1U }, // 控制环: 只分发组 1
+ *     { 3U, 0U, 0U }, // 其余时间: 只分发组 0
+ * };
+ * QV_ttAssign(AO_Motor->prio, 1U);
+ * QV_ttSchedule(&l_sched[0], Q_DIM(l_sched));
+ * @endcode
+ */
+void QV_ttSchedule(QVTtWindow const *const tab, uint_fast8_t const len)
+{
+    uint_fast8_t i;
+    QF_CRIT_STAT_
+
+    /** @pre 调度表必须有 1..#QV_TT_MAX_WIN 个窗口 */
+    Q_REQUIRE_ID(1100, (tab != (QVTtWindow const *)0)
+                       && (0U < len) && (len <= QV_TT_MAX_WIN));
+    for (i = 0U; i < len; ++i) {
+        /** @pre 每个窗口至少一个节拍, 组号必须在范围内 */
+        Q_REQUIRE_ID(1101, (tab[i].ticks != 0U)
+                           && (tab[i].group <= QV_TT_MAX_GROUP));
+    }
+
+    QF_CRIT_E_();
+    QV_ttTab_   = tab;
+    QV_ttLen_   = len;
+    QV_ttIdx_   = len - 1U; /* 下一个节拍切换到窗口 0 */
+    QV_ttLeft_  = 1U;
+    QV_ttFirst_ = false;
+    for (i = 0U; i < QV_TT_MAX_WIN; ++i) {
+        QF_bzero(&QV_ttStat_[i], sizeof(QV_ttStat_[i]));
+        QV_ttStat_[i].latMin = 0xFFFFFFFFU;
+    }
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 把优先级为 @p prio 的活动对象分配到组 @p group. 可以在活动对象启动
+ * 之前或之后调用; 如果该 AO 有未处理的事件, 它会立即按新组所在的窗口
+ * 被分发或挂起.
+ *
+ * @param[in] prio  活动对象的优先级
+ * @param[in] group 组号, 0 表示事件触发 (默认),
+ *                  1..#QV_TT_MAX_GROUP 表示时间触发
+ */
+void QV_ttAssign(uint_fast8_t const prio, uint_fast8_t const group)
+{
+    QF_CRIT_STAT_
+
+    /** @pre 优先级和组号必须在范围内 */
+    Q_REQUIRE_ID(1110, (0U < prio) && (prio <= QF_MAX_ACTIVE)
+                       && (group <= QV_TT_MAX_GROUP));
+
+    QF_CRIT_E_();
+    QV_ttGroup_[prio] = (uint8_t)group;
+    if (QPSet_hasElement(&QV_readySet_, prio)
+        || QPSet_hasElement(&QV_ttPend_, prio))
+    {
+        QPSet_remove(&QV_readySet_, prio);
+        QPSet_remove(&QV_ttPend_, prio);
+        if (QV_ttOn_[group] != 0U) {
+            QPSet_insert(&QV_readySet_, prio);
+        } else {
+            QPSet_insert(&QV_ttPend_, prio);
+        }
+    }
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 每个系统时钟节拍调用一次 (通过 QV_TT_TICK(), 在 QF_TICK_X() 之前,
+ * 这样窗口开始时节拍产生的时间事件正好落在新窗口内).
+ * 当前窗口结束时, 如果该窗口的组仍有就绪的 AO (有事件未处理或者
+ * RTC 步骤仍在运行), 记为一次超限; 然后切换到下一个窗口, 记录窗口
+ * 开始的周期计数, 并重新划分就绪集合和挂起集合.
+ *
+ * @note 窗口切换的开销与就绪和挂起的 AO 的数量成正比, 其他节拍只有
+ * 一次递减.
+ */
+void QV_ttTick(void)
+{
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+    if (QV_ttLen_ != 0U) { /* 有调度表? */
+        --QV_ttLeft_;
+        if (QV_ttLeft_ == 0U) { /* 当前窗口结束? */
+            uint_fast8_t const prev = QV_ttIdx_;
+            QVTtWindow const *w;
+            uint_fast8_t g;
+
+            ++QV_ttIdx_;
+            if (QV_ttIdx_ == QV_ttLen_) {
+                QV_ttIdx_ = 0U;
+            }
+            w = &QV_ttTab_[QV_ttIdx_];
+            QV_ttLeft_ = (uint_fast8_t)w->ticks;
+
+            for (g = 0U; g <= QV_TT_MAX_GROUP; ++g) {
+                QV_ttOn_[g] = 0U;
+            }
+            QV_ttOn_[0] = (w->excl == 0U) ? 1U : 0U;
+            if (w->group != 0U) {
+                QV_ttOn_[w->group] = 1U;
+            }
+
+            g = (uint_fast8_t)QV_ttTab_[prev].group;
+            if (QV_ttSort_(g) && (g != 0U)) { /* 上一个窗口的组未完成? */
+                ++QV_ttStat_[prev].nOverrun;
+            }
+
+            QV_ttStart_ = QV_CYCCNT_GET();
+            QV_ttFirst_ = (w->group != 0U);
+            ++QV_ttStat_[QV_ttIdx_].nWin;
+        }
+    }
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回窗口 @p win 的统计. latMin 和 latMax 是从窗口开始 (节拍中断中)
+ * 到第一次分发该窗口的组所经过的时间, 两者之差即该窗口的抖动.
+ * 该时间包括窗口开始时正在运行的 RTC 步骤, 也包括组内 AO 等待事件的时间,
+ * 因此时间触发的 AO 应当由同一节拍产生的时间事件驱动.
+ *
+ * @param[in] win 窗口在调度表中的索引
+ *
+ * @returns 指向统计数据的指针(只读)
+ */
+QVTtStat const *QV_getTtStat(uint_fast8_t const win)
+{
+    /** @pre 窗口必须在调度表的范围内 */
+    Q_REQUIRE_ID(1120, win < QV_ttLen_);
+    return &QV_ttStat_[win];
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 清零窗口 @p win 的统计.
+ *
+ * @param[in] win 窗口在调度表中的索引
+ */
+void QV_resetTtStat(uint_fast8_t const win)
+{
+    QF_CRIT_STAT_
+
+    /** @pre 窗口必须在调度表的范围内 */
+    Q_REQUIRE_ID(1130, win < QV_ttLen_);
+
+    QF_CRIT_E_();
+    QF_bzero(&QV_ttStat_[win], sizeof(QV_ttStat_[win]));
+    QV_ttStat_[win].latMin = 0xFFFFFFFFU;
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由 QV_ttTick() 在窗口切换时调用, 开销与就绪和挂起的 AO 的数量成正比.
+ *
+ * @returns 切换前组 @p group 是否有就绪的 AO
+ */
+static bool QV_ttSort_(uint_fast8_t const group)
+{
+    QPSet set = QV_readySet_;
+    bool busy = false;
+    uint_fast8_t p;
+
+    QPSet_insertSet(&set, &QV_ttPend_);
+    while (QPSet_notEmpty(&set)) {
+        QPSet_findMax(&set, p);
+        QPSet_remove(&set, p);
+        if ((QV_ttGroup_[p] == group) && QPSet_hasElement(&QV_readySet_, p)) {
+            busy = true;
+        }
+        if (QV_ttOn_[QV_ttGroup_[p]] != 0U) {
+            QPSet_remove(&QV_ttPend_, p);
+            QPSet_insert(&QV_readySet_, p);
+        } else {
+            QPSet_remove(&QV_readySet_, p);
+            QPSet_insert(&QV_ttPend_, p);
+        }
+    }
+    return busy;
+}
+#endif /* QV_TT */
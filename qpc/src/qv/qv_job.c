@@ -0,0 +1,323 @@
+/**
+ * @file
+ * @brief QV background jobs run from the idle callback
+ * (QVJob_start(), QVJob_stop(), QV_runJobs())
+ * @ingroup qv
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#define QP_IMPL      /* this is QP implementation */
+#include "qf_port.h" /* QF port */
+#include "qf_pkg.h"  /* QF package-scope internal interface */
+#include "qassert.h" /* QP embedded systems-friendly assertions */
+
+/* 防止在错误的项目中包含此源文件 */
+#ifndef QV_H
+#error "Source file included in a project NOT based on the QV kernel"
+#endif /* QV_H */
+
+#ifdef QV_BG_JOB /* 是否启用后台作业? */
+
+Q_DEFINE_THIS_MODULE("qv_job")
+
+/* Package-scope objects ****************************************************/
+#ifndef QF_CONTEXT /* 否则在 QF 实例上下文中, 见 qv.h */
+QVJob *QV_jobHead_; /* 待运行后台作业链表的头 */
+QVJob *QV_jobTail_; /* 待运行后台作业链表的尾 */
+
+static QVJob *QV_jobCurr_; /* 正在运行分片的作业 */
+#endif
+
+#define JOB_IDLE      0U /* QVJob.busy: 停止或已完成 */
+#define JOB_BUSY      1U /* QVJob.busy: 已启动, 尚未完成 */
+#define JOB_RESTARTED 2U /* QVJob.busy: 在自己的分片运行期间被停止后重新启动 */
+
+#if (defined QV_CYCCNT_GET) && (!defined QF_CONTEXT)
+static uint32_t QV_jobT0_;   /* 当前分片开始时的周期计数 */
+static uint32_t QV_jobLast_; /* 上一次调用 QVJob_expired() 时的周期计数 */
+#endif
+
+/*! 把作业 @p me 从待运行链表中摘除(必须在临界区内调用) */
+static void QV_jobUnlink_(QVJob *const me);
+
+/****************************************************************************/
+/**
+ * @brief
+ * 构造后台作业. 作业构造后处于停止状态, 由 QVJob_start() 启动.
+ *
+ * @param[in,out] me      指针
+ * @param[in]     handler 作业处理函数, 每次调用运行一个分片
+ * @param[in]     budget  每个分片的预算[周期] (由移植层的 QV_CYCCNT_GET()
+ *                        测量), 0 表示不限制
+ *
+ * @note 预算是"软"的: 框架不能打断分片, 只能统计超限, 并通过
+ * QVJob_expired() 通知作业处理函数结束分片. 移植层没有定义
+ * QV_CYCCNT_GET() 时 (例如 Cortex-M0/M0+) 预算和时间统计不起作用,
+ * 分片的长度完全由作业处理函数决定.
+ */
+void QVJob_ctor(QVJob *const me, QVJobHandler handler, uint32_t const budget)
+{
+    /** @pre 作业处理函数不能为空 */
+    Q_REQUIRE_ID(900, handler != (QVJobHandler)0);
+
+    QF_bzero(me, sizeof(*me));
+    me->handler = handler;
+    me->budget  = budget;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 启动后台作业: 清零进度 @c progress, 并把作业加入待运行链表的尾部.
+ * 作业在下一次空闲 (没有就绪 AO) 时开始运行, 直到处理函数返回 true.
+ * 作业的上下文 (例如下一个要处理的地址) 应在启动前由应用程序设置好.
+ *
+ * @param[in,out] me 指针
+ *
+ * @returns 作业已启动时返回 true; 作业已经在运行(尚未完成)时返回 false,
+ * 此时作业继续运行, 不会重新开始.
+ *
+ * @note 可以在线程级 (例如 AO) 或 ISR 中调用.
+ */
+bool QVJob_start(QVJob *const me)
+{
+    bool started = false;
+    QF_CRIT_STAT_
+    QF_CRIT_E_();
+
+    /** @pre 作业必须已经构造 */
+    Q_REQUIRE_CRIT_(910, me->handler != (QVJobHandler)0);
+
+    if (me->busy == JOB_IDLE) {
+        me->progress = 0U;
+#ifdef QV_CYCCNT_GET
+        me->tStart = QV_CYCCNT_GET();
+#endif
+        if (me == QV_jobCurr_) { /* 分片正在运行? */
+            me->busy = JOB_RESTARTED; /* 分片结束后再加入链表 */
+        } else {
+            me->busy = JOB_BUSY;
+            me->next = (QVJob *)0;
+            if (QV_jobTail_ == (QVJob *)0) { /* 链表空? */
+                QV_jobHead_ = me;
+            } else {
+                QV_jobTail_->next = me;
+            }
+            QV_jobTail_ = me;
+        }
+        started = true;
+    }
+    QF_CRIT_X_();
+
+    return started;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 停止后台作业, 作业不再运行, 也不计入完成次数. 如果在作业的分片运行
+ * 期间 (例如在作业处理函数自身或 ISR 中) 调用, 该分片结束后作业被丢弃.
+ *
+ * @param[in,out] me 指针
+ *
+ * @note 可以在线程级 (例如 AO) 或 ISR 中调用. 停止已经停止的作业没有作用.
+ */
+void QVJob_stop(QVJob *const me)
+{
+    QF_CRIT_STAT_
+    QF_CRIT_E_();
+    if (me->busy != JOB_IDLE) {
+        me->busy = JOB_IDLE;
+        QV_jobUnlink_(me); /* 正在运行的作业不在链表中, 不受影响 */
+    }
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由作业处理函数在分片内部调用, 用于把分片的长度限制在预算内:
+ * 处理函数可以循环处理小的工作单元, 直到本函数返回 true 再返回.
+ * 本函数把两次调用之间的时间当作一个工作单元的长度, 如果再做一个
+ * 单元就会超出预算, 就提前返回 true, 因此单元长度稳定时分片不会超限.
+ *
+ * @param[in] me 指针 (当前运行的作业)
+ *
+ * @returns 有 AO 就绪, 或者当前分片已经用完预算时返回 true
+ *
+ * @usage
+ * @code
+ * static bool FlashCrc_chunk(QVJob *const me) {
+ *     FlashCrc *const job = (FlashCrc *)me;
+ *     do {
+ *         job->crc = crc32_update(job->crc, job->addr, 64U);
+ *         job->addr += 64U;
+ *         me->progress += 64U;
+ *     } while ((job->addr < job->end) && !QVJob_expired(me));
+ *     return job->addr >= job->end; // 完成?
+ * }
+ * @endcode
+ */
+bool QVJob_expired(QVJob const *const me)
+{
+    bool expired = QPSet_notEmpty(&QV_readySet_); /* 有 AO 就绪? */
+#ifdef QV_CYCCNT_GET
+    if ((!expired) && (me->budget != 0U)) {
+        uint32_t const now = QV_CYCCNT_GET();
+        /* 已用时间加上一个单元的估计长度 */
+        expired     = (((now - QV_jobT0_) + (now - QV_jobLast_)) > me->budget);
+        QV_jobLast_ = now;
+    }
+#else
+    (void)me; /* unused parameter */
+#endif
+    return expired;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 在 QV_onIdle() 中调用, 只要没有就绪的 AO 就依次 (轮转) 运行待运行作业
+ * 的分片. 每个分片运行时中断是使能的; 分片结束后检查就绪集合,
+ * 有 AO 就绪时立即返回, 由 QF_run() 分发事件. 未完成的作业移到链表尾部,
+ * 下次空闲时继续.
+ *
+ * @returns 运行了至少一个分片时返回 true. 此时 QV_onIdle() 应当只使能
+ * 中断并返回 (不能进入低功耗模式), 因为可能还有作业或就绪的 AO;
+ * 返回 false 时没有待运行的作业, QV_onIdle() 可以照常进入低功耗模式.
+ *
+ * @note 必须在中断禁止时调用 (QV_onIdle() 的入口状态), 返回时中断仍然
+ * 禁止. 定义 #QV_LOAD_STAT 时, 后台作业的时间计入空闲时间.
+ *
+ * @usage
+ * @code
+ * void QV_onIdle(void) { // 中断禁止时调用
+ *     if (QV_runJobs()) {
+ *         QF_INT_ENABLE(); // 还有工作, 不进入低功耗模式
+ *     } else {
+ *         QV_CPU_SLEEP();  // 原子地进入低功耗模式并使能中断
+ *     }
+ * }
+ * @endcode
+ */
+bool QV_runJobs(void)
+{
+    bool ran = false;
+
+    while ((QV_jobHead_ != (QVJob *)0) && QPSet_isEmpty(&QV_readySet_)) {
+        QVJob *const j = QV_jobHead_;
+        bool done;
+#ifdef QV_CYCCNT_GET
+        uint32_t cyc;
+#endif
+
+        QV_jobUnlink_(j); /* 运行期间作业不在链表中 */
+        QV_jobCurr_ = j;
+#ifdef QV_CYCCNT_GET
+        QV_jobT0_   = QV_CYCCNT_GET();
+        QV_jobLast_ = QV_jobT0_;
+#endif
+        QF_INT_ENABLE();
+
+        done = (*j->handler)(j); /* 运行一个分片 */
+
+#ifdef QV_CYCCNT_GET
+        cyc = QV_CYCCNT_GET() - QV_jobT0_;
+#endif
+        QF_INT_DISABLE();
+        QV_jobCurr_ = (QVJob *)0;
+        ran         = true;
+
+        ++j->nChunk;
+#ifdef QV_CYCCNT_GET
+        if (cyc > j->chunkMax) {
+            j->chunkMax = cyc;
+        }
+        if ((j->budget != 0U) && (cyc > j->budget)) {
+            ++j->nOverrun;
+        }
+#endif
+
+        if (j->busy == JOB_IDLE) {  /* 分片运行期间被停止? */
+            /* 丢弃 */
+        } else if ((done) && (j->busy == JOB_BUSY)) { /* 作业完成? */
+            j->busy = JOB_IDLE;
+            ++j->nDone;
+#ifdef QV_CYCCNT_GET
+            j->latency = QV_CYCCNT_GET() - j->tStart;
+            if (j->latency > j->latencyMax) {
+                j->latencyMax = j->latency;
+            }
+#endif
+        } else { /* 未完成或被重新启动, 移到链表尾部 */
+            j->busy = JOB_BUSY;
+            if (QV_jobTail_ == (QVJob *)0) {
+                QV_jobHead_ = j;
+            } else {
+                QV_jobTail_->next = j;
+            }
+            QV_jobTail_ = j;
+            if (QPSet_notEmpty(&QV_readySet_)) { /* 让出给就绪的 AO? */
+                ++j->nPreempt;
+            }
+        }
+    }
+    return ran;
+}
+
+/****************************************************************************/
+static void QV_jobUnlink_(QVJob *const me)
+{
+    QVJob *prev = (QVJob *)0;
+    QVJob *j    = QV_jobHead_;
+
+    while ((j != (QVJob *)0) && (j != me)) {
+        prev = j;
+        j    = j->next;
+    }
+    if (j != (QVJob *)0) { /* 找到? */
+        if (prev == (QVJob *)0) {
+            QV_jobHead_ = j->next;
+        } else {
+            prev->next = j->next;
+        }
+        if (QV_jobTail_ == j) {
+            QV_jobTail_ = prev;
+        }
+        j->next = (QVJob *)0;
+    }
+}
+
+#endif /* QV_BG_JOB */
@@ -0,0 +1,562 @@
+/**
+ * @file
+ * @brief QXK preemptive dual-mode kernel core functions
+ * @ingroup qxk
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#define QP_IMPL      /* this is QP implementation */
+#include "qf_port.h" /* QF port */
+#include "qxk_pkg.h" /* QXK package-scope interface */
+#include "qf_pkg.h"  /* QF package-scope internal interface */
+#include "qassert.h" /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+/* 防止在错误的项目中包含此源文件 */
+#ifndef QXK_H
+#error "Source file included in a project NOT based on the QXK kernel"
+#endif /* QXK_H */
+
+#ifndef QXK_CONTEXT_SWITCH_
+#error "QXK port must define QXK_CONTEXT_SWITCH_()"
+#endif
+
+Q_DEFINE_THIS_MODULE("qxk")
+
+/* Public-scope objects *****************************************************/
+QXK_PrivAttr QXK_attr_; /* QXK 内核的私有属性 */
+
+/* Local-scope objects ******************************************************/
+/*! 表示基本上下文 (AO 和空闲循环共用的栈) 的对象 */
+static QActive l_idleThread;
+
+/*! 在 QF_run() 中解锁调度器并处理启动期间投递的事件 */
+static void initial_events(void);
+
+/****************************************************************************/
+/**
+ * @brief
+ * 初始化 QF, 必须在调用其他任何 QF 函数之前且仅调用一次.
+ * 通常在 main() 中调用 QF_init(), 甚至在初始化板级支持包 (BSP) 之前.
+ *
+ * @note QF_init() 会清零内部的 QF 变量, 这样即使启动代码没有清零未初始化数据
+ * (C 标准要求的), 框架仍然可以正确启动. QXK 调度器在 QF_run() 之前保持加锁,
+ * 因此 main() 中投递的事件和启动的扩展线程不会引起抢占.
+ */
+void QF_init(void)
+{
+    QF_maxPool_      = 0U;
+    QF_subscrList_   = (QSubscrList *)0;
+    QF_maxPubSignal_ = 0;
+#ifdef QF_PS_SPARSE
+    QF_subscrNum_ = 0U;
+#endif
+#if (QF_MAX_PS_GROUP > 0U)
+    QF_psGroupNum_ = 0U;
+#endif
+#if (QF_MAX_PS_FILTER > 0U)
+    QF_psFilterNum_ = 0U;
+#endif
+
+    QF_bzero(&QF_timeEvtHead_[0], sizeof(QF_timeEvtHead_));
+    QF_bzero((void *)&QF_tickCtr_[0], sizeof(QF_tickCtr_));
+#ifdef QF_TMO_WHEEL_SIZE
+    QF_bzero(&QF_tmo_, sizeof(QF_tmo_));
+#endif
+    QF_bzero(&QF_active_[0], sizeof(QF_active_));
+    QF_bzero(&QXK_attr_, sizeof(QXK_attr_));
+    QF_bzero(&l_idleThread, sizeof(l_idleThread));
+
+    /* 当前运行的是基本上下文 (main() 的栈) */
+    QXK_attr_.idleThread = &l_idleThread;
+    QXK_attr_.curr       = &l_idleThread;
+
+    /* QXK 调度器在 QF_run() 之前保持加锁 */
+    QXK_attr_.lockPrio = (uint8_t)(QF_MAX_ACTIVE + 1U);
+
+#ifdef QXK_INIT
+    QXK_INIT(); /* port-specific initialization of the QXK kernel */
+#endif
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 该函数用于停止 QF 应用程序. 调用此函数后, QF 会尝试优雅地关闭应用程序.
+ *
+ * @attention
+ * 调用 QF_stop() 后, 应用程序必须终止, 不能继续运行.
+ * 特别地, QF_stop() 不应该之后再调用 QF_init() 来"复活"应用程序.
+ */
+void QF_stop(void)
+{
+    QF_onCleanup(); /* 应用程序特定的清理回调 */
+    /* 对于 QXK 内核无需其他操作 */
+}
+
+/****************************************************************************/
+static void initial_events(void)
+{
+    QXK_attr_.lockPrio = 0U; /* 解锁调度器 */
+
+    /* 有 AO 在启动期间收到了事件吗? (扩展线程由上下文切换启动) */
+    if (QXK_sched_() != 0U) {
+        QXK_activate_(); /* 激活 AO 处理这些事件 */
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 通常在 main() 中调用 QF_run(), 在初始化 QF 并通过 QACTIVE_START()
+ * 和 QXTHREAD_START() 启动 AO 和扩展线程之后.
+ *
+ * @returns 在 QXK 内核中, QF_run() 函数不会返回.
+ */
+int_t QF_run(void)
+{
+    QF_INT_DISABLE();
+    initial_events(); /* 处理所有在启动期间投递的事件 */
+    QF_INT_ENABLE();  /* 待处理的上下文切换在这里发生 */
+
+    QF_onStartup(); /* 应用程序特定的启动回调 */
+
+    /* QXK 的空闲循环... */
+    for (;;) {
+        QXK_onIdle(); /* 应用程序特定的 QXK 空闲回调 */
+    }
+#ifdef __GNUC__ /* GNU compiler? */
+    return 0;
+#endif
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 启动活动对象 (AO) 的执行, 并将 AO 注册到框架中.
+ * 同时执行 AO 状态机中的最顶层初始转换.
+ *
+ * @param[in,out] me      指针
+ * @param[in]     prio    启动活动对象时的优先级
+ * @param[in]     qSto    指向事件队列环形缓冲区的存储指针
+ *                        (仅用于内置的 ::QEQueue)
+ * @param[in]     qLen    事件队列长度 [事件数]
+ * @param[in]     stkSto  栈存储指针 (AO 必须为 NULL, 扩展线程见 QXTHREAD_START())
+ * @param[in]     stkSize 栈大小 [字节]
+ * @param[in]     par     额外参数指针 (可以为 NULL)
+ *
+ * @note 此函数应通过宏 QACTIVE_START() 调用.
+ */
+void QActive_start_(QActive *const me, uint_fast8_t prio,
+                    QEvt const **const qSto, uint_fast16_t const qLen,
+                    void *const stkSto, uint_fast16_t const stkSize,
+                    void const *const par)
+{
+    QF_CRIT_STAT_
+
+    (void)stkSize; /* unused parameter */
+
+    /** @pre AO 不能在 ISR 中启动, 优先级必须在范围内,
+     * 并且不能提供栈存储, 因为所有 AO 共用基本上下文的栈
+     */
+    Q_REQUIRE_ID(300, (!QXK_ISR_CONTEXT_())
+                      && (0U < prio) && (prio <= QF_MAX_ACTIVE)
+                      && (stkSto == (void *)0));
+
+    QEQueue_init(&me->eQueue, qSto, qLen); /* 初始化内置队列 */
+    me->osObject = (void *)0;              /* AO 没有私有栈 */
+    me->prio     = (uint8_t)prio;          /* 设置 AO 的优先级 */
+    me->dynPrio  = (uint8_t)prio;          /* AO 的动态优先级不变 */
+    QF_add_(me);                           /* 添加到 QF */
+
+    QHSM_INIT(&me->super, par, me->prio); /* 执行最顶层初始转换 */
+    QS_FLUSH();                           /* 将跟踪缓冲区刷新到主机 */
+
+    /* QXK 已经运行时, 检查该 AO 是否需要立即运行 */
+    QF_CRIT_E_();
+    if (QXK_sched_() != 0U) { /* 同步抢占? */
+        QXK_activate_();      /* 激活 AO 处理事件 */
+    }
+    QF_CRIT_X_();
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 该函数锁定 QXK 调度器, 使优先级不高于 @p ceiling 的 AO 和扩展线程
+ * 不能抢占当前线程, 而更高优先级的线程和中断仍然可以运行
+ * (选择性调度器锁, 即优先级天花板).
+ *
+ * @param[in] ceiling 调度器锁的天花板优先级
+ *
+ * @returns 调度器锁之前的状态, 必须原样传给 QXK_schedUnlock()
+ *
+ * @note 调度器锁可以嵌套, 但必须按后进先出的顺序解锁. 持有调度器锁的
+ * 扩展线程不能阻塞.
+ *
+ * @note 只能在线程级调用, 不能在 ISR 中调用. QF_publish_() 使用同样的锁,
+ * 使多播期间不会发生订阅者之间的抢占.
+ */
+QSchedStatus QXK_schedLock(uint_fast8_t const ceiling)
+{
+    QSchedStatus stat;
+    QF_CRIT_STAT_
+    QF_CRIT_E_();
+
+    /** @pre 不能在 ISR 中调用调度器锁 */
+    Q_REQUIRE_CRIT_(600, !QXK_ISR_CONTEXT_());
+
+    /* 天花板高于当前的锁? */
+    if (QXK_attr_.lockPrio < ceiling) {
+        stat               = ((QSchedStatus)QXK_attr_.lockPrio << 8);
+        QXK_attr_.lockPrio = (uint8_t)ceiling;
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_LOCK, 0U)
+        QS_TIME_PRE_(); /* timestamp */
+        QS_2U8_PRE_(stat >> 8,           /* the previous lock prio */
+                    QXK_attr_.lockPrio); /* the new lock prio */
+        QS_END_NOCRIT_PRE_()
+
+        /* 保存锁持有者 */
+        stat |= (QSchedStatus)QXK_attr_.lockHolder;
+        QXK_attr_.lockHolder = QXK_IN_XTHREAD_()
+                               ? QXK_attr_.curr->prio
+                               : QXK_attr_.actPrio;
+    } else {
+        stat = 0xFFU; /* 调度器没有被锁定 */
+    }
+    QF_CRIT_X_();
+
+    return stat; /* 返回之前的状态 */
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 该函数恢复 QXK_schedLock() 之前的调度器锁, 并在需要时立即运行
+ * 锁定期间就绪的更高优先级线程.
+ *
+ * @param[in] stat QXK_schedLock() 返回的调度器锁状态
+ *
+ * @note 只能在线程级调用, 不能在 ISR 中调用.
+ */
+void QXK_schedUnlock(QSchedStatus const stat)
+{
+    /* 锁是否由 QXK_schedLock() 真正加上? */
+    if (stat != 0xFFU) {
+        uint_fast8_t const lockPrio = (uint_fast8_t)QXK_attr_.lockPrio;
+        uint_fast8_t const prevPrio = (uint_fast8_t)(stat >> 8);
+        QF_CRIT_STAT_
+        QF_CRIT_E_();
+
+        /** @pre 不能在 ISR 中解锁, 且当前的锁必须高于之前的锁 */
+        Q_REQUIRE_CRIT_(700, (!QXK_ISR_CONTEXT_()) && (lockPrio > prevPrio));
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_UNLOCK, 0U)
+        QS_TIME_PRE_();                /* timestamp */
+        QS_2U8_PRE_(lockPrio,          /* lock prio */
+                    prevPrio);         /* previous lock prio */
+        QS_END_NOCRIT_PRE_()
+
+        /* 恢复之前的锁和锁持有者 */
+        QXK_attr_.lockPrio   = (uint8_t)prevPrio;
+        QXK_attr_.lockHolder = (uint8_t)(stat & 0xFFU);
+
+        /* 锁定期间有更高优先级的线程就绪? */
+        if (QXK_sched_() != 0U) {
+            QXK_activate_(); /* 同步抢占 */
+        }
+
+        QF_CRIT_X_(); /* 待处理的上下文切换在这里发生 */
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 找出就绪集合中的最高优先级线程, 并与当前上下文比较:
+ * - 调度器被锁住且该线程不高于天花板: 改为选择锁的持有者 (在 main() 中
+ *   加的锁没有持有者, 对应基本上下文);
+ * - 该线程是扩展线程: 如果它高于基本上下文中被抢占的 AO, 切换到它,
+ *   否则切换回基本上下文;
+ * - 该线程是 AO (或没有就绪线程): 需要在基本上下文中运行. 如果当前就在
+ *   基本上下文中, 且该 AO 高于正在运行的 AO, 返回其优先级供 QXK_activate_()
+ *   使用; 如果当前在扩展线程中, 切换回基本上下文.
+ *
+ * @returns 需要在当前的基本上下文中激活的 AO 的优先级, 或 0
+ *
+ * @note 必须在临界区内调用. 上下文切换在退出临界区 (或中断返回) 之后发生.
+ */
+uint_fast8_t QXK_sched_(void)
+{
+    QActive *const curr = QXK_attr_.curr;
+    QActive *next       = curr; /* 默认不切换 */
+    uint_fast8_t pa     = 0U;   /* 需要激活的 AO 的优先级 */
+    uint_fast8_t p;
+
+    if (QPSet_isEmpty(&QXK_attr_.readySet)) {
+        p = 0U; /* 没有就绪的线程 */
+    } else {
+        /* 找出就绪集合中的最高优先级线程 */
+        QPSet_findMax(&QXK_attr_.readySet, p);
+    }
+
+    if ((p != 0U) && (p <= (uint_fast8_t)QXK_attr_.lockPrio)) {
+        p = (uint_fast8_t)QXK_attr_.lockHolder; /* 被锁定: 锁的持有者继续运行 */
+    }
+
+    if ((p != 0U) && (QF_active_[p]->osObject != (void *)0)) {
+        /* 扩展线程: 必须高于基本上下文中被抢占的 AO */
+        if (p > (uint_fast8_t)QXK_attr_.actPrio) {
+            next = QF_active_[p];
+        } else {
+            next = QXK_attr_.idleThread;
+        }
+    } else { /* AO 或空闲循环, 都运行在基本上下文中 */
+        next = QXK_attr_.idleThread;
+        if ((curr == next) && (p > (uint_fast8_t)QXK_attr_.actPrio)) {
+            pa                 = p;
+            QXK_attr_.nextPrio = (uint8_t)p; /* 下一个要激活的 AO */
+        }
+    }
+
+    if (next != curr) {       /* 需要切换上下文? */
+        QXK_attr_.next = next;
+        QXK_CONTEXT_SWITCH_(); /* 请求移植层切换上下文 */
+    } else {
+        QXK_attr_.next = (QActive *)0; /* 取消可能待处理的切换 */
+    }
+    return pa;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 从 QXK_attr_.nextPrio 开始, 在基本上下文中依次运行优先级高于当前 AO 的
+ * 所有就绪 AO 的 RTC 步骤, 然后返回被抢占的 AO. 如果期间有更高优先级的
+ * 扩展线程就绪, QXK_sched_() 会请求上下文切换, 基本上下文连同正在运行的
+ * AO 一起被挂起, 之后再恢复.
+ *
+ * @note 必须在临界区内调用, 返回时也处于临界区内.
+ */
+void QXK_activate_(void)
+{
+    uint_fast8_t const pin = (uint_fast8_t)QXK_attr_.actPrio; /* 保存被抢占的优先级 */
+    uint_fast8_t p         = (uint_fast8_t)QXK_attr_.nextPrio;
+    QActive *a;
+#if (defined QXK_ON_CONTEXT_SW) || (defined Q_SPY)
+    uint_fast8_t pprev = pin;
+#endif /* QXK_ON_CONTEXT_SW || Q_SPY */
+
+    /** @pre QXK_attr_.nextPrio 必须已经由 QXK_sched_() 设置,
+     * 并且只能在基本上下文中调用
+     */
+    Q_REQUIRE_ID(500, (pin < QF_MAX_ACTIVE) && (0U < p) && (p <= QF_MAX_ACTIVE)
+                      && (!QXK_IN_XTHREAD_()));
+
+    QXK_attr_.nextPrio = 0U; /* 清除 nextPrio, 表示已处理 */
+
+    /* 依次运行就绪集合中优先级高于 pin 的 AO */
+    do {
+        QEvt const *e;
+        a = QF_active_[p]; /* 下一个 AO */
+
+        QXK_attr_.actPrio = (uint8_t)p; /* 该 AO 成为当前运行的 AO */
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_NEXT, a->prio)
+        QS_TIME_PRE_();     /* timestamp */
+        QS_2U8_PRE_(p,      /* priority of the scheduled AO */
+                    pprev); /* previous priority */
+        QS_END_NOCRIT_PRE_()
+
+#if (defined QXK_ON_CONTEXT_SW) || (defined Q_SPY)
+        if (p != pprev) { /* 切换到另一个 AO? */
+#ifdef QXK_ON_CONTEXT_SW
+            QXK_onContextSw(((pprev != 0U) ? QF_active_[pprev] : (QActive *)0), a);
+#endif /* QXK_ON_CONTEXT_SW */
+            pprev = p; /* 更新上一次的优先级 */
+        }
+#endif /* QXK_ON_CONTEXT_SW || Q_SPY */
+
+        QF_INT_ENABLE(); /* 在 RTC 步骤中使能中断 */
+
+        /* 执行完成运行(RTC)步骤:
+         * 1. 从活动对象的事件队列中取出事件, 此时队列必须非空.
+         * 2. 将事件分发到活动对象的状态机.
+         * 3. 判断事件是否为垃圾, 如果是则回收.
+         */
+        e = QActive_get_(a);
+        QHSM_DISPATCH(&a->super, e, a->prio);
+        QF_gc(e);
+
+        /* 找出下一个要运行的线程... */
+        QF_INT_DISABLE();
+
+        if (a->eQueue.frontEvt == (QEvt *)0) { /* 事件队列空? */
+            QPSet_remove(&QXK_attr_.readySet, p);
+        }
+
+        /* 与被抢占的 AO 比较; 更高优先级的扩展线程由上下文切换处理 */
+        QXK_attr_.actPrio = (uint8_t)pin;
+        p = QXK_sched_();
+        Q_ASSERT_ID(510, p <= QF_MAX_ACTIVE);
+    } while (p != 0U);
+
+    QXK_attr_.nextPrio = 0U;
+
+#if (defined QXK_ON_CONTEXT_SW) || (defined Q_SPY)
+    if (pin != 0U) { /* 恢复一个 AO? */
+        a = QF_active_[pin];
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_RESUME, a->prio)
+        QS_TIME_PRE_();     /* timestamp */
+        QS_2U8_PRE_(pin,    /* priority of the resumed AO */
+                    pprev); /* previous priority */
+        QS_END_NOCRIT_PRE_()
+    } else { /* 恢复到空闲循环 */
+        a = (QActive *)0;
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_IDLE, 0U)
+        QS_TIME_PRE_();    /* timestamp */
+        QS_U8_PRE_(pprev); /* previous priority */
+        QS_END_NOCRIT_PRE_()
+    }
+
+#ifdef QXK_ON_CONTEXT_SW
+    QXK_onContextSw(QF_active_[pprev], a);
+#endif /* QXK_ON_CONTEXT_SW */
+
+#endif /* QXK_ON_CONTEXT_SW || Q_SPY */
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 由移植层的上下文切换代码 (例如 ARM Cortex-M 上的 PendSV) 在临界区内调用.
+ * 它把被切换出去的上下文的栈指针 @p sp 保存在 QXK_attr_.curr 的 osObject 中,
+ * 使 QXK_attr_.next 成为当前上下文, 并返回其保存的栈指针.
+ * 没有待处理的切换时直接返回 @p sp.
+ *
+ * 返回之前会重新调度: 如果切换到的 (或当前的) 是基本上下文并且有更高优先级的
+ * AO 就绪, QXK_attr_.nextPrio 非零, 移植层必须在恢复该上下文之前, 在线程模式下
+ * 调用 QXK_activate_().
+ *
+ * @param[in] sp 被切换出去的上下文的栈指针
+ *
+ * @returns 要恢复的上下文的栈指针
+ */
+void *QXK_contextSw_(void *sp)
+{
+    QActive *const next = QXK_attr_.next;
+
+    if (next != (QActive *)0) { /* 待处理的上下文切换? */
+        QActive *const prev = QXK_attr_.curr;
+
+        prev->osObject = sp; /* 保存被切换出去的上下文 */
+
+        QS_BEGIN_NOCRIT_PRE_(QS_SCHED_NEXT, next->prio)
+        QS_TIME_PRE_();               /* timestamp */
+        QS_2U8_PRE_(next->prio,       /* priority of the next thread */
+                    prev->prio);      /* priority of the previous thread */
+        QS_END_NOCRIT_PRE_()
+
+#ifdef QXK_ON_CONTEXT_SW
+        QXK_onContextSw(((prev != QXK_attr_.idleThread)
+                             ? prev : QF_active_[QXK_attr_.actPrio]),
+                        ((next != QXK_attr_.idleThread)
+                             ? next : QF_active_[QXK_attr_.actPrio]));
+#endif /* QXK_ON_CONTEXT_SW */
+
+        QXK_attr_.curr = next;
+        QXK_attr_.next = (QActive *)0;
+        sp             = next->osObject; /* 恢复的上下文 */
+    }
+
+    /* 基本上下文需要激活 AO? (可能再次请求切换) */
+    QXK_attr_.nextPrio = (uint8_t)QXK_sched_();
+
+    return sp;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 返回当前正在运行的扩展线程, 或基本上下文中正在运行的 AO
+ * (空闲循环中返回 NULL).
+ */
+QActive *QXK_current(void)
+{
+    QActive *curr;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+    curr = QXK_attr_.curr;
+    if (curr == QXK_attr_.idleThread) { /* 基本上下文? */
+        curr = QF_active_[QXK_attr_.actPrio];
+    }
+    QF_CRIT_X_();
+
+    return curr;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 扩展线程的处理函数返回后执行 (移植层把它设置为线程处理函数的返回地址).
+ * 该线程从 QF 中移除, 其优先级可以重新使用, 然后切换到其他上下文, 不再返回.
+ */
+void QXK_threadExit_(void)
+{
+    QActive *const thr = QXK_attr_.curr;
+    QF_CRIT_STAT_
+
+    /** @pre 必须在扩展线程中, 并且没有持有调度器锁 */
+    Q_REQUIRE_ID(800, QXK_IN_XTHREAD_()
+                      && (QXK_attr_.lockHolder != thr->prio));
+
+    QF_remove_(thr); /* 释放优先级 */
+
+    QF_CRIT_E_();
+    QPSet_remove(&QXK_attr_.readySet, thr->dynPrio);
+    (void)QXK_sched_(); /* 切换到其他上下文 */
+    QF_CRIT_X_();
+
+    Q_ERROR_ID(810); /* 已停止的线程不会再被切换回来 */
+}
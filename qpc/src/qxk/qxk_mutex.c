@@ -0,0 +1,261 @@
+/**
+ * @file
+ * @brief QXK/C preemptive kernel priority-ceiling mutex implementation
+ * @ingroup qxk
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#define QP_IMPL      /* this is QP implementation */
+#include "qf_port.h" /* QF port */
+#include "qxk_pkg.h" /* QXK package-scope interface */
+#include "qf_pkg.h"  /* QF package-scope internal interface */
+#include "qassert.h" /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+/* 防止在错误的项目中包含此源文件 */
+#ifndef QXK_H
+#error "Source file included in a project NOT based on the QXK kernel"
+#endif /* QXK_H */
+
+Q_DEFINE_THIS_MODULE("qxk_mutex")
+
+/* Local-scope objects ******************************************************/
+/*! 在 QF 中保留天花板优先级的占位对象 (互斥量空闲时) */
+static QActive l_ceilingRsv;
+
+/*! 把持有者 @p thr 提升到互斥量的天花板优先级 (在临界区内调用) */
+static void QXMutex_raise_(QXMutex const *const me, QActive *const thr);
+
+/****************************************************************************/
+/**
+ * @brief
+ * 初始化互斥量, 必须在任何线程使用它之前调用. 非零的天花板优先级在 QF 中
+ * 被保留, 不能再分配给 AO 或扩展线程.
+ *
+ * @param[in,out] me      指针
+ * @param[in]     ceiling 天花板优先级, 0 表示不提升持有者的优先级
+ */
+void QXMutex_init(QXMutex *const me, uint_fast8_t const ceiling)
+{
+    QF_CRIT_STAT_
+
+    /** @pre 天花板优先级必须在范围内并且未被使用 */
+    Q_REQUIRE_ID(100, (ceiling <= QF_MAX_ACTIVE)
+                      && ((ceiling == 0U)
+                          || (QF_active_[ceiling] == (QActive *)0)));
+
+    me->ceiling  = (uint8_t)ceiling;
+    me->holder   = (QActive *)0;
+    me->lockNest = 0U;
+    QPSet_setEmpty(&me->waitSet);
+
+    if (ceiling != 0U) {
+        QF_CRIT_E_();
+        QF_active_[ceiling] = &l_ceilingRsv; /* 保留天花板优先级 */
+        QF_CRIT_X_();
+    }
+}
+
+/****************************************************************************/
+static void QXMutex_raise_(QXMutex const *const me, QActive *const thr)
+{
+    if (me->ceiling != 0U) {
+        uint_fast8_t const ceiling = (uint_fast8_t)me->ceiling;
+
+        /* 天花板必须空闲, 并且高于持有者 */
+        Q_ASSERT_CRIT_(200, (QF_active_[ceiling] == &l_ceilingRsv)
+                            && (thr->prio < ceiling)
+                            && (thr->dynPrio == thr->prio));
+
+        /* 就绪的持有者在就绪集合中换到天花板优先级 */
+        if (QPSet_hasElement(&QXK_attr_.readySet, (uint_fast8_t)thr->prio)) {
+            QPSet_remove(&QXK_attr_.readySet, (uint_fast8_t)thr->prio);
+            QPSet_insert(&QXK_attr_.readySet, ceiling);
+        }
+        thr->dynPrio        = (uint8_t)ceiling;
+        QF_active_[ceiling] = thr;
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 加锁互斥量. 互斥量空闲或已由当前线程持有时立即返回, 否则阻塞当前扩展
+ * 线程, 直到持有者解锁 (所有权直接转交给等待者中优先级最高的线程),
+ * 或者经过 @p nTicks 个时钟滴答.
+ *
+ * @param[in,out] me     指针
+ * @param[in]     nTicks 超时 [滴答], #QXTHREAD_NO_TIMEOUT 表示一直等待
+ *
+ * @returns 'true' 表示获得了互斥量, 'false' 表示超时
+ *
+ * @note 只能在扩展线程中调用.
+ */
+bool QXMutex_lock(QXMutex *const me, uint_fast16_t const nTicks)
+{
+    QActive *const curr = QXK_attr_.curr;
+    bool locked         = true;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+
+    /** @pre 必须在扩展线程中调用, 并且没有持有调度器锁 */
+    Q_REQUIRE_CRIT_(300, (!QXK_ISR_CONTEXT_()) && QXK_IN_XTHREAD_()
+                         && (QXK_attr_.lockHolder != curr->prio));
+
+    if (me->lockNest == 0U) { /* 互斥量空闲? */
+        me->holder   = curr;
+        me->lockNest = 1U;
+        QXMutex_raise_(me, curr);
+    } else if (me->holder == curr) { /* 嵌套加锁? */
+        Q_ASSERT_CRIT_(310, me->lockNest < 0xFFU);
+        ++me->lockNest;
+    } else { /* 被其他线程持有, 需要等待 */
+        QXThread *const thr = QXTHREAD_CAST_(curr);
+
+        QPSet_insert(&me->waitSet, (uint_fast8_t)curr->prio);
+        curr->super.temp.obj = QXK_PTR_CAST_(struct QMState const *, me);
+        QXThread_teArm_(thr, (QSignal)QXK_WAIT_SIG, nTicks);
+        QXThread_block_(thr);
+        QF_CRIT_X_();
+        QF_CRIT_EXIT_NOP(); /* 在这里切换到其他线程 */
+
+        QF_CRIT_E_();
+        /* QXMutex_unlock() 转交所有权时清除 temp.obj, 超时则保留 */
+        locked = (curr->super.temp.obj == (struct QMState const *)0);
+        curr->super.temp.obj = (struct QMState const *)0;
+    }
+    QF_CRIT_X_();
+
+    return locked;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 不阻塞地尝试加锁互斥量.
+ *
+ * @returns 'true' 表示获得了互斥量 (或嵌套加锁)
+ *
+ * @note 只能在扩展线程中调用.
+ */
+bool QXMutex_tryLock(QXMutex *const me)
+{
+    QActive *const curr = QXK_attr_.curr;
+    bool locked         = true;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+
+    /** @pre 必须在扩展线程中调用 */
+    Q_REQUIRE_CRIT_(400, (!QXK_ISR_CONTEXT_()) && QXK_IN_XTHREAD_());
+
+    if (me->lockNest == 0U) {
+        me->holder   = curr;
+        me->lockNest = 1U;
+        QXMutex_raise_(me, curr);
+    } else if (me->holder == curr) {
+        Q_ASSERT_CRIT_(410, me->lockNest < 0xFFU);
+        ++me->lockNest;
+    } else {
+        locked = false;
+    }
+    QF_CRIT_X_();
+
+    return locked;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 解锁互斥量. 最外层的解锁恢复持有者的优先级, 并把所有权直接转交给
+ * 等待者中优先级最高的线程 (如果有). 如果该线程的优先级更高, 立即切换到它.
+ *
+ * @note 只能由持有者调用.
+ */
+void QXMutex_unlock(QXMutex *const me)
+{
+    QActive *const curr = QXK_attr_.curr;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+
+    /** @pre 必须在扩展线程中调用, 并且当前线程必须持有该互斥量 */
+    Q_REQUIRE_CRIT_(500, (!QXK_ISR_CONTEXT_()) && QXK_IN_XTHREAD_()
+                         && (me->lockNest > 0U) && (me->holder == curr));
+
+    --me->lockNest;
+    if (me->lockNest == 0U) { /* 最外层的解锁? */
+
+        /* 恢复持有者的优先级 */
+        if (me->ceiling != 0U) {
+            uint_fast8_t const ceiling = (uint_fast8_t)me->ceiling;
+            QPSet_remove(&QXK_attr_.readySet, ceiling);
+            QPSet_insert(&QXK_attr_.readySet, (uint_fast8_t)curr->prio);
+            curr->dynPrio       = curr->prio;
+            QF_active_[ceiling] = &l_ceilingRsv;
+        }
+
+        if (QPSet_notEmpty(&me->waitSet)) { /* 有等待者? 转交所有权 */
+            uint_fast8_t p;
+            QXThread *thr;
+
+            QPSet_findMax(&me->waitSet, p);
+            QPSet_remove(&me->waitSet, p);
+            thr = QXTHREAD_CAST_(QF_active_[p]);
+
+            /* 等待者必须是阻塞在该互斥量上的扩展线程 */
+            Q_ASSERT_CRIT_(510, (thr != (QXThread *)0)
+                                && (thr->super.super.temp.obj
+                                    == QXK_PTR_CAST_(struct QMState const *, me)));
+
+            (void)QXThread_teDisarm_(thr);
+            thr->super.super.temp.obj = (struct QMState const *)0;
+            me->holder   = &thr->super;
+            me->lockNest = 1U;
+            QXMutex_raise_(me, &thr->super);
+            QXThread_unblock_(thr);
+        } else {
+            me->holder = (QActive *)0;
+            (void)QXK_sched_(); /* 降低优先级后可能需要切换 */
+        }
+    }
+    QF_CRIT_X_(); /* 待处理的上下文切换在这里发生 */
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @brief Internal (package scope) QXK/C interface.
+ * @ingroup qxk
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#ifndef QXK_PKG_H
+#define QXK_PKG_H
+
+/*! 扩展线程私有时间事件的内部信号, 表示线程阻塞在什么上 */
+/**
+ * @brief
+ * 这些信号都小于 #Q_USER_SIG, QF_tickX_() 据此把到期的私有时间事件交给
+ * QXThread_timeout_() 处理, 而不是投递到事件队列.
+ */
+enum QXK_TimeoutSigs {
+    QXK_DELAY_SIG = 1, /*!< 阻塞在 QXThread_delay() */
+    QXK_QUEUE_SIG,     /*!< 阻塞在 QXThread_queueGet() */
+    QXK_WAIT_SIG       /*!< 阻塞在信号量或互斥量的等待集合上 */
+};
+
+/*! 把指针 @p ptr_ 转换为 @p type_ 类型 */
+#define QXK_PTR_CAST_(type_, ptr_) ((type_)(ptr_))
+
+/*! 把 ::QActive 指针转换为 ::QXThread 指针 */
+#define QXTHREAD_CAST_(ptr_) ((QXThread *)(ptr_))
+
+/*! 当前上下文是否为扩展线程 (而不是 AO 或空闲循环) */
+#define QXK_IN_XTHREAD_() (QXK_attr_.curr != QXK_attr_.idleThread)
+
+/*! 阻塞当前扩展线程 (在临界区内调用) */
+void QXThread_block_(QXThread const *const me);
+
+/*! 解除扩展线程的阻塞 (在临界区内调用) */
+void QXThread_unblock_(QXThread const *const me);
+
+/*! 以内部信号 @p sig 启动扩展线程的私有时间事件 (在临界区内调用) */
+void QXThread_teArm_(QXThread *const me, QSignal const sig,
+                     uint_fast16_t const nTicks);
+
+/*! 解除扩展线程的私有时间事件 (在临界区内调用) */
+bool QXThread_teDisarm_(QXThread *const me);
+
+#endif /* QXK_PKG_H */
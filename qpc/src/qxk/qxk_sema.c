@@ -0,0 +1,185 @@
+/**
+ * @file
+ * @brief QXK/C preemptive kernel counting semaphore implementation
+ * @ingroup qxk
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#define QP_IMPL      /* this is QP implementation */
+#include "qf_port.h" /* QF port */
+#include "qxk_pkg.h" /* QXK package-scope interface */
+#include "qf_pkg.h"  /* QF package-scope internal interface */
+#include "qassert.h" /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+/* 防止在错误的项目中包含此源文件 */
+#ifndef QXK_H
+#error "Source file included in a project NOT based on the QXK kernel"
+#endif /* QXK_H */
+
+Q_DEFINE_THIS_MODULE("qxk_sema")
+
+/****************************************************************************/
+/**
+ * @brief
+ * 初始化计数信号量, 必须在任何线程使用它之前调用.
+ *
+ * @param[in,out] me       指针
+ * @param[in]     count    信号量的初始计数
+ * @param[in]     maxCount 信号量计数的最大值 (二值信号量为 1)
+ */
+void QXSemaphore_init(QXSemaphore *const me, uint_fast8_t const count,
+                      uint_fast8_t const maxCount)
+{
+    /** @pre 最大计数不能为 0, 初始计数不能超过最大计数 */
+    Q_REQUIRE_ID(100, (maxCount != 0U) && (count <= maxCount));
+
+    me->count    = (uint8_t)count;
+    me->maxCount = (uint8_t)maxCount;
+    QPSet_setEmpty(&me->waitSet);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 等待信号量. 计数大于 0 时立即返回, 否则阻塞当前扩展线程, 直到信号量被
+ * 发出, 或者经过 @p nTicks 个时钟滴答.
+ *
+ * @param[in,out] me     指针
+ * @param[in]     nTicks 超时 [滴答], #QXTHREAD_NO_TIMEOUT 表示一直等待
+ *
+ * @returns 'true' 表示获得了信号量, 'false' 表示超时
+ *
+ * @note 只能在扩展线程中调用.
+ */
+bool QXSemaphore_wait(QXSemaphore *const me, uint_fast16_t const nTicks)
+{
+    QXThread *const thr = QXTHREAD_CAST_(QXK_attr_.curr);
+    bool signaled       = true;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+
+    /** @pre 必须在扩展线程中调用, 并且没有持有调度器锁 */
+    Q_REQUIRE_CRIT_(200, (!QXK_ISR_CONTEXT_()) && QXK_IN_XTHREAD_()
+                         && (QXK_attr_.lockHolder != thr->super.prio));
+
+    if (me->count > 0U) {
+        --me->count; /* 直接获得信号量 */
+    } else {
+        QPSet_insert(&me->waitSet, (uint_fast8_t)thr->super.prio);
+        thr->super.super.temp.obj = QXK_PTR_CAST_(struct QMState const *, me);
+        QXThread_teArm_(thr, (QSignal)QXK_WAIT_SIG, nTicks);
+        QXThread_block_(thr);
+        QF_CRIT_X_();
+        QF_CRIT_EXIT_NOP(); /* 在这里切换到其他线程 */
+
+        QF_CRIT_E_();
+        /* QXSemaphore_signal() 清除 temp.obj, 超时则保留 */
+        signaled = (thr->super.super.temp.obj == (struct QMState const *)0);
+        thr->super.super.temp.obj = (struct QMState const *)0;
+    }
+    QF_CRIT_X_();
+
+    return signaled;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 不阻塞地尝试获取信号量, 可以在 ISR, AO 和扩展线程中调用.
+ *
+ * @returns 'true' 表示获得了信号量
+ */
+bool QXSemaphore_tryWait(QXSemaphore *const me)
+{
+    bool isAvailable;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+    isAvailable = (me->count > 0U);
+    if (isAvailable) {
+        --me->count;
+    }
+    QF_CRIT_X_();
+
+    return isAvailable;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 发出信号量. 如果有线程在等待, 唤醒其中优先级最高的一个 (计数不变),
+ * 否则增加计数. 可以在 ISR, AO 和扩展线程中调用.
+ *
+ * @returns 'true' 表示成功, 'false' 表示计数已达到最大值
+ */
+bool QXSemaphore_signal(QXSemaphore *const me)
+{
+    bool signaled = true;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+    if (QPSet_notEmpty(&me->waitSet)) {
+        uint_fast8_t p;
+        QXThread *thr;
+
+        QPSet_findMax(&me->waitSet, p); /* 优先级最高的等待线程 */
+        QPSet_remove(&me->waitSet, p);
+        thr = QXTHREAD_CAST_(QF_active_[p]);
+
+        /* 等待者必须是阻塞在该信号量上的扩展线程 */
+        Q_ASSERT_CRIT_(310, (thr != (QXThread *)0)
+                            && (thr->super.osObject != (void *)0)
+                            && (thr->super.super.temp.obj
+                                == QXK_PTR_CAST_(struct QMState const *, me)));
+
+        (void)QXThread_teDisarm_(thr);
+        thr->super.super.temp.obj = (struct QMState const *)0;
+        QXThread_unblock_(thr);
+    } else if (me->count < me->maxCount) {
+        ++me->count;
+    } else {
+        signaled = false;
+    }
+    QF_CRIT_X_();
+
+    return signaled;
+}
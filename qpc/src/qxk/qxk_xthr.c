@@ -0,0 +1,479 @@
+/**
+ * @file
+ * @brief QXK/C preemptive kernel extended (blocking) thread implementation
+ * @ingroup qxk
+ * @cond
+ ******************************************************************************
+ * Last updated for version 6.9.3
+ * Last updated on  2021-04-08
+ *
+ *                    Q u a n t u m  L e a P s
+ *                    ------------------------
+ *                    Modern Embedded Software
+ *
+ * Copyright (C) 2005-2021 Quantum Leaps, LLC. All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Alternatively, this program may be distributed and modified under the
+ * terms of Quantum Leaps commercial licenses, which expressly supersede
+ * the GNU General Public License and are specifically designed for
+ * licensees interested in retaining the proprietary status of their code.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <www.gnu.org/licenses>.
+ *
+ * Contact information:
+ * <www.state-machine.com/licensing>
+ * <info@state-machine.com>
+ ******************************************************************************
+ * @endcond
+ */
+#define QP_IMPL      /* this is QP implementation */
+#include "qf_port.h" /* QF port */
+#include "qxk_pkg.h" /* QXK package-scope interface */
+#include "qf_pkg.h"  /* QF package-scope internal interface */
+#include "qassert.h" /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY         /* QS software tracing enabled? */
+#include "qs_port.h" /* QS port */
+#include "qs_pkg.h"  /* QS facilities for pre-defined trace records */
+#else
+#include "qs_dummy.h" /* disable the QS software tracing */
+#endif                /* Q_SPY */
+
+/* 防止在错误的项目中包含此源文件 */
+#ifndef QXK_H
+#error "Source file included in a project NOT based on the QXK kernel"
+#endif /* QXK_H */
+
+Q_DEFINE_THIS_MODULE("qxk_xthr")
+
+/* Local-scope function prototypes *****************************************/
+#ifdef Q_SPY
+static void QXThread_init_(QHsm *const me, void const *const par,
+                           uint_fast8_t const qs_id);
+static void QXThread_dispatch_(QHsm *const me, QEvt const *const e,
+                               uint_fast8_t const qs_id);
+static bool QXThread_post_(QActive *const me, QEvt const *const e,
+                           uint_fast16_t const margin,
+                           void const *const sender);
+#else
+static void QXThread_init_(QHsm *const me, void const *const par);
+static void QXThread_dispatch_(QHsm *const me, QEvt const *const e);
+static bool QXThread_post_(QActive *const me, QEvt const *const e,
+                           uint_fast16_t const margin);
+#endif
+static void QXThread_start_(QActive *const me, uint_fast8_t prio,
+                            QEvt const **const qSto, uint_fast16_t const qLen,
+                            void *const stkSto, uint_fast16_t const stkSize,
+                            void const *const par);
+static void QXThread_postLIFO_(QActive *const me, QEvt const *const e);
+
+/****************************************************************************/
+/**
+ * @brief
+ * 执行扩展线程的第一步初始化: 设置线程处理函数和私有时间事件的滴答速率.
+ * 线程在 QXTHREAD_START() 之后才开始运行.
+ *
+ * @param[in,out] me       指针
+ * @param[in]     handler  线程处理函数
+ * @param[in]     tickRate 阻塞超时使用的时钟滴答速率
+ */
+void QXThread_ctor(QXThread *const me, QXThreadHandler handler,
+                   uint_fast8_t tickRate)
+{
+    static QXThreadVtable const vtable = {/* QXThread virtual table */
+                                          {{&QXThread_init_,
+                                            &QXThread_dispatch_
+#ifdef Q_SPY
+                                            ,
+                                            &QHsm_getStateHandler_
+#endif
+                                           },
+                                           &QXThread_start_,
+                                           &QXThread_post_,
+                                           &QXThread_postLIFO_}};
+
+    /** @pre 滴答速率必须在范围内 */
+    Q_REQUIRE_ID(100, tickRate < QF_MAX_TICK_RATE);
+
+    QActive_ctor(&me->super, Q_STATE_CAST(0)); /* superclass' ctor */
+    me->super.super.vptr     = &vtable.super.super; /* hook the vptr */
+    me->super.super.temp.thr = handler;             /* 线程处理函数 */
+
+    /* 私有时间事件: 内部信号小于 Q_USER_SIG, 因此不用 QTimeEvt_ctorX() */
+    me->timeEvt.next          = (QTimeEvt *)0;
+    me->timeEvt.act           = &me->super;
+    me->timeEvt.ctr           = 0U;
+    me->timeEvt.interval      = 0U;
+    me->timeEvt.overrun       = 0U;
+    me->timeEvt.super.sig     = 0U;
+    me->timeEvt.super.poolId_ = 0U;
+    me->timeEvt.super.refCtr_ = (uint8_t)tickRate;
+}
+
+/****************************************************************************/
+/* 扩展线程不是状态机, 不能初始化或分发事件 */
+#ifdef Q_SPY
+static void QXThread_init_(QHsm *const me, void const *const par,
+                           uint_fast8_t const qs_id)
+#else
+static void QXThread_init_(QHsm *const me, void const *const par)
+#endif
+{
+    (void)me;  /* unused parameter */
+    (void)par; /* unused parameter */
+#ifdef Q_SPY
+    (void)qs_id; /* unused parameter */
+#endif
+    Q_ERROR_ID(110);
+}
+/*..........................................................................*/
+#ifdef Q_SPY
+static void QXThread_dispatch_(QHsm *const me, QEvt const *const e,
+                               uint_fast8_t const qs_id)
+#else
+static void QXThread_dispatch_(QHsm *const me, QEvt const *const e)
+#endif
+{
+    (void)me; /* unused parameter */
+    (void)e;  /* unused parameter */
+#ifdef Q_SPY
+    (void)qs_id; /* unused parameter */
+#endif
+    Q_ERROR_ID(120);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 启动扩展线程: 初始化可选的事件队列和私有栈, 注册到 QF 并标记为就绪.
+ *
+ * @note 此函数应通过宏 QXTHREAD_START() 调用.
+ */
+static void QXThread_start_(QActive *const me, uint_fast8_t prio,
+                            QEvt const **const qSto, uint_fast16_t const qLen,
+                            void *const stkSto, uint_fast16_t const stkSize,
+                            void const *const par)
+{
+    QF_CRIT_STAT_
+
+    (void)par; /* unused parameter */
+
+    /** @pre 不能在 ISR 中启动, 优先级必须在范围内, 必须提供私有栈 */
+    Q_REQUIRE_ID(200, (!QXK_ISR_CONTEXT_())
+                      && (0U < prio) && (prio <= QF_MAX_ACTIVE)
+                      && (stkSto != (void *)0) && (stkSize != 0U));
+
+    /* 事件队列是可选的 */
+    QEQueue_init(&me->eQueue, qSto, qLen);
+
+    me->prio    = (uint8_t)prio;
+    me->dynPrio = (uint8_t)prio;
+    QF_add_(me); /* 添加到 QF */
+
+    /* 构造私有栈上的初始上下文, 移植层设置 me->osObject */
+    QXK_stackInit_(me, me->super.temp.thr, stkSto, stkSize);
+    me->super.temp.obj = (struct QMState const *)0; /* 未阻塞 */
+
+    QF_CRIT_E_();
+    QPSet_insert(&QXK_attr_.readySet, (uint_fast8_t)me->dynPrio);
+    if (QXK_sched_() != 0U) { /* 同步抢占? */
+        QXK_activate_();
+    }
+    QF_CRIT_X_(); /* 待处理的上下文切换在这里发生 */
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 向扩展线程的事件队列投递事件 (FIFO). 如果线程正阻塞在 QXThread_queueGet()
+ * 上, 解除其阻塞. 可以在 ISR, AO 和扩展线程中调用.
+ *
+ * @note 此函数应通过宏 QXTHREAD_POST_X() 或 QACTIVE_POST() 调用.
+ */
+#ifdef Q_SPY
+static bool QXThread_post_(QActive *const me, QEvt const *const e,
+                           uint_fast16_t const margin,
+                           void const *const sender)
+#else
+static bool QXThread_post_(QActive *const me, QEvt const *const e,
+                           uint_fast16_t const margin)
+#endif
+{
+    QEQueueCtr nFree;
+    bool status;
+    QF_CRIT_STAT_
+
+    /** @pre 事件指针必须有效, 线程必须有事件队列 */
+    Q_REQUIRE_ID(300, (e != (QEvt *)0) && (me->eQueue.end != 0U));
+
+    QF_CRIT_E_();
+    nFree = me->eQueue.nFree; /* 将 volatile 变量复制到临时变量 */
+
+    if (margin == QF_NO_MARGIN) {
+        if (nFree > 0U) {
+            status = true; /* 可以投递 */
+        } else {
+            status = false;     /* 无法投递 */
+            Q_ERROR_CRIT_(310); /* 必须能够投递事件 */
+        }
+    } else if (nFree > (QEQueueCtr)margin) {
+        status = true; /* 可以投递 */
+    } else {
+        status = false; /* 无法投递, 但不触发断言 */
+    }
+
+    if (status) {
+        if (e->poolId_ != 0U) { /* 是否为动态事件? */
+            QF_EVT_REF_CTR_INC_(e); /* 增加引用计数 */
+        }
+        (void)QACTIVE_INSERT_FIFO_(me, e, sender); /* 同时输出 QS 记录 */
+
+        /* 线程正阻塞在事件队列上? */
+        if (me->super.temp.obj == QXK_PTR_CAST_(struct QMState const *, &me->eQueue)) {
+            (void)QXThread_teDisarm_(QXTHREAD_CAST_(me));
+            me->super.temp.obj = (struct QMState const *)0; /* 解除阻塞 */
+            QXThread_unblock_(QXTHREAD_CAST_(me));
+        }
+    }
+    QF_CRIT_X_();
+
+    return status;
+}
+
+/****************************************************************************/
+/* 扩展线程的事件队列不支持 LIFO 投递 */
+static void QXThread_postLIFO_(QActive *const me, QEvt const *const e)
+{
+    (void)me; /* unused parameter */
+    (void)e;  /* unused parameter */
+    Q_ERROR_ID(400);
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 从当前扩展线程的事件队列中取出事件. 如果队列为空, 线程阻塞直到有事件
+ * 到达, 或者经过 @p nTicks 个时钟滴答.
+ *
+ * @param[in] nTicks 超时 [滴答], #QXTHREAD_NO_TIMEOUT 表示一直等待
+ *
+ * @returns 取出的事件, 超时返回 NULL
+ *
+ * @note 只能在扩展线程中调用. 取出的事件使用完毕后必须调用 QF_gc().
+ */
+QEvt const *QXThread_queueGet(uint_fast16_t const nTicks)
+{
+    QXThread *const thr = QXTHREAD_CAST_(QXK_attr_.curr);
+    QEvt const *e       = (QEvt *)0;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+
+    /** @pre 必须在扩展线程中调用, 线程必须有事件队列, 并且没有持有调度器锁 */
+    Q_REQUIRE_CRIT_(500, (!QXK_ISR_CONTEXT_()) && QXK_IN_XTHREAD_()
+                         && (thr->super.eQueue.end != 0U)
+                         && (QXK_attr_.lockHolder != thr->super.prio));
+
+    if (thr->super.eQueue.frontEvt == (QEvt *)0) { /* 队列为空? */
+        thr->super.super.temp.obj
+            = QXK_PTR_CAST_(struct QMState const *, &thr->super.eQueue);
+        QXThread_teArm_(thr, (QSignal)QXK_QUEUE_SIG, nTicks);
+        QXThread_block_(thr);
+        QF_CRIT_X_();
+        QF_CRIT_EXIT_NOP(); /* 在这里切换到其他线程 */
+
+        QF_CRIT_E_();
+        thr->super.super.temp.obj = (struct QMState const *)0;
+    }
+    if (thr->super.eQueue.frontEvt != (QEvt *)0) { /* 有事件 (未超时)? */
+        e = thr->super.eQueue.frontEvt;
+    }
+    QF_CRIT_X_();
+
+    if (e != (QEvt *)0) {
+        e = QActive_get_(&thr->super); /* 只有该线程会取出事件 */
+    }
+    return e;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 阻塞当前扩展线程 @p nTicks 个时钟滴答.
+ *
+ * @param[in] nTicks 延时 [滴答], 必须大于 0
+ *
+ * @returns 'true' 表示延时正常结束, 'false' 表示被 QXThread_delayCancel() 取消
+ *
+ * @note 只能在扩展线程中调用.
+ */
+bool QXThread_delay(uint_fast16_t const nTicks)
+{
+    QXThread *const thr = QXTHREAD_CAST_(QXK_attr_.curr);
+    bool timedOut;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+
+    /** @pre 必须在扩展线程中调用, 延时不能为 0, 并且没有持有调度器锁 */
+    Q_REQUIRE_CRIT_(600, (!QXK_ISR_CONTEXT_()) && QXK_IN_XTHREAD_()
+                         && (nTicks != 0U)
+                         && (QXK_attr_.lockHolder != thr->super.prio));
+
+    thr->super.super.temp.obj
+        = QXK_PTR_CAST_(struct QMState const *, &thr->timeEvt);
+    QXThread_teArm_(thr, (QSignal)QXK_DELAY_SIG, nTicks);
+    QXThread_block_(thr);
+    QF_CRIT_X_();
+    QF_CRIT_EXIT_NOP(); /* 在这里切换到其他线程 */
+
+    QF_CRIT_E_();
+    timedOut = (thr->super.super.temp.obj != (struct QMState const *)0);
+    thr->super.super.temp.obj = (struct QMState const *)0;
+    QF_CRIT_X_();
+
+    return timedOut;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 取消扩展线程 @p me 的延时, 使其立即就绪.
+ *
+ * @returns 'true' 表示线程正在延时并被唤醒
+ */
+bool QXThread_delayCancel(QXThread *const me)
+{
+    bool wasDelayed;
+    QF_CRIT_STAT_
+
+    QF_CRIT_E_();
+    wasDelayed = (me->super.super.temp.obj
+                  == QXK_PTR_CAST_(struct QMState const *, &me->timeEvt));
+    if (wasDelayed) {
+        (void)QXThread_teDisarm_(me);
+        me->super.super.temp.obj = (struct QMState const *)0;
+        QXThread_unblock_(me);
+    }
+    QF_CRIT_X_();
+
+    return wasDelayed;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 把扩展线程从就绪集合中移除并请求切换到其他线程. 调用者随后退出临界区,
+ * 上下文切换在那里发生, 线程被解除阻塞后从那里继续执行.
+ *
+ * @note 必须在临界区内调用
+ */
+void QXThread_block_(QXThread const *const me)
+{
+    /** @pre 只能阻塞当前线程 */
+    Q_REQUIRE_ID(700, QXK_attr_.curr == &me->super);
+
+    QPSet_remove(&QXK_attr_.readySet, (uint_fast8_t)me->super.dynPrio);
+    (void)QXK_sched_(); /* 在扩展线程中只会请求上下文切换 */
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 把扩展线程插入就绪集合. 在线程级调用时立即调度, 在 ISR 中调用时
+ * 由中断退出 (QXK_ISR_EXIT()) 调度.
+ *
+ * @note 必须在临界区内调用
+ */
+void QXThread_unblock_(QXThread const *const me)
+{
+    QPSet_insert(&QXK_attr_.readySet, (uint_fast8_t)me->super.dynPrio);
+    if (!QXK_ISR_CONTEXT_()) {
+        if (QXK_sched_() != 0U) {
+            QXK_activate_();
+        }
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 以内部信号 @p sig 启动扩展线程的私有时间事件 (一次性). @p nTicks 为
+ * #QXTHREAD_NO_TIMEOUT 时只记录信号, 不启动时间事件.
+ *
+ * @note 必须在临界区内调用. 与 QTimeEvt_armX() 相同, 新启动的时间事件先插入
+ * "新激活"链表, 由 QF_tickX_() 合并到主链表.
+ */
+void QXThread_teArm_(QXThread *const me, QSignal const sig,
+                     uint_fast16_t const nTicks)
+{
+    uint_fast8_t const tickRate
+        = ((uint_fast8_t)me->timeEvt.super.refCtr_ & TE_TICK_RATE);
+
+    /** @pre 时间事件必须未激活, 超时必须在 ::QTimeEvtCtr 的范围内 */
+    Q_REQUIRE_CRIT_(800, (me->timeEvt.ctr == 0U)
+                         && (nTicks <= (uint_fast16_t)(QTimeEvtCtr)(~(QTimeEvtCtr)0)));
+
+    me->timeEvt.super.sig = sig;
+
+    if (nTicks != QXTHREAD_NO_TIMEOUT) {
+        me->timeEvt.ctr      = (QTimeEvtCtr)nTicks;
+        me->timeEvt.interval = 0U;
+
+        /* 时间事件未链接? (可能已解除激活但仍在链表中) */
+        if ((me->timeEvt.super.refCtr_ & TE_IS_LINKED) == 0U) {
+            me->timeEvt.super.refCtr_ |= TE_IS_LINKED; /* 标记为已链接 */
+            me->timeEvt.next = (QTimeEvt *)QF_timeEvtHead_[tickRate].act;
+            QF_timeEvtHead_[tickRate].act = &me->timeEvt;
+        }
+    }
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 解除扩展线程的私有时间事件. 解除链接在 QF_tickX_() 中完成.
+ *
+ * @returns 'true' 表示时间事件当时处于激活状态
+ *
+ * @note 必须在临界区内调用
+ */
+bool QXThread_teDisarm_(QXThread *const me)
+{
+    bool wasArmed = (me->timeEvt.ctr != 0U);
+    me->timeEvt.ctr = 0U; /* 标记从链表中移除 */
+    return wasArmed;
+}
+
+/****************************************************************************/
+/**
+ * @brief
+ * 扩展线程的私有时间事件到期: 把线程从它等待的对象中移除并解除阻塞.
+ * 被唤醒的线程根据 temp.obj 仍然非 NULL 判断发生了超时.
+ *
+ * @note 由 QF_tickX_() 在临界区内调用, 此时一次性时间事件已自动解除.
+ */
+void QXThread_timeout_(QActive *const act)
+{
+    QXThread *const thr = QXTHREAD_CAST_(act);
+
+    /** @pre 线程必须处于阻塞状态 */
+    Q_REQUIRE_ID(900, thr->super.super.temp.obj != (struct QMState const *)0);
+
+    /* 阻塞在信号量或互斥量上? 从等待集合中移除 */
+    if (thr->timeEvt.super.sig == (QSignal)QXK_WAIT_SIG) {
+        QPSet_remove(QXK_PTR_CAST_(QPSet *, thr->super.super.temp.obj),
+                     (uint_fast8_t)thr->super.prio);
+    }
+    QXThread_unblock_(thr);
+}